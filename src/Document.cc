@@ -50,59 +50,91 @@ int Document::numObjects(ObjType type) const
 //   CHECKSUM LOGIC
 //------------------------------------------------------------------------
 
-static void ChecksumThing(crc32_c &crc, const Thing *T)
+//
+// The fields are gathered in a buffer, then checksummed all at once. This
+// gives the same result as adding each field to the checksum in turn.
+//
+class ChecksumBuffer
 {
-	crc += T->raw_x.raw();
-	crc += T->raw_y.raw();
-	crc += T->angle;
-	crc += T->type;
-	crc += T->options;
-}
+public:
+	void add(int value)
+	{
+		u32_t v = (u32_t)value;
+
+		bytes.push_back((u8_t)(v >> 24));
+		bytes.push_back((u8_t)(v >> 16));
+		bytes.push_back((u8_t)(v >> 8));
+		bytes.push_back((u8_t)v);
+	}
 
-static void ChecksumVertex(crc32_c &crc, const Vertex *V)
+	void add(const SString &str)
+	{
+		bytes.insert(bytes.end(), str.c_str(), str.c_str() + str.length());
+	}
+
+	std::vector<u8_t> bytes;
+};
+
+static void ChecksumThing(ChecksumBuffer &buf, const Thing *T)
 {
-	crc += V->raw_x.raw();
-	crc += V->raw_y.raw();
+	buf.add(T->raw_x.raw());
+	buf.add(T->raw_y.raw());
+	buf.add(T->angle);
+	buf.add(T->type);
+	buf.add(T->options);
 }
 
-static void ChecksumSector(crc32_c &crc, const Sector *sector)
+static void ChecksumVertex(ChecksumBuffer &buf, const Vertex *V)
 {
-	crc += sector->floorh;
-	crc += sector->ceilh;
-	crc += sector->light;
-	crc += sector->type;
-	crc += sector->tag;
+	buf.add(V->raw_x.raw());
+	buf.add(V->raw_y.raw());
+}
 
-	crc += sector->FloorTex();
-	crc += sector->CeilTex();
+static void ChecksumSector(ChecksumBuffer &buf, const Sector *sector)
+{
+	buf.add(sector->floorh);
+	buf.add(sector->ceilh);
+	buf.add(sector->light);
+	buf.add(sector->type);
+	buf.add(sector->tag);
+
+	buf.add(sector->FloorTex());
+	buf.add(sector->CeilTex());
 }
 
-static void ChecksumSideDef(crc32_c &crc, const SideDef *S, const Document &doc)
+static void ChecksumSideDef(ChecksumBuffer &buf, const SideDef *S, const Document &doc)
 {
-	crc += S->x_offset;
-	crc += S->y_offset;
+	buf.add(S->x_offset);
+	buf.add(S->y_offset);
 
-	crc += S->LowerTex();
-	crc += S->MidTex();
-	crc += S->UpperTex();
+	buf.add(S->LowerTex());
+	buf.add(S->MidTex());
+	buf.add(S->UpperTex());
 
-	ChecksumSector(crc, &doc.getSector(*S));
+	ChecksumSector(buf, &doc.getSector(*S));
 }
 
-static void ChecksumLineDef(crc32_c &crc, const LineDef *L, const Document &doc)
+static void ChecksumLineDef(ChecksumBuffer &buf, const LineDef *L, const Document &doc)
 {
-	crc += L->flags;
-	crc += L->type;
-	crc += L->tag;
+	buf.add(L->flags);
+	buf.add(L->type);
+	buf.add(L->tag);
 
-	ChecksumVertex(crc, &doc.getStart(*L));
-	ChecksumVertex(crc, &doc.getEnd(*L));
+	ChecksumVertex(buf, &doc.getStart(*L));
+	ChecksumVertex(buf, &doc.getEnd(*L));
 
 	if(doc.getRight(*L))
-		ChecksumSideDef(crc, doc.getRight(*L), doc);
+		ChecksumSideDef(buf, doc.getRight(*L), doc);
 
 	if(doc.getLeft(*L))
-		ChecksumSideDef(crc, doc.getLeft(*L), doc);
+		ChecksumSideDef(buf, doc.getLeft(*L), doc);
+}
+
+bool Document::checksumCountsMatch() const
+{
+	return checksumCounts[0] == numThings() && checksumCounts[1] == numVertices() &&
+		   checksumCounts[2] == numSectors() && checksumCounts[3] == numSidedefs() &&
+		   checksumCounts[4] == numLinedefs();
 }
 
 //
@@ -110,18 +142,45 @@ static void ChecksumLineDef(crc32_c &crc, const LineDef *L, const Document &doc)
 //
 void Document::getLevelChecksum(crc32_c &crc) const
 {
+	// the cached value is only usable when starting from scratch
+	bool fresh = (crc.raw == crc32_c().raw && crc.extra == 0);
+
+	if (fresh && checksumValid && checksumCountsMatch())
+	{
+		crc.raw = checksumRaw;
+		crc.extra = checksumExtra;
+		return;
+	}
+
 	// the following method conveniently skips any unused vertices,
 	// sidedefs and sectors.  It also adds each sector umpteen times
 	// (for each line in the sector), but that should not affect the
 	// validity of the final checksum.
 
+	ChecksumBuffer buf;
+	buf.bytes.reserve((size_t)numThings() * 20 + (size_t)numLinedefs() * 100);
+
 	int i;
 
 	for(i = 0; i < numThings(); i++)
-		ChecksumThing(crc, things[i].get());
+		ChecksumThing(buf, things[i].get());
 
 	for(i = 0; i < numLinedefs(); i++)
-		ChecksumLineDef(crc, linedefs[i].get(), *this);
+		ChecksumLineDef(buf, linedefs[i].get(), *this);
+
+	crc.AddBlock(buf.bytes.data(), (int)buf.bytes.size());
+
+	if (fresh)
+	{
+		checksumRaw = crc.raw;
+		checksumExtra = crc.extra;
+		checksumCounts[0] = numThings();
+		checksumCounts[1] = numVertices();
+		checksumCounts[2] = numSectors();
+		checksumCounts[3] = numSidedefs();
+		checksumCounts[4] = numLinedefs();
+		checksumValid = true;
+	}
 }
 
 const Sector &Document::getSector(const SideDef &side) const
@@ -25,6 +25,7 @@
 #include "e_linedef.h"
 #include "e_objects.h"
 #include "e_sector.h"
+#include "e_tags.h"
 #include "e_vertex.h"
 #include "LineDef.h"
 #include "Vertex.h"
@@ -59,9 +60,10 @@ public:
 	VertexModule vertmod;
 	SectorModule secmod;
 	ObjectsModule objects;
+	TagIndex tags;
 
 	explicit Document(Instance &inst) : inst(inst), basis(*this), checks(*this), hover(*this),
-	linemod(*this), vertmod(*this), secmod(*this), objects(*this)
+	linemod(*this), vertmod(*this), secmod(*this), objects(*this), tags(*this)
 	{
 	}
 
@@ -112,6 +114,12 @@ public:
 	int numObjects(ObjType type) const;
 	void getLevelChecksum(crc32_c &crc) const;
 
+	// called by the basis on every change of the level
+	void invalidateChecksum()
+	{
+		checksumValid = false;
+	}
+
 	const Sector &getSector(const SideDef &side) const;
 	int getSectorID(const LineDef &line, Side side) const;
 	const Vertex &getStart(const LineDef &line) const;
@@ -135,6 +143,15 @@ public:
 	bool isVertical(const LineDef &line) const;
 private:
 	friend class DocumentModule;
+
+	// the last level checksum, valid until the level is changed.
+	// The object counts guard against changes made outside the basis.
+	mutable bool checksumValid = false;
+	mutable u32_t checksumRaw = 0;
+	mutable u32_t checksumExtra = 0;
+	mutable int checksumCounts[5] = {};
+
+	bool checksumCountsMatch() const;
 };
 
 #endif /* Document_hpp */
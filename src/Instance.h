@@ -22,9 +22,12 @@
 #include "bsp.h"
 #include "Document.h"
 #include "e_main.h"
+#include "e_path.h"
 #include "im_img.h"
 #include "m_game.h"
+#include "m_journal.h"
 #include "m_loadsave.h"
+#include "m_perf.h"
 #include "main.h"
 #include "r_grid.h"
 #include "r_render.h"
@@ -39,6 +42,7 @@ class Fl_RGB_Image;
 class Lump_c;
 class UI_NodeDialog;
 class UI_ProjectSetup;
+struct paste_marks_t;
 struct v2double_t;
 struct v2int_t;
 
@@ -46,9 +50,25 @@ struct v2int_t;
 // An instance with a document, holding all other associated data, such as the window reference, the
 // wad list.
 //
-class Instance
+class Instance : public ChangeListener
 {
 public:
+	Instance()
+	{
+		level.basis.addListener(*this);
+	}
+	~Instance()
+	{
+		level.basis.removeListener(*this);
+	}
+
+	// E_MAIN: level changes, passed on to the parts below
+	void notifyBegin() override;
+	void notifyInsert(ObjType type, int objnum, int count) override;
+	void notifyDelete(ObjType type, int objnum) override;
+	void notifyChanges(const ChangeBatch &changes) override;
+	void notifyEnd() override;
+
 	// E_COMMANDS
 	void ACT_Click_release();
 	void ACT_Drag_release();
@@ -117,6 +137,7 @@ public:
 	void CMD_OnlineDocs();
 	void CMD_OpenMap();
 	void CMD_OperationMenu();
+	void CMD_PasteArray();
 	void CMD_PlaceCamera();
 	void CMD_Preferences();
 	void CMD_PruneUnused();
@@ -142,10 +163,12 @@ public:
 	void CMD_TestMap();
 	void CMD_TH_SpinThings();
 	void CMD_ToggleVar();
+	void CMD_TraceDump();
 	void CMD_Undo();
 	void CMD_UnselectAll();
 	void CMD_VT_ShapeArc();
 	void CMD_VT_ShapeLine();
+	void CMD_VT_Weld();
 	void CMD_WHEEL_Scroll();
 	void CMD_Zoom();
 	void CMD_ZoomSelection();
@@ -185,6 +208,11 @@ public:
 	void R3D_WHEEL_Move();
 	void Transform_Update();
 
+	// E_CUTPASTE
+	bool Clipboard_DoCopy();
+	bool Clipboard_DoPaste();
+	bool Clipboard_DoPasteArray(int cols, int rows, v2double_t step, int angle);
+
 	// E_LINEDEF
 	bool LD_RailHeights(int &z1, int &z2, const LineDef *L, const SideDef *sd,
 		const Sector *front, const Sector *back) const;
@@ -199,12 +227,12 @@ public:
 	bool Editor_ParseUser(const std::vector<SString> &tokens);
 	void Editor_WriteUser(std::ostream &os) const;
 	void MapStuff_NotifyBegin();
-	void MapStuff_NotifyChange(ObjType type, int objnum, int field);
+	void MapStuff_NotifyChanges(const ChangeBatch &changes);
 	void MapStuff_NotifyDelete(ObjType type, int objnum);
 	void MapStuff_NotifyEnd();
 	void MapStuff_NotifyInsert(ObjType type, int objnum);
 	void ObjectBox_NotifyBegin();
-	void ObjectBox_NotifyChange(ObjType type, int objnum, int field);
+	void ObjectBox_NotifyChanges(const ChangeBatch &changes);
 	void ObjectBox_NotifyDelete(ObjType type, int objnum);
 	void ObjectBox_NotifyEnd() const;
 	void ObjectBox_NotifyInsert(ObjType type, int objnum);
@@ -273,6 +301,7 @@ public:
 	void LoadLevelNum(Wad_file *wad, int lev_num);
 	bool MissingIWAD_Dialog();
 	void ReplaceEditWad(const std::shared_ptr<Wad_file> &new_wad);
+	void SaveLevel(const SString &level);
 	bool M_SaveMap();
 	void ValidateVertexRefs(LineDef *ld, int num);
 	void ValidateSectorRef(SideDef *sd, int num);
@@ -282,6 +311,11 @@ public:
 	void BuildNodesAfterSave(int lev_idx);
 	void GB_PrintMsg(EUR_FORMAT_STRING(const char *str), ...) const EUR_PRINTF(2, 3);
 
+	// M_PERF
+	std::vector<SString> Perf_OverlayLines() const;
+	void Perf_SetDisplay(int mode);
+	SString Perf_StatusText() const;
+
 	// M_TESTMAP
 	bool M_PortSetupDialog(const SString& port, const SString& game);
 
@@ -308,12 +342,14 @@ public:
 	// R_SOFTWARE
 	bool SW_QueryPoint(Objid &hl, int qx, int qy);
 	void SW_RenderWorld(int ox, int oy, int ow, int oh);
+	void SW_RenderToBuffer();
 
 	// R_SUBDIV
 	sector_3dfloors_c *Subdiv_3DFloorsForSector(int num);
 	void Subdiv_InvalidateAll();
 	bool Subdiv_SectorOnScreen(int num, double map_lx, double map_ly, double map_hx, double map_hy);
 	sector_subdivision_c *Subdiv_PolygonsForSector(int num);
+	void Subdiv_BuildPolygons(const std::vector<int> &sectors);
 
 	// UI_BROWSER
 	void Browser_WriteUser(std::ostream &os) const;
@@ -338,9 +374,8 @@ private:
 	void DoBeginDrag();
 
 	// E_CUTPASTE
-	bool Clipboard_DoCopy();
-	bool Clipboard_DoPaste();
-	void ReselectGroup();
+	v2double_t Clipboard_PastePos() const;
+	void ReselectGroup(const paste_marks_t &marks);
 
 	// E_LINEDEF
 	void commandLinedefMergeTwo();
@@ -395,7 +430,6 @@ private:
 	bool Project_AskFile(fs::path& filename) const;
 	void SaveBehavior();
 	void SaveHeader(const SString &level);
-	void SaveLevel(const SString &level);
 	void SaveLineDefs();
 	void SaveLineDefs_Hexen();
 	void SaveThings();
@@ -405,6 +439,7 @@ private:
 	void SaveSideDefs();
 	void SaveVertices();
 	void ShowLoadProblem() const;
+	void StartJournal(const fs::path &wadPath, const SString &level);
 
 	// M_NODES
 	build_result_e BuildAllNodes(nodebuildinfo_t *info);
@@ -465,6 +500,7 @@ public:	// will be private when we encapsulate everything
 	// Document stuff
 	//
 	bool MadeChanges = false;
+	EditJournal journal;	// crash recovery of the unsaved edits
 	v2double_t Map_bound1 = { 32767, 32767 };	/* minimum XY value of map */
 	v2double_t Map_bound2 = { -32767, -32767 };	/* maximum XY value of map */
 	int moved_vertex_count = 0;
@@ -485,6 +521,7 @@ public:	// will be private when we encapsulate everything
 	int saving_level = 0;
 	UI_NodeDialog *nodeialog = nullptr;
 	nodebuildinfo_t *nb_info = nullptr;
+	partition_memos_t bsp_memos;	// for the incremental builds
 
 	WadData wad;
 
@@ -492,10 +529,11 @@ public:	// will be private when we encapsulate everything
 	// Path stuff
 	//
 	bool sound_propagation_invalid = false;
-	std::vector<byte> sound_prop_vec;
+	std::vector<int> sound_edge_start;	// per sector, into sound_edges
+	std::vector<sound_edge_t> sound_edges;
 	std::vector<byte> sound_temp1_vec;
 	std::vector<byte> sound_temp2_vec;
-	int sound_start_sec = 0;
+	std::unordered_map<int, std::vector<byte>> sound_prop_cache;	// per start sector
 
 	//
 	// IO stuff
@@ -523,6 +561,7 @@ public:	// will be private when we encapsulate everything
 	Grid_State_c grid{ *this };
 	Render_View_t r_view{ *this };
 	sector_info_cache_c sector_info_cache{ *this };
+	PerfCounters perf;
 };
 
 extern Instance gInstance;	// for now we run with one instance, will have more for the MDI.
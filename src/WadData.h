@@ -42,6 +42,18 @@ struct ConfigData;
 // maps type number to an image
 typedef std::map<int, tl::optional<Img_c>> sprite_map_t;
 
+//
+// What an interned texture or flat name stands for in the renderers
+//
+struct resolved_image_t
+{
+	Img_c *img = nullptr;	// NULL when unknown, or for "-" and "#xxxx" textures
+	bool sky = false;		// flats: the sky flat of the game
+	bool null_tex = false;	// textures: "-"
+	bool special = false;	// textures: begins with "#"
+	bool resolved = false;
+};
+
 //
 // Wad image set
 //
@@ -106,8 +118,16 @@ public:
 
 	void W_ClearSprites();
 
+	// bytes of pixels held by the textures, flats and sprites
+	size_t memoryUsage() const;
+
 	void W_UnloadAllTextures();
 
+	// the same as looking up the name of the string ID, but only done
+	// the first time. Changes to the textures or flats start over.
+	const resolved_image_t &resolveTexture(const ConfigData &config, StringID id);
+	const resolved_image_t &resolveFlat(const ConfigData &config, StringID id);
+
 public: // TODO: make private
 	sprite_map_t sprites;
 
@@ -116,7 +136,10 @@ private:
 	// textures which can cause the Medusa Effect in vanilla/chocolate DOOM
 	std::map<SString, int> medusa_textures;
 	std::map<SString, Img_c> flats;
-	
+
+	// per string ID
+	std::vector<resolved_image_t> resolved_textures;
+	std::vector<resolved_image_t> resolved_flats;
 
 	int missing_tex_color = 0;
 	tl::optional<Img_c> missing_tex_image;
@@ -22,8 +22,10 @@
 #define __EUREKA_BSP_H__
 
 #include "lib_util.h"
+#include "m_strings.h"
 #include "sys_type.h"
 
+#include <unordered_map>
 #include <vector>
 
 class Instance;
@@ -32,6 +34,39 @@ struct Sector;
 enum class Side;
 struct Document;
 
+//
+// What an incremental build picked at each node: the signature of the
+// node's segs, and the partition (or none for a subsector).
+//
+struct partition_memo_t
+{
+	uint64_t signature;
+
+	// position of the partition in the seg list, -1 for a subsector
+	int position;
+
+	// the partition line
+	double x1, y1, x2, y2;
+
+	// the memos of the two halves, -1 when none
+	int right, left;
+};
+
+//
+// The partitions of the last successful incremental build.  Each Instance
+// keeps its own, and they only get used for the same level of the same wad.
+//
+struct partition_memos_t
+{
+	SString wad_path;
+	SString level_name;
+
+	std::vector<partition_memo_t> nodes;
+
+	// signature --> index into nodes
+	std::unordered_map<uint64_t, int> index;
+};
+
 // Node Build Information Structure
 //
 // Memory note: when changing the string values here (and in
@@ -54,6 +89,14 @@ struct nodebuildinfo_t
 	bool fast = false;
 	bool warnings = false;
 
+	// reuse the partitions of the last build where they still work, and
+	// optionally build as usual but count where that would differ
+	bool incremental = false;
+	bool verify_incremental = false;
+
+	// where the partitions are kept between builds, needed for the above
+	partition_memos_t *memos = nullptr;
+
 	bool force_v5 = false;
 	bool force_xnod = false;
 	bool force_compress = false;
@@ -582,8 +625,17 @@ quadtree_c *TreeFromSegList(seg_t *list);
 // and '*N' is the new node (and '*S' is set to NULL).  Normally
 // returns BUILD_OK, or BUILD_Cancelled if user stopped it.
 //
+// 'last_memo' is the matching node of the last incremental build (the
+// root is 0), or -1 when there is none.
+//
 build_result_e BuildNodes(seg_t *list, bbox_t *bounds /* output */,
-    node_t ** N, subsec_t ** S, int depth, const Instance &inst);
+    node_t ** N, subsec_t ** S, int depth, const Instance &inst, int last_memo = 0);
+
+// incremental building: the partitions picked by the last successful
+// build of the same level are remembered, and reused where the segs have
+// not changed or the old partition still divides them.
+void BeginIncrementalBuild(const SString &wad_path, const SString &level_name);
+void FinishIncrementalBuild(bool success);
 
 // compute the height of the bsp tree, starting at 'node'.
 int ComputeBspHeight(node_t *node);
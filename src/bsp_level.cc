@@ -2189,8 +2189,13 @@ static build_result_e BuildLevel(nodebuildinfo_t *info, int lev_idx, const Insta
 		// create initial segs
 		seg_t *list = CreateSegs(inst);
 
+		BeginIncrementalBuild(SString(inst.wad.master.edit_wad->PathName().u8string()),
+							  inst.wad.master.edit_wad->GetLump(lev_current_start)->Name());
+
 		// recursively create nodes
 		ret = BuildNodes(list, &root_bbox, &root_node, &root_sub, 0, inst);
+
+		FinishIncrementalBuild(ret == BUILD_OK);
 	}
 
 	if (ret == BUILD_OK)
@@ -46,6 +46,11 @@
 
 #include "w_rawdef.h"
 
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <unordered_map>
+
 
 namespace ajbsp
 {
@@ -789,6 +794,272 @@ static seg_t *PickNode(quadtree_c *tree, int depth, const Document &doc)
 }
 
 
+//------------------------------------------------------------------------
+// INCREMENTAL BUILDING
+//------------------------------------------------------------------------
+
+//
+// What was picked at each node of the last build.  When the segs at a
+// node have the same signature, the same partition is used again and
+// no candidates are evaluated.  The same segs may turn up elsewhere in
+// the tree, so the memos are also found by their signature.
+//
+// When the segs have changed, the old partition is kept if its line is
+// still there and it still divides the segs.  Only the nodes which lost
+// their partition get searched, so the nodes can differ a little from a
+// full build -- the verify option does both and counts the differences.
+//
+// The memos of the last build come from cur_info->memos, the ones of
+// this build are gathered here.
+//
+static std::vector<partition_memo_t> memo_next;
+
+static int memo_reused;
+static int memo_kept;
+static int memo_searched;
+static int memo_differ;
+
+
+static inline bool Incremental()
+{
+	return cur_info->incremental && cur_info->memos;
+}
+
+
+void BeginIncrementalBuild(const SString &wad_path, const SString &level_name)
+{
+	if (! Incremental())
+		return;
+
+	partition_memos_t *memos = cur_info->memos;
+
+	if (wad_path != memos->wad_path || level_name != memos->level_name)
+	{
+		memos->nodes.clear();
+		memos->index.clear();
+	}
+
+	memos->wad_path = wad_path;
+	memos->level_name = level_name;
+
+	memo_next.clear();
+
+	memo_reused   = 0;
+	memo_kept     = 0;
+	memo_searched = 0;
+	memo_differ   = 0;
+}
+
+
+void FinishIncrementalBuild(bool success)
+{
+	if (! Incremental())
+		return;
+
+	partition_memos_t *memos = cur_info->memos;
+
+	if (success)
+	{
+		PrintDetail("Partitions: %d reused, %d kept for changed segs, %d searched\n",
+					memo_reused, memo_kept, memo_searched);
+
+		if (cur_info->verify_incremental)
+			PrintDetail("Partitions differing from a full build: %d\n", memo_differ);
+
+		memos->nodes.swap(memo_next);
+		memos->index.clear();
+
+		for (int i = 0 ; i < (int)memos->nodes.size() ; i++)
+			memos->index[memos->nodes[i].signature] = i;
+	}
+	else
+	{
+		memos->nodes.clear();
+		memos->index.clear();
+	}
+
+	memo_next.clear();
+}
+
+
+static inline void HashMix(uint64_t &hash, uint64_t value)
+{
+	hash = (hash ^ value) * 0x100000001b3ULL;
+	hash ^= hash >> 29;
+}
+
+static inline void HashMix(uint64_t &hash, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	HashMix(hash, bits);
+}
+
+
+//
+// A signature of everything PickNode looks at: the seg geometry in list
+// order, which segs may be partitions or are precious, and which segs
+// come from the same line (by the coordinates of that line, so that
+// renumbering the linedefs does not matter).
+//
+static uint64_t SegListSignature(const std::vector<seg_t *> &segs, const Document &doc)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	HashMix(hash, (uint64_t)cur_info->factor);
+	HashMix(hash, (uint64_t)(cur_info->fast ? 1 : 0));
+	HashMix(hash, (uint64_t)segs.size());
+
+	for (const seg_t *seg : segs)
+	{
+		HashMix(hash, seg->start->x);
+		HashMix(hash, seg->start->y);
+		HashMix(hash, seg->end->x);
+		HashMix(hash, seg->end->y);
+
+		uint64_t kind = 0;
+		if (seg->linedef >= 0)
+			kind = (doc.linedefs[seg->linedef]->flags & MLF_IS_PRECIOUS) ? 2 : 1;
+
+		HashMix(hash, kind);
+
+		const LineDef *source = doc.linedefs[seg->source_line].get();
+
+		HashMix(hash, lev_vertices[source->start]->x);
+		HashMix(hash, lev_vertices[source->start]->y);
+		HashMix(hash, lev_vertices[source->end]->x);
+		HashMix(hash, lev_vertices[source->end]->y);
+	}
+
+	return hash;
+}
+
+
+static inline bool MemoMatchesSeg(const partition_memo_t &memo, const seg_t *seg)
+{
+	return seg->start->x == memo.x1 && seg->start->y == memo.y1 &&
+		   seg->end->x   == memo.x2 && seg->end->y   == memo.y2;
+}
+
+
+//
+// Pick the partition for the segs (in their original list 'order') and
+// record it in memo_next[memo].  Returns NULL for a subsector, or when
+// cancelled.  'last_memo' is updated when the segs are found elsewhere.
+//
+static seg_t *PickNodeIncremental(quadtree_c *tree, int depth,
+		const std::vector<seg_t *> &order, int &last_memo, int memo, const Instance &inst)
+{
+	const Document &doc = inst.level;
+	const partition_memos_t &memos = *cur_info->memos;
+
+	seg_t *part = NULL;
+
+	bool reused = false;
+	bool kept   = false;
+
+	uint64_t signature = memo_next[memo].signature;
+
+	if (last_memo < 0 || memos.nodes[last_memo].signature != signature)
+	{
+		auto it = memos.index.find(signature);
+
+		if (it != memos.index.end())
+			last_memo = it->second;
+	}
+
+	if (last_memo >= 0)
+	{
+		const partition_memo_t &last = memos.nodes[last_memo];
+
+		if (last.signature == signature)
+		{
+			if (last.position < 0)
+			{
+				reused = true;
+			}
+			else if (last.position < (int)order.size() && order[last.position]->linedef >= 0)
+			{
+				part = order[last.position];
+				reused = true;
+			}
+		}
+		else if (last.position >= 0)
+		{
+			for (seg_t *seg : order)
+			{
+				if (seg->linedef >= 0 && MemoMatchesSeg(last, seg))
+				{
+					// it must leave real segs on both sides
+					if (EvalPartition(tree, seg, INT_MAX, doc) >= 0)
+					{
+						part = seg;
+						kept = true;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// the signature could collide, so what is reused gets checked: the
+	// partition has to divide the segs, and a subsector has to be convex
+	// (no partition left to find).
+	if (reused)
+	{
+		if (part ? EvalPartition(tree, part, INT_MAX, doc) < 0 : PickNode(tree, depth, doc) != NULL)
+		{
+			part = NULL;
+			reused = false;
+		}
+	}
+
+	if (reused)
+		memo_reused++;
+	else if (kept)
+		memo_kept++;
+	else
+		part = PickNode(tree, depth, doc);
+
+	if (! (reused || kept))
+	{
+		memo_searched++;
+	}
+	else if (cur_info->verify_incremental)
+	{
+		// build what a full build would, only counting the differences
+		seg_t *full = PickNode(tree, depth, doc);
+
+		if (full != part && !cur_info->cancelled)
+		{
+			memo_differ++;
+
+			if (reused)
+				Warning(inst, "Reused partition differs from a full build (depth %d)\n", depth);
+
+			part = full;
+		}
+	}
+
+	partition_memo_t &rec = memo_next[memo];
+
+	rec.position = -1;
+
+	if (part)
+	{
+		rec.position = (int)(std::find(order.begin(), order.end(), part) - order.begin());
+
+		rec.x1 = part->start->x;
+		rec.y1 = part->start->y;
+		rec.x2 = part->end->x;
+		rec.y2 = part->end->y;
+	}
+
+	return part;
+}
+
+
 //
 // Apply the partition line to the given seg, taking the necessary
 // action (moving it into either the left list, right list, or
@@ -1688,7 +1959,7 @@ static void DebugShowSegs(seg_t *list)
 
 
 build_result_e BuildNodes(seg_t *list, bbox_t *bounds /* output */,
-						  node_t ** N, subsec_t ** S, int depth, const Instance &inst)
+						  node_t ** N, subsec_t ** S, int depth, const Instance &inst, int last_memo)
 {
 	*N = NULL;
 	*S = NULL;
@@ -1704,11 +1975,32 @@ build_result_e BuildNodes(seg_t *list, bbox_t *bounds /* output */,
 	// determine bounds of segs
 	FindLimits2(list, bounds);
 
+	// the tree takes the list apart, so remember the order of the segs
+	std::vector<seg_t *> order;
+	int memo = -1;
+
+	if (! Incremental() || last_memo >= (int)cur_info->memos->nodes.size())
+		last_memo = -1;
+
+	if (Incremental())
+	{
+		for (seg_t *seg = list ; seg ; seg = seg->next)
+			order.push_back(seg);
+
+		memo = (int)memo_next.size();
+		memo_next.push_back(partition_memo_t { SegListSignature(order, inst.level), -1, 0, 0, 0, 0, -1, -1 });
+	}
+
 	quadtree_c *tree = TreeFromSegList(list, bounds);
 
 
 	/* pick partition line  None indicates convexicity */
-	seg_t *part = PickNode(tree, depth, inst.level);
+	seg_t *part;
+
+	if (Incremental())
+		part = PickNodeIncremental(tree, depth, order, last_memo, memo, inst);
+	else
+		part = PickNode(tree, depth, inst.level);
 
 	if (part == NULL)
 	{
@@ -1759,8 +2051,22 @@ build_result_e BuildNodes(seg_t *list, bbox_t *bounds /* output */,
 	gLog.debugPrintf("Build: Going LEFT\n");
 # endif
 
+	// the halves of the last build only match with the same partition
+	int last_left  = -1;
+	int last_right = -1;
+
+	if (last_memo >= 0 && MemoMatchesSeg(cur_info->memos->nodes[last_memo], part))
+	{
+		last_left  = cur_info->memos->nodes[last_memo].left;
+		last_right = cur_info->memos->nodes[last_memo].right;
+	}
+
 	build_result_e ret;
-	ret = BuildNodes(lefts, &node->l.bounds, &node->l.node, &node->l.subsec, depth+1, inst);
+
+	if (memo >= 0)
+		memo_next[memo].left = (int)memo_next.size();
+
+	ret = BuildNodes(lefts, &node->l.bounds, &node->l.node, &node->l.subsec, depth+1, inst, last_left);
 
 	if (ret != BUILD_OK)
 		return ret;
@@ -1769,7 +2075,10 @@ build_result_e BuildNodes(seg_t *list, bbox_t *bounds /* output */,
 	gLog.debugPrintf("Build: Going RIGHT\n");
 # endif
 
-	ret = BuildNodes(rights, &node->r.bounds, &node->r.node, &node->r.subsec, depth+1, inst);
+	if (memo >= 0)
+		memo_next[memo].right = (int)memo_next.size();
+
+	ret = BuildNodes(rights, &node->r.bounds, &node->r.node, &node->r.subsec, depth+1, inst, last_right);
 
 # if DEBUG_BUILDER
 	gLog.debugPrintf("Build: DONE\n");
@@ -28,6 +28,8 @@
 
 #include "w_rawdef.h"
 
+#include <unordered_map>
+
 
 namespace ajbsp
 {
@@ -195,15 +197,35 @@ void Adler32_Begin(u32_t *crc)
 	*crc = 1;
 }
 
+// the most bytes which can be summed before s2 could overflow 32 bits
+#define ADLER_NMAX  5552
+
 void Adler32_AddBlock(u32_t *crc, const u8_t *data, int length)
 {
 	u32_t s1 = (*crc) & 0xFFFF;
 	u32_t s2 = ((*crc) >> 16) & 0xFFFF;
 
-	for ( ; length > 0 ; data++, length--)
+	// only take the modulo once per run of ADLER_NMAX bytes
+	while (length > 0)
 	{
-		s1 = (s1 + *data) % 65521;
-		s2 = (s2 + s1)    % 65521;
+		int count = std::min(length, ADLER_NMAX);
+		length -= count;
+
+		for ( ; count >= 4 ; data += 4, count -= 4)
+		{
+			s1 += data[0]; s2 += s1;
+			s1 += data[1]; s2 += s1;
+			s1 += data[2]; s2 += s1;
+			s1 += data[3]; s2 += s1;
+		}
+
+		for ( ; count > 0 ; data++, count--)
+		{
+			s1 += *data; s2 += s1;
+		}
+
+		s1 %= 65521;
+		s2 %= 65521;
 	}
 
 	*crc = (s2 << 16) | s1;
@@ -398,7 +420,7 @@ void DetectPolyobjSectors(const Instance &inst)
 	for (i = 0 ; i < inst.level.numLinedefs(); i++)
 	{
 		const auto &L = inst.level.linedefs[i];
-        const linetype_t *type = get(inst.conf.line_types, L->type);
+        const linetype_t *type = inst.conf.findLineType(L->type);
         if(type && type->isPolyObjectSpecial())
 			break;
 	}
@@ -422,7 +444,7 @@ void DetectPolyobjSectors(const Instance &inst)
 		double y = T->y();
 
         // ignore everything except polyobj start spots
-        const thingtype_t *type = get(inst.conf.thing_types, T->type);
+        const thingtype_t *type = inst.conf.findThingType(T->type);
         if(!type || !(type->flags & THINGDEF_POLYSPOT))
             continue;
 
@@ -437,55 +459,28 @@ void DetectPolyobjSectors(const Instance &inst)
 
 /* ----- analysis routines ----------------------------- */
 
-static FFixedPoint VertexCompare(const Document &doc, const void *p1, const void *p2)
-{
-	int vert1 = static_cast<const u16_t *>(p1)[0];
-	int vert2 = static_cast<const u16_t *>(p2)[0];
-
-	if (vert1 == vert2)
-		return FFixedPoint{};
-
-	const auto &A = doc.vertices[vert1];
-	const auto &B = doc.vertices[vert2];
-
-	if (A->raw_x != B->raw_x)
-		return A->raw_x - B->raw_x;
-
-	return A->raw_y - B->raw_y;
-}
-
-
 void DetectOverlappingVertices(const Document &doc)
 {
 	SYS_ASSERT(num_vertices == doc.numVertices());
 
-	u16_t *array = new u16_t[num_vertices];
+	// raw coordinates --> first vertex there
+	std::unordered_map<uint64_t, vertex_t *> first_at;
+	first_at.reserve(num_vertices);
 
-	// sort array of indices
-	int i;
-	for (i=0 ; i < num_vertices ; i++)
-		array[i] = static_cast<u16_t>(i);
+	for (int i = 0 ; i < num_vertices ; i++)
+	{
+		const auto &V = doc.vertices[i];
 
-	std::sort(array, array + num_vertices, [&doc](u16_t left, u16_t right)
-		{
-			return VertexCompare(doc, &left, &right).raw() < 0;
-		});
+		uint64_t key = ((uint64_t)(uint32_t)V->raw_x.raw() << 32) | (uint32_t)V->raw_y.raw();
 
-	// now mark them off
-	for (i=0 ; i < num_vertices - 1 ; i++)
-	{
-		if (VertexCompare(doc, array + i, array + i + 1).raw() == 0)
+		auto found = first_at.emplace(key, lev_vertices[i]);
+
+		if (! found.second)
 		{
 			// found an overlap!
-
-			vertex_t *A = lev_vertices[array[i]];
-			vertex_t *B = lev_vertices[array[i+1]];
-
-			B->overlap = A->overlap ? A->overlap : A;
+			lev_vertices[i]->overlap = found.first->second;
 		}
 	}
-
-	delete[] array;
 }
 
 
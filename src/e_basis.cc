@@ -29,19 +29,20 @@
 #include "Errors.h"
 #include "Instance.h"
 #include "LineDef.h"
+#include "m_config.h"
 #include "main.h"
 #include "Sector.h"
 #include "SideDef.h"
+#include "sys_trace.h"
 #include "Thing.h"
 #include "Vertex.h"
 
-// need these for the XXX_Notify() prototypes
-#include "r_render.h"
-
 int global::default_floor_h		=   0;
 int global::default_ceil_h		= 128;
 int global::default_light_level	= 176;
 
+int config::undo_max_space = 64;	// MB
+
 static StringTable basis_strtab;
 
 const char *NameForObjectType(ObjType type, bool plural)
@@ -97,8 +98,7 @@ void Basis::begin()
 {
 	if(mCurrentGroup.isActive())
 		BugError("Basis::begin called twice without Basis::end\n");
-	while(!mRedoFuture.empty())
-		mRedoFuture.pop();
+	clearRedoFuture();
 	mCurrentGroup.activate();
 	doClearChangeStatus();
 }
@@ -108,6 +108,8 @@ void Basis::begin()
 //
 void Basis::end()
 {
+	TRACE_SCOPE("edit", "Basis::end");
+
 	if(!mCurrentGroup.isActive())
 		BugError("Basis::end called without a previous Basis::begin\n");
 	mCurrentGroup.end();
@@ -117,9 +119,14 @@ void Basis::end()
 	else
 	{
 		SString message = mCurrentGroup.getMessage();
-		mUndoHistory.push(std::move(mCurrentGroup));
+		if(inst.journal.isActive())
+			inst.journal.append(mJournalOps.finish(doc, true, message));
+		mHistoryMemory += mCurrentGroup.getMemory();
+		mUndoHistory.push_back(std::move(mCurrentGroup));
+		trimUndoHistory();
 		inst.Status_Set("%s", message.c_str());
 	}
+	mJournalOps.clear();
 	doProcessChangeStatus();
 }
 
@@ -137,6 +144,9 @@ void Basis::abort(bool keepChanges)
 
 	if(!keepChanges && !mCurrentGroup.isEmpty())
 		mCurrentGroup.reapply(*this);
+	else if(keepChanges && !mJournalOps.isEmpty() && inst.journal.isActive())
+		inst.journal.append(mJournalOps.finish(doc, false, ""));
+	mJournalOps.clear();
 
 	mCurrentGroup.reset();
 	mDidMakeChanges = false;
@@ -192,42 +202,45 @@ int Basis::addNew(ObjType type)
 
 	op.action = EditType::insert;
 	op.objtype = type;
+	op.objnum = doc.numObjects(type);
+	op.value = mCurrentGroup.addObjectSlot(type, true);
 
-	switch(type)
-	{
-	case ObjType::things:
-		op.objnum = doc.numThings();
-		op.thing = std::make_unique<Thing>();
-		break;
+	int objnum = op.objnum;
+	mCurrentGroup.addApply(std::move(op), *this);
 
-	case ObjType::vertices:
-		op.objnum = doc.numVertices();
-		op.vertex = std::make_unique<Vertex>();
-		break;
+	return objnum;
+}
 
-	case ObjType::sidedefs:
-		op.objnum = doc.numSidedefs();
-		op.sidedef = std::make_unique<SideDef>();
-		break;
+//
+// create 'count' new objects at the end, returning the objnum of the
+// first one.  The listeners get told about them once, as a batch.
+//
+int Basis::addNew(ObjType type, int count)
+{
+	SYS_ASSERT(mCurrentGroup.isActive());
+	SYS_ASSERT(count > 0);
 
-	case ObjType::linedefs:
-		op.objnum = doc.numLinedefs();
-		op.linedef = std::make_unique<LineDef>();
-		break;
+	int first = doc.numObjects(type);
 
-	case ObjType::sectors:
-		op.objnum = doc.numSectors();
-		op.sector = std::make_unique<Sector>();
-		break;
+	notifyInsert(type, first, count);
 
-	default:
-		BugError("Basis::addNew: unknown type\n");
+	mInsertingBatch = true;
+
+	for(int k = 0; k < count; k++)
+	{
+		EditUnit op;
+
+		op.action = EditType::insert;
+		op.objtype = type;
+		op.objnum = first + k;
+		op.value = mCurrentGroup.addObjectSlot(type, true);
+
+		mCurrentGroup.addApply(std::move(op), *this);
 	}
 
-	int objnum = op.objnum;
-	mCurrentGroup.addApply(std::move(op), *this);
+	mInsertingBatch = false;
 
-	return objnum;
+	return first;
 }
 
 //
@@ -239,12 +252,6 @@ void Basis::del(ObjType type, int objnum)
 {
 	SYS_ASSERT(mCurrentGroup.isActive());
 
-	EditUnit op;
-
-	op.action = EditType::del;
-	op.objtype = type;
-	op.objnum = objnum;
-
 	// this must happen _before_ doing the deletion (otherwise
 	// when we undo, the insertion will mess up the references).
 	if(type == ObjType::sidedefs)
@@ -280,8 +287,24 @@ void Basis::del(ObjType type, int objnum)
 				del(ObjType::sidedefs, n);
 	}
 
+	rawDel(type, objnum);
+}
+
+//
+// delete just the given object, with no handling of the objects bound
+// to it (the journal replay records those separately).
+//
+void Basis::rawDel(ObjType type, int objnum)
+{
 	SYS_ASSERT(mCurrentGroup.isActive());
 
+	EditUnit op;
+
+	op.action = EditType::del;
+	op.objtype = type;
+	op.objnum = objnum;
+	op.value = mCurrentGroup.addObjectSlot(type, false);
+
 	mCurrentGroup.addApply(std::move(op), *this);
 }
 
@@ -396,8 +419,8 @@ bool Basis::undo()
 
 	doClearChangeStatus();
 
-	UndoGroup grp = std::move(mUndoHistory.top());
-	mUndoHistory.pop();
+	UndoGroup grp = std::move(mUndoHistory.back());
+	mUndoHistory.pop_back();
 
 	inst.Status_Set("UNDO: %s", grp.getMessage().c_str());
 
@@ -405,6 +428,9 @@ bool Basis::undo()
 
 	mRedoFuture.push(std::move(grp));
 
+	if(inst.journal.isActive())
+		inst.journal.appendUndo();
+
 	doProcessChangeStatus();
 	return true;
 }
@@ -427,7 +453,10 @@ bool Basis::redo()
 
 	grp.reapply(*this);
 
-	mUndoHistory.push(std::move(grp));
+	mUndoHistory.push_back(std::move(grp));
+
+	if(inst.journal.isActive())
+		inst.journal.appendRedo();
 
 	doProcessChangeStatus();
 	return true;
@@ -448,10 +477,13 @@ void Basis::clearAll()
 	doc.behaviorData.clear();
 	doc.scriptsData.clear();
 
-	while(!mUndoHistory.empty())
-		mUndoHistory.pop();
-	while(!mRedoFuture.empty())
-		mRedoFuture.pop();
+	mUndoHistory.clear();
+	clearRedoFuture();
+	mHistoryMemory = 0;
+	mJournalOps.clear();
+	doc.hover.invalidateIndexes();
+	doc.tags.invalidateIndexes();
+	doc.invalidateChecksum();
 
 	// Note: we don't clear the string table, since there can be
 	//       string references in the clipboard.
@@ -460,10 +492,40 @@ void Basis::clearAll()
 	Clipboard_ClearLocals();
 }
 
+//
+// forget the redo steps
+//
+void Basis::clearRedoFuture()
+{
+	while(!mRedoFuture.empty())
+	{
+		mHistoryMemory -= mRedoFuture.top().getMemory();
+		mRedoFuture.pop();
+	}
+}
+
+//
+// drop the oldest undo steps until the history fits in the configured
+// space. The latest step is always kept.
+//
+void Basis::trimUndoHistory()
+{
+	if(config::undo_max_space <= 0)
+		return;
+
+	size_t limit = (size_t)config::undo_max_space << 20;
+
+	while(mHistoryMemory > limit && mUndoHistory.size() > 1)
+	{
+		mHistoryMemory -= mUndoHistory.front().getMemory();
+		mUndoHistory.pop_front();
+	}
+}
+
 //
 // Execute the operation
 //
-void Basis::EditUnit::apply(Basis &basis)
+void Basis::EditUnit::apply(Basis &basis, UndoGroup &group)
 {
 	switch(action)
 	{
@@ -471,11 +533,11 @@ void Basis::EditUnit::apply(Basis &basis)
 		rawChange(basis);
 		return;
 	case EditType::del:
-		rawDelete(basis);
+		rawDelete(basis, group);
 		action = EditType::insert;	// reverse the operation
 		return;
 	case EditType::insert:
-		rawInsert(basis);
+		rawInsert(basis, group);
 		action = EditType::del;	// reverse the operation
 		return;
 	default:
@@ -483,23 +545,6 @@ void Basis::EditUnit::apply(Basis &basis)
 	}
 }
 
-//
-// Destroy an inst.inst.edit operation
-//
-void Basis::EditUnit::destroy()
-{
-	switch(action)
-	{
-	case EditType::insert:
-		deleteFinally();
-		break;
-	case EditType::del:
-		break;
-	default:
-		break;
-	}
-}
-
 //
 // Execute the raw change
 //
@@ -536,48 +581,50 @@ void Basis::EditUnit::rawChange(Basis &basis)
 	std::swap(pos[field], value);
 	basis.mDidMakeChanges = true;
 
-	// TODO: their modules
-	Clipboard_NotifyChange(objtype, objnum, field);
-	Selection_NotifyChange(objtype, objnum, field);
-	basis.inst.MapStuff_NotifyChange(objtype, objnum, field);
-	Render3D_NotifyChange(objtype, objnum, field);
-	basis.inst.ObjectBox_NotifyChange(objtype, objnum, field);
+	basis.mChanges.add(objtype, objnum, field);
+
+	// queries during the operation must see the change right away
+	basis.doc.hover.notifyChange(objtype, objnum, field);
+	basis.doc.tags.notifyChange(objtype, objnum, field);
+	basis.doc.invalidateChecksum();
 }
 
 //
 // Deletion operation
 //
-void Basis::EditUnit::rawDelete(Basis &basis)
+void Basis::EditUnit::rawDelete(Basis &basis, UndoGroup &group)
 {
 	basis.mDidMakeChanges = true;
 
-	// TODO: their own modules
-	Clipboard_NotifyDelete(objtype, objnum);
-	basis.inst.Selection_NotifyDelete(objtype, objnum);
-	basis.inst.MapStuff_NotifyDelete(objtype, objnum);
-	Render3D_NotifyDelete(basis.doc, objtype, objnum);
-	basis.inst.ObjectBox_NotifyDelete(objtype, objnum);
+	// pending changes still use the old numbering
+	basis.flushChanges();
+
+	for(ChangeListener *listener : basis.mListeners)
+		listener->notifyDelete(objtype, objnum);
+	basis.doc.hover.notifyDelete(objtype, objnum);
+	basis.doc.tags.notifyDelete(objtype, objnum);
+	basis.doc.invalidateChecksum();
 
 	switch(objtype)
 	{
 	case ObjType::things:
-		thing = rawDeleteThing(basis.doc);
+		group.mThings[value] = rawDeleteThing(basis.doc);
 		return;
 
 	case ObjType::vertices:
-		vertex = rawDeleteVertex(basis.doc);
+		group.mVertices[value] = rawDeleteVertex(basis.doc);
 		return;
 
 	case ObjType::sectors:
-		sector = rawDeleteSector(basis.doc);
+		group.mSectors[value] = rawDeleteSector(basis.doc);
 		return;
 
 	case ObjType::sidedefs:
-		sidedef = rawDeleteSidedef(basis.doc);
+		group.mSidedefs[value] = rawDeleteSidedef(basis.doc);
 		return;
 
 	case ObjType::linedefs:
-		linedef = rawDeleteLinedef(basis.doc);
+		group.mLinedefs[value] = rawDeleteLinedef(basis.doc);
 		return;
 
 	default:
@@ -699,42 +746,31 @@ std::unique_ptr<LineDef> Basis::EditUnit::rawDeleteLinedef(Document &doc) const
 //
 // Insert operation
 //
-void Basis::EditUnit::rawInsert(Basis &basis)
+void Basis::EditUnit::rawInsert(Basis &basis, UndoGroup &group)
 {
-	basis.mDidMakeChanges = true;
-
-	// TODO: their module
-	Clipboard_NotifyInsert(basis.doc, objtype, objnum);
-	basis.inst.Selection_NotifyInsert(objtype, objnum);
-	basis.inst.MapStuff_NotifyInsert(objtype, objnum);
-	Render3D_NotifyInsert(objtype, objnum);
-	basis.inst.ObjectBox_NotifyInsert(objtype, objnum);
+	if(!basis.mInsertingBatch)
+		basis.notifyInsert(objtype, objnum, 1);
 
 	switch(objtype)
 	{
 	case ObjType::things:
-		rawInsertThing(basis.doc);
-		thing.reset();	// normally already reset
+		rawInsertThing(basis.doc, std::move(group.mThings[value]));
 		break;
 
 	case ObjType::vertices:
-		rawInsertVertex(basis.doc);
-		vertex.reset();
+		rawInsertVertex(basis.doc, std::move(group.mVertices[value]));
 		break;
 
 	case ObjType::sidedefs:
-		rawInsertSidedef(basis.doc);
-		sidedef.reset();
+		rawInsertSidedef(basis.doc, std::move(group.mSidedefs[value]));
 		break;
 
 	case ObjType::sectors:
-		rawInsertSector(basis.doc);
-		sector.reset();
+		rawInsertSector(basis.doc, std::move(group.mSectors[value]));
 		break;
 
 	case ObjType::linedefs:
-		rawInsertLinedef(basis.doc);
-		linedef.reset();
+		rawInsertLinedef(basis.doc, std::move(group.mLinedefs[value]));
 		break;
 
 	default:
@@ -745,7 +781,7 @@ void Basis::EditUnit::rawInsert(Basis &basis)
 //
 // Thing insertion
 //
-void Basis::EditUnit::rawInsertThing(Document &doc)
+void Basis::EditUnit::rawInsertThing(Document &doc, std::unique_ptr<Thing> &&thing) const
 {
 	SYS_ASSERT(0 <= objnum && objnum <= doc.numThings());
 	doc.things.insert(doc.things.begin() + objnum, std::move(thing));
@@ -754,7 +790,7 @@ void Basis::EditUnit::rawInsertThing(Document &doc)
 //
 // Vertex insertion
 //
-void Basis::EditUnit::rawInsertVertex(Document &doc)
+void Basis::EditUnit::rawInsertVertex(Document &doc, std::unique_ptr<Vertex> &&vertex) const
 {
 	SYS_ASSERT(0 <= objnum && objnum <= doc.numVertices());
 	doc.vertices.insert(doc.vertices.begin() + objnum, std::move(vertex));
@@ -779,7 +815,7 @@ void Basis::EditUnit::rawInsertVertex(Document &doc)
 //
 // Sector insertion
 //
-void Basis::EditUnit::rawInsertSector(Document &doc)
+void Basis::EditUnit::rawInsertSector(Document &doc, std::unique_ptr<Sector> &&sector) const
 {
 	SYS_ASSERT(0 <= objnum && objnum <= doc.numSectors());
 	doc.sectors.insert(doc.sectors.begin() + objnum, std::move(sector));
@@ -801,7 +837,7 @@ void Basis::EditUnit::rawInsertSector(Document &doc)
 //
 // Sidedef insertion
 //
-void Basis::EditUnit::rawInsertSidedef(Document &doc)
+void Basis::EditUnit::rawInsertSidedef(Document &doc, std::unique_ptr<SideDef> &&sidedef) const
 {
 	SYS_ASSERT(0 <= objnum && objnum <= doc.numSidedefs());
 	doc.sidedefs.insert(doc.sidedefs.begin() + objnum, std::move(sidedef));
@@ -826,38 +862,27 @@ void Basis::EditUnit::rawInsertSidedef(Document &doc)
 //
 // Linedef insertion
 //
-void Basis::EditUnit::rawInsertLinedef(Document &doc)
+void Basis::EditUnit::rawInsertLinedef(Document &doc, std::unique_ptr<LineDef> &&linedef) const
 {
 	SYS_ASSERT(0 <= objnum && objnum <= doc.numLinedefs());
 	doc.linedefs.insert(doc.linedefs.begin() + objnum, std::move(linedef));
 }
 
-//
-// Action to do on destruction of insert operation
-//
-void Basis::EditUnit::deleteFinally()
-{
-	switch(objtype)
-	{
-	case ObjType::things:   thing.reset(); break;
-	case ObjType::vertices: vertex.reset(); break;
-	case ObjType::sectors:  sector.reset(); break;
-	case ObjType::sidedefs: sidedef.reset(); break;
-	case ObjType::linedefs: linedef.reset(); break;
-
-	default:
-		BugError("DeleteFinally: bad objtype %d\n", (int)objtype);
-	}
-}
-
 //
 // Move operator
 //
 Basis::UndoGroup &Basis::UndoGroup::operator = (UndoGroup &&other) noexcept
 {
 	mOps = std::move(other.mOps);
+	mThings = std::move(other.mThings);
+	mVertices = std::move(other.mVertices);
+	mSectors = std::move(other.mSectors);
+	mSidedefs = std::move(other.mSidedefs);
+	mLinedefs = std::move(other.mLinedefs);
+	mChangeIndex = std::move(other.mChangeIndex);
 	mDir = other.mDir;
 	mMessage = std::move(other.mMessage);
+	mMemory = other.mMemory;
 
 	other.reset();	// ensure the other goes into the default state
 	return *this;
@@ -869,17 +894,116 @@ Basis::UndoGroup &Basis::UndoGroup::operator = (UndoGroup &&other) noexcept
 void Basis::UndoGroup::reset()
 {
 	mOps.clear();
+	mThings.clear();
+	mVertices.clear();
+	mSectors.clear();
+	mSidedefs.clear();
+	mLinedefs.clear();
+	mChangeIndex.clear();
 	mDir = 0;
 	mMessage = DEFAULT_UNDO_GROUP_MESSAGE;
+	mMemory = 0;
 }
 
 //
-// Add and apply
+// Reserve a slot in the object store for an insertion or deletion.
+// Insertions start out owning a fresh object.
+//
+int Basis::UndoGroup::addObjectSlot(ObjType type, bool withNewObject)
+{
+	switch(type)
+	{
+	case ObjType::things:
+		mThings.push_back(withNewObject ? std::make_unique<Thing>() : nullptr);
+		return (int)mThings.size() - 1;
+	case ObjType::vertices:
+		mVertices.push_back(withNewObject ? std::make_unique<Vertex>() : nullptr);
+		return (int)mVertices.size() - 1;
+	case ObjType::sectors:
+		mSectors.push_back(withNewObject ? std::make_unique<Sector>() : nullptr);
+		return (int)mSectors.size() - 1;
+	case ObjType::sidedefs:
+		mSidedefs.push_back(withNewObject ? std::make_unique<SideDef>() : nullptr);
+		return (int)mSidedefs.size() - 1;
+	case ObjType::linedefs:
+		mLinedefs.push_back(withNewObject ? std::make_unique<LineDef>() : nullptr);
+		return (int)mLinedefs.size() - 1;
+	default:
+		BugError("Basis::UndoGroup::addObjectSlot: bad objtype %u\n", (unsigned)type);
+		return -1; /* NOT REACHED */
+	}
+}
+
+//
+// Add and apply. A change to a field which was already changed in this
+// group (with no insertion or deletion in between) is only applied: the
+// first record already holds the value to restore.
 //
 void Basis::UndoGroup::addApply(EditUnit &&op, Basis &basis)
 {
+	basis.journalOp(op);
+
+	if(op.action != EditType::change)
+	{
+		mChangeIndex.clear();	// object numbers may shift
+		mOps.push_back(std::move(op));
+		mOps.back().apply(basis, *this);
+		return;
+	}
+
+	auto inserted = mChangeIndex.emplace(changeKey(op), (int)mOps.size());
+	if(!inserted.second)
+	{
+		op.apply(basis, *this);
+		return;
+	}
+
 	mOps.push_back(std::move(op));
-	mOps.back().apply(basis);
+	mOps.back().apply(basis, *this);
+}
+
+//
+// Record an operation for the edit journal, before it's applied
+//
+void Basis::journalOp(const EditUnit &op)
+{
+	if(!inst.journal.isActive())
+		return;
+
+	switch(op.action)
+	{
+	case EditType::change:
+		mJournalOps.addChange(op.objtype, op.objnum, op.field, op.value);
+		break;
+	case EditType::insert:
+		mJournalOps.addInsert(op.objtype, op.objnum);
+		break;
+	case EditType::del:
+		mJournalOps.addDelete(op.objtype, op.objnum);
+		break;
+	default:
+		BugError("Basis::journalOp: bad action\n");
+	}
+}
+
+//
+// End current action: drop the building state and compute the footprint
+//
+void Basis::UndoGroup::end()
+{
+	mDir = -1;
+
+	mChangeIndex.clear();
+	mChangeIndex.rehash(0);
+	mOps.shrink_to_fit();
+
+	mMemory = sizeof(UndoGroup) + mMessage.length() +
+			mOps.size() * sizeof(EditUnit) +
+			mThings.size() * (sizeof(Thing) + sizeof(void *)) +
+			mVertices.size() * (sizeof(Vertex) + sizeof(void *)) +
+			mSectors.size() * (sizeof(Sector) + sizeof(void *)) +
+			mSidedefs.size() * (sizeof(SideDef) + sizeof(void *)) +
+			mLinedefs.size() * (sizeof(LineDef) + sizeof(void *));
 }
 
 //
@@ -889,10 +1013,10 @@ void Basis::UndoGroup::reapply(Basis &basis)
 {
 	if(mDir > 0)
 		for(auto it = mOps.begin(); it != mOps.end(); ++it)
-			it->apply(basis);
+			it->apply(basis, *this);
 	else if(mDir < 0)
 		for(auto it = mOps.rbegin(); it != mOps.rend(); ++it)
-			it->apply(basis);
+			it->apply(basis, *this);
 
 	// reverse the order for next time
 	mDir = -mDir;
@@ -904,19 +1028,16 @@ void Basis::UndoGroup::reapply(Basis &basis)
 void Basis::doClearChangeStatus()
 {
 	mDidMakeChanges = false;
+	mChanges.clear();
 
-	// TODO: these shall go to other modules
-	Clipboard_NotifyBegin();
-	inst.Selection_NotifyBegin();
-	inst.MapStuff_NotifyBegin();
-	Render3D_NotifyBegin();
-	inst.ObjectBox_NotifyBegin();
+	for(ChangeListener *listener : mListeners)
+		listener->notifyBegin();
 }
 
 //
 // If we made changes, notify the others
 //
-void Basis::doProcessChangeStatus() const
+void Basis::doProcessChangeStatus()
 {
 	if(mDidMakeChanges)
 	{
@@ -925,11 +1046,103 @@ void Basis::doProcessChangeStatus() const
 		inst.RedrawMap();
 	}
 
-	Clipboard_NotifyEnd();
-	inst.Selection_NotifyEnd();
-	inst.MapStuff_NotifyEnd();
-	Render3D_NotifyEnd(inst);
-	inst.ObjectBox_NotifyEnd();
+	flushChanges();
+
+	for(ChangeListener *listener : mListeners)
+		listener->notifyEnd();
+	doc.hover.notifyEnd();
+}
+
+//
+// Send the gathered field changes to the listeners
+//
+void Basis::flushChanges()
+{
+	if(mChanges.isEmpty())
+		return;
+
+	for(ChangeListener *listener : mListeners)
+		listener->notifyChanges(mChanges);
+
+	mChanges.clear();
+}
+
+//
+// Objects about to be inserted
+//
+void Basis::notifyInsert(ObjType type, int objnum, int count)
+{
+	mDidMakeChanges = true;
+
+	flushChanges();
+
+	for(ChangeListener *listener : mListeners)
+		listener->notifyInsert(type, objnum, count);
+	doc.hover.notifyInsert(type, objnum, count);
+	doc.tags.notifyInsert(type, objnum, count);
+	doc.invalidateChecksum();
+}
+
+//
+// Stop notifying a listener
+//
+void Basis::removeListener(ChangeListener &listener)
+{
+	auto it = std::find(mListeners.begin(), mListeners.end(), &listener);
+	if(it != mListeners.end())
+		mListeners.erase(it);
+}
+
+//
+// Add a field change
+//
+void ChangeBatch::add(ObjType type, int objnum, byte field)
+{
+	SYS_ASSERT(field < 32);
+
+	TypeChanges &changes = mTypes[(int)type];
+
+	if(objnum >= (int)changes.marked.size())
+		changes.marked.resize(objnum + 1);
+
+	if(!changes.marked[objnum])
+	{
+		changes.marked[objnum] = true;
+		changes.objects.push_back(objnum);
+	}
+
+	changes.fields |= 1u << field;
+	mEmpty = false;
+}
+
+//
+// Empty it, in time proportional to the changes
+//
+void ChangeBatch::clear()
+{
+	if(mEmpty)
+		return;
+
+	for(TypeChanges &changes : mTypes)
+	{
+		for(int objnum : changes.objects)
+			changes.marked[objnum] = false;
+
+		changes.objects.clear();
+		changes.fields = 0;
+	}
+
+	mEmpty = true;
+}
+
+//
+// Whether the given object got changed
+//
+bool ChangeBatch::hasObject(ObjType type, int objnum) const
+{
+	const TypeChanges &changes = mTypes[(int)type];
+
+	return objnum >= 0 && objnum < (int)changes.marked.size() && changes.marked[objnum];
 }
 
 //
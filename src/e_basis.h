@@ -29,14 +29,17 @@
 
 #include "DocumentModule.h"
 #include "LineDef.h"
+#include "m_journal.h"
 #include "m_strings.h"
 #include "objid.h"
 #include "Sector.h"
 #include "SideDef.h"
 #include "Thing.h"
 #include "Vertex.h"
+#include <deque>
 #include <memory>
 #include <stack>
+#include <unordered_map>
 
 #define DEFAULT_UNDO_GROUP_MESSAGE "[something]"
 
@@ -73,6 +76,69 @@ namespace global
 
 FFixedPoint MakeValidCoord(MapFormat format, double x);
 
+//
+// Field changes made during an edit operation, gathered per object type,
+// so they can be handled in one go
+//
+class ChangeBatch
+{
+public:
+	void add(ObjType type, int objnum, byte field);
+	void clear();
+
+	bool isEmpty() const
+	{
+		return mEmpty;
+	}
+
+	//
+	// Every changed object once, in order of its first change
+	//
+	const std::vector<int> &getObjects(ObjType type) const
+	{
+		return mTypes[(int)type].objects;
+	}
+
+	bool hasObject(ObjType type, int objnum) const;
+
+	//
+	// Whether the field got changed in any of the objects
+	//
+	bool hasField(ObjType type, int field) const
+	{
+		return (mTypes[(int)type].fields >> field & 1) != 0;
+	}
+
+private:
+	struct TypeChanges
+	{
+		std::vector<int> objects;
+		std::vector<bool> marked;	// by object number
+		uint32_t fields = 0;	// bit per field
+	};
+
+	TypeChanges mTypes[5];
+	bool mEmpty = true;
+};
+
+//
+// Gets told about the changes to the level. Insertions and deletions come
+// as they happen, since they renumber the objects. Field changes are held
+// back until the next of those, or until the operation ends. A batch of
+// objects added together is one insertion of 'count' objects.
+//
+class ChangeListener
+{
+public:
+	virtual void notifyBegin() = 0;
+	virtual void notifyInsert(ObjType type, int objnum, int count) = 0;
+	virtual void notifyDelete(ObjType type, int objnum) = 0;
+	virtual void notifyChanges(const ChangeBatch &changes) = 0;
+	virtual void notifyEnd() = 0;
+
+	virtual ~ChangeListener() = default;
+};
+
 //
 // Editor command manager, handles undo/redo
 //
@@ -87,7 +153,23 @@ public:
 	bool redo();
 	void clearAll();
 
+	void addListener(ChangeListener &listener)
+	{
+		mListeners.push_back(&listener);
+	}
+	void removeListener(ChangeListener &listener);
+
+	//
+	// Approximate memory (in bytes) held by the undo and redo history
+	//
+	size_t undoMemoryUsage() const
+	{
+		return mHistoryMemory;
+	}
+
 private:
+	class UndoGroup;
+
 	//
 	// Edit change
 	//
@@ -100,7 +182,9 @@ private:
 	};
 
 	//
-	// Edit operation
+	// Edit operation. Kept packed: for changes, 'value' holds the swapped
+	// field value. For insertions and deletions it's the slot of the
+	// whole object in the owning group's object store.
 	//
 	struct EditUnit
 	{
@@ -108,36 +192,29 @@ private:
 		ObjType objtype = ObjType::things;
 		byte field = 0;
 		int objnum = 0;
-		std::unique_ptr<Thing> thing;
-		std::unique_ptr<Vertex> vertex;
-		std::unique_ptr<Sector> sector;
-		std::unique_ptr<SideDef> sidedef;
-		std::unique_ptr<LineDef> linedef;
 		int value = 0;
 
-		void apply(Basis &basis);
-		void destroy();
+		void apply(Basis &basis, UndoGroup &group);
 
 	private:
 		void rawChange(Basis &basis);
 
-		void rawDelete(Basis &basis);
+		void rawDelete(Basis &basis, UndoGroup &group);
 		std::unique_ptr<Thing> rawDeleteThing(Document &doc) const;
 		std::unique_ptr<Vertex> rawDeleteVertex(Document &doc) const;
 		std::unique_ptr<Sector> rawDeleteSector(Document &doc) const;
 		std::unique_ptr<SideDef> rawDeleteSidedef(Document &doc) const;
 		std::unique_ptr<LineDef> rawDeleteLinedef(Document &doc) const;
 
-		void rawInsert(Basis &basis);
-		void rawInsertThing(Document &doc);
-		void rawInsertVertex(Document &doc);
-		void rawInsertSector(Document &doc);
-		void rawInsertSidedef(Document &doc);
-		void rawInsertLinedef(Document &doc);
-
-		void deleteFinally();
+		void rawInsert(Basis &basis, UndoGroup &group);
+		void rawInsertThing(Document &doc, std::unique_ptr<Thing> &&thing) const;
+		void rawInsertVertex(Document &doc, std::unique_ptr<Vertex> &&vertex) const;
+		void rawInsertSector(Document &doc, std::unique_ptr<Sector> &&sector) const;
+		void rawInsertSidedef(Document &doc, std::unique_ptr<SideDef> &&sidedef) const;
+		void rawInsertLinedef(Document &doc, std::unique_ptr<LineDef> &&linedef) const;
 	};
 
+	friend class EditJournal;
 	friend class EditOperation;
 	friend struct EditUnit;
 
@@ -148,11 +225,6 @@ private:
 	{
 	public:
 		UndoGroup() = default;
-		~UndoGroup()
-		{
-			for(auto it = mOps.rbegin(); it != mOps.rend(); ++it)
-				it->destroy();
-		}
 
 		// Ensure we only use move semantics
 		UndoGroup(const UndoGroup &other) = delete;
@@ -193,15 +265,10 @@ private:
 			return mOps.empty();
 		}
 
+		int addObjectSlot(ObjType type, bool withNewObject);
 		void addApply(EditUnit &&op, Basis &basis);
 
-		//
-		// End current action
-		//
-		void end()
-		{
-			mDir = -1;
-		}
+		void end();
 
 		void reapply(Basis &basis);
 
@@ -221,9 +288,37 @@ private:
 			mMessage = message;
 		}
 
+		//
+		// Memory footprint, as computed when the group was ended
+		//
+		size_t getMemory() const
+		{
+			return mMemory;
+		}
+
 	private:
+		friend struct EditUnit;
+
+		static uint64_t changeKey(const EditUnit &op)
+		{
+			return (uint64_t)(unsigned)op.objnum << 16 | (unsigned)op.objtype << 8 | op.field;
+		}
+
 		std::vector<EditUnit> mOps;
+
+		// whole objects, only for insertions and deletions
+		std::vector<std::unique_ptr<Thing>> mThings;
+		std::vector<std::unique_ptr<Vertex>> mVertices;
+		std::vector<std::unique_ptr<Sector>> mSectors;
+		std::vector<std::unique_ptr<SideDef>> mSidedefs;
+		std::vector<std::unique_ptr<LineDef>> mLinedefs;
+
+		// while building: field changes seen since the last insert/delete,
+		// so repeated changes of the same field are coalesced
+		std::unordered_map<uint64_t, int> mChangeIndex;
+
 		SString mMessage = DEFAULT_UNDO_GROUP_MESSAGE;
+		size_t mMemory = 0;
 		int mDir = 0;	// dir must be +1 or -1 if active
 	};
 
@@ -232,6 +327,7 @@ private:
 	void setMessage(EUR_FORMAT_STRING(const char *format), ...) EUR_PRINTF(2, 3);
 	void setMessageForSelection(const char *verb, const selection_c &list, const char *suffix = "");
 	int addNew(ObjType type);
+	int addNew(ObjType type, int count);
 	bool change(ObjType type, int objnum, byte field, int value);
 	bool changeThing(int thing, Thing::IntAddress field, int value);
 	bool changeThing(int thing, Thing::FixedPointAddress field, FFixedPoint value);
@@ -242,18 +338,33 @@ private:
 	bool changeSidedef(int side, SideDef::StringIDAddress field, StringID value);
 	bool changeLinedef(int line, byte field, int value);
 	void del(ObjType type, int objnum);
+	void rawDel(ObjType type, int objnum);
 	void end();
 	void abort(bool keepChanges);
 
+	void journalOp(const EditUnit &op);
+
 	void doClearChangeStatus();
-	void doProcessChangeStatus() const;
+	void doProcessChangeStatus();
+	void flushChanges();
+	void notifyInsert(ObjType type, int objnum, int count);
+
+	void clearRedoFuture();
+	void trimUndoHistory();
 
 	UndoGroup mCurrentGroup;
-	// FIXME: use a better data type here
-	std::stack<UndoGroup> mUndoHistory;
+	std::deque<UndoGroup> mUndoHistory;	// oldest at front
 	std::stack<UndoGroup> mRedoFuture;
+	size_t mHistoryMemory = 0;	// both undo and redo
+
+	// operations of the current group, for the edit journal
+	JournalGroupEncoder mJournalOps;
+
+	std::vector<ChangeListener *> mListeners;
+	ChangeBatch mChanges;	// not yet sent to the listeners
 
 	bool mDidMakeChanges = false;
+	bool mInsertingBatch = false;	// already notified
 };
 
 //
@@ -285,6 +396,11 @@ public:
 		return basis.addNew(type);
 	}
 
+	int addNew(ObjType type, int count)
+	{
+		return basis.addNew(type, count);
+	}
+
 	bool change(ObjType type, int objnum, byte field, int value)
 	{
 		return basis.change(type, objnum, field, value);
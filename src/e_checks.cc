@@ -29,6 +29,8 @@
 #include "main.h"
 
 #include <algorithm>
+#include <chrono>
+#include <unordered_map>
 
 #include "e_checks.h"
 #include "e_cutpaste.h"
@@ -306,23 +308,6 @@ static void Vertex_ShowDanglers(Instance &inst)
 }
 
 
-struct vertex_X_CMP_pred
-{
-	const Document &doc;
-	explicit vertex_X_CMP_pred(const Document &doc) : doc(doc)
-	{
-	}
-
-	inline bool operator() (int A, int B) const
-	{
-		const auto &V1 = doc.vertices[A];
-		const auto &V2 = doc.vertices[B];
-
-		return V1->raw_x < V2->raw_x;
-	}
-};
-
-
 void Vertex_FindOverlaps(selection_c& sel, const Document &doc)
 {
 	// NOTE: when two or more vertices share the same coordinates,
@@ -330,94 +315,32 @@ void Vertex_FindOverlaps(selection_c& sel, const Document &doc)
 
 	sel.change_type(ObjType::vertices);
 
-	if (doc.numVertices() < 2)
-		return;
-
-	// sort the vertices into order of the 'X' value.
-	// hence any overlapping vertices will be near each other.
-
-	std::vector<int> sorted_list(doc.numVertices(), 0);
+	// raw coordinates --> first vertex there
+	std::unordered_map<uint64_t, int> first_at;
+	first_at.reserve(doc.numVertices());
 
 	for (int i = 0 ; i < doc.numVertices(); i++)
-		sorted_list[i] = i;
-
-	std::sort(sorted_list.begin(), sorted_list.end(), vertex_X_CMP_pred(doc));
-
-#define VERT_K  doc.vertices[sorted_list[k]]
-#define VERT_N  doc.vertices[sorted_list[n]]
-
-	for (int k = 0 ; k < doc.numVertices(); k++)
-	{
-		for (int n = k + 1 ; n < doc.numVertices() && VERT_N->raw_x == VERT_K->raw_x ; n++)
-		{
-			if (VERT_N->raw_y == VERT_K->raw_y)
-			{
-				sel.set(sorted_list[k]);
-			}
-		}
-	}
-
-#undef VERT_K
-#undef VERT_N
-}
-
-
-static void Vertex_MergeOne(EditOperation &op, int idx, selection_c& merge_verts, Document &doc)
-{
-	const auto &V = doc.vertices[idx];
-
-	// find the base vertex (the one V is sitting on)
-	for (int n = 0 ; n < doc.numVertices(); n++)
 	{
-		if (n == idx)
-			continue;
-
-		// skip any in the merge list
-		if (merge_verts.get(n))
-			continue;
-
-		const auto &N = doc.vertices[n];
-
-		if (*N != *V)
-			continue;
-
-		// Ok, found it, so update linedefs
+		const auto &V = doc.vertices[i];
 
-		for (int ld = 0 ; ld < doc.numLinedefs(); ld++)
-		{
-			const auto &L = doc.linedefs[ld];
-
-			if (L->start == idx)
-				op.changeLinedef(ld, LineDef::F_START, n);
-
-			if (L->end == idx)
-				op.changeLinedef(ld, LineDef::F_END, n);
-		}
+		uint64_t key = ((uint64_t)(uint32_t)V->raw_x.raw() << 32) | (uint32_t)V->raw_y.raw();
 
-		return;
+		if (! first_at.emplace(key, i).second)
+			sel.set(i);
 	}
-
-	// SHOULD NOT GET HERE
-	gLog.printf("VERTEX MERGE FAILURE.\n");
 }
 
 
 static void Vertex_MergeOverlaps(Instance &inst)
 {
-	selection_c verts;
-	Vertex_FindOverlaps(verts, inst.level);
+	selection_c verts(ObjType::vertices);
+	verts.frob_range(0, inst.level.numVertices() - 1, BitOp::add);
 
 	{
 		EditOperation op(inst.level.basis);
 		op.setMessage("merged overlapping vertices");
 
-		for (sel_iter_c it(verts) ; !it.done() ; it.next())
-		{
-			Vertex_MergeOne(op, *it, verts, inst.level);
-		}
-
-		// nothing should reference these vertices now
-		inst.level.objects.del(op, verts);
+		inst.level.vertmod.weldVertices(op, verts, 0);
 	}
 
 	inst.RedrawMap();
@@ -676,7 +599,7 @@ static void Sectors_ShowUnclosed(ObjType what, Instance &inst)
 }
 
 
-static void Sectors_FindMismatches(selection_c& secs, selection_c& lines, Document &doc)
+static void Sectors_FindMismatches(selection_c& secs, selection_c& lines, const Document &doc)
 {
 	//
 	// Note from RQ:
@@ -700,8 +623,6 @@ static void Sectors_FindMismatches(selection_c& secs, selection_c& lines, Docume
 	if (doc.numLinedefs() == 0 || doc.numSectors() == 0)
 		return;
 
-	doc.hover.fastOpposite_begin();
-
 	for (int n = 0 ; n < doc.numLinedefs(); n++)
 	{
 		const auto &L = doc.linedefs[n];
@@ -728,8 +649,6 @@ static void Sectors_FindMismatches(selection_c& secs, selection_c& lines, Docume
 			}
 		}
 	}
-
-	doc.hover.fastOpposite_finish();
 }
 
 
@@ -1440,13 +1359,11 @@ static void Things_FindInVoid(selection_c& list, const Instance &inst)
 
 	for (int n = 0 ; n < inst.level.numThings() ; n++)
 	{
-		v2double_t pos = inst.level.things[n]->xy();
-
-		Objid obj = hover::getNearestSector(inst.level, pos);
-
-		if (! obj.is_nil())
+		if (inst.level.hover.getThingSector(n) >= 0)
 			continue;
 
+		v2double_t pos = inst.level.things[n]->xy();
+
 		// allow certain things in the void (Heretic sounds)
 		const thingtype_t &info = inst.conf.getThingType(inst.level.things[n]->type);
 
@@ -1460,9 +1377,7 @@ static void Things_FindInVoid(selection_c& list, const Instance &inst)
 		{
 			v2double_t pos2 = pos + v2double_t{ corner & 1 ? -4.0 : +4.0, corner & 2 ? -4.0 : +4.0 };
 
-			obj = hover::getNearestSector(inst.level, pos2);
-
-			if (obj.is_nil())
+			if (inst.level.hover.getNearestSector(pos2).is_nil())
 				out_count++;
 		}
 
@@ -1762,7 +1677,129 @@ static inline bool LD_is_blocking(const LineDef *L, const Document &doc)
 }
 
 
-static bool ThingStuckInWall(const Thing *T, int r, char group, const Document &doc)
+//
+// Uniform grid of buckets over the level, so that the objects near a box
+// can be found without testing all of them. Boxes outside of the grid
+// area get clamped to its border cells.
+//
+class CheckGrid
+{
+public:
+	CheckGrid(double x1, double y1, double x2, double y2, double cell_size) :
+		CheckGrid(x1, y1, x2, y2, cell_size, cell_size)
+	{
+	}
+
+	CheckGrid(double x1, double y1, double x2, double y2, double cell_w, double cell_h)
+	{
+		// keep the number of cells sane on sparse or huge maps
+		while ((x2 - x1) / cell_w * (y2 - y1) / cell_h > (1 << 20))
+		{
+			cell_w *= 2;
+			cell_h *= 2;
+		}
+
+		originX = x1;
+		originY = y1;
+		cellW = cell_w;
+		cellH = cell_h;
+		width = (int)((x2 - x1) / cell_w) + 1;
+		height = (int)((y2 - y1) / cell_h) + 1;
+
+		cells.resize((size_t)width * height);
+	}
+
+	void Insert(int index, double x1, double y1, double x2, double y2)
+	{
+		for (int cy = CellY(y1) ; cy <= CellY(y2) ; cy++)
+			for (int cx = CellX(x1) ; cx <= CellX(x2) ; cx++)
+				cells[(size_t)cy * width + cx].push_back(index);
+	}
+
+	// calls func for every object whose cells overlap the box.
+	// objects spanning several cells may be visited more than once.
+	template<typename F>
+	void Query(double x1, double y1, double x2, double y2, F &&func) const
+	{
+		for (int cy = CellY(y1) ; cy <= CellY(y2) ; cy++)
+			for (int cx = CellX(x1) ; cx <= CellX(x2) ; cx++)
+				for (int index : cells[(size_t)cy * width + cx])
+					func(index);
+	}
+
+	// puts a line in all the cells which it passes within margin of
+	void InsertLine(int index, v2double_t p1, v2double_t p2, double margin)
+	{
+		ForLineCells(p1, p2, margin, [this, index](size_t cell)
+		{
+			cells[cell].push_back(index);
+		});
+	}
+
+	// calls func for every object in the cells which the line passes within
+	// margin of. objects may be visited more than once.
+	template<typename F>
+	void QueryLine(v2double_t p1, v2double_t p2, double margin, F &&func) const
+	{
+		ForLineCells(p1, p2, margin, [this, &func](size_t cell)
+		{
+			for (int index : cells[cell])
+				func(index);
+		});
+	}
+
+private:
+	template<typename F>
+	void ForLineCells(v2double_t p1, v2double_t p2, double margin, F &&func) const
+	{
+		if (p1.y > p2.y)
+			std::swap(p1, p2);
+
+		for (int cy = CellY(p1.y - margin) ; cy <= CellY(p2.y + margin) ; cy++)
+		{
+			// the part of the line within the row, widened by the margin
+			double ya = std::max(p1.y, originY + cy * cellH - margin);
+			double yb = std::min(p2.y, originY + (cy + 1) * cellH + margin);
+
+			double xa = p1.x;
+			double xb = p2.x;
+
+			if (p2.y > p1.y)
+			{
+				double slope = (p2.x - p1.x) / (p2.y - p1.y);
+
+				xa = p1.x + (ya - p1.y) * slope;
+				xb = p1.x + (yb - p1.y) * slope;
+			}
+
+			if (xa > xb)
+				std::swap(xa, xb);
+
+			for (int cx = CellX(xa - margin) ; cx <= CellX(xb + margin) ; cx++)
+				func((size_t)cy * width + cx);
+		}
+	}
+
+	int CellX(double x) const
+	{
+		return clamp(0, (int)floor((x - originX) / cellW), width - 1);
+	}
+
+	int CellY(double y) const
+	{
+		return clamp(0, (int)floor((y - originY) / cellH), height - 1);
+	}
+
+	double originX, originY;
+	double cellW, cellH;
+	int width, height;
+
+	std::vector<std::vector<int>> cells;
+};
+
+
+static bool ThingStuckInWall(const Thing *T, int r, char group, const Document &doc,
+							 const CheckGrid &wall_grid, std::vector<int> &line_stamps, int stamp)
 {
 	// only check players and monsters
 	if (! (group == 'p' || group == 'm'))
@@ -1780,23 +1817,28 @@ static bool ThingStuckInWall(const Thing *T, int r, char group, const Document &
 	double x2 = T->x() + r;
 	double y2 = T->y() + r;
 
-	for (int n = 0 ; n < doc.numLinedefs(); n++)
+	// the grid only holds the blocking lines
+	bool stuck = false;
+
+	wall_grid.Query(x1, y1, x2, y2, [&](int n)
 	{
-		const auto &L = doc.linedefs[n];
+		if (stuck || line_stamps[n] == stamp)
+			return;
 
-		if (! LD_is_blocking(L.get(), doc))
-			continue;
+		line_stamps[n] = stamp;
 
 		if (doc.objects.lineTouchesBox(n, x1, y1, x2, y2))
-			return true;
-	}
+			stuck = true;
+	});
 
-	return false;
+	return stuck;
 }
 
 
-static void Things_FindStuckies(selection_c& list, const Instance &inst)
+void Things_FindStuckies(selection_c& list, const Instance &inst)
 {
+	const Document &doc = inst.level;
+
 	list.change_type(ObjType::things);
 
 	std::vector<int> blockers;
@@ -1804,24 +1846,85 @@ static void Things_FindStuckies(selection_c& list, const Instance &inst)
 
 	CollectBlockingThings(blockers, sizes, inst);
 
+	if (blockers.empty())
+		return;
+
+	// put the blocking things and walls into grids, so each thing only
+	// gets tested against its neighbours
+
+	int max_radius = *std::max_element(sizes.begin(), sizes.end());
+
+	double x1 = doc.things[blockers[0]]->x();
+	double y1 = doc.things[blockers[0]]->y();
+	double x2 = x1;
+	double y2 = y1;
+
+	for (int index : blockers)
+	{
+		const auto &T = doc.things[index];
+
+		x1 = std::min(x1, T->x());  x2 = std::max(x2, T->x());
+		y1 = std::min(y1, T->y());  y2 = std::max(y2, T->y());
+	}
+
+	CheckGrid thing_grid(x1, y1, x2, y2, std::max(64, 2 * max_radius));
+
+	for (int n = 0 ; n < (int)blockers.size() ; n++)
+	{
+		const auto &T = doc.things[blockers[n]];
+
+		thing_grid.Insert(n, T->x(), T->y(), T->x(), T->y());
+	}
+
+	CheckGrid wall_grid(x1 - max_radius, y1 - max_radius,
+	                    x2 + max_radius, y2 + max_radius, 256);
+
+	for (int n = 0 ; n < doc.numLinedefs() ; n++)
+	{
+		const auto &L = doc.linedefs[n];
+
+		if (! LD_is_blocking(L.get(), doc))
+			continue;
+
+		const Vertex &V1 = doc.getStart(*L);
+		const Vertex &V2 = doc.getEnd(*L);
+
+		wall_grid.Insert(n, std::min(V1.x(), V2.x()), std::min(V1.y(), V2.y()),
+		                 std::max(V1.x(), V2.x()), std::max(V1.y(), V2.y()));
+	}
+
+	std::vector<int> line_stamps(doc.numLinedefs(), -1);
+
 	for (int n = 0 ; n < (int)blockers.size() ; n++)
 	{
-		const auto &T = inst.level.things[blockers[n]];
+		const auto &T = doc.things[blockers[n]];
 
 		const thingtype_t &info = inst.conf.getThingType(T->type);
 
-		if (ThingStuckInWall(T.get(), info.radius, info.group, inst.level))
+		if (ThingStuckInWall(T.get(), info.radius, info.group, doc, wall_grid, line_stamps, n))
+		{
 			list.set(blockers[n]);
+			continue;
+		}
 
-		for (int n2 = n + 1 ; n2 < (int)blockers.size() ; n2++)
+		// only things later in the list are tested (as T1 is the one
+		// which gets marked), and overlapping requires the centres to be
+		// closer than the sum of both radii.
+		double reach = info.radius + max_radius;
+
+		thing_grid.Query(T->x() - reach, T->y() - reach, T->x() + reach, T->y() + reach,
+		                 [&](int n2)
 		{
-			const auto &T2 = inst.level.things[blockers[n2]];
+			if (n2 <= n || list.get(blockers[n]))
+				return;
+
+			const auto &T2 = doc.things[blockers[n2]];
 
 			const thingtype_t &info2 = inst.conf.getThingType(T2->type);
 
 			if (ThingStuckInThing(inst, T.get(), &info, T2.get(), &info2))
 				list.set(blockers[n]);
-		}
+		});
 	}
 }
 
@@ -2413,23 +2516,6 @@ struct linedef_pos_CMP_pred
 };
 
 
-struct linedef_minx_CMP_pred
-{
-	const Document &doc;
-
-	inline bool operator() (int A, int B) const
-	{
-		const auto &AL = doc.linedefs[A];
-		const auto &BL = doc.linedefs[B];
-
-		FFixedPoint A_x = std::min(doc.getStart(*AL).raw_x, doc.getEnd(*AL).raw_x);
-		FFixedPoint B_x = std::min(doc.getStart(*BL).raw_x, doc.getEnd(*BL).raw_x);
-
-		return A_x < B_x;
-	}
-};
-
-
 static void LineDefs_FindOverlaps(selection_c& lines, const Document &doc)
 {
 	// we only find directly overlapping linedefs here
@@ -2493,7 +2579,7 @@ static void LineDefs_RemoveOverlaps(Document &doc)
 }
 
 
-static int CheckLinesCross(int A, int B, const Document &doc)
+int CheckLinesCross(int A, int B, const Document &doc)
 {
 	// return values:
 	//    0 : the lines do not cross
@@ -2521,8 +2607,8 @@ static int CheckLinesCross(int A, int B, const Document &doc)
 
 	// bbox test
 	//
-	// the algorithm in LineDefs_FindCrossings() ensures that A and B
-	// already overlap on the X axis.  hence only check Y axis here.
+	// the caller ensures that A and B already overlap on the X axis.
+	// hence only check Y axis here.
 
 	if (std::min(doc.getStart(*AL).raw_y, doc.getEnd(*AL).raw_y) >
 		std::max(doc.getStart(*BL).raw_y, doc.getEnd(*BL).raw_y))
@@ -2614,52 +2700,109 @@ static int CheckLinesCross(int A, int B, const Document &doc)
 }
 
 
-static void LineDefs_FindCrossings(selection_c& lines, const Document &doc)
+void LineDefs_FindCrossings(selection_c& lines, const Document &doc)
 {
+	// CheckLinesCross() only flags lines closer than its epsilon, so lines
+	// put in a grid with a wider margin than that share a cell when they
+	// can cross.
+	const double margin = 1.0;
+
 	lines.change_type(ObjType::linedefs);
 
 	if (doc.numLinedefs() < 2)
 		return;
 
-	int n;
+	double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+	double total_dx = 0, total_dy = 0;
+	int count = 0;
 
-	// sort linedefs by their position.  linedefs which cross will be
-	// near each other in this list.
-	std::vector<int> sorted_list(doc.numLinedefs(), 0);
+	for (const auto &L : doc.linedefs)
+	{
+		if (doc.isZeroLength(*L))
+			continue;
 
-	for (n = 0 ; n < doc.numLinedefs(); n++)
-		sorted_list[n] = n;
+		v2double_t p1 = doc.getStart(*L).xy();
+		v2double_t p2 = doc.getEnd(*L).xy();
 
-	std::sort(sorted_list.begin(), sorted_list.end(), linedef_minx_CMP_pred{ doc });
+		if (count == 0)
+		{
+			x1 = x2 = p1.x;
+			y1 = y2 = p1.y;
+		}
 
-	for (n = 0 ; n < doc.numLinedefs(); n++)
+		x1 = std::min({ x1, p1.x, p2.x });
+		y1 = std::min({ y1, p1.y, p2.y });
+		x2 = std::max({ x2, p1.x, p2.x });
+		y2 = std::max({ y2, p1.y, p2.y });
+
+		total_dx += fabs(p2.x - p1.x);
+		total_dy += fabs(p2.y - p1.y);
+		count++;
+	}
+
+	if (count < 2)
+		return;
+
+	// cells about twice the extent of the typical line on each axis, so
+	// rows of long horizontal lines (say) get rows of flat cells, but not
+	// many more cells than lines.
+	double cell_w = std::max(8.0, 2 * total_dx / count);
+	double cell_h = std::max(8.0, 2 * total_dy / count);
+
+	double scale = sqrt((x2 - x1) / cell_w * (y2 - y1) / cell_h / (4.0 * count));
+
+	if (scale > 1)
 	{
-		int n2 = sorted_list[n];
+		cell_w *= scale;
+		cell_h *= scale;
+	}
 
-		const auto &L1 = doc.linedefs[n2];
+	CheckGrid grid(x1 - margin, y1 - margin, x2 + margin, y2 + margin, cell_w, cell_h);
 
+	for (int n = 0 ; n < doc.numLinedefs(); n++)
+	{
+		const auto &L = doc.linedefs[n];
+
+		if (! doc.isZeroLength(*L))
+			grid.InsertLine(n, doc.getStart(*L).xy(), doc.getEnd(*L).xy(), margin);
+	}
+
+	// the last line each one was tested against, so a pair sharing several
+	// cells only gets tested once
+	std::vector<int> line_stamps(doc.numLinedefs(), -1);
+
+	for (int n = 0 ; n < doc.numLinedefs(); n++)
+	{
+		const auto &L1 = doc.linedefs[n];
+
+		if (doc.isZeroLength(*L1))
+			continue;
+
+		FFixedPoint min_x = std::min(doc.getStart(*L1).raw_x, doc.getEnd(*L1).raw_x);
 		FFixedPoint max_x = std::max(doc.getStart(*L1).raw_x, doc.getEnd(*L1).raw_x);
 
-		for (int k = n + 1 ; k < doc.numLinedefs(); k++)
+		grid.QueryLine(doc.getStart(*L1).xy(), doc.getEnd(*L1).xy(), margin, [&](int k)
 		{
-			int k2 = sorted_list[k];
-
-			const auto &L2 = doc.linedefs[k2];
+			if (k <= n || line_stamps[k] == n)
+				return;
 
-			FFixedPoint min_x = std::min(doc.getStart(*L2).raw_x, doc.getEnd(*L2).raw_x);
+			line_stamps[k] = n;
 
-			// stop when all remaining linedefs are to the right of L1
-			if (min_x > max_x)
-				break;
+			const auto &L2 = doc.linedefs[k];
 
-			int res = CheckLinesCross(n2, k2, doc);
+			// CheckLinesCross() relies on the lines overlapping on the X axis
+			if (std::min(doc.getStart(*L2).raw_x, doc.getEnd(*L2).raw_x) > max_x ||
+				std::max(doc.getStart(*L2).raw_x, doc.getEnd(*L2).raw_x) < min_x)
+			{
+				return;
+			}
 
-			if (res)
+			if (CheckLinesCross(n, k, doc))
 			{
-				lines.set(n2);
-				lines.set(k2);
+				lines.set(n);
+				lines.set(k);
 			}
-		}
+		});
 	}
 }
 
@@ -2954,25 +3097,21 @@ CheckResult ChecksModule::checkLinedefs(int min_severity) const
 
 void ChecksModule::tagsUsedRange(int *min_tag, int *max_tag) const
 {
-	int i;
-
 	*min_tag = INT_MAX;
 	*max_tag = INT_MIN;
 
-	for (i = 0 ; i < doc.numLinedefs(); i++)
-	{
-		int tag = doc.linedefs[i]->tag;
+	const auto &line_tags = doc.tags.tagMap(ObjType::linedefs);
 
-		if (tag > 0)
-		{
-			*min_tag = std::min(*min_tag, tag);
-			*max_tag = std::max(*max_tag, tag);
-		}
+	auto first = line_tags.upper_bound(0);
+	if (first != line_tags.end())
+	{
+		*min_tag = first->first;
+		*max_tag = line_tags.rbegin()->first;
 	}
 
-	for (i = 0 ; i < doc.numSectors() ; i++)
+	for (const auto &entry : doc.tags.tagMap(ObjType::sectors))
 	{
-		int tag = doc.sectors[i]->tag;
+		int tag = entry.first;
 
 		// ignore special tags
 		if (inst.conf.features.tag_666 != Tag666Rules::disabled && (tag == 666 || tag == 667))
@@ -3079,26 +3218,6 @@ void Instance::CMD_ApplyTag()
 }
 
 
-static bool LD_tag_exists(int tag, const Document &doc)
-{
-	for (const auto &linedef : doc.linedefs)
-		if (linedef->tag == tag)
-			return true;
-
-	return false;
-}
-
-
-static bool SEC_tag_exists(int tag, const Document &doc)
-{
-	for (const auto &sector : doc.sectors)
-		if (sector->tag == tag)
-			return true;
-
-	return false;
-}
-
-
 static void Tags_FindUnmatchedSectors(selection_c& secs, const Instance &inst)
 {
 	secs.change_type(ObjType::sectors);
@@ -3115,7 +3234,7 @@ static void Tags_FindUnmatchedSectors(selection_c& secs, const Instance &inst)
 		if (inst.conf.features.tag_666 != Tag666Rules::disabled && (tag == 666 || tag == 667))
 			continue;
 
-		if (! LD_tag_exists(tag, inst.level))
+		if (! inst.level.tags.tagExists(ObjType::linedefs, tag))
 			secs.set(s);
 	}
 }
@@ -3137,7 +3256,7 @@ static void Tags_FindUnmatchedLineDefs(selection_c& lines, const Document &doc)
 		if (L->type <= 0)
 			continue;
 
-		if (! SEC_tag_exists(L->tag, doc))
+		if (! doc.tags.tagExists(ObjType::sectors, L->tag))
 			lines.set(n);
 	}
 }
@@ -3578,7 +3697,7 @@ static int check_transparent(const Instance &inst, const SString &tex,
 }
 
 
-static void Textures_FindTransparent(Instance &inst, selection_c& lines,
+static void Textures_FindTransparent(const Instance &inst, selection_c& lines,
                               std::map<SString, int>& names)
 {
 	lines.change_type(ObjType::linedefs);
@@ -4410,6 +4529,168 @@ void ChecksModule::checkAll(bool major_stuff) const
 }
 
 
+//------------------------------------------------------------------------
+//  BATCH LINTING
+//------------------------------------------------------------------------
+
+//
+// A detector as used by the linter. The ones sharing the lazy indexes of
+// the document (hover and tags) are all run by the first task, one after
+// another, while the others get a task each.
+//
+struct lint_def_t
+{
+	const char *name;
+	int severity;
+	ObjType type;
+	bool indexed;
+	void (*find)(selection_c &list, const Instance &inst);
+};
+
+static const lint_def_t lint_defs[] =
+{
+	{ "vertices.overlapping", 2, ObjType::vertices, false,
+		[](selection_c &list, const Instance &inst) { Vertex_FindOverlaps(list, inst.level); } },
+	{ "vertices.dangling", 2, ObjType::vertices, false,
+		[](selection_c &list, const Instance &inst) { Vertex_FindDanglers(list, inst.level); } },
+	{ "vertices.unused", 1, ObjType::vertices, false,
+		[](selection_c &list, const Instance &inst) { Vertex_FindUnused(list, inst.level); } },
+
+	{ "sectors.unclosed", 2, ObjType::sectors, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			selection_c verts;
+			Sectors_FindUnclosed(list, verts, inst.level);
+		} },
+	{ "sectors.mismatched", 2, ObjType::sectors, true,
+		[](selection_c &list, const Instance &inst)
+		{
+			selection_c lines;
+			Sectors_FindMismatches(list, lines, inst.level);
+		} },
+	{ "sectors.ceil_below_floor", 2, ObjType::sectors, false,
+		[](selection_c &list, const Instance &inst) { Sectors_FindBadCeil(list, inst.level); } },
+	{ "sectors.unknown_type", 2, ObjType::sectors, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<int, int> types;
+			Sectors_FindUnknown(list, types, inst);
+		} },
+	{ "sectors.unused", 1, ObjType::sectors, false,
+		[](selection_c &list, const Instance &inst) { Sectors_FindUnused(list, inst.level); } },
+	{ "sidedefs.unused", 1, ObjType::sidedefs, false,
+		[](selection_c &list, const Instance &inst) { SideDefs_FindUnused(list, inst.level); } },
+
+	{ "linedefs.zero_length", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindZeroLen(list, inst.level); } },
+	{ "linedefs.overlapping", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindOverlaps(list, inst.level); } },
+	{ "linedefs.crossing", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindCrossings(list, inst.level); } },
+	{ "linedefs.unknown_type", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<int, int> types;
+			LineDefs_FindUnknown(list, types, inst);
+		} },
+	{ "linedefs.missing_right", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindMissingRight(list, inst.level); } },
+	{ "linedefs.manual_door_1s", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindManualDoors(list, inst); } },
+	{ "linedefs.lack_impassable", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindLackImpass(list, inst.level); } },
+	{ "linedefs.bad_two_sided_flag", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { LineDefs_FindBad2SFlag(list, inst.level); } },
+
+	{ "things.unknown_type", 2, ObjType::things, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<int, int> types;
+			Things_FindUnknown(list, types, inst);
+		} },
+	{ "things.stuck", 2, ObjType::things, false, Things_FindStuckies },
+	{ "things.in_void", 1, ObjType::things, true, Things_FindInVoid },
+	{ "things.unspawnable", 1, ObjType::things, false,
+		[](selection_c &list, const Instance &inst) { Things_FindDuds(inst, list); } },
+
+	{ "textures.unknown", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<SString, int> names;
+			Textures_FindUnknownTex(list, names, inst);
+		} },
+	{ "textures.unknown_flat", 2, ObjType::sectors, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<SString, int> names;
+			Textures_FindUnknownFlat(list, names, inst);
+		} },
+	{ "textures.medusa", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<SString, int> names;
+			if (! inst.conf.features.medusa_fixed)
+				Textures_FindMedusa(list, names, inst);
+		} },
+	{ "textures.missing", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { Textures_FindMissing(inst, list); } },
+	{ "textures.transparent", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst)
+		{
+			std::map<SString, int> names;
+			Textures_FindTransparent(inst, list, names);
+		} },
+	{ "textures.non_animating_switch", 1, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { Textures_FindDupSwitches(list, inst.level); } },
+
+	{ "tags.missing", 2, ObjType::linedefs, false,
+		[](selection_c &list, const Instance &inst) { Tags_FindMissingTags(list, inst); } },
+	{ "tags.unmatched_linedefs", 2, ObjType::linedefs, true,
+		[](selection_c &list, const Instance &inst) { Tags_FindUnmatchedLineDefs(list, inst.level); } },
+	{ "tags.unmatched_sectors", 1, ObjType::sectors, true, Tags_FindUnmatchedSectors },
+	{ "tags.beast_marks", 1, ObjType::sectors, false, Tags_FindBeastMarks },
+};
+
+
+int ChecksModule::lintTaskCount()
+{
+	int count = 1;
+
+	for (const lint_def_t &def : lint_defs)
+		if (! def.indexed)
+			count++;
+
+	return count;
+}
+
+
+void ChecksModule::lintTask(int task, std::vector<lint_check_t> &results) const
+{
+	int index = 0;
+
+	for (const lint_def_t &def : lint_defs)
+	{
+		if (def.indexed ? task != 0 : task != ++index)
+			continue;
+
+		auto start = std::chrono::steady_clock::now();
+
+		selection_c list(def.type);
+		def.find(list, inst);
+
+		lint_check_t check = { def.name, def.severity, def.type };
+
+		for (sel_iter_c it(list) ; !it.done() ; it.next())
+			check.objects.push_back(*it);
+
+		check.millis = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start).count();
+
+		results.push_back(std::move(check));
+	}
+}
+
+
 void Instance::CMD_MapCheck()
 {
 	SString what = EXEC_Param[0];
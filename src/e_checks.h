@@ -30,6 +30,8 @@
 #include "DocumentModule.h"
 #include "ui_window.h"
 
+#include <vector>
+
 // the CHECK_xxx functions return the following values:
 enum class CheckResult
 {
@@ -40,6 +42,18 @@ enum class CheckResult
 	tookAction		// [internal use : user took some action]
 };
 
+//
+// Result of one detector, when linting a level without the dialogs
+//
+struct lint_check_t
+{
+	const char *name;
+	int severity;		// 1 = minor, 2 = major problem
+	ObjType type;
+	std::vector<int> objects;
+	double millis;
+};
+
 //
 // The map checking module
 //
@@ -57,6 +71,10 @@ public:
 	void tagsApplyNewValue(int new_tag);
 	void tagsUsedRange(int *min_tag, int *max_tag) const;
 
+	// the detectors split into tasks, which can run concurrently
+	static int lintTaskCount();
+	void lintTask(int task, std::vector<lint_check_t> &results) const;
+
 private:
 	void checkAll(bool majorStuff) const;
 
@@ -71,6 +89,10 @@ private:
 };
 
 int findFreeTag(const Instance &inst, bool forsector);
+void Things_FindStuckies(selection_c &list, const Instance &inst);
+
+int CheckLinesCross(int A, int B, const Document &doc);
+void LineDefs_FindCrossings(selection_c &lines, const Document &doc);
 
 #endif  /* __EUREKA_E_CHECKS_H__ */
 
@@ -36,6 +36,7 @@
 #include "r_render.h"
 #include "r_subdiv.h"
 #include "Sector.h"
+#include "sys_trace.h"
 #include "Thing.h"
 #include "ui_about.h"
 #include "ui_misc.h"
@@ -280,6 +281,10 @@ void Instance::CMD_SetVar()
 
 		RedrawMap();
 	}
+	else if (var_name.noCaseEqual("perf"))
+	{
+		Perf_SetDisplay(clamp(0, int_val, (int)PERF_StatusBar));
+	}
 	else
 	{
 		Beep("Set: unknown var: %s", var_name.c_str());
@@ -351,6 +356,11 @@ void Instance::CMD_ToggleVar()
 			edit.sector_render_mode = (sector_rendering_mode_e)(1 + (int)edit.sector_render_mode);
 		RedrawMap();
 	}
+	else if (var_name.noCaseEqual("perf"))
+	{
+		// off -> overlay -> status bar -> off
+		Perf_SetDisplay((edit.perf_display + 1) % (PERF_StatusBar + 1));
+	}
 	else
 	{
 		Beep("Toggle: unknown var: %s", var_name.c_str());
@@ -553,12 +563,10 @@ void Instance::DoBeginDrag()
 			// get thing's floor
 			if (edit.drag_thing_num >= 0)
 			{
-				const auto &T = level.things[edit.drag_thing_num];
+				int sec = level.hover.getThingSector(edit.drag_thing_num);
 
-				Objid sec = hover::getNearestSector(level, T->xy());
-
-				if (sec.valid())
-					edit.drag_thing_floorh = static_cast<float>(level.sectors[sec.num]->floorh);
+				if (sec >= 0)
+					edit.drag_thing_floorh = static_cast<float>(level.sectors[sec]->floorh);
 			}
 		}
 	}
@@ -584,7 +592,7 @@ void Instance::DoBeginDrag()
 
 	Editor_SetAction(EditorAction::drag);
 
-	main_win->canvas->redraw();
+	main_win->canvas->RedrawOverlay();
 }
 
 
@@ -885,7 +893,7 @@ void Instance::Transform_Update()
 			break;
 	}
 
-	main_win->canvas->redraw();
+	main_win->canvas->RedrawOverlay();
 }
 
 
@@ -1334,6 +1342,36 @@ void Instance::CMD_LogViewer()
 }
 
 
+//
+// writes the trace recorded so far, or starts recording when not yet
+//
+void Instance::CMD_TraceDump()
+{
+#ifdef NO_TRACING
+	Beep("Tracing is not compiled in");
+#else
+	if (! trace::recording)
+	{
+		trace::start();
+		Status_Set("Tracing started");
+		return;
+	}
+
+	fs::path path = global::trace_file.empty() ? global::home_dir / "trace.json" :
+			global::trace_file;
+
+	if (! trace::writeJSON(path))
+	{
+		Beep("Cannot write trace: %s", path.u8string().c_str());
+		return;
+	}
+
+	gLog.printf("Wrote %d trace events to %s\n", trace::eventCount(), path.u8string().c_str());
+	Status_Set("Wrote trace to %s", path.u8string().c_str());
+#endif
+}
+
+
 void Instance::CMD_OnlineDocs()
 {
 	int rv = fl_open_uri("http://eureka-editor.sourceforge.net/?n=Docs.Index");
@@ -1365,13 +1403,13 @@ static editor_command_t  command_table[] =
 	{	"Set", "Misc",
 		&Instance::CMD_SetVar,
 		/* flags */ NULL,
-		/* keywords */ "3d browser gamma grid obj_nums ratio sec_render snap sprites"
+		/* keywords */ "3d browser gamma grid obj_nums perf ratio sec_render snap sprites"
 	},
 
 	{	"Toggle", "Misc",
 		&Instance::CMD_ToggleVar,
 		/* flags */ NULL,
-		/* keywords */ "3d browser gamma grid obj_nums ratio sec_render snap recent sprites"
+		/* keywords */ "3d browser gamma grid obj_nums perf ratio sec_render snap recent sprites"
 	},
 
 	{	"MetaKey", "Misc",
@@ -1553,6 +1591,10 @@ static editor_command_t  command_table[] =
 		&Instance::CMD_CopyAndPaste
 	},
 
+	{	"PasteArray",   "Edit",
+		&Instance::CMD_PasteArray
+	},
+
 	{	"CopyProperties",   "Edit",
 		&Instance::CMD_CopyProperties,
 		/* flags */ "/reverse"
@@ -1647,6 +1689,10 @@ static editor_command_t  command_table[] =
 		&Instance::CMD_LogViewer
 	},
 
+	{	"TraceDump",  "Tools",
+		&Instance::CMD_TraceDump
+	},
+
 
 	/* ------ HELP menu ------ */
 
@@ -1783,6 +1829,10 @@ static editor_command_t  command_table[] =
 		&Instance::CMD_VT_ShapeArc
 	},
 
+	{	"VT_Weld", NULL,
+		&Instance::CMD_VT_Weld
+	},
+
 
 	/* -------- Browser -------- */
 
@@ -20,14 +20,22 @@
 
 #include "Instance.h"
 
+#include "e_cutpaste.h"
+#include "e_linedef.h"
+#include "e_things.h"
 #include "LineDef.h"
 #include "Sector.h"
 #include "SideDef.h"
 #include "Thing.h"
 #include "Vertex.h"
 
+#include <unordered_map>
+
 #define INVALID_SECTOR  (-999999)
 
+// most copies in each direction of a paste array
+#define MAX_PASTE_ARRAY  256
+
 
 class clipboard_data_c
 {
@@ -103,7 +111,7 @@ public:
 		}
 	}
 
-	void InsertRealSector(int snum)
+	void InsertRealSectors(int snum, int count)
 	{
 		if (! uses_real_sectors)
 			return;
@@ -111,7 +119,7 @@ public:
 		for (SideDef &side : sides)
 		{
 			if (side.sector >= snum)
-				side.sector++;
+				side.sector += count;
 		}
 	}
 
@@ -172,9 +180,9 @@ void Clipboard_NotifyEnd()
 { }
 
 
-void Clipboard_NotifyInsert(const Document &doc, ObjType type, int objnum)
+void Clipboard_NotifyInsert(const Document &doc, ObjType type, int objnum, int count)
 {
-	// this function notifies us that a new sector is about to be
+	// this function notifies us that new sectors are about to be
 	// inserted in the map (causing other sectors to be moved).
 
 	if (type != ObjType::sectors)
@@ -189,7 +197,7 @@ void Clipboard_NotifyInsert(const Document &doc, ObjType type, int objnum)
 		SYS_ASSERT(! clip_doing_paste);
 	}
 
-	clip_board->InsertRealSector(objnum);
+	clip_board->InsertRealSectors(objnum, count);
 }
 
 
@@ -210,10 +218,6 @@ void Clipboard_NotifyDelete(ObjType type, int objnum)
 }
 
 
-void Clipboard_NotifyChange(ObjType type, int objnum, int field)
-{
-	// field changes never affect the clipboard
-}
 
 
 //----------------------------------------------------------------------
@@ -453,128 +457,298 @@ static v2double_t CentreOfPointObjects(const std::vector<T> &list)
 }
 
 
-static void PasteGroupOfObjects(EditOperation &op, MapFormat format, const v2double_t &pos)
+//
+// where one copy of the clipboard goes: the centre of the copied
+// objects is moved to 'pos', and everything is rotated around it.
+//
+struct paste_place_t
 {
-	v2double_t cpos = CentreOfPointObjects(clip_board->verts);
+	v2double_t centre;
+	v2double_t pos;
+
+	// anti-clockwise, in degrees
+	int angle = 0;
+
+	v2double_t apply(const v2double_t &p) const
+	{
+		v2double_t d = p - centre;
+
+		if (angle != 0)
+		{
+			double rad = angle * M_PI / 180.0;
+
+			double s = sin(rad);
+			double c = cos(rad);
+
+			d = { d.x * c - d.y * s, d.x * s + d.y * c };
+		}
+
+		return d + pos;
+	}
+};
+
+
+static v2double_t ClipboardCentre()
+{
+	// the things only count when there are no vertices (THINGS mode)
+	if (clip_board->verts.empty())
+		return CentreOfPointObjects(clip_board->things);
+
+	return CentreOfPointObjects(clip_board->verts);
+}
 
-	// these hold the mapping from clipboard index --> real index
-	std::map<int, int> vert_map;
-	std::map<int, int> sector_map;
-	std::map<int, int> side_map;
 
-	unsigned int i;
+static inline uint64_t PasteKey(int a, int b)
+{
+	return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+
+//
+// Joins up the copies of a paste array: a vertex landing on a vertex
+// of an earlier copy is shared, and a one-sided line running back along
+// a one-sided line of an earlier copy becomes its second side.
+//
+// Objects of the copy being pasted are only looked up once it is
+// finished, so the clipboard contents are never welded to themselves.
+//
+class paste_welder_c
+{
+public:
+	// raw coordinates --> vertex number
+	std::unordered_map<uint64_t, int> verts;
+
+	// start and end vertex --> one-sided linedef number
+	std::unordered_map<uint64_t, int> lines;
+
+	std::vector<std::pair<uint64_t, int>> new_verts;
+	std::vector<std::pair<uint64_t, int>> new_lines;
+
+	void finishCopy()
+	{
+		verts.insert(new_verts.begin(), new_verts.end());
+		lines.insert(new_lines.begin(), new_lines.end());
+
+		new_verts.clear();
+		new_lines.clear();
+	}
+};
+
+
+//
+// pastes one copy of the clipboard.  The remapping from clipboard index
+// to real index uses plain vectors, since the clipboard indices are
+// contiguous.  Each kind of object is added as one batch, after working
+// out which of them get welded instead.
+//
+static void PasteGroupOfObjects(EditOperation &op, MapFormat format, const paste_place_t &place,
+								paste_welder_c *welder = nullptr)
+{
+	Document &doc = op.doc;
+
+	std::vector<int> vert_map(clip_board->verts.size());
+	std::vector<int> sector_map(clip_board->sectors.size());
+	std::vector<int> side_map(clip_board->sides.size());
+
+	size_t i;
+
+	std::vector<Vertex> new_verts;
+	new_verts.reserve(clip_board->verts.size());
 
 	for (i = 0 ; i < clip_board->verts.size() ; i++)
 	{
-		int new_v = op.addNew(ObjType::vertices);
-		auto & V = op.doc.vertices[new_v];
+		Vertex V = clip_board->verts[i];
 
-		vert_map[i] = new_v;
+		V.SetRawXY(format, place.apply(V.xy()));
 
-		*V = clip_board->verts[i];
+		uint64_t key = PasteKey(V.raw_x.raw(), V.raw_y.raw());
 
-		V->SetRawXY(format, V->xy() + pos - cpos);
+		if (welder)
+		{
+			auto found = welder->verts.find(key);
+
+			if (found != welder->verts.end())
+			{
+				vert_map[i] = found->second;
+				continue;
+			}
+		}
+
+		vert_map[i] = doc.numVertices() + (int)new_verts.size();
+		new_verts.push_back(V);
+
+		if (welder)
+			welder->new_verts.push_back({ key, vert_map[i] });
 	}
 
-	for (i = 0 ; i < clip_board->sectors.size() ; i++)
+	if (! new_verts.empty())
 	{
-		int new_s = op.addNew(ObjType::sectors);
-		auto & S = op.doc.sectors[new_s];
+		int first = op.addNew(ObjType::vertices, (int)new_verts.size());
 
-		sector_map[i] = new_s;
+		for (i = 0 ; i < new_verts.size() ; i++)
+			*doc.vertices[first + i] = new_verts[i];
+	}
+
+	if (! clip_board->sectors.empty())
+	{
+		int first = op.addNew(ObjType::sectors, (int)clip_board->sectors.size());
 
-		*S = clip_board->sectors[i];
+		for (i = 0 ; i < clip_board->sectors.size() ; i++)
+		{
+			*doc.sectors[first + i] = clip_board->sectors[i];
+
+			sector_map[i] = first + (int)i;
+		}
 	}
 
+	int num_sides = 0;
+
 	for (i = 0 ; i < clip_board->sides.size() ; i++)
 	{
 		// handle invalidated sectors (as if sidedef had been deleted)
 		if (clip_board->sides[i].sector == INVALID_SECTOR)
-		{
 			side_map[i] = -1;
-			continue;
-		}
+		else
+			side_map[i] = doc.numSidedefs() + num_sides++;
+	}
 
-		int new_sd = op.addNew(ObjType::sidedefs);
-		auto &SD = op.doc.sidedefs[new_sd];
+	if (num_sides > 0)
+		op.addNew(ObjType::sidedefs, num_sides);
 
-		side_map[i] = new_sd;
+	for (i = 0 ; i < clip_board->sides.size() ; i++)
+	{
+		if (side_map[i] < 0)
+			continue;
+
+		auto &SD = doc.sidedefs[side_map[i]];
 
 		*SD = clip_board->sides[i];
 
 		if (SD->sector < 0)
 		{
 			int local = -1 - SD->sector;
-			SYS_ASSERT(sector_map.find(local) != sector_map.end());
+			SYS_ASSERT(local < (int)sector_map.size());
 			SD->sector = sector_map[local];
 		}
 	}
 
+	std::vector<LineDef> new_lines;
+	new_lines.reserve(clip_board->lines.size());
+
 	for (i = 0 ; i < clip_board->lines.size() ; i++)
 	{
-		int new_l = op.addNew(ObjType::linedefs);
-		auto &L = op.doc.linedefs[new_l];
-
-		*L = clip_board->lines[i];
+		LineDef L = clip_board->lines[i];
 
 		// adjust vertex references
-		SYS_ASSERT(vert_map.find(L->start) != vert_map.end());
-		SYS_ASSERT(vert_map.find(L->end)   != vert_map.end());
+		SYS_ASSERT(L.start < (int)vert_map.size());
+		SYS_ASSERT(L.end   < (int)vert_map.size());
 
-		L->start = vert_map[L->start];
-		L->end   = vert_map[L->end  ];
+		L.start = vert_map[L.start];
+		L.end   = vert_map[L.end  ];
 
 		// adjust sidedef references
-		if (op.doc.getRight(*L))
+		if (L.right >= 0)
 		{
-			SYS_ASSERT(side_map.find(L->right) != side_map.end());
-			L->right = side_map[L->right];
+			SYS_ASSERT(L.right < (int)side_map.size());
+			L.right = side_map[L.right];
 		}
 
-		if (op.doc.getLeft(*L))
+		if (L.left >= 0)
 		{
-			SYS_ASSERT(side_map.find(L->left) != side_map.end());
-			L->left = side_map[L->left];
+			SYS_ASSERT(L.left < (int)side_map.size());
+			L.left = side_map[L.left];
 		}
 
 		// flip linedef if necessary
-		if (op.doc.getLeft(*L) && ! op.doc.getRight(*L))
+		if (L.left >= 0 && L.right < 0)
 		{
-			op.doc.linemod.flipLinedef(op, new_l);
+			std::swap(L.start, L.end);
+			std::swap(L.left, L.right);
+		}
+
+		if (welder && L.OneSided())
+		{
+			auto found = welder->lines.find(PasteKey(L.end, L.start));
+
+			if (found != welder->lines.end())
+			{
+				// the earlier line gets our sidedef as its left side
+				int other = found->second;
+				welder->lines.erase(found);
+
+				op.changeLinedef(other, LineDef::F_LEFT, L.right);
+				doc.linemod.mergedSecondSidedef(op, other);
+				continue;
+			}
 		}
 
-		// if the linedef lost a side, fix texturing
-		if (L->OneSided() && is_null_tex(op.doc.getRight(*L)->MidTex()))
-			op.doc.linemod.fixForLostSide(op, new_l);
+		new_lines.push_back(L);
+	}
+
+	if (! new_lines.empty())
+	{
+		int first = op.addNew(ObjType::linedefs, (int)new_lines.size());
+
+		for (i = 0 ; i < new_lines.size() ; i++)
+		{
+			const LineDef &L = new_lines[i];
+			int new_l = first + (int)i;
+
+			*doc.linedefs[new_l] = L;
+
+			// if the linedef lost a side, fix texturing
+			if (L.OneSided() && is_null_tex(doc.getRight(L)->MidTex()))
+				doc.linemod.fixForLostSide(op, new_l);
+
+			if (welder && L.OneSided())
+				welder->new_lines.push_back({ PasteKey(L.start, L.end), new_l });
+		}
 	}
 
-	for (i = 0 ; i < clip_board->things.size() ; i++)
+	if (! clip_board->things.empty())
 	{
-		int new_t = op.addNew(ObjType::things);
-		auto & T = op.doc.things[new_t];
+		int first = op.addNew(ObjType::things, (int)clip_board->things.size());
+
+		for (i = 0 ; i < clip_board->things.size() ; i++)
+		{
+			auto &T = doc.things[first + i];
+
+			*T = clip_board->things[i];
 
-		*T = clip_board->things[i];
+			T->SetRawXY(format, place.apply(T->xy()));
 
-		T->SetRawXY(format, T->xy() + pos - cpos);
+			if (place.angle != 0)
+				T->angle = calc_new_angle(T->angle, place.angle);
+		}
 	}
+
+	if (welder)
+		welder->finishCopy();
 }
 
 
-void Instance::ReselectGroup()
+//
+// the object counts before pasting, all the objects beyond them are new.
+// This assumes new objects go at the end of their array (currently true,
+// but not a guarantee of BA_New).
+//
+paste_marks_t::paste_marks_t(const Document &doc) :
+		things(doc.numThings()), verts(doc.numVertices()),
+		lines(doc.numLinedefs()), sectors(doc.numSectors())
 {
-	// this assumes all the new objects are at the end of their
-	// array (currently true, but not a guarantee of BA_New).
+}
 
+
+void Instance::ReselectGroup(const paste_marks_t &marks)
+{
 	if (edit.mode == ObjType::things)
 	{
 		if (clip_board->mode == ObjType::things ||
 		    clip_board->mode == ObjType::sectors)
 		{
-			int count = (int)clip_board->things.size();
-
 			Selection_Clear();
 
-			edit.Selected->frob_range(level.numThings() - count, level.numThings()-1, BitOp::add);
+			edit.Selected->frob_range(marks.things, level.numThings()-1, BitOp::add);
 		}
 		return;
 	}
@@ -594,8 +768,7 @@ void Instance::ReselectGroup()
 
 	if (clip_board->mode == ObjType::vertices)
 	{
-		int count = (int)clip_board->verts.size();
-		new_sel.frob_range(level.numVertices() - count, level.numVertices() -1, BitOp::add);
+		new_sel.frob_range(marks.verts, level.numVertices() -1, BitOp::add);
 	}
 	else if (clip_board->mode == ObjType::linedefs)
 	{
@@ -603,15 +776,13 @@ void Instance::ReselectGroup()
 		// SECTORS, because the pasted lines do not completely surround
 		// the sectors (non-pasted lines refer to them too).
 
-		int count = (int)clip_board->lines.size();
-		new_sel.frob_range(level.numLinedefs() - count, level.numLinedefs() -1, BitOp::add);
+		new_sel.frob_range(marks.lines, level.numLinedefs() -1, BitOp::add);
 	}
 	else
 	{
 		SYS_ASSERT(clip_board->mode == ObjType::sectors);
 
-		int count = (int)clip_board->sectors.size();
-		new_sel.frob_range(level.numSectors() - count, level.numSectors() -1, BitOp::add);
+		new_sel.frob_range(marks.sectors, level.numSectors() -1, BitOp::add);
 	}
 
 	Selection_Clear();
@@ -620,25 +791,35 @@ void Instance::ReselectGroup()
 }
 
 
+//
+// where to put pasted stuff: the mouse pointer, honoring the grid snapping
+//
+v2double_t Instance::Clipboard_PastePos() const
+{
+	v2double_t pos = edit.map.xy;
+
+	if (! edit.pointer_in_window)
+	{
+		pos = grid.orig;
+	}
+
+	return grid.Snap(pos);
+}
+
+
 bool Instance::Clipboard_DoPaste()
 {
 	bool reselect = true;  // CONFIG TODO
 
-	unsigned int i;
-
 	if (! Clipboard_HasStuff())
 		return false;
 
-	// figure out where to put stuff
-	v2double_t pos = edit.map.xy;
+	paste_marks_t marks(level);
 
-	if (! edit.pointer_in_window)
-	{
-		pos = grid.orig;
-	}
+	paste_place_t place;
 
-	// honor the grid snapping setting
-	pos = grid.Snap(pos);
+	place.centre = ClipboardCentre();
+	place.pos = Clipboard_PastePos();
 
 	{
 		EditOperation op(level.basis);
@@ -646,61 +827,121 @@ bool Instance::Clipboard_DoPaste()
 
 		clip_doing_paste = true;
 
-		switch (clip_board->mode)
+		PasteGroupOfObjects(op, loaded.levelFormat, place);
+
+		clip_doing_paste = false;
+	}
+
+	if (clip_board->mode == ObjType::things)
+	{
+		for (const Thing &T : clip_board->things)
+			recent_things.insert_number(T.type);
+	}
+
+	edit.error_mode = false;
+
+	if (reselect)
+		ReselectGroup(marks);
+
+	return true;
+}
+
+
+//
+// size of the area covered by the clipboard, used as the default spacing
+// of a paste array so that the copies touch each other.
+//
+static v2double_t ClipboardExtent()
+{
+	bool first = true;
+
+	v2double_t lo = {};
+	v2double_t hi = {};
+
+	auto extend = [&](const v2double_t &p)
+	{
+		if (first)
 		{
-			case ObjType::things:
-			{
-				v2double_t cpos = CentreOfPointObjects(clip_board->things);
+			lo = hi = p;
+			first = false;
+			return;
+		}
 
-				for (unsigned int i = 0 ; i < clip_board->things.size() ; i++)
-				{
-					int new_t = op.addNew(ObjType::things);
-					auto &T = level.things[new_t];
+		lo.x = std::min(lo.x, p.x);  hi.x = std::max(hi.x, p.x);
+		lo.y = std::min(lo.y, p.y);  hi.y = std::max(hi.y, p.y);
+	};
 
-					*T = clip_board->things[i];
+	for (const Vertex &V : clip_board->verts)
+		extend(V.xy());
 
-					T->SetRawXY(loaded.levelFormat, T->xy() + pos - cpos);
+	if (clip_board->verts.empty())
+	{
+		for (const Thing &T : clip_board->things)
+			extend(T.xy());
+	}
 
-					recent_things.insert_number(T->type);
-				}
-				break;
-			}
+	return hi - lo;
+}
 
-			case ObjType::vertices:
-			{
-				v2double_t cpos = CentreOfPointObjects(clip_board->verts);
 
-				for (i = 0 ; i < clip_board->verts.size() ; i++)
-				{
-					int new_v = op.addNew(ObjType::vertices);
-					auto & V = level.vertices[new_v];
+//
+// pastes cols x rows copies of the clipboard as a single operation,
+// 'step' apart (a zero component means the size of the clipboard).
+// Each copy is rotated 'angle' degrees further than the one before,
+// around its own centre.  Coincident vertices of the copies are welded
+// and the one-sided lines between them become two-sided.
+//
+bool Instance::Clipboard_DoPasteArray(int cols, int rows, v2double_t step, int angle)
+{
+	SYS_ASSERT(cols > 0 && rows > 0);
 
-					*V = clip_board->verts[i];
+	if (! Clipboard_HasStuff())
+		return false;
 
-					V->SetRawXY(loaded.levelFormat, V->xy() + pos - cpos);
-				}
-				break;
-			}
+	v2double_t extent = ClipboardExtent();
 
-			case ObjType::linedefs:
-			case ObjType::sectors:
-			{
-				PasteGroupOfObjects(op, loaded.levelFormat, pos);
-				break;
-			}
+	if (step.x == 0) step.x = extent.x > 0 ? extent.x : grid.step;
+	if (step.y == 0) step.y = extent.y > 0 ? extent.y : grid.step;
+
+	paste_marks_t marks(level);
+
+	paste_place_t place;
+
+	place.centre = ClipboardCentre();
 
-			default:
-				break;
+	v2double_t origin = Clipboard_PastePos();
+
+	paste_welder_c welder;
+
+	{
+		EditOperation op(level.basis);
+		op.setMessage("pasted %dx%d array", cols, rows);
+
+		clip_doing_paste = true;
+
+		for (int r = 0 ; r < rows ; r++)
+		for (int c = 0 ; c < cols ; c++)
+		{
+			int k = r * cols + c;
+
+			place.pos = origin + v2double_t{ c * step.x, r * step.y };
+			place.angle = calc_new_angle(0, k * angle);
+
+			PasteGroupOfObjects(op, loaded.levelFormat, place, &welder);
 		}
 
 		clip_doing_paste = false;
+	}
 
+	if (clip_board->mode == ObjType::things)
+	{
+		for (const Thing &T : clip_board->things)
+			recent_things.insert_number(T.type);
 	}
 
 	edit.error_mode = false;
 
-	if (reselect)
-		ReselectGroup();
+	ReselectGroup(marks);
 
 	return true;
 }
@@ -723,6 +964,32 @@ void Instance::CMD_CopyAndPaste()
 }
 
 
+//
+// PasteArray <cols> <rows> [<dx> <dy>] [<angle>]
+//
+void Instance::CMD_PasteArray()
+{
+	int cols = atoi(EXEC_Param[0]);
+	int rows = atoi(EXEC_Param[1]);
+
+	if (cols < 1 || rows < 1 || cols > MAX_PASTE_ARRAY || rows > MAX_PASTE_ARRAY)
+	{
+		Beep("PasteArray: bad size '%s' '%s'", EXEC_Param[0].c_str(), EXEC_Param[1].c_str());
+		return;
+	}
+
+	v2double_t step = { atof(EXEC_Param[2]), atof(EXEC_Param[3]) };
+
+	int angle = atoi(EXEC_Param[4]);
+
+	if (! Clipboard_DoPasteArray(cols, rows, step, angle))
+	{
+		Beep("Clipboard is empty");
+		return;
+	}
+}
+
+
 void Instance::CMD_Clipboard_Cut()
 {
 	if (main_win->ClipboardOp(EditCommand::cut))
@@ -41,12 +41,24 @@ enum class EditCommand
 	del
 };
 
+//
+// Object counts before a paste, for selecting the pasted objects
+//
+struct paste_marks_t
+{
+	int things;
+	int verts;
+	int lines;
+	int sectors;
+
+	explicit paste_marks_t(const Document &doc);
+};
+
 void Clipboard_ClearLocals();
 
 void Clipboard_NotifyBegin();
-void Clipboard_NotifyInsert(const Document &doc, ObjType type, int objnum);
+void Clipboard_NotifyInsert(const Document &doc, ObjType type, int objnum, int count);
 void Clipboard_NotifyDelete(ObjType type, int objnum);
-void Clipboard_NotifyChange(ObjType type, int objnum, int field);
 void Clipboard_NotifyEnd();
 
 void UnusedVertices(const Document &doc, const selection_c &lines, selection_c &result);
@@ -54,6 +54,8 @@ struct opp_test_state_t
 
 	Side * result_side = nullptr;
 
+	const bitvec_c * ignore_lines = nullptr;
+
 	double dx = 0, dy = 0;
 
 	// origin of casting line
@@ -111,6 +113,9 @@ public:
 		if (ld == n)  // ignore input line
 			return;
 
+		if (ignore_lines && ignore_lines->get(n))
+			return;
+
 		double nx1 = doc.getStart(*doc.linedefs[n]).x();
 		double ny1 = doc.getStart(*doc.linedefs[n]).y();
 		double nx2 = doc.getEnd(*doc.linedefs[n]).x();
@@ -175,6 +180,89 @@ public:
 };
 
 
+//
+// Casts a ray both ways from a point, looking for the closest line which
+// crosses it. Used to find the sector at a point.
+//
+struct sector_cast_state_t
+{
+	v2double_t pos;
+
+	bool cast_horizontal;
+
+	int    best_match = -1;
+	double best_dist = 9e9;
+	Side   side = Side::neither;
+
+	const Document &doc;
+
+public:
+	sector_cast_state_t(const Document &doc, const v2double_t &origin, bool horizontal) :
+		pos(origin), cast_horizontal(horizontal), doc(doc)
+	{
+		// most lines have integral coords, so offset slightly to
+		// avoid hitting vertices.
+		if (cast_horizontal)
+			pos.y += 0.04;
+		else
+			pos.x += 0.04;
+	}
+
+	void ProcessLine(int n)
+	{
+		v2double_t lpos1 = doc.getStart(*doc.linedefs[n]).xy();
+		v2double_t lpos2 = doc.getEnd(*doc.linedefs[n]).xy();
+
+		double dist;
+
+		if (cast_horizontal)
+		{
+			// ignore purely horizontal lines
+			if (lpos1.y == lpos2.y)
+				return;
+
+			// does the linedef cross the horizontal ray?
+			if (std::min(lpos1.y, lpos2.y) >= pos.y || std::max(lpos1.y, lpos2.y) <= pos.y)
+				return;
+
+			dist = lpos1.x - pos.x + (lpos2.x - lpos1.x) * (pos.y - lpos1.y) / (lpos2.y - lpos1.y);
+		}
+		else
+		{
+			// ignore purely vertical lines
+			if (lpos1.x == lpos2.x)
+				return;
+
+			// does the linedef cross the vertical ray?
+			if (std::min(lpos1.x, lpos2.x) >= pos.x || std::max(lpos1.x, lpos2.x) <= pos.x)
+				return;
+
+			dist = lpos1.y - pos.y + (lpos2.y - lpos1.y) * (pos.x - lpos1.x) / (lpos2.x - lpos1.x);
+		}
+
+		// on a tie, the lowest numbered line wins, whatever order the
+		// lines are visited in
+		if (fabs(dist) > best_dist || (fabs(dist) == best_dist && n > best_match))
+			return;
+
+		best_match = n;
+		best_dist = fabs(dist);
+
+		if (best_dist < 0.01)
+			side = Side::neither;  // on the line
+		else if (cast_horizontal ? (lpos1.y > lpos2.y) == (dist > 0) :
+		                           (lpos1.x > lpos2.x) == (dist < 0))
+			side = Side::right;  // right side
+		else
+			side = Side::left; // left side
+	}
+};
+
+
+static Objid pickNearestSector(const Document &doc, const v2double_t &pos,
+							   const sector_cast_state_t &horiz, const sector_cast_state_t &vert);
+
+
 class fastopp_node_c
 {
 public:
@@ -212,77 +300,69 @@ private:
 	}
 
 public:
-	/* horizontal tree */
+	/* both trees: returns the node holding the line */
 
-	void AddLine_X(int ld, int x1, int x2)
+	fastopp_node_c * AddLine(int ld, int c1, int c2)
 	{
-		if (lo_child && (x1 > lo_child->lo) &&
-		                (x2 < lo_child->hi))
+		if (lo_child && (c1 > lo_child->lo) &&
+		                (c2 < lo_child->hi))
 		{
-			lo_child->AddLine_X(ld, x1, x2);
-			return;
+			return lo_child->AddLine(ld, c1, c2);
 		}
 
-		if (hi_child && (x1 > hi_child->lo) &&
-		                (x2 < hi_child->hi))
+		if (hi_child && (c1 > hi_child->lo) &&
+		                (c2 < hi_child->hi))
 		{
-			hi_child->AddLine_X(ld, x1, x2);
-			return;
+			return hi_child->AddLine(ld, c1, c2);
 		}
 
 		lines.push_back(ld);
+		return this;
 	}
 
-	void AddLine_X(int ld)
+	/* horizontal tree */
+
+	fastopp_node_c * AddLine_X(int ld)
 	{
 		const auto &L = doc.linedefs[ld];
 
 		// can ignore purely vertical lines
 		if (doc.isVertical(*L))
-			return;
+			return nullptr;
 
 		double x1 = std::min(doc.getStart(*L).x(), doc.getEnd(*L).x());
 		double x2 = std::max(doc.getStart(*L).x(), doc.getEnd(*L).x());
 
-		AddLine_X(ld, (int)floor(x1), (int)ceil(x2));
+		return AddLine(ld, (int)floor(x1), (int)ceil(x2));
 	}
 
 	/* vertical tree */
 
-	void AddLine_Y(int ld, int y1, int y2)
-	{
-		if (lo_child && (y1 > lo_child->lo) &&
-		                (y2 < lo_child->hi))
-		{
-			lo_child->AddLine_Y(ld, y1, y2);
-			return;
-		}
-
-		if (hi_child && (y1 > hi_child->lo) &&
-		                (y2 < hi_child->hi))
-		{
-			hi_child->AddLine_Y(ld, y1, y2);
-			return;
-		}
-
-		lines.push_back(ld);
-	}
-
-	void AddLine_Y(int ld)
+	fastopp_node_c * AddLine_Y(int ld)
 	{
 		const auto &L = doc.linedefs[ld];
 
 		// can ignore purely horizonal lines
 		if (doc.isHorizontal(*L))
-			return;
+			return nullptr;
 
 		double y1 = std::min(doc.getStart(*L).y(), doc.getEnd(*L).y());
 		double y2 = std::max(doc.getStart(*L).y(), doc.getEnd(*L).y());
 
-		AddLine_Y(ld, (int)floor(y1), (int)ceil(y2));
+		return AddLine(ld, (int)floor(y1), (int)ceil(y2));
+	}
+
+	void RemoveLine(int ld)
+	{
+		auto it = std::find(lines.begin(), lines.end(), ld);
+		SYS_ASSERT(it != lines.end());
+
+		*it = lines.back();
+		lines.pop_back();
 	}
 
-	void Process(opp_test_state_t& test, double coord) const
+	template<typename TEST>
+	void Process(TEST& test, double coord) const
 	{
 		for (unsigned int k = 0 ; k < lines.size() ; k++)
 			test.ProcessLine(lines[k]);
@@ -377,101 +457,15 @@ Objid hover::getNearbyObject(ObjType type, const Document &doc, const ConfigData
 //
 int hover::getClosestLine_CastingHoriz(const Document &doc, v2double_t pos, Side *side)
 {
-	int    best_match = -1;
-	double best_dist = 9e9;
-
-	// most lines have integral X coords, so offset slightly to
-	// avoid hitting vertices.
-	pos.y += 0.04;
-
-	for(int n = 0; n < doc.numLinedefs(); n++)
-	{
-		v2double_t lpos1, lpos2;
-		lpos1.y = doc.getStart(*doc.linedefs[n]).y();
-		lpos2.y = doc.getEnd(*doc.linedefs[n]).y();
-
-		// ignore purely horizontal lines
-		if(lpos1.y == lpos2.y)
-			continue;
-
-		// does the linedef cross the horizontal ray?
-		if(std::min(lpos1.y, lpos2.y) >= pos.y || std::max(lpos1.y, lpos2.y) <= pos.y)
-			continue;
-
-		lpos1.x = doc.getStart(*doc.linedefs[n]).x();
-		lpos2.x = doc.getEnd(*doc.linedefs[n]).x();
-
-		double dist = lpos1.x - pos.x + (lpos2.x - lpos1.x) * (pos.y - lpos1.y) / (lpos2.y - lpos1.y);
-
-		if(fabs(dist) < best_dist)
-		{
-			best_match = n;
-			best_dist = fabs(dist);
-
-			if(side)
-			{
-				if(best_dist < 0.01)
-					*side = Side::neither;  // on the line
-				else if((lpos1.y > lpos2.y) == (dist > 0))
-					*side = Side::right;  // right side
-				else
-					*side = Side::left; // left side
-			}
-		}
-	}
-
-	return best_match;
-}
-
-//
-// Gets the closest line, casting vertically
-//
-static int getClosestLine_CastingVert(const Document &doc, v2double_t pos, Side *side)
-{
-	int    best_match = -1;
-	double best_dist = 9e9;
-
-	// most lines have integral X coords, so offset slightly to
-	// avoid hitting vertices.
-	pos.x += 0.04;
+	sector_cast_state_t test(doc, pos, true);
 
 	for(int n = 0; n < doc.numLinedefs(); n++)
-	{
-		v2double_t lpos1, lpos2;
-		lpos1.x = doc.getStart(*doc.linedefs[n]).x();
-		lpos2.x = doc.getEnd(*doc.linedefs[n]).x();
+		test.ProcessLine(n);
 
-		// ignore purely vertical lines
-		if(lpos1.x == lpos2.x)
-			continue;
+	if(side && test.best_match >= 0)
+		*side = test.side;
 
-		// does the linedef cross the vertical ray?
-		if(std::min(lpos1.x, lpos2.x) >= pos.x || std::max(lpos1.x, lpos2.x) <= pos.x)
-			continue;
-
-		lpos1.y = doc.getStart(*doc.linedefs[n]).y();
-		lpos2.y = doc.getEnd(*doc.linedefs[n]).y();
-
-		double dist = lpos1.y - pos.y + (lpos2.y - lpos1.y) * (pos.x - lpos1.x) / (lpos2.x - lpos1.x);
-
-		if(fabs(dist) < best_dist)
-		{
-			best_match = n;
-			best_dist = fabs(dist);
-
-			if(side)
-			{
-				if(best_dist < 0.01)
-					*side = Side::neither;  // on the line
-				else if((lpos1.x > lpos2.x) == (dist < 0))
-					*side = Side::right;  // right side
-				else
-					*side = Side::left; // left side
-			}
-		}
-	}
-
-	return best_match;
+	return test.best_match;
 }
 
 static Objid getNearestSplitLine(const Document &doc, MapFormat format, const Grid_State_c &grid,
@@ -582,6 +576,7 @@ int Hover::getOppositeLinedef(int ld, Side ld_side, Side *result_side, const bit
 	test.ld = ld;
 	test.ld_side = ld_side;
 	test.result_side = result_side;
+	test.ignore_lines = ignore_lines;
 
 	// this sets dx and dy
 	test.ComputeCastOrigin();
@@ -592,29 +587,12 @@ int Hover::getOppositeLinedef(int ld, Side ld_side, Side *result_side, const bit
 	test.best_match = -1;
 	test.best_dist = 9e9;
 
-	if(m_fastopp_X_tree)
-	{
-		// fast way : use the binary tree
+	updateFastOpposite();
 
-		SYS_ASSERT(ignore_lines == NULL);
-
-		if(test.cast_horizontal)
-			m_fastopp_Y_tree->Process(test, test.y);
-		else
-			m_fastopp_X_tree->Process(test, test.x);
-	}
+	if(test.cast_horizontal)
+		m_fastopp_Y_tree->Process(test, test.y);
 	else
-	{
-		// normal way : test all linedefs
-
-		for(int n = 0; n < doc.numLinedefs(); n++)
-		{
-			if(ignore_lines && ignore_lines->get(n))
-				continue;
-
-			test.ProcessLine(n);
-		}
-	}
+		m_fastopp_X_tree->Process(test, test.x);
 
 	return test.best_match;
 }
@@ -635,35 +613,463 @@ int Hover::getOppositeSector(int ld, Side ld_side) const
 	return doc.getSectorID(*doc.linedefs[opp], opp_side);
 }
 
+Hover::~Hover()
+{
+	delete m_fastopp_X_tree;
+	delete m_fastopp_Y_tree;
+}
+
 //
-// Begin fast-opposite mode
+// Drop the line indexes and the thing sectors, they get rebuilt on the
+// next query
 //
-void Hover::fastOpposite_begin()
+void Hover::invalidateIndexes()
 {
-	SYS_ASSERT(!m_fastopp_X_tree && !m_fastopp_Y_tree);
+	delete m_fastopp_X_tree;
+	m_fastopp_X_tree = nullptr;
+	delete m_fastopp_Y_tree;
+	m_fastopp_Y_tree = nullptr;
 
-	inst.CalculateLevelBounds();
+	m_fastopp_X_node.clear();
+	m_fastopp_Y_node.clear();
+	m_fastopp_dirty_lines.clear();
+	m_fastopp_moved_verts.clear();
+	m_fastopp_op_lines.clear();
+	m_fastopp_op_verts.clear();
 
-	m_fastopp_X_tree = new fastopp_node_c(static_cast<int>(inst.Map_bound1.x - 8), static_cast<int>(inst.Map_bound2.x + 8), doc);
-	m_fastopp_Y_tree = new fastopp_node_c(static_cast<int>(inst.Map_bound1.y - 8), static_cast<int>(inst.Map_bound2.y + 8), doc);
+	invalidateThingSectors();
+}
 
-	for(int n = 0; n < doc.numLinedefs(); n++)
+void Hover::invalidateThingSectors()
+{
+	m_thing_sectors.clear();
+	m_thing_sectors_valid = false;
+	m_thingsec_dirty_things.clear();
+	m_thingsec_dirty_lines.clear();
+	m_thingsec_moved_verts.clear();
+	m_thingsec_dirty_sides.clear();
+	m_thingsec_op_things.clear();
+	m_thingsec_op_sides.clear();
+}
+
+//
+// Objects got renumbered. Instead of shifting the indexes for each
+// object, they get dropped here and are rebuilt once, when next needed.
+//
+void Hover::dropRenumbered(ObjType type)
+{
+	if(type == ObjType::vertices || type == ObjType::linedefs)
 	{
-		m_fastopp_X_tree->AddLine_X(n);
-		m_fastopp_Y_tree->AddLine_Y(n);
+		invalidateIndexes();
+		m_fastopp_renumbered = true;
 	}
+	else
+	{
+		invalidateThingSectors();
+	}
+	m_thingsec_renumbered = true;
 }
 
 //
-// End fast-opposite mode
+// Objects about to be inserted
 //
-void Hover::fastOpposite_finish()
+void Hover::notifyInsert(ObjType type, int objnum, int count)
+{
+	// new objects nearly always go at the end, which renumbers nothing
+	if(objnum < doc.numObjects(type))
+	{
+		dropRenumbered(type);
+		return;
+	}
+
+	// the level got changed behind our back
+	if(type == ObjType::linedefs && m_fastopp_X_tree &&
+	   (int)m_fastopp_X_node.size() != doc.numLinedefs())
+	{
+		invalidateIndexes();
+	}
+
+	for(int n = objnum; n < objnum + count; n++)
+	{
+		switch(type)
+		{
+		case ObjType::things:
+			m_thingsec_op_things.push_back(n);
+			if(m_thing_sectors_valid)
+			{
+				m_thing_sectors.push_back({ -1, -1, -1 });
+				m_thingsec_dirty_things.push_back(n);
+			}
+			break;
+
+		case ObjType::vertices:
+			m_fastopp_op_verts.push_back(n);
+			break;
+
+		case ObjType::sidedefs:
+			m_thingsec_op_sides.push_back(n);
+			break;
+
+		case ObjType::linedefs:
+			m_fastopp_op_lines.push_back(n);
+
+			if(m_fastopp_X_tree)
+			{
+				m_fastopp_X_node.push_back(nullptr);
+				m_fastopp_Y_node.push_back(nullptr);
+				m_fastopp_dirty_lines.push_back(n);
+			}
+			if(m_thing_sectors_valid)
+				m_thingsec_dirty_lines.push_back(n);
+			break;
+
+		default:
+			return;
+		}
+	}
+}
+
+//
+// Object about to be deleted
+//
+void Hover::notifyDelete(ObjType type, int objnum)
+{
+	dropRenumbered(type);
+}
+
+//
+// Object field changed
+//
+void Hover::notifyChange(ObjType type, int objnum, int field)
+{
+	if(type == ObjType::vertices)
+	{
+		m_fastopp_op_verts.push_back(objnum);
+		if(m_fastopp_X_tree)
+			m_fastopp_moved_verts.push_back(objnum);
+	}
+	else if(type == ObjType::linedefs && (field == LineDef::F_START || field == LineDef::F_END))
+	{
+		m_fastopp_op_lines.push_back(objnum);
+		if(m_fastopp_X_tree)
+			m_fastopp_dirty_lines.push_back(objnum);
+	}
+
+	if(!m_thing_sectors_valid)
+		return;
+
+	switch(type)
+	{
+	case ObjType::things:
+		if(field == Thing::F_X || field == Thing::F_Y)
+			m_thingsec_dirty_things.push_back(objnum);
+		break;
+	case ObjType::vertices:
+		m_thingsec_moved_verts.push_back(objnum);
+		break;
+	case ObjType::linedefs:
+		if(field == LineDef::F_START || field == LineDef::F_END || field == LineDef::F_RIGHT ||
+		   field == LineDef::F_LEFT)
+		{
+			m_thingsec_dirty_lines.push_back(objnum);
+		}
+		break;
+	case ObjType::sidedefs:
+		if(field == SideDef::F_SECTOR)
+			m_thingsec_dirty_sides.push_back(objnum);
+		break;
+	default:
+		break;
+	}
+}
+
+//
+// End of an edit operation
+//
+void Hover::notifyEnd()
+{
+	// objects filled in after an earlier rebuild in this operation
+	// are not queued anywhere, so rebuild once more
+	if(m_fastopp_renumbered)
+		invalidateIndexes();
+	else if(m_thingsec_renumbered)
+		invalidateThingSectors();
+	m_fastopp_renumbered = false;
+	m_thingsec_renumbered = false;
+
+	if(m_fastopp_X_tree)
+	{
+		m_fastopp_dirty_lines.insert(m_fastopp_dirty_lines.end(), m_fastopp_op_lines.begin(),
+				m_fastopp_op_lines.end());
+		m_fastopp_moved_verts.insert(m_fastopp_moved_verts.end(), m_fastopp_op_verts.begin(),
+				m_fastopp_op_verts.end());
+	}
+	if(m_thing_sectors_valid)
+	{
+		m_thingsec_dirty_lines.insert(m_thingsec_dirty_lines.end(), m_fastopp_op_lines.begin(),
+				m_fastopp_op_lines.end());
+		m_thingsec_moved_verts.insert(m_thingsec_moved_verts.end(), m_fastopp_op_verts.begin(),
+				m_fastopp_op_verts.end());
+		m_thingsec_dirty_things.insert(m_thingsec_dirty_things.end(),
+				m_thingsec_op_things.begin(), m_thingsec_op_things.end());
+		m_thingsec_dirty_sides.insert(m_thingsec_dirty_sides.end(),
+				m_thingsec_op_sides.begin(), m_thingsec_op_sides.end());
+	}
+	m_fastopp_op_lines.clear();
+	m_fastopp_op_verts.clear();
+	m_thingsec_op_things.clear();
+	m_thingsec_op_sides.clear();
+}
+
+//
+// Bring the opposite-line index up to date
+//
+void Hover::updateFastOpposite() const
+{
+	// also catches levels loaded or built directly
+	if(!m_fastopp_X_tree || (int)m_fastopp_X_node.size() != doc.numLinedefs())
+	{
+		rebuildFastOpposite();
+		return;
+	}
+
+	if(!m_fastopp_moved_verts.empty())
+	{
+		bitvec_c moved(doc.numVertices());
+		for(int v : m_fastopp_moved_verts)
+			moved.set(v);
+
+		for(int n = 0; n < doc.numLinedefs(); n++)
+		{
+			const auto &L = doc.linedefs[n];
+			if(moved.get(L->start) || moved.get(L->end))
+				m_fastopp_dirty_lines.push_back(n);
+		}
+		m_fastopp_moved_verts.clear();
+	}
+
+	for(int ld : m_fastopp_dirty_lines)
+		reindexLine(ld);
+	m_fastopp_dirty_lines.clear();
+}
+
+//
+// Put a linedef back into the trees, according to its current position
+//
+void Hover::reindexLine(int ld) const
+{
+	if(m_fastopp_X_node[ld])
+		m_fastopp_X_node[ld]->RemoveLine(ld);
+	if(m_fastopp_Y_node[ld])
+		m_fastopp_Y_node[ld]->RemoveLine(ld);
+
+	m_fastopp_X_node[ld] = m_fastopp_X_tree->AddLine_X(ld);
+	m_fastopp_Y_node[ld] = m_fastopp_Y_tree->AddLine_Y(ld);
+
+	m_indexed_lines++;
+}
+
+//
+// Build the opposite-line index from scratch
+//
+void Hover::rebuildFastOpposite() const
 {
-	SYS_ASSERT(m_fastopp_X_tree || m_fastopp_Y_tree);
 	delete m_fastopp_X_tree;
-	m_fastopp_X_tree = nullptr;
 	delete m_fastopp_Y_tree;
-	m_fastopp_Y_tree = nullptr;
+
+	double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+
+	for(int n = 0; n < doc.numVertices(); n++)
+	{
+		const auto &V = doc.vertices[n];
+
+		if(n == 0 || V->x() < x1) x1 = V->x();
+		if(n == 0 || V->y() < y1) y1 = V->y();
+		if(n == 0 || V->x() > x2) x2 = V->x();
+		if(n == 0 || V->y() > y2) y2 = V->y();
+	}
+
+	// lines outside of these bounds (after editing) simply stay in
+	// the root nodes
+	m_fastopp_X_tree = new fastopp_node_c(static_cast<int>(x1 - 8), static_cast<int>(x2 + 8), doc);
+	m_fastopp_Y_tree = new fastopp_node_c(static_cast<int>(y1 - 8), static_cast<int>(y2 + 8), doc);
+
+	m_fastopp_X_node.resize(doc.numLinedefs());
+	m_fastopp_Y_node.resize(doc.numLinedefs());
+
+	for(int n = 0; n < doc.numLinedefs(); n++)
+	{
+		m_fastopp_X_node[n] = m_fastopp_X_tree->AddLine_X(n);
+		m_fastopp_Y_node[n] = m_fastopp_Y_tree->AddLine_Y(n);
+	}
+	m_indexed_lines += doc.numLinedefs();
+
+	m_fastopp_dirty_lines.clear();
+	m_fastopp_moved_verts.clear();
+}
+
+//
+// Get the sector of a thing, -1 for none. Same as hover::getNearestSector()
+// at the thing's position.
+//
+int Hover::getThingSector(int th) const
+{
+	SYS_ASSERT(0 <= th && th < doc.numThings());
+
+	updateThingSectors();
+
+	return m_thing_sectors[th].sector;
+}
+
+//
+// Look up the sector of a thing
+//
+void Hover::findThingSector(int th) const
+{
+	v2double_t pos = doc.things[th]->xy();
+
+	sector_cast_state_t horiz(doc, pos, true);
+	sector_cast_state_t vert(doc, pos, false);
+
+	m_fastopp_Y_tree->Process(horiz, horiz.pos.y);
+	m_fastopp_X_tree->Process(vert, vert.pos.x);
+
+	thing_sector_t &info = m_thing_sectors[th];
+
+	info.sector = pickNearestSector(doc, pos, horiz, vert).num;
+	info.horiz_line = horiz.best_match;
+	info.vert_line = vert.best_match;
+
+	m_thing_lookups++;
+}
+
+//
+// Merge overlapping ranges, so they can be binary searched
+//
+static void MergeRanges(std::vector<std::pair<double, double>> &ranges)
+{
+	std::sort(ranges.begin(), ranges.end());
+
+	size_t count = 0;
+
+	for(const auto &range : ranges)
+	{
+		if(count > 0 && range.first <= ranges[count - 1].second)
+			ranges[count - 1].second = std::max(ranges[count - 1].second, range.second);
+		else
+			ranges[count++] = range;
+	}
+
+	ranges.resize(count);
+}
+
+static bool InsideRanges(const std::vector<std::pair<double, double>> &ranges, double value)
+{
+	auto it = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(value, 9e9));
+
+	return it != ranges.begin() && value <= (it - 1)->second;
+}
+
+//
+// Bring the thing sectors up to date. A thing's result can only change
+// when one of its two closest lines changed, or when a changed line now
+// crosses one of its casts.
+//
+void Hover::updateThingSectors() const
+{
+	updateFastOpposite();
+
+	// also catches levels loaded or built directly
+	if(!m_thing_sectors_valid || (int)m_thing_sectors.size() != doc.numThings())
+	{
+		m_thing_sectors.resize(doc.numThings());
+
+		for(int th = 0; th < doc.numThings(); th++)
+			findThingSector(th);
+
+		m_thing_sectors_valid = true;
+		m_thingsec_dirty_things.clear();
+		m_thingsec_dirty_lines.clear();
+		m_thingsec_moved_verts.clear();
+		m_thingsec_dirty_sides.clear();
+		return;
+	}
+
+	if(m_thingsec_dirty_things.empty() && m_thingsec_dirty_lines.empty() &&
+	   m_thingsec_moved_verts.empty() && m_thingsec_dirty_sides.empty())
+	{
+		return;
+	}
+
+	bitvec_c changed_lines(doc.numLinedefs());
+
+	for(int ld : m_thingsec_dirty_lines)
+		changed_lines.set(ld);
+
+	if(!m_thingsec_moved_verts.empty() || !m_thingsec_dirty_sides.empty())
+	{
+		bitvec_c moved(doc.numVertices());
+		for(int v : m_thingsec_moved_verts)
+			moved.set(v);
+
+		bitvec_c sides(doc.numSidedefs());
+		for(int sd : m_thingsec_dirty_sides)
+			sides.set(sd);
+
+		for(int n = 0; n < doc.numLinedefs(); n++)
+		{
+			const auto &L = doc.linedefs[n];
+			if(moved.get(L->start) || moved.get(L->end) ||
+			   (L->right >= 0 && sides.get(L->right)) || (L->left >= 0 && sides.get(L->left)))
+			{
+				changed_lines.set(n);
+			}
+		}
+	}
+
+	// the coordinate ranges covered by the changed lines. The casts are
+	// slightly offset, so the ranges get some margin.
+	std::vector<std::pair<double, double>> x_ranges, y_ranges;
+
+	for(int n = 0; n < doc.numLinedefs(); n++)
+	{
+		if(!changed_lines.get(n))
+			continue;
+
+		const auto &L = doc.linedefs[n];
+		const Vertex &V1 = doc.getStart(*L);
+		const Vertex &V2 = doc.getEnd(*L);
+
+		x_ranges.emplace_back(std::min(V1.x(), V2.x()) - 1, std::max(V1.x(), V2.x()) + 1);
+		y_ranges.emplace_back(std::min(V1.y(), V2.y()) - 1, std::max(V1.y(), V2.y()) + 1);
+	}
+
+	MergeRanges(x_ranges);
+	MergeRanges(y_ranges);
+
+	bitvec_c dirty_things(doc.numThings());
+
+	for(int th : m_thingsec_dirty_things)
+		dirty_things.set(th);
+
+	for(int th = 0; th < doc.numThings(); th++)
+	{
+		const thing_sector_t &info = m_thing_sectors[th];
+		const auto &T = doc.things[th];
+
+		if(dirty_things.get(th) ||
+		   (info.horiz_line >= 0 && changed_lines.get(info.horiz_line)) ||
+		   (info.vert_line >= 0 && changed_lines.get(info.vert_line)) ||
+		   InsideRanges(x_ranges, T->x()) || InsideRanges(y_ranges, T->y()))
+		{
+			findThingSector(th);
+		}
+	}
+
+	m_thingsec_dirty_things.clear();
+	m_thingsec_dirty_lines.clear();
+	m_thingsec_moved_verts.clear();
+	m_thingsec_dirty_sides.clear();
 }
 
 //
@@ -957,10 +1363,46 @@ Objid hover::getNearestSector(const Document &doc, const v2double_t &pos)
 	   //       grab the closest linedef.  Now it is possible to access
 	   //       self-referencing lines, even purely horizontal ones.
 
-	Side side1, side2;
+	sector_cast_state_t horiz(doc, pos, true);
+	sector_cast_state_t vert(doc, pos, false);
 
-	int line1 = hover::getClosestLine_CastingHoriz(doc, pos, &side1);
-	int line2 = getClosestLine_CastingVert(doc, pos, &side2);
+	for(int n = 0; n < doc.numLinedefs(); n++)
+	{
+		horiz.ProcessLine(n);
+		vert.ProcessLine(n);
+	}
+
+	return pickNearestSector(doc, pos, horiz, vert);
+}
+
+//
+// Same as hover::getNearestSector(), but only visits the lines which may
+// cross the rays, using the opposite-line index. Meant for checking many
+// points, e.g. all the things.
+//
+Objid Hover::getNearestSector(const v2double_t &pos) const
+{
+	updateFastOpposite();
+
+	sector_cast_state_t horiz(doc, pos, true);
+	sector_cast_state_t vert(doc, pos, false);
+
+	m_fastopp_Y_tree->Process(horiz, horiz.pos.y);
+	m_fastopp_X_tree->Process(vert, vert.pos.x);
+
+	return pickNearestSector(doc, pos, horiz, vert);
+}
+
+//
+// Picks the closer result of the two casts
+//
+static Objid pickNearestSector(const Document &doc, const v2double_t &pos,
+							   const sector_cast_state_t &horiz, const sector_cast_state_t &vert)
+{
+	int line1 = horiz.best_match;
+	int line2 = vert.best_match;
+	Side side1 = horiz.side;
+	Side side2 = vert.side;
 
 	if(line2 < 0)
 	{
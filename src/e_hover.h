@@ -68,11 +68,28 @@ public:
 	Hover(Document &doc) : DocumentModule(doc)
 	{
 	}
+	~Hover();
 
 	int getOppositeLinedef(int ld, Side ld_side, Side *result_side, const bitvec_c *ignore_lines) const;
 	int getOppositeSector(int ld, Side ld_side) const;
-	void fastOpposite_begin();
-	void fastOpposite_finish();
+	Objid getNearestSector(const v2double_t &pos) const;
+	int getThingSector(int th) const;
+
+	void notifyInsert(ObjType type, int objnum, int count);
+	void notifyDelete(ObjType type, int objnum);
+	void notifyChange(ObjType type, int objnum, int field);
+	void notifyEnd();
+	void invalidateIndexes();
+
+	// work done by the indexes so far, for checking that edits stay cheap
+	int indexedLineCount() const
+	{
+		return m_indexed_lines;
+	}
+	int thingLookupCount() const
+	{
+		return m_thing_lookups;
+	}
 
 	void findCrossingPoints(crossing_state_c &cross,
 		v2double_t p1, int possible_v1,
@@ -81,8 +98,59 @@ public:
 private:
 	void findCrossingLines(crossing_state_c &cross, const v2double_t &pos1, int possible_v1, const v2double_t &pos2, int possible_v2) const;
 
-	fastopp_node_c *m_fastopp_X_tree = nullptr;
-	fastopp_node_c *m_fastopp_Y_tree = nullptr;
+	void updateFastOpposite() const;
+	void rebuildFastOpposite() const;
+	void reindexLine(int ld) const;
+
+	void updateThingSectors() const;
+	void findThingSector(int th) const;
+	void invalidateThingSectors();
+	void dropRenumbered(ObjType type);
+
+	//
+	// Persistent index of the linedefs for the opposite line and sector
+	// queries.
+	// Edits only queue up the affected lines, and the trees catch up on
+	// the next query.
+	//
+	mutable fastopp_node_c *m_fastopp_X_tree = nullptr;
+	mutable fastopp_node_c *m_fastopp_Y_tree = nullptr;
+	mutable std::vector<fastopp_node_c *> m_fastopp_X_node;	// per linedef
+	mutable std::vector<fastopp_node_c *> m_fastopp_Y_node;
+	mutable std::vector<int> m_fastopp_dirty_lines;
+	mutable std::vector<int> m_fastopp_moved_verts;
+
+	// new objects get filled in directly during the edit operation, so
+	// what it touches is queued up once more at its end. Queries during
+	// the operation only catch up with what changed since the last one.
+	std::vector<int> m_fastopp_op_lines;
+	std::vector<int> m_fastopp_op_verts;
+	bool m_fastopp_renumbered = false;
+
+	//
+	// Sector of each thing, along with the closest lines of both casts
+	// which decided it. Only the things which are near the edited lines,
+	// or use them, get looked up again.
+	//
+	struct thing_sector_t
+	{
+		int sector;
+		int horiz_line;
+		int vert_line;
+	};
+
+	mutable std::vector<thing_sector_t> m_thing_sectors;
+	mutable bool m_thing_sectors_valid = false;
+	mutable std::vector<int> m_thingsec_dirty_things;
+	mutable std::vector<int> m_thingsec_dirty_lines;
+	mutable std::vector<int> m_thingsec_moved_verts;
+	mutable std::vector<int> m_thingsec_dirty_sides;
+	std::vector<int> m_thingsec_op_things;
+	std::vector<int> m_thingsec_op_sides;
+	bool m_thingsec_renumbered = false;
+
+	mutable int m_indexed_lines = 0;
+	mutable int m_thing_lookups = 0;
 };
 
 // result: -1 for back, +1 for front, 0 for _exactly_on_ the line
@@ -54,6 +54,7 @@ public:
 	int splitLinedefAtVertex(EditOperation &op, int ld, int v_idx) const;
 
 	void addSecondSidedef(EditOperation &op, int ld, int new_sd, int other_sd) const;
+	void mergedSecondSidedef(EditOperation &op, int ld) const;
 	void removeSidedef(EditOperation &op, int ld, Side ld_side) const;
 	void fixForLostSide(EditOperation &op, int ld) const;
 
@@ -91,8 +92,6 @@ private:
 							  const std::vector<byte>& seen, bool do_right) const;
 
 	bool doSplitLineDef(EditOperation &op, int ld) const;
-
-	void mergedSecondSidedef(EditOperation &op, int ld) const;
 };
 
 SString LD_RatioName(FFixedPoint idx, FFixedPoint idy, bool number_only);
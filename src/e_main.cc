@@ -432,34 +432,37 @@ void Instance::MapStuff_NotifyDelete(ObjType type, int objnum)
 	}
 }
 
-void Instance::MapStuff_NotifyChange(ObjType type, int objnum, int field)
+void Instance::MapStuff_NotifyChanges(const ChangeBatch &changes)
 {
-	if (type == ObjType::vertices)
-	{
-		// NOTE: for performance reasons we don't recalculate the
-		//       map bounds when only moving a few vertices.
-		moved_vertex_count++;
+	const std::vector<int> &moved = changes.getObjects(ObjType::vertices);
+
+	// NOTE: for performance reasons we don't recalculate the
+	//       map bounds when only moving a few vertices.
+	moved_vertex_count += (int)moved.size();
 
-		const auto &V = level.vertices[objnum];
+	for (int v : moved)
+	{
+		const auto &V = level.vertices[v];
 
 		if (V->x() < Map_bound1.x) Map_bound1.x = V->x();
 		if (V->y() < Map_bound1.y) Map_bound1.y = V->y();
 
 		if (V->x() > Map_bound2.x) Map_bound2.x = V->x();
 		if (V->y() > Map_bound2.y) Map_bound2.y = V->y();
-
-		// TODO: only invalidate sectors touching vertex
-		Subdiv_InvalidateAll();
 	}
 
-	if (type == ObjType::sidedefs && field == SideDef::F_SECTOR)
-		Subdiv_InvalidateAll();
-
-	if (type == ObjType::linedefs && (field == LineDef::F_LEFT || field == LineDef::F_RIGHT || field == LineDef::F_START || field == LineDef::F_END))
-		Subdiv_InvalidateAll();
-
-	if (type == ObjType::sectors && (field == Sector::F_FLOORH || field == Sector::F_CEILH))
+	// TODO: only invalidate sectors touching the changes
+	if (! moved.empty() ||
+		changes.hasField(ObjType::sidedefs, SideDef::F_SECTOR) ||
+		changes.hasField(ObjType::linedefs, LineDef::F_LEFT) ||
+		changes.hasField(ObjType::linedefs, LineDef::F_RIGHT) ||
+		changes.hasField(ObjType::linedefs, LineDef::F_START) ||
+		changes.hasField(ObjType::linedefs, LineDef::F_END) ||
+		changes.hasField(ObjType::sectors, Sector::F_FLOORH) ||
+		changes.hasField(ObjType::sectors, Sector::F_CEILH))
+	{
 		Subdiv_InvalidateAll();
+	}
 }
 
 void Instance::MapStuff_NotifyEnd()
@@ -493,7 +496,7 @@ void Instance::ObjectBox_NotifyInsert(ObjType type, int objnum)
 {
 	invalidated_totals = true;
 
-	if (type != edit.mode)
+	if (type != edit.mode || !main_win)
 		return;
 
 	if (objnum > main_win->GetPanelObjNum())
@@ -507,7 +510,7 @@ void Instance::ObjectBox_NotifyDelete(ObjType type, int objnum)
 {
 	invalidated_totals = true;
 
-	if (type != edit.mode)
+	if (type != edit.mode || !main_win)
 		return;
 
 	if (objnum > main_win->GetPanelObjNum())
@@ -517,20 +520,21 @@ void Instance::ObjectBox_NotifyDelete(ObjType type, int objnum)
 }
 
 
-void Instance::ObjectBox_NotifyChange(ObjType type, int objnum, int field)
+void Instance::ObjectBox_NotifyChanges(const ChangeBatch &changes)
 {
-	if (type != edit.mode || !main_win)
-		return;
-
-	if (objnum != main_win->GetPanelObjNum())
+	if (!main_win)
 		return;
 
-	changed_panel_obj = true;
+	if (changes.hasObject(edit.mode, main_win->GetPanelObjNum()))
+		changed_panel_obj = true;
 }
 
 
 void Instance::ObjectBox_NotifyEnd() const
 {
+	if (!main_win)
+		return;
+
 	if (invalidated_totals)
 		main_win->UpdateTotals();
 
@@ -591,12 +595,6 @@ void Instance::Selection_NotifyDelete(ObjType type, int objnum)
 }
 
 
-void Selection_NotifyChange(ObjType type, int objnum, int field)
-{
-	// field changes never affect the current selection
-}
-
-
 void Instance::Selection_NotifyEnd()
 {
 	if (invalidated_selection)
@@ -610,6 +608,52 @@ void Instance::Selection_NotifyEnd()
 }
 
 
+//------------------------------------------------------------------------
+//  Level change notifications
+//------------------------------------------------------------------------
+
+
+void Instance::notifyBegin()
+{
+	Clipboard_NotifyBegin();
+	Selection_NotifyBegin();
+	MapStuff_NotifyBegin();
+	ObjectBox_NotifyBegin();
+}
+
+void Instance::notifyInsert(ObjType type, int objnum, int count)
+{
+	// the others only care about the first object
+	Clipboard_NotifyInsert(level, type, objnum, count);
+	Selection_NotifyInsert(type, objnum);
+	MapStuff_NotifyInsert(type, objnum);
+	ObjectBox_NotifyInsert(type, objnum);
+}
+
+void Instance::notifyDelete(ObjType type, int objnum)
+{
+	Clipboard_NotifyDelete(type, objnum);
+	Selection_NotifyDelete(type, objnum);
+	MapStuff_NotifyDelete(type, objnum);
+	ObjectBox_NotifyDelete(type, objnum);
+}
+
+void Instance::notifyChanges(const ChangeBatch &changes)
+{
+	// field changes never affect the clipboard or the selection
+	MapStuff_NotifyChanges(changes);
+	ObjectBox_NotifyChanges(changes);
+}
+
+void Instance::notifyEnd()
+{
+	Clipboard_NotifyEnd();
+	Selection_NotifyEnd();
+	MapStuff_NotifyEnd();
+	ObjectBox_NotifyEnd();
+}
+
+
 //
 //  list the contents of a selection (for debugging)
 //
@@ -639,11 +683,9 @@ void ConvertSelection(const Document &doc, const selection_c & src, selection_c
 	{
 		for (int t = 0 ; t < doc.numThings() ; t++)
 		{
-			const auto &T = doc.things[t];
-
-			Objid obj = hover::getNearestSector(doc, T->xy());
+			int sec = doc.hover.getThingSector(t);
 
-			if (! obj.is_nil() && src.get(obj.num))
+			if (sec >= 0 && src.get(sec))
 			{
 				dest.set(t);
 			}
@@ -1271,6 +1313,7 @@ void Instance::Editor_DefaultState()
 
 	edit.error_mode = false;
 	edit.show_object_numbers = false;
+	edit.perf_display = PERF_Off;
 
 	edit.sector_render_mode = config::sector_render_default;
 	edit. thing_render_mode =  config::thing_render_default;
@@ -49,6 +49,15 @@ typedef enum
 
 } sector_rendering_mode_e;
 
+// where the performance figures are shown (the "perf" toggle)
+typedef enum
+{
+	PERF_Off = 0,
+	PERF_Overlay,
+	PERF_StatusBar
+
+} perf_display_mode_e;
+
 //
 // When using editor
 //
@@ -117,6 +126,8 @@ struct Editor_State_t
 
 	bool show_object_numbers;
 
+	int  perf_display;   // one of the PERF_XXX values
+
 
 	/* navigation stuff */
 
@@ -192,7 +203,6 @@ struct Editor_State_t
 	struct { float x1, y1, x2, y2; } adjust_bbox;
 };
 
-void Selection_NotifyChange(ObjType type, int objnum, int field);
 
 
 void DumpSelection (selection_c * list);
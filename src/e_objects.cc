@@ -2290,17 +2290,17 @@ bool getSpecialTagInfo(ObjType objtype, int objnum, int special, const void *obj
     }
 
     // Now try individual specials, including parameterized
-    auto it = config.line_types.find(special);
-    if(it == config.line_types.end())
+    const linetype_t *linetype = config.findLineType(special);
+    if(!linetype)
         return false;
     info = {};
     info.type = objtype;
     info.objnum = objnum;
-    for(int i = 0; i < (int)lengthof(it->second.args); ++i)
+    for(int i = 0; i < (int)lengthof(linetype->args); ++i)
     {
         int arg = getArg(i + 1);
 
-        switch(it->second.args[i].type)
+        switch(linetype->args[i].type)
         {
             case SpecialArgType::tag:
                 info.tags[info.numtags++] = arg;
@@ -43,6 +43,10 @@
 #include "ui_misc.h"
 
 #include <assert.h>
+#include <deque>
+
+// most memory kept for the sound propagation of recent start sectors
+#define SOUND_CACHE_BYTES  (4 << 20)
 
 typedef enum
 {
@@ -512,62 +516,104 @@ void Instance::CMD_PruneUnused()
 
 //------------------------------------------------------------------------
 
-static void CalcPropagation(const Instance &inst, std::vector<byte>& vec, bool ignore_doors)
+//
+// Builds the graph of the sectors, connected by the two-sided lines
+//
+static void BuildSoundGraph(Instance &inst)
 {
-	bool changes;
+	const Document &doc = inst.level;
+
+	inst.sound_edge_start.assign(doc.numSectors() + 1, 0);
+	inst.sound_edges.clear();
+
+	for (const auto &L : doc.linedefs)
+	{
+		if (! L->TwoSided())
+			continue;
+
+		int sec1 = doc.getSectorID(*L, Side::right);
+		int sec2 = doc.getSectorID(*L, Side::left);
+
+		SYS_ASSERT(sec1 >= 0);
+		SYS_ASSERT(sec2 >= 0);
+
+		inst.sound_edge_start[sec1 + 1]++;
+		inst.sound_edge_start[sec2 + 1]++;
+	}
 
-	for (int k = 0 ; k < inst.level.numSectors(); k++)
-		vec[k] = 0;
+	for (int s = 0 ; s < doc.numSectors() ; s++)
+		inst.sound_edge_start[s + 1] += inst.sound_edge_start[s];
 
-	vec[inst.sound_start_sec] = 2;
+	inst.sound_edges.resize(inst.sound_edge_start.back());
 
-	do
+	std::vector<int> fill(inst.sound_edge_start.begin(), inst.sound_edge_start.end() - 1);
+
+	for (const auto &L : doc.linedefs)
 	{
-		changes = false;
+		if (! L->TwoSided())
+			continue;
 
-		for (const auto &L : inst.level.linedefs)
-		{
-			if (! L->TwoSided())
-				continue;
+		int sec1 = doc.getSectorID(*L, Side::right);
+		int sec2 = doc.getSectorID(*L, Side::left);
 
-			int sec1 = inst.level.getSectorID(*L, Side::right);
-			int sec2 = inst.level.getSectorID(*L, Side::left);
+		// check for doors
+		bool closed = (std::min(doc.sectors[sec1]->ceilh, doc.sectors[sec2]->ceilh) <=
+					   std::max(doc.sectors[sec1]->floorh, doc.sectors[sec2]->floorh));
 
-			SYS_ASSERT(sec1 >= 0);
-			SYS_ASSERT(sec2 >= 0);
+		bool block = (L->flags & MLF_SoundBlock) != 0;
 
-			// check for doors
-			if (!ignore_doors &&
-				(std::min(inst.level.sectors[sec1]->ceilh, inst.level.sectors[sec2]->ceilh) <=
-				 std::max(inst.level.sectors[sec1]->floorh, inst.level.sectors[sec2]->floorh)))
-			{
-				continue;
-			}
+		inst.sound_edges[fill[sec1]++] = { sec2, block, closed };
+		inst.sound_edges[fill[sec2]++] = { sec1, block, closed };
+	}
+}
 
-			int val1 = vec[sec1];
-			int val2 = vec[sec2];
 
-			int new_val = std::max(val1, val2);
+//
+// Level of the sound reaching each sector: 2 minus the fewest sound
+// blocking lines on the way. This is a 0-1 BFS, where crossing a blocking
+// line costs one level and others are free.
+//
+static void CalcPropagation(const Instance &inst, int start_sec, std::vector<byte>& vec,
+							bool ignore_doors)
+{
+	std::fill(vec.begin(), vec.end(), 0);
+
+	vec[start_sec] = 2;
+
+	std::deque<int> queue;
+	queue.push_back(start_sec);
+
+	while (! queue.empty())
+	{
+		int sec = queue.front();
+		queue.pop_front();
+
+		int val = vec[sec];
+
+		for (int k = inst.sound_edge_start[sec] ; k < inst.sound_edge_start[sec + 1] ; k++)
+		{
+			const sound_edge_t &edge = inst.sound_edges[k];
+
+			if (!ignore_doors && edge.closed)
+				continue;
 
-			if (L->flags & MLF_SoundBlock)
-				new_val -= 1;
+			int new_val = edge.block ? val - 1 : val;
 
-			if (new_val > val1 || new_val > val2)
+			if (new_val > vec[edge.sector])
 			{
-				if (new_val > val1)
-                    vec[sec1] = static_cast<byte>(new_val);
-				if (new_val > val2)
-                    vec[sec2] = static_cast<byte>(new_val);
+				vec[edge.sector] = static_cast<byte>(new_val);
 
-				changes = true;
+				if (edge.block)
+					queue.push_back(edge.sector);
+				else
+					queue.push_front(edge.sector);
 			}
 		}
-
-	} while (changes);
+	}
 }
 
 
-static void CalcFinalPropagation(Instance &inst)
+static void CalcFinalPropagation(const Instance &inst, std::vector<byte> &prop)
 {
 	for (int s = 0 ; s < inst.level.numSectors(); s++)
 	{
@@ -578,7 +624,7 @@ static void CalcFinalPropagation(Instance &inst)
 		{
 			if (t1 == 0 || t2 == 0)
 			{
-				inst.sound_prop_vec[s] = PGL_Maybe;
+				prop[s] = PGL_Maybe;
 				continue;
 			}
 
@@ -587,9 +633,9 @@ static void CalcFinalPropagation(Instance &inst)
 
 		switch (t1)
 		{
-			case 0: inst.sound_prop_vec[s] = PGL_Never;   break;
-			case 1: inst.sound_prop_vec[s] = PGL_Level_1; break;
-			case 2: inst.sound_prop_vec[s] = PGL_Level_2; break;
+			case 0: prop[s] = PGL_Never;   break;
+			case 1: prop[s] = PGL_Level_1; break;
+			case 2: prop[s] = PGL_Level_2; break;
 		}
 	}
 }
@@ -597,30 +643,39 @@ static void CalcFinalPropagation(Instance &inst)
 
 const byte *Instance::SoundPropagation(int start_sec)
 {
-	if ((int)sound_prop_vec.size() != level.numSectors())
+	if ((int)sound_edge_start.size() != level.numSectors() + 1)
+		sound_propagation_invalid = true;
+
+	if (sound_propagation_invalid)
 	{
-		sound_prop_vec .resize(level.numSectors());
+		// the level changed, forget all the cached results
+		sound_propagation_invalid = false;
+		sound_prop_cache.clear();
+
 		sound_temp1_vec.resize(level.numSectors());
 		sound_temp2_vec.resize(level.numSectors());
 
-		sound_propagation_invalid = true;
+		BuildSoundGraph(*this);
 	}
 
-	if (sound_propagation_invalid ||
-		sound_start_sec != start_sec)
-	{
-		// cannot used cached data, recompute it
+	auto it = sound_prop_cache.find(start_sec);
+	if (it != sound_prop_cache.end())
+		return it->second.data();
 
-		sound_start_sec = start_sec;
-		sound_propagation_invalid = false;
+	// keep the cache to a few megabytes
+	if (sound_prop_cache.size() >= std::max<size_t>(1, SOUND_CACHE_BYTES /
+												  std::max<size_t>(1, sound_temp1_vec.size())))
+		sound_prop_cache.clear();
 
-		CalcPropagation(*this, sound_temp1_vec, false);
-		CalcPropagation(*this, sound_temp2_vec, true);
+	CalcPropagation(*this, start_sec, sound_temp1_vec, false);
+	CalcPropagation(*this, start_sec, sound_temp2_vec, true);
 
-		CalcFinalPropagation(*this);
-	}
+	std::vector<byte> &prop = sound_prop_cache[start_sec];
+	prop.resize(level.numSectors());
+
+	CalcFinalPropagation(*this, prop);
 
-	return &sound_prop_vec[0];
+	return prop.data();
 }
 
 //--- editor settings ---
@@ -36,6 +36,17 @@ enum propagate_level_e
 
 };
 
+//
+// Edge of the sector graph used for sound propagation: a two-sided
+// linedef, seen from one of its sectors
+//
+struct sound_edge_t
+{
+	int sector;		// on the other side
+	bool block;		// sound blocking line
+	bool closed;	// the line has no opening (e.g. a closed door)
+};
+
 #endif  /* __EUREKA_E_PATH_H__ */
 
 //--- editor settings ---
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------
+//  TAG INDEX
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "e_tags.h"
+
+#include "Document.h"
+#include "Errors.h"
+
+#include <algorithm>
+
+//
+// The index of the given type, NULL for types without tags
+//
+TagIndex::index_t *TagIndex::indexFor(ObjType type) const
+{
+	switch(type)
+	{
+	case ObjType::sectors:
+		return &m_sectors;
+	case ObjType::linedefs:
+		return &m_linedefs;
+	default:
+		return nullptr;
+	}
+}
+
+void TagIndex::rebuild(ObjType type, index_t &index) const
+{
+	index.objects.clear();
+	index.tags.clear();
+
+	if(type == ObjType::sectors)
+	{
+		for(const auto &sector : doc.sectors)
+			index.tags.push_back(sector->tag);
+	}
+	else
+	{
+		for(const auto &linedef : doc.linedefs)
+			index.tags.push_back(linedef->tag);
+	}
+
+	for(int n = 0; n < (int)index.tags.size(); ++n)
+		index.objects[index.tags[n]].push_back(n);
+
+	index.valid = true;
+}
+
+const std::map<int, std::vector<int>> &TagIndex::tagMap(ObjType type) const
+{
+	index_t *index = indexFor(type);
+	if(!index)
+		BugError("TagIndex::tagMap: bad objtype %u\n", (unsigned)type);
+
+	// the level got changed behind our back
+	if(index->valid && (int)index->tags.size() != doc.numObjects(type))
+		index->valid = false;
+
+	if(!index->valid)
+		rebuild(type, *index);
+
+	return index->objects;
+}
+
+const std::vector<int> &TagIndex::objectsWithTag(ObjType type, int tag) const
+{
+	static const std::vector<int> none;
+
+	const std::map<int, std::vector<int>> &objects = tagMap(type);
+
+	auto it = objects.find(tag);
+	return it != objects.end() ? it->second : none;
+}
+
+//
+// Object about to be inserted or deleted, both renumber the ones after it
+//
+void TagIndex::notifyInsert(ObjType type, int objnum, int count)
+{
+	(void)objnum;
+	(void)count;
+
+	index_t *index = indexFor(type);
+	if(index)
+		index->valid = false;
+}
+
+void TagIndex::notifyDelete(ObjType type, int objnum)
+{
+	(void)objnum;
+
+	index_t *index = indexFor(type);
+	if(index)
+		index->valid = false;
+}
+
+//
+// Field changed, moves the object to its new tag
+//
+void TagIndex::notifyChange(ObjType type, int objnum, int field)
+{
+	index_t *index = indexFor(type);
+	if(!index || !index->valid)
+		return;
+
+	int tag;
+	if(type == ObjType::sectors)
+	{
+		if(field != Sector::F_TAG)
+			return;
+		tag = doc.sectors[objnum]->tag;
+	}
+	else
+	{
+		if(field != LineDef::F_TAG)
+			return;
+		tag = doc.linedefs[objnum]->tag;
+	}
+
+	if(objnum >= (int)index->tags.size())
+	{
+		index->valid = false;
+		return;
+	}
+
+	int old_tag = index->tags[objnum];
+	if(old_tag == tag)
+		return;
+
+	std::vector<int> &old_list = index->objects[old_tag];
+	auto it = std::lower_bound(old_list.begin(), old_list.end(), objnum);
+	if(it != old_list.end() && *it == objnum)
+		old_list.erase(it);
+	if(old_list.empty())
+		index->objects.erase(old_tag);
+
+	std::vector<int> &new_list = index->objects[tag];
+	new_list.insert(std::lower_bound(new_list.begin(), new_list.end(), objnum), objnum);
+
+	index->tags[objnum] = tag;
+}
+
+//
+// Drop both indexes, they get rebuilt on the next query
+//
+void TagIndex::invalidateIndexes()
+{
+	m_sectors = index_t();
+	m_linedefs = index_t();
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------
+//  TAG INDEX
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#ifndef __EUREKA_E_TAGS_H__
+#define __EUREKA_E_TAGS_H__
+
+#include "DocumentModule.h"
+#include "objid.h"
+
+#include <map>
+#include <vector>
+
+//
+// Index of the sectors and linedefs by their tag.
+// Tag changes update it in place, while inserting or deleting sectors
+// or linedefs (which renumbers them) drops the index of that type, and
+// it gets rebuilt on the next query.
+//
+class TagIndex : public DocumentModule
+{
+public:
+	TagIndex(Document &doc) : DocumentModule(doc)
+	{
+	}
+
+	// the sectors or linedefs with the given tag, in ascending order
+	const std::vector<int> &objectsWithTag(ObjType type, int tag) const;
+
+	bool tagExists(ObjType type, int tag) const
+	{
+		return !objectsWithTag(type, tag).empty();
+	}
+
+	// all the tags in use by the sectors or linedefs, in ascending order
+	const std::map<int, std::vector<int>> &tagMap(ObjType type) const;
+
+	void notifyInsert(ObjType type, int objnum, int count);
+	void notifyDelete(ObjType type, int objnum);
+	void notifyChange(ObjType type, int objnum, int field);
+	void invalidateIndexes();
+
+private:
+	struct index_t
+	{
+		bool valid = false;
+		std::map<int, std::vector<int>> objects;	// per tag
+		std::vector<int> tags;						// per object
+	};
+
+	index_t *indexFor(ObjType type) const;
+	void rebuild(ObjType type, index_t &index) const;
+
+	mutable index_t m_sectors;
+	mutable index_t m_linedefs;
+};
+
+#endif  /* __EUREKA_E_TAGS_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
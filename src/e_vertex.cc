@@ -45,6 +45,7 @@
 #include "w_rawdef.h"
 
 #include <algorithm>
+#include <unordered_map>
 
 
 int VertexModule::findExact(FFixedPoint fx, FFixedPoint fy) const
@@ -292,6 +293,206 @@ void VertexModule::mergeList(EditOperation &op, selection_c &verts) const
 }
 
 
+static inline uint64_t WeldKey(int a, int b)
+{
+	return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+static inline uint64_t CellKey(int64_t x, int64_t y)
+{
+	return (uint64_t)x * 0x9E3779B97F4A7C15ULL ^ (uint64_t)y;
+}
+
+
+//
+// welds together the given vertices which are within 'epsilon' map units
+// of each other, or exactly on top of each other when it is zero.  The
+// vertices are clustered through a hash grid, keeping the first vertex
+// of each cluster, then all the linedefs are repointed in a single
+// pass.  Lines which collapse to nothing are deleted, and lines which
+// end up on top of each other are merged like in mergeList().
+//
+// Returns the number of vertices removed.
+//
+int VertexModule::weldVertices(EditOperation &op, const selection_c &verts, double epsilon) const
+{
+	// closer than the fixed point resolution means exactly on top
+	if (epsilon < 1.0 / kFracUnitD)
+		epsilon = 0;
+
+	std::vector<int> remap(doc.numVertices());
+
+	for (int i = 0 ; i < doc.numVertices() ; i++)
+		remap[i] = i;
+
+	// grid cell --> vertices which are kept.  With a zero epsilon the
+	// cells are the raw coordinates, otherwise they are 'epsilon' wide,
+	// so any neighbour is in one of the nine cells around a vertex.
+	std::unordered_map<uint64_t, std::vector<int>> grid;
+
+	selection_c gone(ObjType::vertices);
+
+	for (sel_iter_c it(verts) ; !it.done() ; it.next())
+	{
+		const auto &V = doc.vertices[*it];
+
+		int64_t cx, cy;
+		int range = 0;
+
+		if (epsilon > 0)
+		{
+			cx = (int64_t)floor(V->x() / epsilon);
+			cy = (int64_t)floor(V->y() / epsilon);
+			range = 1;
+		}
+		else
+		{
+			cx = V->raw_x.raw();
+			cy = V->raw_y.raw();
+		}
+
+		int keep = -1;
+
+		for (int dy = -range ; dy <= range && keep < 0 ; dy++)
+		for (int dx = -range ; dx <= range && keep < 0 ; dx++)
+		{
+			auto cell = grid.find(CellKey(cx + dx, cy + dy));
+			if (cell == grid.end())
+				continue;
+
+			for (int k : cell->second)
+			{
+				const auto &K = doc.vertices[k];
+
+				if (epsilon > 0 ? hypot(K->x() - V->x(), K->y() - V->y()) <= epsilon : *K == *V)
+				{
+					keep = k;
+					break;
+				}
+			}
+		}
+
+		if (keep < 0)
+		{
+			grid[CellKey(cx, cy)].push_back(*it);
+			continue;
+		}
+
+		remap[*it] = keep;
+		gone.set(*it);
+	}
+
+	if (gone.empty())
+		return 0;
+
+	selection_c del_lines(ObjType::linedefs);
+
+	std::vector<byte> moved(doc.numLinedefs(), 0);
+
+	// the two vertices (lowest first) --> linedef between them
+	std::unordered_map<uint64_t, int> line_at;
+
+	for (int n = 0 ; n < doc.numLinedefs() ; n++)
+	{
+		const auto &L = doc.linedefs[n];
+
+		int start = remap[L->start];
+		int end   = remap[L->end];
+
+		if (start != L->start)
+		{
+			op.changeLinedef(n, LineDef::F_START, start);
+			moved[n] = 1;
+		}
+
+		if (end != L->end)
+		{
+			op.changeLinedef(n, LineDef::F_END, end);
+			moved[n] = 1;
+		}
+
+		if (start == end)
+		{
+			if (moved[n])
+				del_lines.set(n);
+			continue;
+		}
+
+		uint64_t key = WeldKey(std::min(start, end), std::max(start, end));
+
+		auto found = line_at.find(key);
+
+		if (found == line_at.end())
+		{
+			line_at[key] = n;
+			continue;
+		}
+
+		int other = found->second;
+
+		// leave alone lines which were already overlapping
+		if (! (moved[n] || moved[other]))
+			continue;
+
+		mergeSandwichLines(op, n, other, start, del_lines);
+
+		// both lines can vanish
+		if (del_lines.get(other))
+			line_at.erase(found);
+	}
+
+	int count = gone.count_obj();
+
+	// nothing uses these vertices now
+	doc.objects.del(op, gone);
+
+	// as in mergeList(), keep the vertices which become unused
+	DeleteObjects_WithUnused(op, doc, del_lines, false /* keep_things */, true /* keep_verts */, false /* keep_lines */);
+
+	return count;
+}
+
+
+//
+// VT_Weld [<distance>] : weld the selected vertices (or all of them)
+//
+void Instance::CMD_VT_Weld()
+{
+	double epsilon = atof(EXEC_Param[0]);
+
+	if (epsilon < 0)
+	{
+		Beep("VT_Weld: bad distance '%s'", EXEC_Param[0].c_str());
+		return;
+	}
+
+	selection_c verts(ObjType::vertices);
+
+	if (edit.mode == ObjType::vertices && edit.Selected->notempty())
+		verts.merge(*edit.Selected);
+	else
+		verts.frob_range(0, level.numVertices() - 1, BitOp::add);
+
+	int count;
+
+	{
+		EditOperation op(level.basis);
+
+		count = level.vertmod.weldVertices(op, verts, epsilon);
+
+		op.setMessage("welded %d vertices", count);
+	}
+
+	if (count == 0)
+	{
+		Beep("No vertices to weld");
+		return;
+	}
+
+	Selection_Clear(true /* no_save */);
+}
+
+
 void Instance::commandVertexMerge()
 {
 	if (edit.Selected->count_obj() == 1 && edit.highlight.valid())
@@ -675,11 +876,10 @@ void VertexModule::verticesOfDetachableSectors(selection_c &verts) const
 		}
 	}
 
-	for (int k = 0 ; k < doc.numVertices() ; k++)
-	{
-		if (in_verts.get(k) && out_verts.get(k))
-			verts.set(k);
-	}
+	in_verts.intersect(out_verts);
+
+	for (int k = in_verts.find_next(0) ; k >= 0 ; k = in_verts.find_next(k + 1))
+		verts.set(k);
 }
 
 
@@ -44,6 +44,7 @@ public:
 	int howManyLinedefs(int v_num) const;
 	void mergeList(EditOperation &op, selection_c &list) const;
 	bool tryFixDangler(int v_num) const;
+	int weldVertices(EditOperation &op, const selection_c &verts, double epsilon) const;
 
 private:
 	void mergeSandwichLines(EditOperation &op, int ld1, int ld2, int v, selection_c &del_lines) const;
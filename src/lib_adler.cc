@@ -32,42 +32,43 @@
 
 // ---- Primitive routines ----
 
+#define ADLER_BASE   65521
+#define EXTRA_PRIME  0xFFFEFFF9
+
 crc32_c& crc32_c::operator+= (u8_t data)
 {
-	u32_t s1 = raw & 0xFFFF;
-	u32_t s2 = (raw >> 16) & 0xFFFF;
-
-	s1 = (s1 + data) % 65521;
-	s2 = (s2 + s1)   % 65521;
-
-	raw = (s2 << 16) | s1;
-
-  extra += s2;
-
-  // modulo the extra value by a large prime number
-  if (extra >= 0xFFFEFFF9)
-      extra -= 0xFFFEFFF9;
-
-	return *this;
+	return AddBlock(&data, 1);
 }
 
+//
+// Same result as doing "% 65521" on both sums for every byte, which the
+// 'extra' sum depends on, but with a compare instead of each division:
+// both sums stay below twice the modulus. The 'extra' sum is kept in 64
+// bits and only reduced at the end.
+//
 crc32_c& crc32_c::AddBlock(const u8_t *data, int len)
 {
 	u32_t s1 = raw & 0xFFFF;
 	u32_t s2 = (raw >> 16) & 0xFFFF;
 
+	uint64_t ext = extra;
+
 	for (; len > 0; data++, len--)
 	{
-		s1 = (s1 + *data) % 65521;
-		s2 = (s2 + s1)    % 65521;
+		s1 += *data;
+		s1 -= (s1 >= ADLER_BASE) ? ADLER_BASE : 0;
 
-    extra += s2;
-    if (extra >= 0xFFFEFFF9)
-        extra -= 0xFFFEFFF9;
+		s2 += s1;
+		s2 -= (s2 >= ADLER_BASE) ? ADLER_BASE : 0;
+
+		ext += s2;
 	}
 
 	raw = (s2 << 16) | s1;
 
+	// modulo the extra value by a large prime number
+	extra = (u32_t)(ext % EXTRA_PRIME);
+
 	return *this;
 }
 
@@ -75,20 +76,16 @@ crc32_c& crc32_c::AddBlock(const u8_t *data, int len)
 
 crc32_c& crc32_c::operator+= (u16_t value)
 {
-	*this += (u8_t) (value >> 8);
-	*this += (u8_t) (value);
+	u8_t bytes[2] = { (u8_t) (value >> 8), (u8_t) value };
 
-	return *this;
+	return AddBlock(bytes, 2);
 }
 
 crc32_c& crc32_c::operator+= (u32_t value)
 {
-	*this += (u8_t) (value >> 24);
-	*this += (u8_t) (value >> 16);
-	*this += (u8_t) (value >> 8);
-	*this += (u8_t) (value);
+	u8_t bytes[4] = { (u8_t) (value >> 24), (u8_t) (value >> 16), (u8_t) (value >> 8), (u8_t) value };
 
-	return *this;
+	return AddBlock(bytes, 4);
 }
 
 crc32_c& crc32_c::operator+= (float value)
@@ -29,37 +29,100 @@
 
 #include "m_bitvec.h"
 
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+//
+// Word helpers, using the compiler intrinsics where there are some
+//
+static inline int CountBits(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(word);
+#else
+	int count = 0;
+	for ( ; word ; word &= word - 1)
+		count++;
+	return count;
+#endif
+}
+
+// index of the lowest one bit, the word must not be zero
+static inline int LowestBit(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (int)index;
+#else
+	int index = 0;
+	while (!(word & 1))
+	{
+		word >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+// index of the highest one bit, the word must not be zero
+static inline int HighestBit(uint64_t word)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return (int)index;
+#else
+	int index = 63;
+	while (!(word & (UINT64_C(1) << 63)))
+	{
+		word <<= 1;
+		index--;
+	}
+	return index;
+#endif
+}
+
+// the bits from <lo> to <hi> of a word, inclusive
+static inline uint64_t WordMask(int lo, int hi)
+{
+	uint64_t upper = (hi >= 63) ? ~UINT64_C(0) : (UINT64_C(1) << (hi + 1)) - 1;
+
+	return upper & (~UINT64_C(0) << lo);
+}
+
 
 bitvec_c::bitvec_c(int n_elements) : num_elem(n_elements)
 {
-	int total = (num_elem / 8) + 1;
-	data.resize(total);
-	clear_all();
+	data.resize((num_elem / 64) + 1);
 }
 
 void bitvec_c::resize(int n_elements)
 {
 	SYS_ASSERT(n_elements > 0);
 
-	int old_elem  = num_elem;
-	int new_total = (n_elements / 8) + 1;
+	num_elem = n_elements;
 
-	// don't bother re-allocating unless shrinking by a large amount
-	if (num_elem / 2 < n_elements && n_elements < num_elem)
-	{
-		num_elem = n_elements;
-		return;
-	}
+	// new words come in cleared
+	data.resize((num_elem / 64) + 1);
 
-	num_elem = n_elements;
-	data.resize(new_total);
+	clearTail();
+}
 
-	// make sure the bits near the old top are clear
-	for (int i = 0 ; i < 8 ; i++)
-	{
-		if (old_elem + i < num_elem)
-			raw_clear(old_elem + i);
-	}
+
+void bitvec_c::clearTail()
+{
+	data.back() &= ~WordMask(num_elem & 63, 63);
 }
 
 
@@ -78,9 +141,9 @@ void bitvec_c::set(int n)
 {
 	SYS_ASSERT(n >= 0);
 
-	while (n >= num_elem)
+	if (n >= num_elem)
 	{
-		resize(num_elem * 3 / 2 + 16);
+		resize(std::max(n + 1, num_elem * 3 / 2 + 16));
 	}
 
 	raw_set(n);
@@ -118,25 +181,136 @@ void bitvec_c::frob(int n, BitOp op)
 }
 
 
-void bitvec_c::set_all()
+void bitvec_c::frob_range(int n1, int n2, BitOp op)
 {
-	// Note: this will set some extra bits (over num_elem).
-	//       the get() functions (etc) make sure to never use them.
+	SYS_ASSERT(n1 >= 0);
+
+	if (op == BitOp::remove)
+		n2 = std::min(n2, num_elem - 1);
+	else if (n2 >= num_elem)
+		resize(std::max(n2 + 1, num_elem * 3 / 2 + 16));
+
+	if (n1 > n2)
+		return;
+
+	int w1 = n1 >> 6;
+	int w2 = n2 >> 6;
+
+	for (int w = w1 ; w <= w2 ; w++)
+	{
+		uint64_t mask = WordMask(w == w1 ? (n1 & 63) : 0, w == w2 ? (n2 & 63) : 63);
+
+		switch (op)
+		{
+			case BitOp::add:    data[w] |=  mask; break;
+			case BitOp::remove: data[w] &= ~mask; break;
+			default:            data[w] ^=  mask; break;
+		}
+	}
+}
+
 
-	memset(data.data(), 0xff, data.size());
+void bitvec_c::set_all()
+{
+	std::fill(data.begin(), data.end(), ~UINT64_C(0));
+	clearTail();
 }
 
 
 void bitvec_c::clear_all()
 {
-	memset(data.data(), 0, data.size());
+	std::fill(data.begin(), data.end(), 0);
 }
 
 
 void bitvec_c::toggle_all()
 {
-	for(byte &b : data)
-		b ^= 0xff;
+	for(uint64_t &word : data)
+		word = ~word;
+	clearTail();
+}
+
+
+int bitvec_c::count() const
+{
+	int total = 0;
+
+	for (uint64_t word : data)
+		total += CountBits(word);
+
+	return total;
+}
+
+
+int bitvec_c::find_next(int n) const
+{
+	SYS_ASSERT(n >= 0);
+
+	if (n >= num_elem)
+		return -1;
+
+	int w = n >> 6;
+	uint64_t word = data[w] & (~UINT64_C(0) << (n & 63));
+
+	for (;;)
+	{
+		if (word)
+			return (w << 6) + LowestBit(word);
+
+		if (++w >= (int)data.size())
+			return -1;
+
+		word = data[w];
+	}
+}
+
+
+int bitvec_c::find_last() const
+{
+	for (int w = (int)data.size() - 1 ; w >= 0 ; w--)
+		if (data[w])
+			return (w << 6) + HighestBit(data[w]);
+
+	return -1;
+}
+
+
+void bitvec_c::merge(const bitvec_c &other)
+{
+	if (other.num_elem > num_elem)
+		resize(other.num_elem);
+
+	// plain loops over the words, which the compiler can vectorise
+	const uint64_t *src = other.data.data();
+	uint64_t *dest = data.data();
+	size_t words = other.data.size();
+
+	for (size_t i = 0 ; i < words ; i++)
+		dest[i] |= src[i];
+}
+
+
+void bitvec_c::unmerge(const bitvec_c &other)
+{
+	const uint64_t *src = other.data.data();
+	uint64_t *dest = data.data();
+	size_t words = std::min(data.size(), other.data.size());
+
+	for (size_t i = 0 ; i < words ; i++)
+		dest[i] &= ~src[i];
+}
+
+
+void bitvec_c::intersect(const bitvec_c &other)
+{
+	const uint64_t *src = other.data.data();
+	uint64_t *dest = data.data();
+	size_t words = std::min(data.size(), other.data.size());
+
+	for (size_t i = 0 ; i < words ; i++)
+		dest[i] &= src[i];
+
+	std::fill(data.begin() + words, data.end(), 0);
 }
 
 
@@ -28,6 +28,7 @@
 #define __EUREKA_M_BITVEC_H__
 
 #include "sys_type.h"
+#include <stdint.h>
 #include <vector>
 
 enum class BitOp
@@ -45,9 +46,13 @@ class bitvec_c
 	// was infinitely sized and all bits past the end are zero.  When
 	// setting a bit past the end, it will automatically resize itself.
 	//
+	// The bits are kept in 64-bit words, and the bits of the last word
+	// past the end are always zero, so whole words can be counted and
+	// combined at once.
+	//
 
 private:
-	std::vector<byte> data;
+	std::vector<uint64_t> data;
 	int num_elem;
 
 public:
@@ -71,38 +76,49 @@ public:
 	void toggle(int n);		// Toggle bit <n>
 
 	void frob(int n, BitOp op);
+	void frob_range(int n1, int n2, BitOp op);	// inclusive
 
 	void set_all();
 	void clear_all();
 	void toggle_all();
 
+	// number of one bits
+	int count() const;
+
+	// these return -1 when there is no such bit
+	int find_next(int n) const;	// first one bit at <n> or after
+	int find_last() const;		// highest one bit
+
+	// set algebra with another vector, word by word
+	void merge(const bitvec_c &other);		// this |= other
+	void unmerge(const bitvec_c &other);	// this &= ~other
+	void intersect(const bitvec_c &other);	// this &= other
+
 private:
 	/* NOTE : these functions do no range checking! */
 
 	inline bool raw_get(int n) const
 	{
-		return !!(data[n >> 3] & (1 << (n & 7)));
+		return !!(data[n >> 6] & (UINT64_C(1) << (n & 63)));
 	}
 
 	inline void raw_set(int n)
 	{
-		data[n >> 3] |= (1 << (n & 7));
+		data[n >> 6] |= (UINT64_C(1) << (n & 63));
 	}
 
 	inline void raw_clear(int n)
 	{
-		data[n >> 3] &= ~(1 << (n & 7));
+		data[n >> 6] &= ~(UINT64_C(1) << (n & 63));
 	}
 
 	inline void raw_toggle(int n)
 	{
-		data[n >> 3] ^= (1 << (n & 7));
+		data[n >> 6] ^= (UINT64_C(1) << (n & 63));
 	}
 
-	inline int getByteCount() const
-	{
-		return num_elem / 8 + 1;
-	}
+	// clears the bits of the last word which are past the end
+	void clearTail();
 
 	// this preserves existing elements
 	void resize(int n_elements);
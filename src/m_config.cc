@@ -28,8 +28,10 @@
 
 #include "lib_adler.h"
 #include "m_config.h"
+#include "m_lint.h"
 #include "m_parse.h"
 #include "m_streams.h"
+#include "sys_trace.h"
 
 #include "filesystem.hpp"
 namespace fs = ghc::filesystem;
@@ -114,6 +116,33 @@ const opt_desc_t options[] =
 		&global::Quiet
 	},
 
+	{	"trace",
+		0,
+        OptType::path,
+		OptFlag_pass1,
+		"Record a trace of the hot paths, written on exit (Chrome format)",
+		"<file>",
+		&global::trace_file
+	},
+
+	{	"lint",
+		0,
+        OptType::path,
+		OptFlag_pass1,
+		"Check all levels of the wad, write a JSON report (- for stdout)",
+		"<file>",
+		&global::lint_report
+	},
+
+	{	"lint_jobs",
+		0,
+        OptType::integer,
+		OptFlag_pass1 | OptFlag_helpNewline,
+		"Number of threads for --lint (default: all cores)",
+		"<num>",
+		&global::lint_jobs
+	},
+
 	//
 	// Normal options from here on....
 	//
@@ -246,6 +275,24 @@ const opt_desc_t options[] =
 		&config::bsp_fast
 	},
 
+	{	"bsp_incremental",
+		0,
+        OptType::boolean,
+		OptFlag_preference,
+		"Node building: reuse the partitions of unchanged areas from the last build (may differ from a full build)",
+		NULL,
+		&config::bsp_incremental
+	},
+
+	{	"bsp_verify_incremental",
+		0,
+        OptType::boolean,
+		OptFlag_preference,
+		"Node building: compare the incremental build against a full build",
+		NULL,
+		&config::bsp_verify_incremental
+	},
+
 	{	"bsp_warnings",
 		0,
         OptType::boolean,
@@ -732,6 +779,15 @@ const opt_desc_t options[] =
 		&config::transparent_col
 	},
 
+	{	"undo_max_space",
+		0,
+        OptType::integer,
+		OptFlag_preference,
+		"Maximum space to use (in MB) for the undo history",
+		NULL,
+		&config::undo_max_space
+	},
+
 	{	"swap_sidedefs",
 		0,
         OptType::boolean,
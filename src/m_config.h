@@ -155,6 +155,8 @@ extern rgb_color_t normal_small_col;
 extern int backup_max_files;
 extern int backup_max_space;
 
+extern int undo_max_space;
+
 extern bool browser_small_tex;
 extern bool browser_combine_tex;
 
@@ -177,6 +179,8 @@ extern rgb_color_t transparent_col;
 
 extern bool bsp_on_save;
 extern bool bsp_fast;
+extern bool bsp_incremental;
+extern bool bsp_verify_incremental;
 extern bool bsp_warnings;
 extern int  bsp_split_factor;
 
@@ -479,7 +479,7 @@ void Instance::EV_MouseMotion(v2int_t pos, keycode_t mod, v2int_t dpos)
 	{
 		edit.selbox2 = edit.map.xy;
 
-		main_win->canvas->redraw();
+		main_win->canvas->RedrawOverlay();
 		return;
 	}
 
@@ -494,7 +494,7 @@ void Instance::EV_MouseMotion(v2int_t pos, keycode_t mod, v2int_t dpos)
 		if (edit.mode == ObjType::vertices && edit.dragged.valid())
 			UpdateHighlight();
 
-		main_win->canvas->redraw();
+		main_win->canvas->RedrawOverlay();
 		return;
 	}
 
@@ -154,6 +154,10 @@ void ConfigData::clearExceptDefaults()
 	thing_groups.clear();
 	thing_types.clear();
 
+	line_table.clear();
+	sector_table.clear();
+	thing_table.clear();
+
 	texture_groups.clear();
 	texture_categories.clear();
 	flat_categories.clear();
@@ -168,6 +172,17 @@ void ConfigData::clearExceptDefaults()
 	num_gen_linetypes = 0;
 }
 
+//
+// Makes the type number lookup tables, once all the definition files
+// have been parsed.
+//
+void ConfigData::compileDefinitions()
+{
+	line_table.compile(line_types);
+	sector_table.compile(sector_types);
+	thing_table.compile(thing_types);
+}
+
 //
 // Called only from Main_LoadResources
 //
@@ -1367,12 +1382,9 @@ bool is_special_tex(const SString &tex)
 
 const sectortype_t &Instance::M_GetSectorType(int type) const
 {
-	std::map<int, sectortype_t>::const_iterator SI;
-
-	SI = conf.sector_types.find(type);
-
-	if (SI != conf.sector_types.end())
-		return SI->second;
+	const sectortype_t *existing = conf.findSectorType(type);
+	if (existing)
+		return *existing;
 
 	static sectortype_t dummy_type =
 	{
@@ -1385,12 +1397,9 @@ const sectortype_t &Instance::M_GetSectorType(int type) const
 
 const linetype_t &Instance::M_GetLineType(int type) const
 {
-	std::map<int, linetype_t>::const_iterator LI;
-
-	LI = conf.line_types.find(type);
-
-	if (LI != conf.line_types.end())
-		return LI->second;
+	const linetype_t *existing = conf.findLineType(type);
+	if (existing)
+		return *existing;
 
 	static linetype_t dummy_type =
 	{
@@ -1403,7 +1412,7 @@ const linetype_t &Instance::M_GetLineType(int type) const
 
 const thingtype_t &ConfigData::getThingType(int type) const
 {
-	const thingtype_t *existing = get(thing_types, type);
+	const thingtype_t *existing = findThingType(type);
 	if(existing)
 		return *existing;
 
@@ -29,9 +29,11 @@
 
 #include "im_color.h"
 #include "m_strings.h"
+#include <algorithm>
 #include <initializer_list>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "filesystem.hpp"
 namespace fs = ghc::filesystem;
@@ -339,6 +341,90 @@ public:
 	}
 };
 
+// type numbers below this are looked up in a plain array
+#define DEFINITION_DENSE_LIMIT  32768
+
+//
+// A copy of the definitions of a map from type number, made for fast
+// lookups: numbers below DEFINITION_DENSE_LIMIT index an array directly,
+// the larger ones are binary searched in a sorted array.
+//
+// The map stays the reference. When it has been changed since compile()
+// (its size differs), lookups go to the map instead.
+//
+template<typename T>
+class DefinitionTable
+{
+public:
+	void compile(const std::map<int, T> &defs)
+	{
+		clear();
+
+		mValues.reserve(defs.size());
+
+		for (const auto &pair : defs)
+		{
+			int index = (int)mValues.size();
+			mValues.push_back(pair.second);
+
+			if (pair.first >= 0 && pair.first < DEFINITION_DENSE_LIMIT)
+			{
+				if (pair.first >= (int)mDense.size())
+					mDense.resize(pair.first + 1, -1);
+
+				mDense[pair.first] = index;
+			}
+			else
+			{
+				// the map is sorted, so this is too
+				mSparse.emplace_back(pair.first, index);
+			}
+		}
+
+		mCount = defs.size();
+	}
+
+	void clear()
+	{
+		mValues.clear();
+		mDense.clear();
+		mSparse.clear();
+		mCount = 0;
+	}
+
+	// returns NULL when the type is not defined
+	const T *find(const std::map<int, T> &defs, int type) const
+	{
+		if (defs.size() != mCount)
+		{
+			auto it = defs.find(type);
+			return it != defs.end() ? &it->second : nullptr;
+		}
+
+		if (type >= 0 && type < DEFINITION_DENSE_LIMIT)
+		{
+			if (type >= (int)mDense.size() || mDense[type] < 0)
+				return nullptr;
+
+			return &mValues[mDense[type]];
+		}
+
+		auto it = std::lower_bound(mSparse.begin(), mSparse.end(), type,
+			[](const std::pair<int, int> &entry, int key) { return entry.first < key; });
+
+		if (it == mSparse.end() || it->first != type)
+			return nullptr;
+
+		return &mValues[it->second];
+	}
+
+private:
+	std::vector<T> mValues;
+	std::vector<int> mDense;					// index into mValues, -1 if none
+	std::vector<std::pair<int, int>> mSparse;	// (type, index), sorted
+	size_t mCount = 0;
+};
+
 //
 // Target for M_ParseDefinitionFile
 //
@@ -364,8 +450,29 @@ struct ConfigData
 	int num_gen_linetypes = 0;
 	generalized_linetype_t gen_linetypes[MAX_GEN_NUM_TYPES] = {};	// BOOM Generalized Lines
 
+	// fast lookup copies of the above, made by compileDefinitions()
+	DefinitionTable<linetype_t> line_table;
+	DefinitionTable<sectortype_t> sector_table;
+	DefinitionTable<thingtype_t> thing_table;
+
 	void clearExceptDefaults();
+	void compileDefinitions();
+
 	const thingtype_t &getThingType(int type) const;
+
+	// these return NULL for an unknown type
+	const linetype_t *findLineType(int type) const
+	{
+		return line_table.find(line_types, type);
+	}
+	const sectortype_t *findSectorType(int type) const
+	{
+		return sector_table.find(sector_types, type);
+	}
+	const thingtype_t *findThingType(int type) const
+	{
+		return thing_table.find(thing_types, type);
+	}
 };
 
 //
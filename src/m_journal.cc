@@ -0,0 +1,646 @@
+//------------------------------------------------------------------------
+//  EDIT JOURNAL (CRASH RECOVERY)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+//
+//  The journal file starts with a header: the "EURJRNL1" magic and the
+//  checksum of the level as it was loaded or last saved.  It's followed
+//  by records:
+//
+//    'G' or 'K'  : an undo group ('K' for one kept outside the history),
+//                  as a 32-bit payload length, the payload, and the
+//                  Adler-32 checksum of the payload.
+//    'U' or 'R'  : an undo or a redo.
+//
+//  A torn record at the end (from a crash during a write) fails its
+//  length or checksum test, and replay stops right before it.
+//
+//------------------------------------------------------------------------
+
+#include "m_journal.h"
+
+#include "Document.h"
+#include "e_basis.h"
+#include "Errors.h"
+#include "main.h"
+#include "m_strings.h"
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char JOURNAL_MAGIC[8] = { 'E', 'U', 'R', 'J', 'R', 'N', 'L', '1' };
+
+static const size_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + 8;
+
+// group payload opcodes
+enum
+{
+	JOP_CHANGE = 'C',
+	JOP_INSERT = 'I',
+	JOP_DELETE = 'D',
+	JOP_OBJECT = 'O'	// all fields of an object created in the group
+};
+
+//
+// Number of int fields of an object type
+//
+static int FieldCount(ObjType type)
+{
+	switch(type)
+	{
+	case ObjType::things:   return (int)(sizeof(Thing) / sizeof(int));
+	case ObjType::vertices: return (int)(sizeof(Vertex) / sizeof(int));
+	case ObjType::sectors:  return (int)(sizeof(Sector) / sizeof(int));
+	case ObjType::sidedefs: return (int)(sizeof(SideDef) / sizeof(int));
+	case ObjType::linedefs: return (int)(sizeof(LineDef) / sizeof(int));
+	default:
+		return 0;
+	}
+}
+
+//
+// Fields which are offsets in the (process-local) string table
+//
+static bool IsStringField(ObjType type, byte field)
+{
+	if(type == ObjType::sectors)
+		return field == Sector::F_FLOOR_TEX || field == Sector::F_CEIL_TEX;
+	if(type == ObjType::sidedefs)
+		return field == SideDef::F_UPPER_TEX || field == SideDef::F_MID_TEX ||
+				field == SideDef::F_LOWER_TEX;
+	return false;
+}
+
+//
+// The fields of an object, as the undo system sees them
+//
+static int *FieldsOf(const Document &doc, ObjType type, int objnum)
+{
+	switch(type)
+	{
+	case ObjType::things:   return reinterpret_cast<int *>(doc.things[objnum].get());
+	case ObjType::vertices: return reinterpret_cast<int *>(doc.vertices[objnum].get());
+	case ObjType::sectors:  return reinterpret_cast<int *>(doc.sectors[objnum].get());
+	case ObjType::sidedefs: return reinterpret_cast<int *>(doc.sidedefs[objnum].get());
+	case ObjType::linedefs: return reinterpret_cast<int *>(doc.linedefs[objnum].get());
+	default:
+		BugError("FieldsOf: bad objtype %u\n", (unsigned)type);
+		return nullptr; /* NOT REACHED */
+	}
+}
+
+static void PutU32(std::vector<byte> &data, u32_t value)
+{
+	for(int i = 0; i < 4; ++i)
+		data.push_back((byte)(value >> (8 * i)));
+}
+
+static u32_t GetU32(const byte *data)
+{
+	return (u32_t)data[0] | (u32_t)data[1] << 8 | (u32_t)data[2] << 16 | (u32_t)data[3] << 24;
+}
+
+static void PutString(std::vector<byte> &data, const SString &str)
+{
+	size_t length = std::min<size_t>(str.length(), 0xffff);
+	data.push_back((byte)length);
+	data.push_back((byte)(length >> 8));
+	data.insert(data.end(), str.c_str(), str.c_str() + length);
+}
+
+//
+// Bounds-checked reader of a group payload
+//
+class JournalReader
+{
+public:
+	JournalReader(const byte *data, size_t length) : mPos(data), mEnd(data + length)
+	{
+	}
+
+	bool atEnd() const
+	{
+		return mPos == mEnd;
+	}
+
+	bool getByte(byte &value)
+	{
+		if(mEnd - mPos < 1)
+			return false;
+		value = *mPos++;
+		return true;
+	}
+
+	bool getInt(int &value)
+	{
+		if(mEnd - mPos < 4)
+			return false;
+		value = (int)GetU32(mPos);
+		mPos += 4;
+		return true;
+	}
+
+	bool getString(SString &str)
+	{
+		if(mEnd - mPos < 2)
+			return false;
+		int length = mPos[0] | mPos[1] << 8;
+		mPos += 2;
+		if(mEnd - mPos < length)
+			return false;
+		str = SString(reinterpret_cast<const char *>(mPos), length);
+		mPos += length;
+		return true;
+	}
+
+	bool getField(ObjType type, byte field, int &value)
+	{
+		if(!IsStringField(type, field))
+			return getInt(value);
+
+		SString str;
+		if(!getString(str))
+			return false;
+		value = BA_InternaliseString(str).get();
+		return true;
+	}
+
+	bool getObjType(ObjType &type)
+	{
+		byte raw;
+		if(!getByte(raw) || raw > (byte)ObjType::sectors)
+			return false;
+		type = (ObjType)raw;
+		return true;
+	}
+
+private:
+	const byte *mPos;
+	const byte *mEnd;
+};
+
+//------------------------------------------------------------------------
+
+void JournalGroupEncoder::putInt(int value)
+{
+	PutU32(mData, (u32_t)value);
+}
+
+void JournalGroupEncoder::putField(ObjType type, byte field, int value)
+{
+	if(IsStringField(type, field))
+		PutString(mData, BA_GetString(StringID(value)));
+	else
+		putInt(value);
+}
+
+void JournalGroupEncoder::addChange(ObjType type, int objnum, byte field, int value)
+{
+	putByte(JOP_CHANGE);
+	putByte((byte)type);
+	putByte(field);
+	putInt(objnum);
+	putField(type, field, value);
+}
+
+void JournalGroupEncoder::addInsert(ObjType type, int objnum)
+{
+	putByte(JOP_INSERT);
+	putByte((byte)type);
+	putInt(objnum);
+	mInserts.emplace_back(type, objnum);
+}
+
+void JournalGroupEncoder::addDelete(ObjType type, int objnum)
+{
+	putByte(JOP_DELETE);
+	putByte((byte)type);
+	putInt(objnum);
+
+	// keep track of where the new objects end up
+	for(Objid &obj : mInserts)
+	{
+		if(obj.type != type || obj.num < objnum)
+			continue;
+		obj.num = obj.num == objnum ? NIL_OBJ : obj.num - 1;
+	}
+}
+
+//
+// Produce the group record and get ready for the next group. The new
+// objects are only complete now, so their fields get written here.
+//
+std::vector<byte> JournalGroupEncoder::finish(const Document &doc, bool keepHistory, const SString &message)
+{
+	for(const Objid &obj : mInserts)
+	{
+		if(obj.num == NIL_OBJ)
+			continue;
+
+		const int *fields = FieldsOf(doc, obj.type, obj.num);
+		int count = FieldCount(obj.type);
+
+		putByte(JOP_OBJECT);
+		putByte((byte)obj.type);
+		putInt(obj.num);
+		putByte((byte)count);
+		for(int i = 0; i < count; ++i)
+			putField(obj.type, (byte)i, fields[i]);
+	}
+
+	std::vector<byte> payload;
+	PutString(payload, message);
+	payload.insert(payload.end(), mData.begin(), mData.end());
+
+	crc32_c check;
+	check.AddBlock(payload.data(), (int)payload.size());
+
+	std::vector<byte> record;
+	record.reserve(payload.size() + 9);
+	record.push_back(keepHistory ? 'G' : 'K');
+	PutU32(record, (u32_t)payload.size());
+	record.insert(record.end(), payload.begin(), payload.end());
+	PutU32(record, check.raw);
+
+	clear();
+	return record;
+}
+
+//------------------------------------------------------------------------
+
+//
+// The journal lives beside the PWAD, one per level
+//
+fs::path EditJournal::pathFor(const fs::path &wadPath, const SString &level)
+{
+	fs::path path = wadPath;
+	path += "." + level.asUpper().get() + ".journal";
+	return path;
+}
+
+//
+// Checksum identifying the level state which the journal applies to
+//
+crc32_c EditJournal::baseline(const Document &doc)
+{
+	crc32_c crc;
+	doc.getLevelChecksum(crc);
+
+	// the level checksum skips unused objects, but the replay needs
+	// the object numbers to line up
+	crc += (u32_t)doc.numThings();
+	crc += (u32_t)doc.numVertices();
+	crc += (u32_t)doc.numSectors();
+	crc += (u32_t)doc.numSidedefs();
+	crc += (u32_t)doc.numLinedefs();
+	return crc;
+}
+
+static bool ReadJournalFile(const fs::path &path, std::vector<byte> &data)
+{
+	FILE *fp = fopen(path.u8string().c_str(), "rb");
+	if(!fp)
+		return false;
+
+	byte buffer[16384];
+	size_t count;
+	while((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+		data.insert(data.end(), buffer, buffer + count);
+
+	fclose(fp);
+	return true;
+}
+
+//
+// Whether there's a journal holding edits for the given level state
+//
+bool EditJournal::isRecoverable(const fs::path &path, const crc32_c &base)
+{
+	std::vector<byte> data;
+	if(!ReadJournalFile(path, data) || data.size() <= JOURNAL_HEADER_SIZE)
+		return false;
+
+	return !memcmp(data.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) &&
+			GetU32(&data[8]) == base.raw && GetU32(&data[12]) == base.extra;
+}
+
+//
+// Replay the operations of one group, rejecting anything which doesn't
+// fit the current level
+//
+bool EditJournal::replayGroupOps(Basis &basis, JournalReader &reader)
+{
+	const Document &doc = basis.doc;
+
+	while(!reader.atEnd())
+	{
+		byte opcode;
+		ObjType type;
+		int objnum;
+		if(!reader.getByte(opcode) || !reader.getObjType(type))
+			return false;
+
+		switch(opcode)
+		{
+		case JOP_CHANGE:
+		{
+			byte field;
+			int value;
+			if(!reader.getByte(field) || !reader.getInt(objnum) ||
+			   !reader.getField(type, field, value))
+			{
+				return false;
+			}
+			if(objnum < 0 || objnum >= doc.numObjects(type) || field >= FieldCount(type))
+				return false;
+			basis.change(type, objnum, field, value);
+			break;
+		}
+		case JOP_INSERT:
+			if(!reader.getInt(objnum) || objnum != doc.numObjects(type))
+				return false;
+			basis.addNew(type);
+			break;
+		case JOP_DELETE:
+			if(!reader.getInt(objnum) || objnum < 0 || objnum >= doc.numObjects(type))
+				return false;
+			basis.rawDel(type, objnum);
+			break;
+		case JOP_OBJECT:
+		{
+			byte count;
+			if(!reader.getInt(objnum) || !reader.getByte(count) ||
+			   objnum < 0 || objnum >= doc.numObjects(type) || count != FieldCount(type))
+			{
+				return false;
+			}
+			// it's OK to directly set fields of newly created objects
+			int *fields = FieldsOf(doc, type, objnum);
+			for(int i = 0; i < count; ++i)
+				if(!reader.getField(type, (byte)i, fields[i]))
+					return false;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+// Replay the journal on top of the freshly loaded level, through the
+// undo system (so the recovered edits can be undone). Returns the length
+// of the valid part of the file.
+//
+size_t EditJournal::replay(const fs::path &path, Basis &basis, int &numGroups)
+{
+	numGroups = 0;
+
+	std::vector<byte> data;
+	if(!ReadJournalFile(path, data) || data.size() < JOURNAL_HEADER_SIZE)
+		return 0;
+
+	size_t pos = JOURNAL_HEADER_SIZE;
+	while(pos < data.size())
+	{
+		byte tag = data[pos];
+
+		if(tag == 'U' || tag == 'R')
+		{
+			if(!(tag == 'U' ? basis.undo() : basis.redo()))
+				break;
+			++pos;
+			continue;
+		}
+
+		if((tag != 'G' && tag != 'K') || data.size() - pos < 5)
+			break;
+
+		size_t length = GetU32(&data[pos + 1]);
+		if(data.size() - pos - 5 < length + 4)
+			break;	// torn write
+
+		const byte *payload = &data[pos + 5];
+
+		crc32_c check;
+		check.AddBlock(payload, (int)length);
+		if(check.raw != GetU32(payload + length))
+			break;
+
+		JournalReader reader(payload, length);
+		SString message;
+		if(!reader.getString(message))
+			break;
+
+		bool ok;
+		{
+			EditOperation op(basis);
+			op.setMessage("%s", message.c_str());
+
+			ok = replayGroupOps(basis, reader);
+			if(!ok)
+				op.setAbort(false);
+			else if(tag == 'K')
+				op.setAbort(true);
+		}
+		if(!ok)
+		{
+			gLog.printf("Journal %s: invalid edit, stopping the replay\n", path.u8string().c_str());
+			break;
+		}
+
+		pos += 5 + length + 4;
+		++numGroups;
+	}
+	return pos;
+}
+
+//------------------------------------------------------------------------
+
+//
+// Start journalling. If 'keepLength' is set, the existing (replayed) file
+// is kept up to that length and appended to.
+//
+void EditJournal::start(const fs::path &path, const crc32_c &base, size_t keepLength)
+{
+	stop(false);
+
+	std::error_code ec;
+	if(keepLength)
+		fs::resize_file(path, keepLength, ec);
+	else
+		fs::remove(path, ec);
+	if(ec)
+		keepLength = 0;
+
+	mPath = path;
+	mBase = base;
+	mKeepLength = keepLength;
+	mReportedFailure = false;
+
+	mPending.clear();
+	mAppendedCount = mSyncedCount = 0;
+	mQuit = false;
+	mFailed = false;
+
+	mThread = std::thread(&EditJournal::threadMain, this);
+	mActive = true;
+}
+
+//
+// Stop journalling, after all the pending records are written
+//
+void EditJournal::stop(bool removeFile)
+{
+	if(!mActive)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_one();
+	mThread.join();
+	mActive = false;
+
+	if(removeFile)
+	{
+		std::error_code ec;
+		fs::remove(mPath, ec);
+	}
+}
+
+void EditJournal::append(std::vector<byte> &&record)
+{
+	SYS_ASSERT(mActive);
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mFailed)
+		{
+			if(!mReportedFailure)
+				gLog.printf("Cannot write journal file: %s\n", mPath.u8string().c_str());
+			mReportedFailure = true;
+			return;
+		}
+		mPending.insert(mPending.end(), record.begin(), record.end());
+		++mAppendedCount;
+	}
+	mWake.notify_one();
+}
+
+void EditJournal::appendUndo()
+{
+	append({ 'U' });
+}
+
+void EditJournal::appendRedo()
+{
+	append({ 'R' });
+}
+
+//
+// Wait until everything appended so far is on the disk
+//
+void EditJournal::flush()
+{
+	if(!mActive)
+		return;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	uint64_t target = mAppendedCount;
+	mSynced.wait(lock, [this, target]()
+			{
+				return mSyncedCount >= target || mFailed;
+			});
+}
+
+bool EditJournal::openFile()
+{
+	if(mKeepLength)
+		return (mFile = fopen(mPath.u8string().c_str(), "ab")) != nullptr;
+
+	mFile = fopen(mPath.u8string().c_str(), "wb");
+	if(!mFile)
+		return false;
+
+	std::vector<byte> header(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+	PutU32(header, mBase.raw);
+	PutU32(header, mBase.extra);
+	return fwrite(header.data(), 1, header.size(), mFile) == header.size();
+}
+
+//
+// Writer thread: takes the pending records in batches, so a burst of
+// edits costs a single sync.
+//
+void EditJournal::threadMain()
+{
+	std::vector<byte> batch;
+
+	for(;;)
+	{
+		uint64_t count;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [this]()
+					{
+						return mQuit || !mPending.empty();
+					});
+			if(mPending.empty())
+				break;	// quitting, and nothing left to write
+			batch.swap(mPending);
+			count = mAppendedCount;
+		}
+
+		bool ok = mFile || openFile();
+		if(ok)
+		{
+			ok = fwrite(batch.data(), 1, batch.size(), mFile) == batch.size() &&
+					fflush(mFile) == 0;
+#ifdef WIN32
+			ok = ok && _commit(_fileno(mFile)) == 0;
+#else
+			ok = ok && fsync(fileno(mFile)) == 0;
+#endif
+		}
+		batch.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mSyncedCount = count;
+			if(!ok)
+			{
+				mFailed = true;
+				mPending.clear();
+			}
+		}
+		mSynced.notify_all();
+	}
+
+	if(mFile)
+	{
+		fclose(mFile);
+		mFile = nullptr;
+	}
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------
+//  EDIT JOURNAL (CRASH RECOVERY)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#ifndef __EUREKA_M_JOURNAL_H__
+#define __EUREKA_M_JOURNAL_H__
+
+#include "m_strings.h"
+#include "objid.h"
+#include "sys_type.h"
+#include "lib_adler.h"	// after the above
+
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "filesystem.hpp"
+namespace fs = ghc::filesystem;
+
+class Basis;
+class JournalReader;
+struct Document;
+
+//
+// Encodes the operations of one undo group, in the order they were
+// applied. Objects created in the group are written out whole when the
+// group is finished, since callers fill them in directly.
+//
+class JournalGroupEncoder
+{
+public:
+	void addChange(ObjType type, int objnum, byte field, int value);
+	void addInsert(ObjType type, int objnum);
+	void addDelete(ObjType type, int objnum);
+
+	bool isEmpty() const
+	{
+		return mData.empty();
+	}
+
+	void clear()
+	{
+		mData.clear();
+		mInserts.clear();
+	}
+
+	std::vector<byte> finish(const Document &doc, bool keepHistory, const SString &message);
+
+private:
+	void putByte(byte value)
+	{
+		mData.push_back(value);
+	}
+	void putInt(int value);
+	void putField(ObjType type, byte field, int value);
+
+	std::vector<byte> mData;
+	std::vector<Objid> mInserts;	// current numbers of the new objects
+};
+
+//
+// Append-only journal of the committed edits of a level, kept beside the
+// PWAD. Records are handed over by the editor and written (and synced to
+// disk) by a background thread. The file is only created on the first
+// record, and is removed when the level is saved or closed cleanly.
+//
+class EditJournal
+{
+public:
+	~EditJournal()
+	{
+		stop(false);
+	}
+
+	static fs::path pathFor(const fs::path &wadPath, const SString &level);
+	static crc32_c baseline(const Document &doc);
+
+	static bool isRecoverable(const fs::path &path, const crc32_c &base);
+	static size_t replay(const fs::path &path, Basis &basis, int &numGroups);
+
+	void start(const fs::path &path, const crc32_c &base, size_t keepLength = 0);
+	void stop(bool removeFile);
+
+	bool isActive() const
+	{
+		return mActive;
+	}
+
+	void append(std::vector<byte> &&record);
+	void appendUndo();
+	void appendRedo();
+
+	void flush();
+
+private:
+	static bool replayGroupOps(Basis &basis, JournalReader &reader);
+
+	void threadMain();
+	bool openFile();
+
+	fs::path mPath;
+	crc32_c mBase;
+	size_t mKeepLength = 0;
+	bool mActive = false;
+	bool mReportedFailure = false;
+
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mSynced;
+
+	// guarded by mMutex
+	std::vector<byte> mPending;
+	uint64_t mAppendedCount = 0;
+	uint64_t mSyncedCount = 0;
+	bool mQuit = false;
+	bool mFailed = false;
+
+	FILE *mFile = nullptr;	// only used by the thread
+};
+
+#endif  /* __EUREKA_M_JOURNAL_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -22,6 +22,7 @@
 #include "Instance.h"
 #include "main.h"
 #include "m_parse.h"
+#include "sys_trace.h"
 
 #include <assert.h>
 #include <algorithm>
@@ -1072,6 +1073,8 @@ extern void Debug_CheckUnusedStuff(Document &doc);
 
 void Instance::DoExecuteCommand(const editor_command_t *cmd)
 {
+	TRACE_SCOPE("command", cmd->name);
+
 	(this->*cmd->func)();
 
 //	Debug_CheckUnusedStuff();
@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------
+//  BATCH LINTING (NO GUI)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+//
+//  Runs the map checks over all the levels of a PWAD, without opening
+//  the editor window, and writes a JSON report.
+//
+//  Levels are loaded a batch at a time, one after another, since the
+//  string table and the lumps are not safe to use from several threads.
+//  The checks of a whole batch are then run in parallel: each level in
+//  its own instance, and each level's independent detectors as separate
+//  tasks.
+//
+//------------------------------------------------------------------------
+
+#include "m_lint.h"
+
+#include "e_basis.h"
+#include "Errors.h"
+#include "Instance.h"
+#include "m_loadsave.h"
+#include "m_select.h"
+#include "w_wad.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// most levels loaded (and instances kept) at once
+#define LINT_MAX_BATCH  8
+
+fs::path global::lint_report;
+int global::lint_jobs = 0;
+
+//
+// Editor instance for linting, with what the level loading needs
+//
+class LintInstance : public Instance
+{
+public:
+	LintInstance()
+	{
+		edit.Selected = &selection;
+	}
+
+private:
+	selection_c selection;
+};
+
+
+static int LintThreadCount(int numThreads)
+{
+	if (numThreads > 0)
+		return numThreads;
+
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+static double MillisSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+													  start).count();
+}
+
+
+//
+// runs all the checks of the given levels, putting them in the results with
+// the same index. Levels which are NULL (failed to load) are skipped.
+//
+void Lint_CheckLevels(const std::vector<const Instance *> &levels,
+					  std::vector<lint_level_t> &results, int numThreads)
+{
+	SYS_ASSERT(levels.size() == results.size());
+
+	int numTasks = ChecksModule::lintTaskCount();
+
+	std::vector<std::vector<lint_check_t>> found(levels.size() * numTasks);
+	std::vector<int> work;
+
+	for (size_t i = 0 ; i < levels.size() ; i++)
+		if (levels[i])
+			for (int task = 0 ; task < numTasks ; task++)
+				work.push_back((int)i * numTasks + task);
+
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]()
+	{
+		for (;;)
+		{
+			size_t k = next++;
+			if (k >= work.size())
+				return;
+
+			int index = work[k];
+			levels[index / numTasks]->level.checks.lintTask(index % numTasks, found[index]);
+		}
+	};
+
+	numThreads = std::min(LintThreadCount(numThreads), (int)work.size());
+
+	std::vector<std::thread> threads;
+	for (int i = 1 ; i < numThreads ; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (std::thread &thread : threads)
+		thread.join();
+
+	for (size_t i = 0 ; i < levels.size() ; i++)
+	{
+		results[i].checks.clear();
+
+		for (int task = 0 ; task < numTasks ; task++)
+			for (lint_check_t &check : found[i * numTasks + task])
+				results[i].checks.push_back(std::move(check));
+	}
+}
+
+
+static void WriteJSONString(FILE *fp, const SString &str)
+{
+	fputc('"', fp);
+
+	for (size_t i = 0 ; i < str.length() ; i++)
+	{
+		unsigned char ch = str[i];
+
+		if (ch == '"' || ch == '\\')
+			fprintf(fp, "\\%c", ch);
+		else if (ch < 0x20)
+			fprintf(fp, "\\u%04x", ch);
+		else
+			fputc(ch, fp);
+	}
+
+	fputc('"', fp);
+}
+
+
+void Lint_WriteReport(FILE *fp, const fs::path &wadPath, const std::vector<lint_level_t> &levels,
+					  int numThreads, double millis)
+{
+	fprintf(fp, "{\n  \"wad\": ");
+	WriteJSONString(fp, wadPath.u8string());
+	fprintf(fp, ",\n  \"threads\": %d,\n  \"total_ms\": %.3f,\n  \"levels\": [", numThreads,
+			millis);
+
+	for (size_t i = 0 ; i < levels.size() ; i++)
+	{
+		const lint_level_t &level = levels[i];
+
+		fprintf(fp, "%s\n    {\n      \"name\": ", i ? "," : "");
+		WriteJSONString(fp, level.name);
+
+		if (!level.error.empty())
+		{
+			fprintf(fp, ",\n      \"error\": ");
+			WriteJSONString(fp, level.error);
+		}
+
+		fprintf(fp, ",\n      \"load_ms\": %.3f,\n      \"checks\": [", level.load_millis);
+
+		for (size_t k = 0 ; k < level.checks.size() ; k++)
+		{
+			const lint_check_t &check = level.checks[k];
+
+			fprintf(fp, "%s\n        { \"name\": \"%s\", \"severity\": \"%s\", \"type\": \"%s\", "
+					"\"ms\": %.3f, \"count\": %d, \"objects\": [", k ? "," : "", check.name,
+					check.severity >= 2 ? "major" : "minor", NameForObjectType(check.type, true),
+					check.millis, (int)check.objects.size());
+
+			for (size_t n = 0 ; n < check.objects.size() ; n++)
+				fprintf(fp, "%s%d", n ? ", " : "", check.objects[n]);
+
+			fprintf(fp, "] }");
+		}
+
+		fprintf(fp, "%s]\n    }", level.checks.empty() ? "" : "\n      ");
+	}
+
+	fprintf(fp, "%s]\n}\n", levels.empty() ? "" : "\n  ");
+}
+
+
+//
+// lints all the levels of the given wad, with the resources given by the
+// loading data. Returns the exit status: zero when there were no major
+// problems.
+//
+int Lint_Main(const LoadingData &loading, const std::shared_ptr<Wad_file> &wad)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	int numThreads = LintThreadCount(global::lint_jobs);
+	int numLevels = wad->LevelCount();
+
+	if (numLevels == 0)
+		gLog.printf("WARNING: no levels found in %s\n", wad->PathName().u8string().c_str());
+
+	int batchSize = std::max(1, std::min({ numThreads, numLevels, LINT_MAX_BATCH }));
+
+	std::vector<std::unique_ptr<LintInstance>> slots;
+
+	for (int i = 0 ; i < batchSize ; i++)
+	{
+		auto inst = std::make_unique<LintInstance>();
+
+		inst->wad.master.edit_wad = wad;
+
+		LoadingData resources = loading;
+		inst->Main_LoadResources(resources);
+
+		slots.push_back(std::move(inst));
+	}
+
+	std::vector<lint_level_t> results;
+
+	for (int first = 0 ; first < numLevels ; first += batchSize)
+	{
+		int count = std::min(batchSize, numLevels - first);
+
+		std::vector<const Instance *> loaded(count);
+		std::vector<lint_level_t> batch(count);
+
+		for (int i = 0 ; i < count ; i++)
+		{
+			int lev_num = first + i;
+
+			batch[i].name = wad->GetLump(wad->LevelHeader(lev_num))->Name();
+
+			gLog.printf("Linting %s\n", batch[i].name.c_str());
+
+			auto load_start = std::chrono::steady_clock::now();
+			try
+			{
+				slots[i]->LoadLevelNum(wad.get(), lev_num);
+				loaded[i] = slots[i].get();
+			}
+			catch (const std::exception &e)
+			{
+				batch[i].error = e.what();
+			}
+			batch[i].load_millis = MillisSince(load_start);
+		}
+
+		Lint_CheckLevels(loaded, batch, numThreads);
+
+		for (lint_level_t &level : batch)
+			results.push_back(std::move(level));
+	}
+
+	int status = 0;
+
+	for (const lint_level_t &level : results)
+	{
+		if (!level.error.empty())
+			status = 1;
+
+		for (const lint_check_t &check : level.checks)
+			if (check.severity >= 2 && !check.objects.empty())
+				status = 1;
+	}
+
+	double millis = MillisSince(start);
+
+	bool to_stdout = global::lint_report == "-";
+
+	FILE *fp = to_stdout ? stdout : fopen(global::lint_report.u8string().c_str(), "w");
+	if (!fp)
+		ThrowException("Cannot create lint report: %s\n", global::lint_report.u8string().c_str());
+
+	Lint_WriteReport(fp, wad->PathName(), results, numThreads, millis);
+
+	if (to_stdout)
+		fflush(fp);
+	else
+		fclose(fp);
+
+	gLog.printf("Linted %d levels in %.1f ms (%d threads)\n", numLevels, millis, numThreads);
+
+	return status;
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------
+//  BATCH LINTING (NO GUI)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#ifndef __EUREKA_M_LINT_H__
+#define __EUREKA_M_LINT_H__
+
+#include "e_checks.h"
+#include "m_strings.h"
+
+#include <memory>
+#include <stdio.h>
+#include <vector>
+
+#include "filesystem.hpp"
+namespace fs = ghc::filesystem;
+
+class Instance;
+class Wad_file;
+struct LoadingData;
+
+namespace global
+{
+	extern fs::path lint_report;	// where to write the report, "-" for stdout
+	extern int lint_jobs;			// number of threads, 0 for all cores
+}
+
+//
+// The lint results of a level
+//
+struct lint_level_t
+{
+	SString name;
+	SString error;		// when the level failed to load
+	double load_millis = 0;
+	std::vector<lint_check_t> checks;
+};
+
+void Lint_CheckLevels(const std::vector<const Instance *> &levels,
+					  std::vector<lint_level_t> &results, int numThreads = 0);
+
+void Lint_WriteReport(FILE *fp, const fs::path &wadPath, const std::vector<lint_level_t> &levels,
+					  int numThreads, double millis);
+
+int Lint_Main(const LoadingData &loading, const std::shared_ptr<Wad_file> &wad);
+
+#endif  /* __EUREKA_M_LINT_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -42,6 +42,7 @@
 #include "Sector.h"
 #include "SideDef.h"
 #include "Thing.h"
+#include "sys_trace.h"
 #include "Vertex.h"
 #include "w_rawdef.h"
 #include "w_wad.h"
@@ -84,6 +85,7 @@ void Instance::ReplaceEditWad(const std::shared_ptr<Wad_file> &new_wad)
 
 void Instance::FreshLevel()
 {
+	journal.stop(true);
 	level.basis.clearAll();
 
 	auto sec = std::make_unique<Sector>();
@@ -898,13 +900,21 @@ void Instance::ShowLoadProblem() const
 
 void Instance::LoadLevel(Wad_file *wad, const SString &level)
 {
+	TRACE_SCOPE("load", "LoadLevel");
+
 	int lev_num = wad->LevelFind(level);
 
 	if (lev_num < 0)
 		ThrowException("No such map: %s\n", level.c_str());
 
+	// the edits of the previous level are given up by now
+	journal.stop(true);
+
 	LoadLevelNum(wad, lev_num);
 
+	if (wad == this->wad.master.edit_wad.get() && ! wad->IsReadOnly())
+		StartJournal(wad->PathName(), level);
+
 	// reset various editor state
 	Editor_ClearAction();
 	Selection_InvalidateLast();
@@ -1000,6 +1010,45 @@ void Instance::LoadLevelNum(Wad_file *wad, int lev_num)
 }
 
 
+//
+// start journalling the edits of the level, first offering to recover
+// the ones of a previous session which didn't end cleanly.
+//
+void Instance::StartJournal(const fs::path &wadPath, const SString &level)
+{
+	fs::path path = EditJournal::pathFor(wadPath, level);
+	crc32_c base = EditJournal::baseline(this->level);
+	size_t keep_length = 0;
+
+	if (EditJournal::isRecoverable(path, base))
+	{
+		bool recover = true;
+
+		if (main_win)
+		{
+			recover = DLG_Confirm({ "&Discard", "&Recover" },
+						"Unsaved edits of %s from a previous session "
+						"were found.\n\nDo you want to recover them?",
+						level.c_str()) == 1;
+		}
+
+		if (recover)
+		{
+			int num_groups;
+			keep_length = EditJournal::replay(path, this->level.basis, num_groups);
+
+			gLog.printf("Recovered %d edits of %s from %s\n", num_groups, level.c_str(),
+						path.u8string().c_str());
+
+			if (num_groups > 0)
+				MadeChanges = true;
+		}
+	}
+
+	journal.start(path, base, keep_length);
+}
+
+
 //
 // open a new wad file.
 // when 'map_name' is not NULL, try to open that map.
@@ -1501,6 +1550,8 @@ void Instance::EmptyLump(const char *name) const
 
 void Instance::SaveLevel(const SString &level)
 {
+	TRACE_SCOPE("save", "SaveLevel");
+
 	// set global level name now (for debugging code)
 	loaded.levelName = level.asUpper();
 
@@ -1586,6 +1637,10 @@ void Instance::SaveLevel(const SString &level)
 		M_SaveUserState();
 	}
 
+	// the saved level is the new baseline for the journal
+	journal.stop(true);
+	StartJournal(wad.master.edit_wad->PathName(), loaded.levelName);
+
 	MadeChanges = false;
 }
 
@@ -24,6 +24,7 @@
 #include "m_config.h"
 #include "m_loadsave.h"
 #include "e_main.h"
+#include "sys_trace.h"
 #include "w_wad.h"
 
 #include "ui_window.h"
@@ -34,6 +35,8 @@
 // config items
 bool config::bsp_on_save	= true;
 bool config::bsp_fast		= false;
+bool config::bsp_incremental	= false;
+bool config::bsp_verify_incremental = false;
 bool config::bsp_warnings	= false;
 
 int  config::bsp_split_factor	= DEFAULT_FACTOR;
@@ -293,6 +296,9 @@ static void PrepareInfo(nodebuildinfo_t *info)
 	info->fast		= config::bsp_fast;
 	info->warnings	= config::bsp_warnings;
 
+	info->incremental			= config::bsp_incremental;
+	info->verify_incremental	= config::bsp_verify_incremental;
+
 	info->force_v5			= config::bsp_force_v5;
 	info->force_xnod		= config::bsp_force_zdoom;
 	info->force_compress	= config::bsp_compressed;
@@ -378,12 +384,16 @@ build_result_e Instance::BuildAllNodes(nodebuildinfo_t *info)
 
 void Instance::BuildNodesAfterSave(int lev_idx)
 {
+	TRACE_SCOPE("nodes", "BuildNodesAfterSave");
+
 	nodeialog = NULL;
 
 	nb_info = new nodebuildinfo_t;
 
 	PrepareInfo(nb_info);
 
+	nb_info->memos = &bsp_memos;
+
 	build_result_e ret = AJBSP_BuildLevel(nb_info, lev_idx, *this);
 
 	// TODO : maybe print # of serious/minor warnings
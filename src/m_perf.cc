@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------
+//  PERFORMANCE COUNTERS
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "m_perf.h"
+
+#include "Instance.h"
+#include "ui_window.h"
+
+#include <algorithm>
+
+void PerfCounters::addFrame(FrameKind kind, double millis, bool reused_map)
+{
+	frame_history_t &hist = (kind == FrameKind::view3d) ? view3d : map2d;
+
+	hist.millis[hist.count % PERF_HISTORY] = static_cast<float>(millis);
+	hist.count++;
+
+	if (reused_map)
+		reused_maps++;
+}
+
+
+//
+// the given percentile of the recent frame times, zero when no frames
+//
+double PerfCounters::percentile(FrameKind kind, int percent) const
+{
+	const frame_history_t &hist = history(kind);
+
+	int n = std::min(hist.count, PERF_HISTORY);
+	if (n == 0)
+		return 0;
+
+	float sorted[PERF_HISTORY];
+	std::copy(hist.millis, hist.millis + n, sorted);
+
+	int k = std::min(n - 1, n * percent / 100);
+	std::nth_element(sorted, sorted + k, sorted + n);
+
+	return sorted[k];
+}
+
+
+SString Perf_FormatBytes(size_t bytes)
+{
+	if (bytes >= 1024 * 1024)
+		return SString::printf("%.1f MB", bytes / (1024.0 * 1024.0));
+
+	return SString::printf("%d KB", (int)((bytes + 1023) / 1024));
+}
+
+
+//
+// the lines of the performance overlay
+//
+std::vector<SString> Instance::Perf_OverlayLines() const
+{
+	std::vector<SString> lines;
+
+	static const FrameKind kinds[2] = { FrameKind::map2d, FrameKind::view3d };
+
+	for (FrameKind kind : kinds)
+	{
+		SString line = SString::printf("%s %6d frames  p50 %5.1f  p95 %5.1f  p99 %5.1f ms",
+				kind == FrameKind::view3d ? "3D" : "2D", perf.frameCount(kind),
+				perf.percentile(kind, 50), perf.percentile(kind, 95), perf.percentile(kind, 99));
+
+		if (kind == FrameKind::map2d)
+			line += SString::printf("  (%d cached)", perf.reusedMapCount());
+
+		lines.push_back(line);
+	}
+
+	lines.push_back(SString::printf("Sectors  %d rebuilds  %d subdivided",
+			sector_info_cache.rebuilds, sector_info_cache.polygon_builds));
+
+	lines.push_back(SString::printf("Memory   undo %s  images %s",
+			Perf_FormatBytes(level.basis.undoMemoryUsage()).c_str(),
+			Perf_FormatBytes(wad.images.memoryUsage()).c_str()));
+
+	return lines;
+}
+
+
+void Instance::Perf_SetDisplay(int mode)
+{
+	edit.perf_display = mode;
+
+	if (main_win)
+	{
+		RedrawMap();
+		main_win->status_bar->redraw();
+	}
+}
+
+
+//
+// the short form for the status bar, for the current view
+//
+SString Instance::Perf_StatusText() const
+{
+	FrameKind kind = edit.render3d ? FrameKind::view3d : FrameKind::map2d;
+
+	return SString::printf("%.1f / %.1f ms  undo %s  img %s",
+			perf.percentile(kind, 50), perf.percentile(kind, 95),
+			Perf_FormatBytes(level.basis.undoMemoryUsage()).c_str(),
+			Perf_FormatBytes(wad.images.memoryUsage()).c_str());
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------
+//  PERFORMANCE COUNTERS
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#ifndef __EUREKA_M_PERF_H__
+#define __EUREKA_M_PERF_H__
+
+#include "m_strings.h"
+
+#include <vector>
+
+// frames kept for the percentiles
+#define PERF_HISTORY  120
+
+enum class FrameKind
+{
+	map2d,
+	view3d
+};
+
+//
+// Frame times of the 2D and 3D views, for the performance overlay
+//
+class PerfCounters
+{
+public:
+	void addFrame(FrameKind kind, double millis, bool reused_map = false);
+
+	int frameCount(FrameKind kind) const
+	{
+		return history(kind).count;
+	}
+
+	// 2D frames which only redrew on top of the cached map
+	int reusedMapCount() const
+	{
+		return reused_maps;
+	}
+
+	double percentile(FrameKind kind, int percent) const;
+
+private:
+	struct frame_history_t
+	{
+		float millis[PERF_HISTORY] = {};
+
+		// total frames, only the last PERF_HISTORY are kept
+		int count = 0;
+	};
+
+	const frame_history_t &history(FrameKind kind) const
+	{
+		return kind == FrameKind::view3d ? view3d : map2d;
+	}
+
+	frame_history_t map2d;
+	frame_history_t view3d;
+
+	int reused_maps = 0;
+};
+
+SString Perf_FormatBytes(size_t bytes);
+
+#endif  /* __EUREKA_M_PERF_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
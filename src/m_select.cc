@@ -30,6 +30,8 @@
 
 #include "m_select.h"
 
+#include <algorithm>
+
 
 //#define NEED_SLOW_CLEAR
 
@@ -246,10 +248,53 @@ void selection_c::frob(int n, BitOp op)
 
 void selection_c::frob_range(int n1, int n2, BitOp op)
 {
-	for ( ; n1 <= n2 ; n1++)
+	if (extended || n2 - n1 < MAX_STORE_SEL)
+	{
+		for ( ; n1 <= n2 ; n1++)
+		{
+			frob(n1, op);
+		}
+		return;
+	}
+
+	if (op == BitOp::remove && !bv)
+	{
+		std::vector<int> removed;
+
+		for (int i = 0 ; i < count ; i++)
+			if (n1 <= objs[i] && objs[i] <= n2)
+				removed.push_back(objs[i]);
+
+		ClearSorted(removed);
+		return;
+	}
+
+	if (!bv)
+		ConvertToBitvec();
+
+	// work out the first object as if they were done one by one
+	int new_first = first_obj;
+
+	if (op != BitOp::add && first_obj >= n1 && first_obj <= n2)
+		new_first = -1;
+
+	if (empty())
+	{
+		if (op != BitOp::remove)
+			new_first = n1;
+	}
+	else if (op == BitOp::toggle && maxobj < n2 && bv->find_next(0) == n1 &&
+			 count == maxobj - n1 + 1)
 	{
-		frob(n1, op);
+		// the selection empties right before the object after it
+		new_first = maxobj + 1;
 	}
+
+	bv->frob_range(n1, n2, op);
+
+	count = bv->count();
+	maxobj = bv->find_last();
+	first_obj = new_first;
 }
 
 
@@ -264,6 +309,21 @@ void selection_c::merge(const selection_c& other)
 			set_ext(i, get_ext(i) | value);
 		}
 	}
+	else if (other.bv && !extended)
+	{
+		bool was_empty = empty();
+
+		if (!bv)
+			ConvertToBitvec();
+
+		bv->merge(*other.bv);
+
+		count = bv->count();
+		maxobj = std::max(maxobj, other.maxobj);
+
+		if (was_empty && first_obj < 0)
+			first_obj = bv->find_next(0);
+	}
 	else if (other.bv || other.extended)
 	{
 		for (int i = 0 ; i <= other.maxobj ; i++)
@@ -281,7 +341,23 @@ void selection_c::merge(const selection_c& other)
 
 void selection_c::unmerge(const selection_c& other)
 {
-	if (other.bv || other.extended)
+	if (bv && other.bv)
+	{
+		bv->unmerge(*other.bv);
+		UpdateFromBitvec();
+	}
+	else if ((other.bv || other.extended) && !bv && !extended)
+	{
+		// only a few objects here, look each of them up
+		std::vector<int> removed;
+
+		for (int i = 0 ; i < count ; i++)
+			if (other.get(objs[i]))
+				removed.push_back(objs[i]);
+
+		ClearSorted(removed);
+	}
+	else if (other.bv || other.extended)
 	{
 		for (int i = 0 ; i <= other.maxobj ; i++)
 			if (other.get(i))
@@ -297,9 +373,35 @@ void selection_c::unmerge(const selection_c& other)
 
 void selection_c::intersect(const selection_c& other)
 {
-	for (int i = 0 ; i <= maxobj ; i++)
-		if (get(i) && !other.get(i))
-			clear(i);
+	if (extended)
+	{
+		for (int i = 0 ; i <= maxobj ; i++)
+			if (get(i) && !other.get(i))
+				clear(i);
+	}
+	else if (bv)
+	{
+		if (other.bv)
+			bv->intersect(*other.bv);
+		else
+		{
+			for (int i = bv->find_next(0) ; i >= 0 ; i = bv->find_next(i + 1))
+				if (!other.get(i))
+					bv->clear(i);
+		}
+
+		UpdateFromBitvec();
+	}
+	else
+	{
+		std::vector<int> removed;
+
+		for (int i = 0 ; i < count ; i++)
+			if (!other.get(objs[i]))
+				removed.push_back(objs[i]);
+
+		ClearSorted(removed);
+	}
 }
 
 
@@ -360,15 +462,7 @@ void selection_c::RecomputeMaxObj()
 	}
 	else if (bv)
 	{
-		// search backwards so we can early out
-		for (int i = bv->size()-1 ; i >= 0 ; i--)
-		{
-			if (bv->get(i))
-			{
-				maxobj = i;
-				break;
-			}
-		}
+		maxobj = bv->find_last();
 	}
 	else
 	{
@@ -381,6 +475,33 @@ void selection_c::RecomputeMaxObj()
 }
 
 
+//
+// Fixes up the count and others after removing bits from the bit vector
+//
+void selection_c::UpdateFromBitvec()
+{
+	count = bv->count();
+
+	if (maxobj >= 0 && !bv->get(maxobj))
+		maxobj = bv->find_last();
+
+	if (first_obj >= 0 && !bv->get(first_obj))
+		first_obj = -1;
+}
+
+
+//
+// Clears the objects, in ascending order like a scan over them does
+//
+void selection_c::ClearSorted(std::vector<int> &list)
+{
+	std::sort(list.begin(), list.end());
+
+	for (int n : list)
+		clear(n);
+}
+
+
 void selection_c::ResizeExtended(int new_size)
 {
 	SYS_ASSERT(new_size > 0);
@@ -489,9 +610,10 @@ void sel_iter_c::next()
 	}
 	else if (sel->bv)
 	{
-		// this could be optimised....
-		while (pos < sel->bv->size() && !sel->bv->get(pos))
-			pos++;
+		pos = sel->bv->find_next(pos);
+
+		if (pos < 0)
+			pos = sel->bv->size();
 	}
 }
 
@@ -120,6 +120,8 @@ public:
 
 private:
 	void ConvertToBitvec();
+	void UpdateFromBitvec();
+	void ClearSorted(std::vector<int> &list);
 	void RecomputeMaxObj();
 	void ResizeExtended(int new_size);
 };
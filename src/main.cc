@@ -36,6 +36,7 @@
 #include "m_config.h"
 #include "m_game.h"
 #include "m_files.h"
+#include "m_lint.h"
 #include "m_loadsave.h"
 
 #include "e_main.h"
@@ -49,6 +50,7 @@
 #include "w_wad.h"
 
 #include "ui_window.h"
+#include "sys_trace.h"
 #include "ui_about.h"
 #include "ui_file.h"
 
@@ -887,6 +889,8 @@ void readPortInfo(LoadingData &loading, ConfigData &config) noexcept(false)
 //
 void Instance::Main_LoadResources(LoadingData &loading)
 {
+	TRACE_SCOPE("load", "Main_LoadResources");
+
 	ConfigData config = conf;
 	std::vector<std::shared_ptr<Wad_file>> resourceWads;
 	try
@@ -925,6 +929,8 @@ void Instance::Main_LoadResources(LoadingData &loading)
 
 			resourceWads.push_back(wad);
 		}
+
+		config.compileDefinitions();
 	}
 	catch(const ParseException &e)
 	{
@@ -1013,6 +1019,23 @@ static void ShowVersion()
 }
 
 
+//
+// writes the trace asked for with --trace, if any
+//
+static void Main_WriteTrace()
+{
+	if (global::trace_file.empty())
+		return;
+
+	if (trace::writeJSON(global::trace_file))
+		gLog.printf("Wrote %d trace events to %s\n", trace::eventCount(),
+					global::trace_file.u8string().c_str());
+	else
+		gLog.printf("WARNING: failed writing trace file '%s'\n",
+					global::trace_file.u8string().c_str());
+}
+
+
 static void ShowTime()
 {
 #ifdef WIN32
@@ -1057,6 +1080,59 @@ static void prepareConfigPath()
 	}
 }
 
+//
+// Checks all the levels of the given PWAD, without the editor window
+//
+static int Main_Lint()
+{
+	if (global::Pwad_list.empty())
+		ThrowException("Nothing to lint: no wad file given\n");
+
+	// this fatal errors on any missing file
+	M_ValidateGivenFiles();
+
+	const fs::path &path = global::Pwad_list[0];
+
+	std::shared_ptr<Wad_file> wad = Wad_file::Open(path, WadOpenMode::read);
+	if (!wad)
+		ThrowException("Cannot load pwad: %s\n", path.u8string().c_str());
+
+	// nobody is there to answer the dialogs
+	DLG_Notify_Override = [](const char *msg, va_list ap)
+	{
+		gLog.printf("%s\n", SString::vprintf(msg, ap).c_str());
+	};
+	DLG_Confirm_Override = [](const std::vector<SString> &buttons, const char *msg, va_list ap)
+	{
+		gLog.printf("%s\n", SString::vprintf(msg, ap).c_str());
+		return -1;
+	};
+
+	global::recent.load(global::home_dir);
+	global::recent.lookForIWADs(global::install_dir, global::home_dir);
+
+	gInstance.loaded.parseEurekaLump(global::home_dir, global::install_dir, global::recent,
+									 wad.get(), true /* keep_cmd_line_args */);
+
+	if (gInstance.loaded.iwadName.empty())
+	{
+		gInstance.loaded.iwadName = gInstance.M_PickDefaultIWAD();
+
+		if (gInstance.loaded.iwadName.empty())
+			ThrowException("Cannot find an IWAD, use the --iwad option\n");
+
+		gInstance.loaded.gameName = GameNameFromIWAD(gInstance.loaded.iwadName);
+	}
+	else if (! DetermineIWAD(gInstance))
+	{
+		return 1;
+	}
+
+	DeterminePort(gInstance);
+
+	return Lint_Main(gInstance.loaded, wad);
+}
+
 //
 //  the program starts here
 //
@@ -1082,6 +1158,13 @@ int main(int argc, char *argv[])
 			return 0;
 		}
 
+		// the lint report may go to stdout, keep the messages off it
+		if (global::lint_report == "-")
+			global::Quiet = true;
+
+		if (!global::trace_file.empty())
+			trace::start();
+
 		init_progress = ProgressStatus::early;
 
 
@@ -1113,6 +1196,18 @@ int main(int argc, char *argv[])
 		// and command line arguments will override both
 		M_ParseCommandLine(argc - 1, argv + 1, CommandLinePass::normal, global::Pwad_list, options);
 
+		if (!global::lint_report.empty())
+		{
+			int status = Main_Lint();
+
+			init_progress = ProgressStatus::nothing;
+
+			Main_WriteTrace();
+			gLog.close();
+
+			return status;
+		}
+
 		// TODO: create a new instance
 		gInstance.Editor_Init();
 
@@ -1210,6 +1305,9 @@ int main(int argc, char *argv[])
 
 		Main_Loop();
 
+		// a clean exit, so any unsaved edits were given up
+		gInstance.journal.stop(true);
+
 	quit:
 		/* that's all folks! */
 
@@ -1220,6 +1318,8 @@ int main(int argc, char *argv[])
 
 		// TODO: all instances
 		gInstance.wad.master.MasterDir_CloseAll();
+
+		Main_WriteTrace();
 		gLog.close();
 
 		return 0;
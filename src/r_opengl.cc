@@ -39,6 +39,7 @@
 #include "Sector.h"
 #include "SideDef.h"
 #include "Thing.h"
+#include "sys_trace.h"
 #include "Vertex.h"
 #include "w_rawdef.h"
 #include "w_texture.h"
@@ -145,11 +146,18 @@ public:
 		return x;
 	}
 
-	Img_c *FindFlat(const SString &fname, byte& r, byte& g, byte& b, bool& fullbright)
+	bool IsSky(StringID fname)
+	{
+		return inst.wad.images.resolveFlat(inst.conf, fname).sky;
+	}
+
+	Img_c *FindFlat(StringID fname, byte& r, byte& g, byte& b, bool& fullbright)
 	{
 		fullbright = false;
 
-		if (inst.is_sky(fname))
+		const resolved_image_t &res = inst.wad.images.resolveFlat(inst.conf, fname);
+
+		if (res.sky)
 		{
 			fullbright = true;
 			glBindTexture(GL_TEXTURE_2D, 0);
@@ -168,13 +176,13 @@ public:
 			if (inst.r_view.lighting)
 				col = inst.conf.miscInfo.floor_colors[1];
 			else
-				col = HashedPalColor(fname, inst.conf.miscInfo.floor_colors);
+				col = HashedPalColor(BA_GetString(fname), inst.conf.miscInfo.floor_colors);
 
 			inst.wad.palette.decodePixel(static_cast<img_pixel_t>(col), r, g, b);
 			return NULL;
 		}
 
-		Img_c *img = inst.wad.images.getMutableFlat(inst.conf, fname);
+		Img_c *img = res.img;
 		if (! img)
 		{
 			img = &inst.wad.images.getMutableUnknownFlat(inst.conf);
@@ -187,7 +195,7 @@ public:
 		return img;
 	}
 
-	Img_c *FindTexture(const SString &tname, byte& r, byte& g, byte& b, bool& fullbright)
+	Img_c *FindTexture(StringID tname, byte& r, byte& g, byte& b, bool& fullbright)
 	{
 		fullbright = false;
 
@@ -201,7 +209,7 @@ public:
 			if (inst.r_view.lighting)
 				col = inst.conf.miscInfo.wall_colors[1];
 			else
-				col = HashedPalColor(tname, inst.conf.miscInfo.wall_colors);
+				col = HashedPalColor(BA_GetString(tname), inst.conf.miscInfo.wall_colors);
 
 			inst.wad.palette.decodePixel(static_cast<img_pixel_t>(col), r, g, b);
 			return NULL;
@@ -209,18 +217,20 @@ public:
 
 		Img_c *img;
 
-		if (is_null_tex(tname))
+		const resolved_image_t &res = inst.wad.images.resolveTexture(inst.conf, tname);
+
+		if (res.null_tex)
 		{
 			img = &inst.wad.images.getMutableMissingTexture(inst.conf);
 			fullbright = config::render_missing_bright;
 		}
-		else if (is_special_tex(tname))
+		else if (res.special)
 		{
 			img = &inst.wad.images.getMutableSpecialTexture(inst.wad.palette);
 		}
 		else
 		{
-			img = inst.wad.images.getMutableTexture(inst.conf, tname);
+			img = res.img;
 
 			if (! img)
 			{
@@ -582,7 +592,7 @@ public:
 	}
 
 	void DrawSectorPolygons(const Sector *sec, sector_subdivision_c *subdiv,
-			const slope_plane_c *plane, int znormal, float z, const SString &fname)
+			const slope_plane_c *plane, int znormal, float z, StringID fname)
 	{
 		bool is_slope = plane && plane->sloped;
 
@@ -682,7 +692,7 @@ public:
 	//   - 'U' for upper
 	//   - 'E' for extrafloor side
 	void DrawSide(char where, const LineDef *ld, const SideDef *sd,
-		const SString &texname, const Sector *front, const Sector *back,
+		StringID texname, const Sector *front, const Sector *back,
 		bool sky_upper, float ld_length,
 		float x1, float y1, const slope_plane_c *p1,
 		float x2, float y2, const slope_plane_c *p2)
@@ -799,7 +809,7 @@ public:
 		bool fullbright;
 		Img_c *img;
 
-		img = FindTexture(sd->MidTex(), r, g, b, fullbright);
+		img = FindTexture(sd->mid_tex, r, g, b, fullbright);
 		if (img == NULL)
 			return;
 
@@ -1004,14 +1014,14 @@ public:
 
 		const Sector *front = sd ? &inst.level.getSector(*sd) : NULL;
 
-		bool sky_front = inst.is_sky(front->CeilTex());
+		bool sky_front = IsSky(front->ceil_tex);
 		bool sky_upper = false;
 
 		if (ld->OneSided())
 		{
 			sector_3dfloors_c *ex = inst.Subdiv_3DFloorsForSector(sd->sector);
 
-			DrawSide('W', ld.get(), sd, sd->MidTex(), front, NULL, false,
+			DrawSide('W', ld.get(), sd, sd->mid_tex, front, NULL, false,
 				ld_len, x1, y1, &ex->f_plane, x2, y2, &ex->c_plane);
 		}
 		else
@@ -1019,7 +1029,7 @@ public:
 			const SideDef *sd_back = (side == Side::left) ? inst.level.getRight(*ld) : inst.level.getLeft(*ld);
 			const Sector *back  = sd_back ? &inst.level.getSector(*sd_back) : NULL;
 
-			sky_upper = sky_front && inst.is_sky(back->CeilTex());
+			sky_upper = sky_front && IsSky(back->ceil_tex);
 
 			// check for BOOM 242 invisible platforms
 			bool invis_back = false;
@@ -1050,16 +1060,16 @@ public:
 
 			// lower part
 			if ((back->floorh > front->floorh || f_sloped) && !self_ref && !invis_back)
-				DrawSide('L', ld.get(), sd, sd->LowerTex(), front, back, sky_upper,
+				DrawSide('L', ld.get(), sd, sd->lower_tex, front, back, sky_upper,
 					ld_len, x1, y1, f_floorp, x2, y2, &b_ex->f_plane);
 
 			// upper part
 			if ((back->ceilh < front->ceilh || c_sloped) && !self_ref && !sky_upper)
-				DrawSide('U', ld.get(), sd, sd->UpperTex(), front, back, sky_upper,
+				DrawSide('U', ld.get(), sd, sd->upper_tex, front, back, sky_upper,
 					ld_len, x1, y1, &b_ex->c_plane, x2, y2, &f_ex->c_plane);
 
 			// railing tex
-			if (!is_null_tex(sd->MidTex()) && inst.r_view.texturing)
+			if (inst.r_view.texturing && !inst.wad.images.resolveTexture(inst.conf, sd->mid_tex).null_tex)
 				DrawMidMasker(ld.get(), sd, front, back, sky_upper,
 					ld_len, x1, y1, x2, y2);
 
@@ -1084,13 +1094,13 @@ public:
 					if (top_h <= bottom_h)
 						continue;
 
-					SString tex = "-";
+					StringID tex;
 					if (EF.flags & EXFL_UPPER)
-						tex = sd->UpperTex();
+						tex = sd->upper_tex;
 					else if (EF.flags & EXFL_LOWER)
-						tex = sd->LowerTex();
+						tex = sd->lower_tex;
 					else
-						tex = ef_sd->MidTex();
+						tex = ef_sd->mid_tex;
 
 					slope_plane_c p1; p1.Init(static_cast<float>(bottom_h));
 					slope_plane_c p2; p2.Init(static_cast<float>(top_h));
@@ -1113,7 +1123,7 @@ public:
 			slope_plane_c p1; p1.Init(static_cast<float>(front->ceilh));
 			slope_plane_c p2; p2.Init(static_cast<float>(front->ceilh + 16384.0));
 
-			DrawSide('U', ld.get(), sd, "-", front, NULL, true /* sky_upper */,
+			DrawSide('U', ld.get(), sd, StringID(), front, NULL, true /* sky_upper */,
 				ld_len, x1, y1, &p1, x2, y2, &p2);
 		}
 	}
@@ -1139,45 +1149,45 @@ public:
 			if (dummy->floorh > sec->floorh && inst.r_view.z < dummy->floorh)
 			{
 				// space C : underwater
-				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->floorh), dummy->CeilTex());
-				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(sec->floorh), dummy->FloorTex());
+				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->floorh), dummy->ceil_tex);
+				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(sec->floorh), dummy->floor_tex);
 
 				// this helps the view to not look weird when clipping around
 				if (dummy->ceilh > sec->floorh)
-					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->CeilTex());
+					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->ceil_tex);
 			}
 			else if (dummy->ceilh < sec->ceilh && inst.r_view.z > dummy->ceilh)
 			{
 				// space A : head over ceiling
-				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), dummy->FloorTex());
-				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(sec->ceilh), dummy->CeilTex());
+				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), dummy->floor_tex);
+				DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(sec->ceilh), dummy->ceil_tex);
 
 				if (dummy->floorh < sec->ceilh)
-					DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->FloorTex());
+					DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->floor_tex);
 			}
 			else if (dummy->floorh < sec->floorh)
 			{
 				// invisible platform
-				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->FloorTex());
+				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->floor_tex);
 
-				if (!inst.is_sky(sec->CeilTex()))
-					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->CeilTex());
+				if (!IsSky(sec->ceil_tex))
+					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->ceil_tex);
 			}
 			else
 			{
 				// space B : normal
-				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->FloorTex());
+				DrawSectorPolygons(sec.get(), subdiv, NULL, +1, static_cast<float>(dummy->floorh), sec->floor_tex);
 
-				if (!inst.is_sky(sec->CeilTex()))
-					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->CeilTex());
+				if (!IsSky(sec->ceil_tex))
+					DrawSectorPolygons(sec.get(), subdiv, NULL, -1, static_cast<float>(dummy->ceilh), sec->ceil_tex);
 			}
 		} else {
 
 			// normal sector
-			DrawSectorPolygons(sec.get(), subdiv, &exfloor->f_plane, +1, static_cast<float>(sec->floorh), sec->FloorTex());
+			DrawSectorPolygons(sec.get(), subdiv, &exfloor->f_plane, +1, static_cast<float>(sec->floorh), sec->floor_tex);
 
-			if (!inst.is_sky(sec->CeilTex()))
-				DrawSectorPolygons(sec.get(), subdiv, &exfloor->c_plane, -1, static_cast<float>(sec->ceilh), sec->CeilTex());
+			if (!IsSky(sec->ceil_tex))
+				DrawSectorPolygons(sec.get(), subdiv, &exfloor->c_plane, -1, static_cast<float>(sec->ceilh), sec->ceil_tex);
 		}
 
 		// draw planes of 3D floors
@@ -1194,8 +1204,8 @@ public:
 			int top_h = dummy->ceilh;
 			int bottom_h = dummy->floorh;
 
-			SString top_tex = dummy->CeilTex();
-			SString bottom_tex = dummy->FloorTex();
+			StringID top_tex = dummy->ceil_tex;
+			StringID bottom_tex = dummy->floor_tex;
 
 			if (EF.flags & EXFL_TOP)
 				bottom_h = top_h;
@@ -1271,7 +1281,7 @@ public:
 		float x2 = static_cast<float>(th->x() + inst.r_view.Sin * scale_w * 0.5);
 		float y2 = static_cast<float>(th->y() - inst.r_view.Cos * scale_w * 0.5);
 
-		int sec_num = inst.r_view.thing_sectors[th_index];
+		int sec_num = inst.level.hover.getThingSector(th_index);
 
 		float z1, z2;
 
@@ -1472,7 +1482,7 @@ public:
 		float x2 = static_cast<float>(tx + inst.r_view.Sin * scale_w * 0.5);
 		float y2 = static_cast<float>(ty - inst.r_view.Cos * scale_w * 0.5);
 
-		int sec_num = inst.r_view.thing_sectors[th_index];
+		int sec_num = inst.level.hover.getThingSector(th_index);
 
 		float z1, z2;
 
@@ -1596,7 +1606,7 @@ public:
 
 	void MarkCameraSector()
 	{
-		Objid obj = hover::getNearestSector(inst.level, { inst.r_view.x, inst.r_view.y });
+		Objid obj = inst.level.hover.getNearestSector({ inst.r_view.x, inst.r_view.y });
 
 		if (obj.valid())
 			seen_sectors.set(obj.num);
@@ -1612,9 +1622,16 @@ public:
 
 		glDisable(GL_ALPHA_TEST);
 
-		for (int s=0 ; s < inst.level.numSectors(); s++)
-			if (seen_sectors.get(s))
-				DrawSector(s);
+		std::vector<int> sectors;
+
+		for (int s = seen_sectors.find_next(0) ; s >= 0 && s < inst.level.numSectors() ;
+			 s = seen_sectors.find_next(s + 1))
+			sectors.push_back(s);
+
+		inst.Subdiv_BuildPolygons(sectors);
+
+		for (int s : sectors)
+			DrawSector(s);
 
 		glEnable(GL_ALPHA_TEST);
 
@@ -1695,6 +1712,8 @@ public:
 
 void RGL_RenderWorld(Instance &inst, int ox, int oy, int ow, int oh)
 {
+	TRACE_SCOPE("render", "RGL_RenderWorld");
+
 	RendInfo3D rend(inst);
 
 	rend.Begin(ow, oh);
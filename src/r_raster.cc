@@ -0,0 +1,815 @@
+//------------------------------------------------------------------------
+//  TILED SOFTWARE RASTERIZER (2D CANVAS)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+//
+//  Lines are drawn with the Bresenham algorithm, which is stepwise.  So
+//  that each tile can start a line where it enters the tile, the state
+//  after any number of steps is computed directly: along the major axis
+//  the line takes one pixel per step, and the number of minor steps taken
+//  before step k is  floor((d0 + (k-1) * a_minor) / a_major) + 1.
+//
+//------------------------------------------------------------------------
+
+#include "Errors.h"
+#include "r_raster.h"
+
+#include "im_img.h"
+#include "sys_debug.h"
+#include "sys_macro.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+// size of the screen tiles, in pixels
+#define RASTER_TILE  64
+
+// below this many commands, finish() doesn't bother with threads
+#define RASTER_MIN_PARALLEL  256
+
+
+enum outcode_flags_e
+{
+	O_TOP    = 1,
+	O_BOTTOM = 2,
+	O_LEFT   = 4,
+	O_RIGHT  = 8,
+};
+
+
+static inline long long FloorDiv(long long a, long long b)
+{
+	long long q = a / b;
+
+	if ((a % b) != 0 && ((a < 0) != (b < 0)))
+		q--;
+
+	return q;
+}
+
+//
+// Bresenham state at step k of a line: the number of minor axis steps
+// taken so far, and the decision variable
+//
+static inline void LineStepState(int k, int a_major, int a_minor, int d0, int &minor, int &d)
+{
+	// a line clipped down to a single pixel has no steps at all
+	if (k == 0)
+	{
+		minor = 0;
+		d = d0;
+		return;
+	}
+
+	long long m = FloorDiv(d0 + (long long)(k - 1) * a_minor, a_major) + 1;
+
+	if (m < 0)
+		m = 0;
+
+	minor = (int)m;
+	d = (int)(d0 + (long long)k * a_minor - m * a_major);
+}
+
+
+void TileRaster::begin(byte *buf, int width, int height, const Palette &palette)
+{
+	SYS_ASSERT(mCommands.empty());
+
+	mBuf = buf;
+	mWidth = width;
+	mHeight = height;
+	mPalette = &palette;
+
+	mTilesW = (width  + RASTER_TILE - 1) / RASTER_TILE;
+	mTilesH = (height + RASTER_TILE - 1) / RASTER_TILE;
+
+	mBins.resize(mTilesW * mTilesH);
+}
+
+
+void TileRaster::add(const Command &cmd)
+{
+	int index = (int)mCommands.size();
+	mCommands.push_back(cmd);
+
+	if (cmd.kind == Kind::line)
+	{
+		binLine(index, cmd);
+		return;
+	}
+
+	addToTiles(index, cmd.x1 / RASTER_TILE, cmd.y1 / RASTER_TILE,
+			   cmd.x2 / RASTER_TILE, cmd.y2 / RASTER_TILE);
+}
+
+
+void TileRaster::addToTiles(int index, int tx1, int ty1, int tx2, int ty2)
+{
+	for (int ty = ty1 ; ty <= ty2 ; ty++)
+		for (int tx = tx1 ; tx <= tx2 ; tx++)
+			mBins[ty * mTilesW + tx].push_back(index);
+}
+
+
+//
+// Only adds the line to the tiles it passes through: for each tile
+// column (or row) along the major axis, the range along the minor axis
+// is known from the steps at the ends.
+//
+void TileRaster::binLine(int index, const Command &cmd)
+{
+	int dx = cmd.x2 - cmd.x1;
+	int dy = cmd.y2 - cmd.y1;
+
+	int ax = 2 * abs(dx);
+	int ay = 2 * abs(dy);
+
+	int sx = dx < 0 ? -1 : 1;
+	int sy = dy < 0 ? -1 : 1;
+
+	bool horiz = (ax > ay);
+
+	int a_major = horiz ? ax : ay;
+	int a_minor = horiz ? ay : ax;
+	int d0 = a_minor - a_major / 2;
+
+	int major1 = horiz ? cmd.x1 : cmd.y1;
+	int major2 = horiz ? cmd.x2 : cmd.y2;
+	int minor1 = horiz ? cmd.y1 : cmd.x1;
+	int s_major = horiz ? sx : sy;
+	int s_minor = horiz ? sy : sx;
+	int steps = abs(major2 - major1);
+
+	int minor_limit = (horiz ? mHeight : mWidth) - 1;
+
+	int t1 = std::min(major1, major2) / RASTER_TILE;
+	int t2 = std::max(major1, major2) / RASTER_TILE;
+
+	for (int t = t1 ; t <= t2 ; t++)
+	{
+		int lo = t * RASTER_TILE;
+		int hi = lo + RASTER_TILE - 1;
+
+		int k1, k2;
+
+		if (s_major > 0)
+		{
+			k1 = std::max(0, lo - major1);
+			k2 = std::min(steps, hi - major1);
+		}
+		else
+		{
+			k1 = std::max(0, major1 - hi);
+			k2 = std::min(steps, major1 - lo);
+		}
+
+		if (k1 > k2)
+			continue;
+
+		int m1, m2, d;
+
+		LineStepState(k1, a_major, a_minor, d0, m1, d);
+		LineStepState(k2, a_major, a_minor, d0, m2, d);
+
+		int p1 = minor1 + m1 * s_minor;
+		int p2 = minor1 + m2 * s_minor;
+
+		if (p1 > p2)
+			std::swap(p1, p2);
+
+		// thick lines also cover the next pixel
+		if (cmd.thickness == 2)
+			p2 = std::min(p2 + 1, minor_limit);
+
+		if (horiz)
+			addToTiles(index, t, p1 / RASTER_TILE, t, p2 / RASTER_TILE);
+		else
+			addToTiles(index, p1 / RASTER_TILE, t, p2 / RASTER_TILE, t);
+	}
+}
+
+
+void TileRaster::rect(int rx, int ry, int rw, int rh, Color col)
+{
+	// clip to screen
+	if (rx + rw > mWidth)
+	{
+		rw = mWidth - rx;
+	}
+	if (rx < 0)
+	{
+		rw += rx;
+		rx = 0;
+	}
+	if (rw <= 0)
+		return;
+
+	if (ry + rh > mHeight)
+	{
+		rh = mHeight - ry;
+	}
+	if (ry < 0)
+	{
+		rh += ry;
+		ry = 0;
+	}
+	if (rh <= 0)
+		return;
+
+	Command cmd = {};
+
+	cmd.kind = Kind::rect;
+	cmd.col = col;
+	cmd.x1 = rx;
+	cmd.y1 = ry;
+	cmd.x2 = rx + rw - 1;
+	cmd.y2 = ry + rh - 1;
+
+	add(cmd);
+}
+
+
+int TileRaster::outcode(int x, int y) const
+{
+	return
+		((y < 0)        ? O_TOP    : 0) |
+		((y >= mHeight) ? O_BOTTOM : 0) |
+		((x < 0)        ? O_LEFT   : 0) |
+		((x >= mWidth)  ? O_RIGHT  : 0);
+}
+
+
+void TileRaster::line(int x1, int y1, int x2, int y2, int thickness, Color col)
+{
+	if (x1 == x2)
+	{
+		if (y1 > y2)
+			std::swap(y1, y2);
+
+		rect(x1, y1, thickness, y2 - y1 + thickness, col);
+		return;
+	}
+	if (y1 == y2)
+	{
+		if (x1 > x2)
+			std::swap(x1, x2);
+
+		rect(x1, y1, x2 - x1 + thickness, thickness, col);
+		return;
+	}
+
+	// completely off the screen?
+	int out1 = outcode(x1, y1);
+	int out2 = outcode(x2, y2);
+
+	if (out1 & out2)
+		return;
+
+	// clip diagonal line to the map
+	// (this is the Cohen-Sutherland clipping algorithm)
+
+	while (out1 | out2)
+	{
+		// may be partially inside box, find an outside point
+		int outside = (out1 ? out1 : out2);
+
+		int dx = x2 - x1;
+		int dy = y2 - y1;
+
+		// this almost certainly cannot happen, but for the sake of
+		// robustness we check anyway (just in case)
+		if (dx == 0 && dy == 0)
+			return;
+
+		int new_x, new_y;
+
+		// clip to each side
+		if (outside & O_TOP)
+		{
+			new_y = 0;
+			new_x = x1 + dx * (new_y - y1) / dy;
+		}
+		else if (outside & O_BOTTOM)
+		{
+			new_y = mHeight-1;
+			new_x = x1 + dx * (new_y - y1) / dy;
+		}
+		else if (outside & O_LEFT)
+		{
+			new_x = 0;
+			new_y = y1 + dy * (new_x - x1) / dx;
+		}
+		else
+		{
+			SYS_ASSERT(outside & O_RIGHT);
+
+			new_x = mWidth-1;
+			new_y = y1 + dy * (new_x - x1) / dx;
+		}
+
+		if (out1)
+		{
+			x1 = new_x;
+			y1 = new_y;
+
+			out1 = outcode(x1, y1);
+		}
+		else
+		{
+			SYS_ASSERT(out2);
+
+			x2 = new_x;
+			y2 = new_y;
+
+			out2 = outcode(x2, y2);
+		}
+
+		if (out1 & out2)
+			return;
+	}
+
+	Command cmd = {};
+
+	cmd.kind = Kind::line;
+	cmd.thickness = (thickness == 2) ? 2 : 1;
+	cmd.col = col;
+	cmd.x1 = x1;
+	cmd.y1 = y1;
+	cmd.x2 = x2;
+	cmd.y2 = y2;
+
+	add(cmd);
+}
+
+
+void TileRaster::flatSpan(int y, int x1, int x2, const img_pixel_t *texRow, int texWidth,
+						  double mapX, int halfWidth, double scale, const Color *light)
+{
+	Command cmd = {};
+
+	cmd.kind = Kind::flatSpan;
+	cmd.x1 = x1;
+	cmd.y1 = y;
+	cmd.x2 = x2;
+	cmd.y2 = y;
+	cmd.ax = halfWidth;
+	cmd.pix = texRow;
+	cmd.pixWidth = texWidth;
+	cmd.mapX = mapX;
+	cmd.scale = scale;
+
+	if (light)
+	{
+		cmd.lit = true;
+		cmd.col = *light;
+	}
+
+	add(cmd);
+}
+
+
+void TileRaster::sprite(int bx1, int by1, int bx2, int by2, const Img_c &img)
+{
+	// clip to screen
+	int rx1 = std::max(bx1, 0);
+	int ry1 = std::max(by1, 0);
+
+	int rx2 = std::min(bx2, mWidth)  - 1;
+	int ry2 = std::min(by2, mHeight) - 1;
+
+	if (rx1 >= rx2 || ry1 >= ry2)
+		return;
+
+	Command cmd = {};
+
+	cmd.kind = Kind::sprite;
+	cmd.x1 = rx1;
+	cmd.y1 = ry1;
+	cmd.x2 = rx2;
+	cmd.y2 = ry2;
+	cmd.ax = bx1;
+	cmd.ay = by1;
+	cmd.bx = bx2;
+	cmd.by = by2;
+	cmd.pix = img.buf();
+	cmd.pixWidth = img.width();
+	cmd.pixHeight = img.height();
+
+	add(cmd);
+}
+
+
+void TileRaster::fontChar(int rx, int ry, const Img_c &img, int ix, int iy, int iw, int ih)
+{
+	// clip to screen
+	int sx1 = std::max(rx, 0);
+	int sy1 = std::max(ry, 0);
+
+	int sx2 = std::min(rx + iw, mWidth)  - 1;
+	int sy2 = std::min(ry + ih, mHeight) - 1;
+
+	if (sx1 >= sx2 || sy1 >= sy2)
+		return;
+
+	Command cmd = {};
+
+	cmd.kind = Kind::fontChar;
+	cmd.x1 = sx1;
+	cmd.y1 = sy1;
+	cmd.x2 = sx2;
+	cmd.y2 = sy2;
+	cmd.ax = ix;
+	cmd.ay = iy;
+	cmd.pix = img.buf();
+	cmd.pixWidth = img.width();
+
+	add(cmd);
+}
+
+
+TileRaster::~TileRaster()
+{
+	stopWorkers();
+}
+
+
+void TileRaster::finish(int numThreads)
+{
+	int numTiles = mTilesW * mTilesH;
+
+	if (numThreads <= 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	if ((int)mCommands.size() < RASTER_MIN_PARALLEL)
+		numThreads = 1;
+
+	numThreads = std::min(numThreads, numTiles);
+
+	if (numThreads <= 1)
+	{
+		for (int tile = 0 ; tile < numTiles ; tile++)
+			drawTile(tile);
+	}
+	else
+	{
+		// the pool only changes when a different count is asked for
+		if ((int)mWorkers.size() != numThreads - 1)
+		{
+			stopWorkers();
+			startWorkers(numThreads - 1);
+		}
+
+		mNextTile = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFrame++;
+			mBusy = (int)mWorkers.size();
+		}
+		mWake.notify_all();
+
+		drawTiles();
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.wait(lock, [this]() { return mBusy == 0; });
+	}
+
+	mCommands.clear();
+
+	for (std::vector<int> &bin : mBins)
+		bin.clear();
+}
+
+
+void TileRaster::startWorkers(int count)
+{
+	// no workers are running here, so nothing else touches these
+	mQuit = false;
+
+	for (int i = 0 ; i < count ; i++)
+		mWorkers.emplace_back(&TileRaster::threadMain, this, mFrame);
+}
+
+
+void TileRaster::stopWorkers()
+{
+	if (mWorkers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread &thread : mWorkers)
+		thread.join();
+
+	mWorkers.clear();
+}
+
+
+void TileRaster::threadMain(unsigned seen)
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [this, seen]() { return mQuit || mFrame != seen; });
+
+			if (mQuit)
+				return;
+
+			seen = mFrame;
+		}
+
+		drawTiles();
+
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			last = (--mBusy == 0);
+		}
+		if (last)
+			mDone.notify_one();
+	}
+}
+
+
+//
+// takes tiles until there are none left, on any thread
+//
+void TileRaster::drawTiles()
+{
+	int numTiles = mTilesW * mTilesH;
+
+	for (int tile ; (tile = mNextTile++) < numTiles ; )
+		drawTile(tile);
+}
+
+
+void TileRaster::drawTile(int tile) const
+{
+	int x1 = (tile % mTilesW) * RASTER_TILE;
+	int y1 = (tile / mTilesW) * RASTER_TILE;
+
+	int x2 = std::min(x1 + RASTER_TILE, mWidth)  - 1;
+	int y2 = std::min(y1 + RASTER_TILE, mHeight) - 1;
+
+	for (int index : mBins[tile])
+	{
+		const Command &cmd = mCommands[index];
+
+		switch (cmd.kind)
+		{
+			case Kind::rect:
+				drawRect(cmd, std::max(x1, cmd.x1), std::max(y1, cmd.y1),
+						 std::min(x2, cmd.x2), std::min(y2, cmd.y2));
+				break;
+
+			case Kind::line:
+				drawLine(cmd, x1, y1, x2, y2);
+				break;
+
+			case Kind::flatSpan:
+				drawFlatSpan(cmd, std::max(x1, cmd.x1), std::min(x2, cmd.x2));
+				break;
+
+			case Kind::sprite:
+				drawSprite(cmd, std::max(x1, cmd.x1), std::max(y1, cmd.y1),
+						   std::min(x2, cmd.x2), std::min(y2, cmd.y2));
+				break;
+
+			case Kind::fontChar:
+				drawFontChar(cmd, std::max(x1, cmd.x1), std::max(y1, cmd.y1),
+							 std::min(x2, cmd.x2), std::min(y2, cmd.y2));
+				break;
+		}
+	}
+}
+
+
+void TileRaster::drawRect(const Command &cmd, int x1, int y1, int x2, int y2) const
+{
+	int rw = x2 - x1 + 1;
+
+	byte *base = mBuf + (y1 * mWidth + x1) * 3;
+
+	// fast method for greyscale (especially BLACK)
+	if (cmd.col.r == cmd.col.g && cmd.col.g == cmd.col.b)
+	{
+		for (int y = y1 ; y <= y2 ; y++, base += mWidth * 3)
+			memset(base, cmd.col.r, rw * 3);
+
+		return;
+	}
+
+	// slower method for all other colors
+	for (int y = y1 ; y <= y2 ; y++, base += mWidth * 3)
+	{
+		byte *dest = base;
+
+		for (int w2 = rw ; w2 > 0 ; w2--)
+		{
+			*dest++ = cmd.col.r;
+			*dest++ = cmd.col.g;
+			*dest++ = cmd.col.b;
+		}
+	}
+}
+
+
+//
+// this is the Bresenham line drawing algorithm
+// (based on code from am_map.c in the GPL DOOM source),
+// only running the steps which fall inside the tile.
+//
+void TileRaster::drawLine(const Command &cmd, int x1, int y1, int x2, int y2) const
+{
+	int dx = cmd.x2 - cmd.x1;
+	int dy = cmd.y2 - cmd.y1;
+
+	int ax = 2 * abs(dx);
+	int ay = 2 * abs(dy);
+
+	int sx = dx < 0 ? -1 : 1;
+	int sy = dy < 0 ? -1 : 1;
+
+	auto plot = [&](int x, int y)
+	{
+		if (x >= x1 && x <= x2 && y >= y1 && y <= y2)
+		{
+			byte *dest = mBuf + (x + y * mWidth) * 3;
+
+			dest[0] = cmd.col.r;
+			dest[1] = cmd.col.g;
+			dest[2] = cmd.col.b;
+		}
+	};
+
+	if (ax > ay)  // horizontal stepping
+	{
+		int steps = abs(dx);
+		int k1 = std::max(0, (sx > 0) ? x1 - cmd.x1 : cmd.x1 - x2);
+		int k2 = std::min(steps, (sx > 0) ? x2 - cmd.x1 : cmd.x1 - x1);
+
+		if (k1 > k2)
+			return;
+
+		int m, d;
+		LineStepState(k1, ax, ay, ay - ax/2, m, d);
+
+		int x = cmd.x1 + k1 * sx;
+		int y = cmd.y1 + m * sy;
+
+		for (int k = k1 ; ; k++)
+		{
+			plot(x, y);
+			if (cmd.thickness == 2 && y+1 < mHeight) plot(x, y+1);
+
+			if (k == k2)
+				break;
+
+			if (d >= 0)
+			{
+				y += sy;
+				d -= ax;
+			}
+
+			x += sx;
+			d += ay;
+		}
+	}
+	else   // vertical stepping
+	{
+		int steps = abs(dy);
+		int k1 = std::max(0, (sy > 0) ? y1 - cmd.y1 : cmd.y1 - y2);
+		int k2 = std::min(steps, (sy > 0) ? y2 - cmd.y1 : cmd.y1 - y1);
+
+		if (k1 > k2)
+			return;
+
+		int m, d;
+		LineStepState(k1, ay, ax, ax - ay/2, m, d);
+
+		int x = cmd.x1 + m * sx;
+		int y = cmd.y1 + k1 * sy;
+
+		for (int k = k1 ; ; k++)
+		{
+			plot(x, y);
+			if (cmd.thickness == 2 && x+1 < mWidth) plot(x+1, y);
+
+			if (k == k2)
+				break;
+
+			if (d >= 0)
+			{
+				x += sx;
+				d -= ay;
+			}
+
+			y += sy;
+			d += ax;
+		}
+	}
+}
+
+
+void TileRaster::drawFlatSpan(const Command &cmd, int x1, int x2) const
+{
+	byte *dest = mBuf + (x1 + cmd.y1 * mWidth) * 3;
+
+	int tw = cmd.pixWidth;
+
+	int r = cmd.col.r * 0x101;
+	int g = cmd.col.g * 0x101;
+	int b = cmd.col.b * 0x101;
+
+	for (int x = x1 ; x <= x2 ; x++, dest += 3)
+	{
+		int tx = (int)(cmd.mapX + (x - cmd.ax) / cmd.scale) & (tw - 1);
+
+		mPalette->decodePixel(cmd.pix[tx], dest[0], dest[1], dest[2]);
+
+		if (cmd.lit)
+		{
+			dest[0] = (byte)(((int)dest[0] * r) >> 16);
+			dest[1] = (byte)(((int)dest[1] * g) >> 16);
+			dest[2] = (byte)(((int)dest[2] * b) >> 16);
+		}
+	}
+}
+
+
+void TileRaster::drawSprite(const Command &cmd, int x1, int y1, int x2, int y2) const
+{
+	int W = cmd.pixWidth;
+	int H = cmd.pixHeight;
+
+	int bx1 = cmd.ax, by1 = cmd.ay;
+	int bx2 = cmd.bx, by2 = cmd.by;
+
+	for (int ry = y1 ; ry <= y2 ; ry++)
+	{
+		byte *dest = mBuf + 3 * (x1 + ry * mWidth);
+
+		for (int rx = x1 ; rx <= x2 ; rx++, dest += 3)
+		{
+			int ix = W * (rx - bx1) / (bx2 - bx1);
+			int iy = H * (ry - by1) / (by2 - by1);
+
+			ix = clamp(0, ix, W - 1);
+			iy = clamp(0, iy, H - 1);
+
+			img_pixel_t pix = cmd.pix[iy * W + ix];
+
+			if (pix != TRANS_PIXEL)
+			{
+				mPalette->decodePixel(pix, dest[0], dest[1], dest[2]);
+			}
+		}
+	}
+}
+
+
+void TileRaster::drawFontChar(const Command &cmd, int x1, int y1, int x2, int y2) const
+{
+	// the source starts at (ix, iy) for the top-left visible pixel
+	for (int sy = y1 ; sy <= y2 ; sy++)
+	{
+		int iy = cmd.ay + (sy - cmd.y1);
+
+		const img_pixel_t *src = cmd.pix + (cmd.ax + (x1 - cmd.x1) + iy * cmd.pixWidth);
+
+		byte *dest = mBuf + 3 * (x1 + sy * mWidth);
+
+		for (int sx = x1 ; sx <= x2 ; sx++, dest += 3)
+		{
+			img_pixel_t pix = *src++;
+
+			if (pix != TRANS_PIXEL)
+			{
+				mPalette->decodePixel(pix, dest[0], dest[1], dest[2]);
+			}
+		}
+	}
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------
+//  TILED SOFTWARE RASTERIZER (2D CANVAS)
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#ifndef __EUREKA_R_RASTER_H__
+#define __EUREKA_R_RASTER_H__
+
+#include "im_color.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Img_c;
+
+//
+// Draws into an RGB buffer for the software version of the 2D canvas.
+// Drawing commands are only recorded, and binned into the screen tiles
+// they touch. finish() then rasterises the tiles in parallel, each one
+// running its commands in order, so the result is exactly the same as
+// drawing everything directly. The worker threads are kept from one
+// frame to the next, small frames are drawn on the calling thread.
+//
+// All coordinates are relative to the buffer.
+//
+class TileRaster
+{
+public:
+	struct Color
+	{
+		byte r, g, b;
+	};
+
+	TileRaster() = default;
+	~TileRaster();
+
+	TileRaster(const TileRaster &other) = delete;
+	TileRaster &operator = (const TileRaster &other) = delete;
+
+	void begin(byte *buf, int width, int height, const Palette &palette);
+	void finish(int numThreads = 0);
+
+	bool hasPending() const
+	{
+		return !mCommands.empty();
+	}
+
+	void rect(int rx, int ry, int rw, int rh, Color col);
+	void line(int x1, int y1, int x2, int y2, int thickness, Color col);
+
+	// span of a flat in the map, the texture column is the integer part
+	// of mapX + (x - halfWidth) / scale
+	void flatSpan(int y, int x1, int x2, const img_pixel_t *texRow, int texWidth,
+				  double mapX, int halfWidth, double scale, const Color *light);
+
+	void sprite(int bx1, int by1, int bx2, int by2, const Img_c &img);
+	void fontChar(int rx, int ry, const Img_c &img, int ix, int iy, int iw, int ih);
+
+private:
+	enum class Kind : byte
+	{
+		rect,
+		line,
+		flatSpan,
+		sprite,
+		fontChar,
+	};
+
+	struct Command
+	{
+		Kind kind;
+		bool lit;
+		byte thickness;
+		Color col;
+
+		// rect, span and images: the visible area, inclusive.
+		// lines: the clipped end points.
+		int x1, y1, x2, y2;
+
+		// images: the unclipped box (sprites) or the source offset (font).
+		// spans: half of the screen width in ax.
+		int ax, ay, bx, by;
+
+		const img_pixel_t *pix;
+		int pixWidth, pixHeight;
+
+		double mapX, scale;
+	};
+
+	int outcode(int x, int y) const;
+
+	void add(const Command &cmd);
+	void addToTiles(int index, int tx1, int ty1, int tx2, int ty2);
+	void binLine(int index, const Command &cmd);
+
+	void startWorkers(int count);
+	void stopWorkers();
+	void threadMain(unsigned seen);
+	void drawTiles();
+
+	void drawTile(int tile) const;
+	void drawRect(const Command &cmd, int x1, int y1, int x2, int y2) const;
+	void drawLine(const Command &cmd, int x1, int y1, int x2, int y2) const;
+	void drawFlatSpan(const Command &cmd, int x1, int x2) const;
+	void drawSprite(const Command &cmd, int x1, int y1, int x2, int y2) const;
+	void drawFontChar(const Command &cmd, int x1, int y1, int x2, int y2) const;
+
+	byte *mBuf = nullptr;
+	int mWidth = 0;
+	int mHeight = 0;
+	const Palette *mPalette = nullptr;
+
+	int mTilesW = 0;
+	int mTilesH = 0;
+
+	std::vector<Command> mCommands;
+	std::vector<std::vector<int>> mBins;	// command indices of each tile
+
+	std::vector<std::thread> mWorkers;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+
+	// guarded by mMutex
+	unsigned mFrame = 0;	// bumped to wake the workers up
+	int mBusy = 0;			// workers still drawing the frame
+	bool mQuit = false;
+
+	std::atomic<int> mNextTile{ 0 };
+};
+
+#endif  /* __EUREKA_R_RASTER_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
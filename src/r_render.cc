@@ -67,31 +67,6 @@ int  config::render_pixel_aspect = 83;  //  100 * width / height
 
 bool global::use_npot_textures;
 
-namespace thing_sec_cache
-{
-	int invalid_low, invalid_high;
-
-	void ResetRange()
-	{
-		invalid_low  = 999999999;
-		invalid_high = -1;
-	}
-
-	void InvalidateThing(int th)
-	{
-		invalid_low  = std::min(invalid_low,  th);
-		invalid_high = std::max(invalid_high, th);
-	}
-
-	void InvalidateAll(const Document &doc)
-	{
-		invalid_low  = 0;
-		invalid_high = doc.numThings() - 1;
-	}
-
-	void Update(Instance &inst);
-};
-
 void Render_View_t::SetAngle(float new_ang)
 {
 	angle = new_ang;
@@ -119,7 +94,7 @@ void Render_View_t::FindGroundZ()
 		double test_x = x + dx * 8;
 		double test_y = y + dy * 8;
 
-		Objid o = hover::getNearestSector(inst.level, { test_x, test_y });
+		Objid o = inst.level.hover.getNearestSector({ test_x, test_y });
 
 		if (o.num >= 0)
 		{
@@ -185,8 +160,6 @@ void Render_View_t::UpdateScreen(int ow, int oh)
 
 void Render_View_t::PrepareToRender(int ow, int oh)
 {
-	thing_sec_cache::Update(inst);
-
 	UpdateScreen(ow, oh);
 
 	if (gravity)
@@ -206,67 +179,6 @@ static const Thing *FindPlayer(const Document &doc, int typenum)
 }
 
 
-//------------------------------------------------------------------------
-
-namespace thing_sec_cache
-{
-	void Update(Instance &inst)
-	{
-		// guarantee that thing_sectors has the correct size.
-		// [ prevent a potential crash ]
-		if (inst.level.numThings() != (int)inst.r_view.thing_sectors.size())
-		{
-			inst.r_view.thing_sectors.resize(inst.level.numThings());
-			thing_sec_cache::InvalidateAll(inst.level);
-		}
-
-		// nothing changed?
-		if (invalid_low > invalid_high)
-			return;
-
-		for (int i = invalid_low ; i <= invalid_high ; i++)
-		{
-			Objid obj = hover::getNearestSector(inst.level, inst.level.things[i]->xy());
-
-			inst.r_view.thing_sectors[i] = obj.num;
-		}
-
-		thing_sec_cache::ResetRange();
-	}
-}
-
-void Render3D_NotifyBegin()
-{
-	thing_sec_cache::ResetRange();
-}
-
-void Render3D_NotifyInsert(ObjType type, int objnum)
-{
-	if (type == ObjType::things)
-		thing_sec_cache::InvalidateThing(objnum);
-}
-
-void Render3D_NotifyDelete(const Document &doc, ObjType type, int objnum)
-{
-	if (type == ObjType::things || type == ObjType::sectors)
-		thing_sec_cache::InvalidateAll(doc);
-}
-
-void Render3D_NotifyChange(ObjType type, int objnum, int field)
-{
-	if (type == ObjType::things &&
-		(field == Thing::F_X || field == Thing::F_Y))
-	{
-		thing_sec_cache::InvalidateThing(objnum);
-	}
-}
-
-void Render3D_NotifyEnd(Instance &inst)
-{
-	thing_sec_cache::Update(inst);
-}
-
-
 //------------------------------------------------------------------------
 
 class save_obj_field_c
@@ -649,9 +561,6 @@ static bool Render3D_Query(Instance &inst, Objid& hl, int sx, int sy)
 
 void Instance::Render3D_Setup()
 {
-	thing_sec_cache::InvalidateAll(level);
-	r_view.thing_sectors.resize(0);
-
 	if (! r_view.p_type)
 	{
 		r_view.p_type = THING_PLAYER1;
@@ -919,9 +828,9 @@ static void DragThings_Update(Instance &inst)
 	new_y = static_cast<float>(new_y + dy * fwd_vy / fwd_len);
 
 	// handle a change in floor height
-	Objid old_sec = hover::getNearestSector(inst.level, { old_x, old_y });
+	Objid old_sec = inst.level.hover.getNearestSector({ old_x, old_y });
 
-	Objid new_sec = hover::getNearestSector(inst.level, { new_x, new_y });
+	Objid new_sec = inst.level.hover.getNearestSector({ new_x, new_y });
 
 	if (old_sec.valid() && new_sec.valid())
 	{
@@ -57,8 +57,6 @@ public:
 
 	bool gravity = true;  // when true, walk on ground
 
-	std::vector<int> thing_sectors;
-
 	// current mouse coords (in window), invalid if -1
 	int mouse_x = -1, mouse_y = -1;
 
@@ -107,12 +105,6 @@ void Render3D_ScrollMap(Instance &inst, v2int_t dpos = {}, keycode_t mod = 0);
 void Render3D_DragThings(Instance &inst);
 void Render3D_DragSectors(Instance &inst);
 
-void Render3D_NotifyBegin();
-void Render3D_NotifyInsert(ObjType type, int objnum);
-void Render3D_NotifyDelete(const Document &doc, ObjType type, int objnum);
-void Render3D_NotifyChange(ObjType type, int objnum, int field);
-void Render3D_NotifyEnd(Instance &inst);
-
 
 /* API for rendering a scene (etc) */
 
@@ -45,6 +45,7 @@
 #include "r_subdiv.h"
 #include "Sector.h"
 #include "SideDef.h"
+#include "sys_trace.h"
 #include "Thing.h"
 #include "Vertex.h"
 
@@ -110,11 +111,13 @@ public:
 	~DrawSurf()
 	{ }
 
-	void FindFlat(const SString & fname)
+	void FindFlat(StringID fname)
 	{
 		fullbright = false;
 
-		if (inst.is_sky(fname))
+		const resolved_image_t &res = inst.wad.images.resolveFlat(inst.conf, fname);
+
+		if (res.sky)
 		{
 			col = static_cast<img_pixel_t>(inst.conf.miscInfo.sky_color);
 			fullbright = true;
@@ -123,7 +126,7 @@ public:
 
 		if (inst.r_view.texturing)
 		{
-			img = inst.wad.images.W_GetFlat(inst.conf, fname);
+			img = res.img;
 
 			if (! img)
 			{
@@ -138,28 +141,30 @@ public:
 		if (inst.r_view.lighting)
 			col = static_cast<img_pixel_t>(inst.conf.miscInfo.floor_colors[1]);
 		else
-			col = static_cast<img_pixel_t>(HashedPalColor(fname, inst.conf.miscInfo.floor_colors));
+			col = static_cast<img_pixel_t>(HashedPalColor(BA_GetString(fname), inst.conf.miscInfo.floor_colors));
 	}
 
-	void FindTex(const SString & tname, LineDef *ld)
+	void FindTex(StringID tname, LineDef *ld)
 	{
 		fullbright = false;
 
 		if (inst.r_view.texturing)
 		{
-			if (is_null_tex(tname))
+			const resolved_image_t &res = inst.wad.images.resolveTexture(inst.conf, tname);
+
+			if (res.null_tex)
 			{
 				img = &inst.wad.images.IM_MissingTex(inst.conf);
 				fullbright = config::render_missing_bright;
 				return;
 			}
-			else if (is_special_tex(tname))
+			else if (res.special)
 			{
 				img = &inst.wad.images.IM_SpecialTex(inst.wad.palette);
 				return;
 			}
 
-			img = inst.wad.images.getTexture(inst.conf, tname);
+			img = res.img;
 
 			if (! img)
 			{
@@ -174,7 +179,7 @@ public:
 		if (inst.r_view.lighting)
 			col = static_cast<img_pixel_t>(inst.conf.miscInfo.wall_colors[1]);
 		else
-			col = static_cast<img_pixel_t>(HashedPalColor(tname, inst.conf.miscInfo.wall_colors));
+			col = static_cast<img_pixel_t>(HashedPalColor(BA_GetString(tname), inst.conf.miscInfo.wall_colors));
 	}
 };
 
@@ -402,10 +407,11 @@ public:
 			}
 		}
 
-		bool sky_upper = back && inst.is_sky(front->CeilTex()) && inst.is_sky(back->CeilTex());
+		bool sky_front = inst.wad.images.resolveFlat(inst.conf, front->ceil_tex).sky;
+		bool sky_upper = back && sky_front && inst.wad.images.resolveFlat(inst.conf, back->ceil_tex).sky;
 		bool self_ref  = (front == back) ? true : false;
 
-		if ((front->ceilh > inst.r_view.z || inst.is_sky(front->CeilTex()))
+		if ((front->ceilh > inst.r_view.z || sky_front)
 		    && ! sky_upper && ! self_ref)
 		{
 			ceil.kind = DrawSurf::K_FLAT;
@@ -414,7 +420,7 @@ public:
 			ceil.tex_h = ceil.h1;
 			ceil.y_clip = DrawSurf::SOLID_ABOVE;
 
-			ceil.FindFlat(front->CeilTex());
+			ceil.FindFlat(front->ceil_tex);
 		}
 
 		if (front->floorh < inst.r_view.z && ! self_ref)
@@ -425,7 +431,7 @@ public:
 			floor.tex_h = floor.h2;
 			floor.y_clip = DrawSurf::SOLID_BELOW;
 
-			floor.FindFlat(front->FloorTex());
+			floor.FindFlat(front->floor_tex);
 		}
 
 		if (! back)
@@ -437,7 +443,7 @@ public:
 			lower.h2 = front->ceilh;
 			lower.y_clip = DrawSurf::SOLID_ABOVE | DrawSurf::SOLID_BELOW;
 
-			lower.FindTex(sd->MidTex(), ld);
+			lower.FindTex(sd->mid_tex, ld);
 
 			if (lower.img && (ld->flags & MLF_LowerUnpegged))
 				lower.tex_h = lower.h1 + lower.img->height();
@@ -457,7 +463,7 @@ public:
 			upper.h2 = front->ceilh;
 			upper.y_clip = DrawSurf::SOLID_ABOVE;
 
-			upper.FindTex(sd->UpperTex(), ld);
+			upper.FindTex(sd->upper_tex, ld);
 
 			if (upper.img && ! (ld->flags & MLF_UpperUnpegged))
 				upper.tex_h = upper.h1 + upper.img->height();
@@ -474,7 +480,7 @@ public:
 			lower.h2 = back->floorh;
 			lower.y_clip = DrawSurf::SOLID_BELOW;
 
-			lower.FindTex(sd->LowerTex(), ld);
+			lower.FindTex(sd->lower_tex, ld);
 
 			// note "sky_upper" here, needed to match original DOOM behavior
 			if (ld->flags & MLF_LowerUnpegged)
@@ -490,10 +496,10 @@ public:
 		if (! inst.r_view.texturing)
 			return;
 
-		if (is_null_tex(sd->MidTex()))
+		if (inst.wad.images.resolveTexture(inst.conf, sd->mid_tex).null_tex)
 			return;
 
-		rail.FindTex(sd->MidTex(), ld);
+		rail.FindTex(sd->mid_tex, ld);
 		if (! rail.img)
 			return;
 
@@ -917,7 +923,7 @@ public:
 		if (query_mode && (sx2 < query_sx || sx1 > query_sx))
 			return;
 
-		int thsec = inst.r_view.thing_sectors[th_index];
+		int thsec = inst.level.hover.getThingSector(th_index);
 
 		// check if thing is hidden by BOOM deep water
 		if (inst.level.isSector(thsec))
@@ -1304,7 +1310,7 @@ public:
 				x1 = DeltaToX(iz, tx1) - 1;
 				x2 = DeltaToX(iz, tx2) + 1;
 
-				int thsec = inst.r_view.thing_sectors[th_index];
+				int thsec = inst.level.hover.getThingSector(th_index);
 
 				if (dw->thingFlags & THINGDEF_CEIL)
 				{
@@ -1665,7 +1671,7 @@ public:
 
 		dh = (dh - hh) / std::max(1, y2 - y1);
 
-		int thsec = inst.r_view.thing_sectors[dw->th];
+		int thsec = inst.level.hover.getThingSector(dw->th);
 		int light = inst.level.isSector(thsec) ? inst.level.sectors[thsec]->light : 255;
 		float dist = static_cast<float>(1.0 / dw->cur_iz);
 
@@ -2099,6 +2105,8 @@ static void BlitLores(const Instance &inst, int ox, int oy, int ow, int oh)
 
 void Instance::SW_RenderWorld(int ox, int oy, int ow, int oh)
 {
+	TRACE_SCOPE("render", "SW_RenderWorld");
+
 	RendInfo rend(*this);
 
 	fl_push_clip(ox, oy, ow, oh);
@@ -2116,6 +2124,17 @@ void Instance::SW_RenderWorld(int ox, int oy, int ow, int oh)
 }
 
 
+//
+// renders the view into r_view.screen, without showing it
+//
+void Instance::SW_RenderToBuffer()
+{
+	RendInfo rend(*this);
+
+	rend.Render();
+}
+
+
 bool Instance::SW_QueryPoint(Objid& hl, int qx, int qy)
 {
 	if (! config::render_high_detail)
@@ -24,6 +24,8 @@
 #include "main.h"
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "e_basis.h"
 #include "e_hover.h"
@@ -35,6 +37,8 @@
 #include "Thing.h"
 #include "Vertex.h"
 
+// below this many sectors, BuildPolygons() doesn't bother with threads
+#define SUBDIV_MIN_PARALLEL  64
 
 /* This file contains code for subdividing map sectors into a set
    of polygons, and also the logic for caching these subdivisions
@@ -162,6 +166,8 @@ void sector_info_cache_c::Rebuild()
 {
 	int sec;
 
+	rebuilds++;
+
 	for (sec = 0 ; sec < total ; sec++)
 	{
 		const auto &S = inst.level.sectors[sec];
@@ -196,13 +202,13 @@ void sector_info_cache_c::Rebuild()
 		}
 	}
 
-	for (const auto &thing : inst.level.things)
+	for (int th = 0 ; th < inst.level.numThings() ; th++)
 	{
-		CheckSlopeThing(thing.get());
+		CheckSlopeThing(th);
 	}
-	for (const auto &thing : inst.level.things)
+	for (int th = 0 ; th < inst.level.numThings() ; th++)
 	{
-		CheckSlopeCopyThing(thing.get());
+		CheckSlopeCopyThing(th);
 	}
 
 	for (const auto &linedef : inst.level.linedefs)
@@ -225,11 +231,8 @@ void sector_info_cache_c::CheckBoom242(const LineDef *L)
 
 	int dummy_sec = inst.level.getRight(*L)->sector;
 
-	for (int n = 0 ; n < inst.level.numSectors(); n++)
-	{
-		if (inst.level.sectors[n]->tag == L->tag)
-			infos[n].floors.heightsec = dummy_sec;
-	}
+	for (int n : inst.level.tags.objectsWithTag(ObjType::sectors, L->tag))
+		infos[n].floors.heightsec = dummy_sec;
 }
 
 void sector_info_cache_c::CheckExtraFloor(const LineDef *L, int ld_num)
@@ -305,11 +308,8 @@ void sector_info_cache_c::CheckExtraFloor(const LineDef *L, int ld_num)
 	EF.flags = flags;
 
 	// find all matching sectors
-	for (int n = 0 ; n < inst.level.numSectors(); n++)
-	{
-		if (inst.level.sectors[n]->tag == sec_tag)
-			infos[n].floors.floors.push_back(EF);
-	}
+	for (int n : inst.level.tags.objectsWithTag(ObjType::sectors, sec_tag))
+		infos[n].floors.floors.push_back(EF);
 }
 
 void sector_info_cache_c::CheckLineSlope(const LineDef *L)
@@ -390,8 +390,10 @@ void sector_info_cache_c::CheckPlaneCopy(const LineDef *L)
 	}
 }
 
-void sector_info_cache_c::CheckSlopeThing(const Thing *T)
+void sector_info_cache_c::CheckSlopeThing(int th)
 {
+	const auto &T = inst.level.things[th];
+
 	if (inst.loaded.levelFormat != MapFormat::doom && (inst.conf.features.slopes & 16))
 	{
 		switch (T->type)
@@ -400,21 +402,23 @@ void sector_info_cache_c::CheckSlopeThing(const Thing *T)
 		// TODO 1504, 1505 Vertex height (triangle sectors)
 		// TODO 9500, 9501 Line slope things
 
-		case 9502: PlaneTiltByThing(T, 0); break;
-		case 9503: PlaneTiltByThing(T, 1); break;
+		case 9502: PlaneTiltByThing(th, 0); break;
+		case 9503: PlaneTiltByThing(th, 1); break;
 		default: break;
 		}
 	}
 }
 
-void sector_info_cache_c::CheckSlopeCopyThing(const Thing *T)
+void sector_info_cache_c::CheckSlopeCopyThing(int th)
 {
+	const auto &T = inst.level.things[th];
+
 	if (inst.loaded.levelFormat != MapFormat::doom && (inst.conf.features.slopes & 16))
 	{
 		switch (T->type)
 		{
-		case 9510: PlaneCopyFromThing(T, 0); break;
-		case 9511: PlaneCopyFromThing(T, 1); break;
+		case 9510: PlaneCopyFromThing(th, 0); break;
+		case 9511: PlaneCopyFromThing(th, 1); break;
 		default: break;
 		}
 	}
@@ -508,29 +512,46 @@ void sector_info_cache_c::PlaneAlignPart(const LineDef *L, Side side, int plane)
 
 void sector_info_cache_c::PlaneCopy(const LineDef *L, int f1_tag, int c1_tag, int f2_tag, int c2_tag, int share)
 {
-	for (int n = 0 ; n < inst.level.numSectors(); n++)
+	// each plane comes from the first sector with its tag, and the copies
+	// are done in the order of those sectors
+	struct plane_copy_t
 	{
-		if (f1_tag > 0 && inst.level.sectors[n]->tag == f1_tag && inst.level.getRight(*L))
-		{
-			infos[inst.level.getRight(*L)->sector].floors.f_plane.Copy(infos[n].floors.f_plane);
-			f1_tag = 0;
-		}
-		if (c1_tag > 0 && inst.level.sectors[n]->tag == c1_tag && inst.level.getRight(*L))
-		{
-			infos[inst.level.getRight(*L)->sector].floors.c_plane.Copy(infos[n].floors.c_plane);
-			c1_tag = 0;
-		}
+		int source;
+		const SideDef *side;
+		bool ceil;
+	};
 
-		if (f2_tag > 0 && inst.level.sectors[n]->tag == f2_tag && inst.level.getLeft(*L))
-		{
-			infos[inst.level.getLeft(*L)->sector].floors.f_plane.Copy(infos[n].floors.f_plane);
-			f2_tag = 0;
-		}
-		if (c2_tag > 0 && inst.level.sectors[n]->tag == c2_tag && inst.level.getLeft(*L))
-		{
-			infos[inst.level.getLeft(*L)->sector].floors.c_plane.Copy(infos[n].floors.c_plane);
-			c2_tag = 0;
-		}
+	plane_copy_t copies[4];
+	int num_copies = 0;
+
+	auto addCopy = [&](int tag, const SideDef *side, bool ceil)
+	{
+		if (tag <= 0 || !side)
+			return;
+
+		const std::vector<int> &tagged = inst.level.tags.objectsWithTag(ObjType::sectors, tag);
+
+		if (!tagged.empty())
+			copies[num_copies++] = { tagged.front(), side, ceil };
+	};
+
+	addCopy(f1_tag, inst.level.getRight(*L), false);
+	addCopy(c1_tag, inst.level.getRight(*L), true);
+	addCopy(f2_tag, inst.level.getLeft(*L), false);
+	addCopy(c2_tag, inst.level.getLeft(*L), true);
+
+	std::stable_sort(copies, copies + num_copies,
+		[](const plane_copy_t &A, const plane_copy_t &B) { return A.source < B.source; });
+
+	for (int i = 0 ; i < num_copies ; i++)
+	{
+		sector_3dfloors_c &dest = infos[copies[i].side->sector].floors;
+		const sector_3dfloors_c &src = infos[copies[i].source].floors;
+
+		if (copies[i].ceil)
+			dest.c_plane.Copy(src.c_plane);
+		else
+			dest.f_plane.Copy(src.f_plane);
 	}
 
 	if (L->left >= 0 && L->right >= 0)
@@ -554,43 +575,46 @@ void sector_info_cache_c::PlaneCopy(const LineDef *L, int f1_tag, int c1_tag, in
 	}
 }
 
-void sector_info_cache_c::PlaneCopyFromThing(const Thing *T, int plane)
+void sector_info_cache_c::PlaneCopyFromThing(int th, int plane)
 {
+	const auto &T = inst.level.things[th];
+
 	if (T->arg1 == 0)
 		return;
 
 	// find sector containing the thing
-	Objid o = hover::getNearestSector(inst.level, T->xy());
+	int sec = inst.level.hover.getThingSector(th);
 
-	if (!o.valid())
+	if (sec < 0)
 		return;
 
-	for (int n = 0 ; n < inst.level.numSectors(); n++)
-	{
-		if (inst.level.sectors[n]->tag == T->arg1)
-		{
-			if (plane > 0)
-				infos[o.num].floors.c_plane.Copy(infos[n].floors.c_plane);
-			else
-				infos[o.num].floors.f_plane.Copy(infos[n].floors.f_plane);
+	const std::vector<int> &tagged = inst.level.tags.objectsWithTag(ObjType::sectors, T->arg1);
 
-			return;
-		}
-	}
+	if (tagged.empty())
+		return;
+
+	int n = tagged.front();
+
+	if (plane > 0)
+		infos[sec].floors.c_plane.Copy(infos[n].floors.c_plane);
+	else
+		infos[sec].floors.f_plane.Copy(infos[n].floors.f_plane);
 }
 
-void sector_info_cache_c::PlaneTiltByThing(const Thing *T, int plane)
+void sector_info_cache_c::PlaneTiltByThing(int th, int plane)
 {
+	const auto &T = inst.level.things[th];
+
 	double tx = T->x();
 	double ty = T->y();
 
 	// find sector containing the thing
-	Objid o = hover::getNearestSector(inst.level, { tx, ty });
+	int sec = inst.level.hover.getThingSector(th);
 
-	if (!o.valid())
+	if (sec < 0)
 		return;
 
-	sector_3dfloors_c *ex = &infos[o.num].floors;
+	sector_3dfloors_c *ex = &infos[sec].floors;
 
 	double tz = ex->PlaneZ(plane ? -1 : +1, tx, ty) + T->h();
 
@@ -667,7 +691,7 @@ void sector_info_cache_c::SlopeFromLine(slope_plane_c& pl, double x1, double y1,
 
 static void R_SubdivideSector(Instance &inst, int num, sector_extra_info_t& exinfo)
 {
-	if (exinfo.first_line < 0)
+	if (exinfo.lines.empty())
 		return;
 
 /* DEBUG
@@ -678,13 +702,10 @@ fprintf(stderr, "R_SubdivideSector %d\n", num);
 
 	std::vector<sector_edge_t> edgelist;
 
-	for (int n = exinfo.first_line ; n <= exinfo.last_line ; n++)
+	for (int n : exinfo.lines)
 	{
 		const auto &L = inst.level.linedefs[n];
 
-		if (! inst.level.touchesSector(*L, num))
-			continue;
-
 		// ignore 2S lines with same sector on both sides
 		if (inst.level.getSectorID(*L, Side::left) == inst.level.getSectorID(*L, Side::right))
 			continue;
@@ -894,11 +915,67 @@ sector_subdivision_c *Instance::Subdiv_PolygonsForSector(int num)
 	{
 		R_SubdivideSector(*this, num, exinfo);
 		exinfo.built = true;
+
+		sector_info_cache.polygon_builds++;
 	}
 
 	return &exinfo.sub;
 }
 
+
+//
+// builds the polygons of all the given sectors which don't have them yet,
+// spreading the sectors over several threads when there are many.
+//
+void sector_info_cache_c::BuildPolygons(const std::vector<int> &sectors, int numThreads)
+{
+	Update();
+
+	std::vector<int> todo;
+
+	for (int num : sectors)
+		if (num >= 0 && num < total && ! infos[num].built)
+			todo.push_back(num);
+
+	if (numThreads <= 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	if ((int)todo.size() < SUBDIV_MIN_PARALLEL)
+		numThreads = 1;
+
+	polygon_builds += (int)todo.size();
+
+	// each sector only writes its own info, and the level is only read
+	std::atomic<size_t> next(0);
+
+	auto worker = [this, &todo, &next]()
+	{
+		for (size_t k ; (k = next++) < todo.size() ; )
+		{
+			sector_extra_info_t &exinfo = infos[todo[k]];
+
+			R_SubdivideSector(inst, todo[k], exinfo);
+			exinfo.built = true;
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (int i = 1 ; i < numThreads ; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (std::thread &thread : threads)
+		thread.join();
+}
+
+
+void Instance::Subdiv_BuildPolygons(const std::vector<int> &sectors)
+{
+	sector_info_cache.BuildPolygons(sectors);
+}
+
 void sector_extra_info_t::AddVertex(const Vertex *V)
 {
 	bound_x1 = std::min(bound_x1, V->x());
@@ -130,9 +130,8 @@ public:
 
 struct sector_extra_info_t
 {
-	// these are < 0 when the sector has no lines
-	int first_line;
-	int last_line;
+	// the linedefs touching the sector, in ascending order
+	std::vector<int> lines;
 
 	// these are random junk when sector has no lines
 	double bound_x1, bound_x2;
@@ -147,7 +146,7 @@ struct sector_extra_info_t
 
 	void Clear()
 	{
-		first_line = last_line = -1;
+		lines.clear();
 
 		bound_x1 = 32767;
 		bound_y1 = 32767;
@@ -162,11 +161,9 @@ struct sector_extra_info_t
 
 	void AddLine(int n)
 	{
-		if (first_line < 0 || first_line > n)
-			first_line = n;
-
-		if (last_line < n)
-			last_line = n;
+		// both sides can be in the same sector
+		if (lines.empty() || lines.back() != n)
+			lines.push_back(n);
 	}
 
 	void AddVertex(const Vertex *V);
@@ -181,6 +178,10 @@ public:
 	int total = -1;
 	std::vector<sector_extra_info_t> infos;
 	Instance &inst;
+
+	// for the performance overlay
+	int rebuilds = 0;
+	int polygon_builds = 0;
 public:
 	explicit sector_info_cache_c(Instance &inst) : inst(inst)
 	{ }
@@ -189,17 +190,18 @@ public:
 public:
 	void Update();
 	void Rebuild();
+	void BuildPolygons(const std::vector<int> &sectors, int numThreads = 0);
 	void CheckBoom242(const LineDef *L);
 	void CheckExtraFloor(const LineDef *L, int ld_num);
 	void CheckLineSlope(const LineDef *L);
 	void CheckPlaneCopy(const LineDef *L);
-	void CheckSlopeThing(const Thing *T);
-	void CheckSlopeCopyThing(const Thing *T);
+	void CheckSlopeThing(int th);
+	void CheckSlopeCopyThing(int th);
 	void PlaneAlign(const LineDef *L, int floor_mode, int ceil_mode);
 	void PlaneAlignPart(const LineDef *L, Side side, int plane);
 	void PlaneCopy(const LineDef *L, int f1_tag, int c1_tag, int f2_tag, int c2_tag, int share);
-	void PlaneCopyFromThing(const Thing *T, int plane);
-	void PlaneTiltByThing(const Thing *T, int plane);
+	void PlaneCopyFromThing(int th, int plane);
+	void PlaneTiltByThing(int th, int plane);
 	void SlopeFromLine(slope_plane_c& pl, double x1, double y1, double z1,
 					   double x2, double y2, double z2);
 };
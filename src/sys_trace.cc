@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------
+//  Tracing support
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "sys_trace.h"
+
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+// most events kept, so a forgotten trace cannot eat all the memory
+#define TRACE_MAX_EVENTS  2000000
+
+fs::path global::trace_file;
+
+std::atomic<bool> trace::recording(false);
+
+namespace
+{
+
+struct trace_event_t
+{
+	const char *category;
+	const char *name;
+	int thread;
+	std::chrono::steady_clock::time_point begin;
+	std::chrono::steady_clock::duration length;
+};
+
+std::mutex trace_mutex;
+
+std::vector<trace_event_t> trace_events;
+int trace_dropped = 0;
+
+std::chrono::steady_clock::time_point trace_epoch;
+
+std::atomic<int> trace_next_thread(0);
+
+//
+// small numbers for the threads, in the order they first record something
+//
+int ThreadIndex()
+{
+	thread_local int index = -1;
+
+	if (index < 0)
+		index = trace_next_thread++;
+
+	return index;
+}
+
+void WriteJSONString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+
+	for (; *str ; str++)
+	{
+		unsigned char ch = *str;
+
+		if (ch == '"' || ch == '\\')
+			fprintf(fp, "\\%c", ch);
+		else if (ch < 0x20)
+			fprintf(fp, "\\u%04x", ch);
+		else
+			fputc(ch, fp);
+	}
+
+	fputc('"', fp);
+}
+
+double Micros(std::chrono::steady_clock::duration length)
+{
+	return std::chrono::duration<double, std::micro>(length).count();
+}
+
+}  // namespace
+
+
+void trace::start()
+{
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	if (recording)
+		return;
+
+	// times are relative to the first start since the last clear
+	if (trace_events.empty())
+		trace_epoch = std::chrono::steady_clock::now();
+
+	recording = true;
+}
+
+
+void trace::stop()
+{
+	recording = false;
+}
+
+
+void trace::clear()
+{
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	trace_events.clear();
+	trace_dropped = 0;
+
+	trace_epoch = std::chrono::steady_clock::now();
+}
+
+
+int trace::eventCount()
+{
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	return (int)trace_events.size();
+}
+
+
+void trace::Scope::finish()
+{
+	auto length = std::chrono::steady_clock::now() - begin;
+	int thread = ThreadIndex();
+
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	if (trace_events.size() >= TRACE_MAX_EVENTS)
+	{
+		trace_dropped++;
+		return;
+	}
+
+	trace_events.push_back({ category, name, thread, begin, length });
+}
+
+
+//
+// writes the events recorded so far, which are kept. Returns false when the
+// file cannot be created.
+//
+bool trace::writeJSON(const fs::path &path)
+{
+	FILE *fp = fopen(path.u8string().c_str(), "w");
+	if (!fp)
+		return false;
+
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	fprintf(fp, "{\n  \"displayTimeUnit\": \"ms\",\n  \"otherData\": { \"dropped\": %d },\n"
+			"  \"traceEvents\": [", trace_dropped);
+
+	for (size_t i = 0 ; i < trace_events.size() ; i++)
+	{
+		const trace_event_t &event = trace_events[i];
+
+		fprintf(fp, "%s\n    { \"name\": ", i ? "," : "");
+		WriteJSONString(fp, event.name);
+		fprintf(fp, ", \"cat\": ");
+		WriteJSONString(fp, event.category);
+		fprintf(fp, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f }",
+				event.thread, Micros(event.begin - trace_epoch), Micros(event.length));
+	}
+
+	fprintf(fp, "%s]\n}\n", trace_events.empty() ? "" : "\n  ");
+
+	return fclose(fp) == 0;
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------
+//  Tracing support
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+//
+//  Scoped timers on the hot paths, written out in the Chrome trace format
+//  (which chrome://tracing and ui.perfetto.dev can open).
+//
+//  Nothing is recorded until trace::start() is called, and a scope costs
+//  a single flag test until then. Building with NO_TRACING removes the
+//  scopes altogether.
+//
+//------------------------------------------------------------------------
+
+#ifndef __SYS_TRACE_H__
+#define __SYS_TRACE_H__
+
+#include "filesystem.hpp"
+namespace fs = ghc::filesystem;
+
+#include <atomic>
+#include <chrono>
+
+namespace global
+{
+	extern fs::path trace_file;
+}
+
+namespace trace
+{
+	extern std::atomic<bool> recording;
+
+	void start();
+	void stop();
+	void clear();
+
+	int eventCount();
+
+	bool writeJSON(const fs::path &path);
+
+	//
+	// Times its own lifetime, as a complete event. The name and category
+	// must outlive the trace (string literals or command names).
+	//
+	class Scope
+	{
+	public:
+		Scope(const char *category, const char *name) : category(category), name(name)
+		{
+			if (recording.load(std::memory_order_relaxed))
+			{
+				active = true;
+				begin = std::chrono::steady_clock::now();
+			}
+		}
+
+		~Scope()
+		{
+			if (active)
+				finish();
+		}
+
+		Scope(const Scope &) = delete;
+		Scope &operator = (const Scope &) = delete;
+
+	private:
+		void finish();
+
+		const char *category;
+		const char *name;
+
+		bool active = false;
+		std::chrono::steady_clock::time_point begin;
+	};
+}
+
+#ifdef NO_TRACING
+#define TRACE_SCOPE(category, name)  ((void) 0)
+#else
+#define TRACE_SCOPE_JOIN2(a, b)  a ## b
+#define TRACE_SCOPE_JOIN(a, b)   TRACE_SCOPE_JOIN2(a, b)
+#define TRACE_SCOPE(category, name)  \
+		trace::Scope TRACE_SCOPE_JOIN(trace_scope_, __LINE__)((category), (name))
+#endif
+
+#endif /* __SYS_TRACE_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
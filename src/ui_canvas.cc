@@ -48,6 +48,7 @@
 #include "r_render.h"
 #include "Sector.h"
 #include "SideDef.h"
+#include "sys_trace.h"
 #include "Thing.h"
 #include "Vertex.h"
 #include "w_rawdef.h"	// MLF_xxx
@@ -58,6 +59,19 @@
 
 #define CAMERA_COLOR  fl_rgb_color(255, 192, 255)
 
+// level of detail settings.
+// below this scale vertices are drawn as single pixels.
+#define LOD_VERTEX_SCALE  0.125
+
+// lines shorter than this (in pixels) don't show their length, etc.
+#define LOD_INFO_PIXELS   24
+
+// size of the cells (in pixels) which tiny things are counted in
+#define LOD_THING_CELL    4
+
+// marks an unused pixel in lod_pixels_c
+#define LOD_EMPTY  ((Fl_Color) 0xFFFFFFFF)
+
 
 typedef enum
 {
@@ -99,6 +113,14 @@ UI_Canvas::UI_Canvas(Instance &inst, int X, int Y, int W, int H, const char *lab
 	last_split_x(), last_split_y(),
 	snap_x(-1), snap_y(-1),
 	seen_sectors(),
+	map_cached(false),
+	cached_key(),
+	reused_map(false),
+#ifndef NO_OPENGL
+	map_tex(0),
+	map_tex_w(0), map_tex_h(0),
+	gl_w(0), gl_h(0),
+#endif
 	inst(inst)
 {
 #ifdef NO_OPENGL
@@ -134,6 +156,10 @@ void UI_Canvas::resize(int X, int Y, int W, int H)
 
 void UI_Canvas::draw()
 {
+	TRACE_SCOPE("draw", "UI_Canvas::draw");
+
+	auto start = std::chrono::steady_clock::now();
+
 #ifndef NO_OPENGL
 	if (! valid())
 	{
@@ -141,6 +167,15 @@ void UI_Canvas::draw()
 		// belongs to a context which was (probably) just deleted and
 		// hence refer to textures which no longer exist.
 		inst.wad.images.W_UnloadAllTextures();
+
+		// a new context has lost our cached map too
+		if (! context_valid())
+		{
+			map_tex = 0;
+			map_tex_w = map_tex_h = 0;
+		}
+
+		map_cached = false;
 	}
 
 #ifndef _WIN32	// TODO: #56: reenable this for Windows
@@ -159,6 +194,11 @@ void UI_Canvas::draw()
 	if (inst.edit.render3d)
 	{
 		Render3D_Draw(inst, x(), y(), w(), h());
+
+		// the map may get edited meanwhile
+		map_cached = false;
+
+		FinishFrame(FrameKind::view3d, start);
 		return;
 	}
 
@@ -188,8 +228,11 @@ void UI_Canvas::draw()
 	int pix = iround(inst.main_win->canvas->pixels_per_unit());
 	Fl::use_high_res_GL(false);
 
+	gl_w = w() * pix;
+	gl_h = h() * pix;
+
 	glLoadIdentity();
-	glViewport(0, 0, w() * pix, h() * pix);
+	glViewport(0, 0, gl_w, gl_h);
 	glOrtho(0, w(), 0, h(), -1, 1);
 #endif
 
@@ -205,6 +248,73 @@ void UI_Canvas::draw()
 	DrawEverything();
 
 	Blit();
+
+	FinishFrame(FrameKind::map2d, start);
+}
+
+
+//
+// counts the frame just drawn, then shows the figures where wanted
+//
+void UI_Canvas::FinishFrame(FrameKind kind, std::chrono::steady_clock::time_point start)
+{
+	double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+															  start).count();
+
+	inst.perf.addFrame(kind, millis, kind == FrameKind::map2d && reused_map);
+
+	if (inst.edit.perf_display == PERF_Overlay)
+		DrawPerfOverlay();
+	else if (inst.edit.perf_display == PERF_StatusBar && inst.main_win)
+		inst.main_win->status_bar->redraw();
+}
+
+
+//
+// the performance figures, in the top left corner of the view
+//
+void UI_Canvas::DrawPerfOverlay()
+{
+	const std::vector<SString> lines = inst.Perf_OverlayLines();
+
+	const int line_h = 16;
+	int box_w = 0;
+	int box_h = (int)lines.size() * line_h + 8;
+
+#ifdef NO_OPENGL
+	fl_font(FL_COURIER, 14);
+
+	for (const SString &line : lines)
+		box_w = std::max(box_w, (int)fl_width(line.c_str()) + 12);
+
+	fl_color(FL_BLACK);
+	fl_rectf(x() + 4, y() + 4, box_w, box_h);
+
+	fl_color(FL_YELLOW);
+
+	for (size_t i = 0 ; i < lines.size() ; i++)
+		fl_draw(lines[i].c_str(), x() + 10, y() + 4 + (int)(i + 1) * line_h);
+#else
+	// the 3D view leaves its own projection behind
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glOrtho(0, w(), 0, h(), -1, 1);
+
+	gl_font(FL_COURIER, 14);
+
+	for (const SString &line : lines)
+		box_w = std::max(box_w, (int)gl_width(line.c_str()) + 12);
+
+	gl_color(FL_BLACK);
+	gl_rectf(4, h() - 4 - box_h, box_w, box_h);
+
+	gl_color(FL_YELLOW);
+
+	for (size_t i = 0 ; i < lines.size() ; i++)
+		gl_draw(lines[i].c_str(), 10, h() - 4 - (int)(i + 1) * line_h);
+#endif
 }
 
 
@@ -326,13 +436,27 @@ int UI_Canvas::ApproxBoxSize(int mx1, int my1, int mx2, int my2)
 
 void UI_Canvas::DrawEverything()
 {
-	// setup for drawing sector numbers
-	if (inst.edit.show_object_numbers && inst.edit.mode == ObjType::sectors)
+	reused_map = CanReuseMap();
+
+	if (reused_map)
+	{
+		RestoreMapCache();
+	}
+	else
 	{
-		seen_sectors.clear_all();
+		// setup for drawing sector numbers
+		if (inst.edit.show_object_numbers && inst.edit.mode == ObjType::sectors)
+		{
+			seen_sectors.clear_all();
+		}
+
+		DrawMap();
+
+		SaveMapCache();
 	}
 
-	DrawMap();
+	if (inst.grid.snap && config::grid_snap_indicator)
+		DrawSnapPoint();
 
 	DrawSelection(inst.edit.Selected);
 
@@ -420,7 +544,15 @@ void UI_Canvas::DrawMap()
 
 	if (inst.edit.sector_render_mode && ! inst.edit.error_mode)
 	{
+		std::vector<int> on_screen;
+
 		for (int n = 0 ; n < inst.level.numSectors(); n++)
+			if (inst.Subdiv_SectorOnScreen(n, map_lx, map_ly, map_hx, map_hy))
+				on_screen.push_back(n);
+
+		inst.Subdiv_BuildPolygons(on_screen);
+
+		for (int n : on_screen)
 			RenderSector(n);
 	}
 
@@ -441,9 +573,6 @@ void UI_Canvas::DrawMap()
 	if (inst.edit.mode != ObjType::things)
 		DrawThings();
 
-	if (inst.grid.snap && config::grid_snap_indicator)
-		DrawSnapPoint();
-
 	DrawLinedefs();
 
 	if (inst.edit.mode == ObjType::vertices)
@@ -681,14 +810,31 @@ void UI_Canvas::DrawVertices()
 
 	RenderColor(FL_GREEN);
 
-	for (const auto &vertex : inst.level.vertices)
+	if (LodVertices(inst.grid.Scale))
 	{
-		double x = vertex->x();
-		double y = vertex->y();
+		// too far out for the knobs to be useful
+		for (const auto &vertex : inst.level.vertices)
+		{
+			double x = vertex->x();
+			double y = vertex->y();
 
-		if (Vis(x, y, r))
+			if (Vis(x, y, 0))
+				LodPlotPixel(SCREENX(x), SCREENY(y), FL_GREEN);
+		}
+
+		LodFlushPixels();
+	}
+	else
+	{
+		for (const auto &vertex : inst.level.vertices)
 		{
-			DrawVertex(x, y, r);
+			double x = vertex->x();
+			double y = vertex->y();
+
+			if (Vis(x, y, r))
+			{
+				DrawVertex(x, y, r);
+			}
 		}
 	}
 
@@ -728,6 +874,15 @@ void UI_Canvas::DrawLinedefs()
 		if (! Vis(std::min(x1,x2), std::min(y1,y2), std::max(x1,x2), std::max(y1,y2)))
 			continue;
 
+		int sx1 = SCREENX(x1);
+		int sy1 = SCREENY(y1);
+		int sx2 = SCREENX(x2);
+		int sy2 = SCREENY(y2);
+
+		// lines which fit in a single pixel are merged, and get no extras
+		bool tiny = LodLine(sx1, sy1, sx2, sy2);
+		bool show_info = std::max(abs(sx2 - sx1), abs(sy2 - sy1)) >= LOD_INFO_PIXELS;
+
 		bool one_sided = (! inst.level.getLeft(*L));
 
 		Fl_Color col = LIGHTGREY;
@@ -755,7 +910,7 @@ void UI_Canvas::DrawLinedefs()
 
 				// show info of last four added lines
 				if (n != inst.edit.split_line.num && n >= (inst.level.numLinedefs() - 4) &&
-					!inst.edit.show_object_numbers)
+					!inst.edit.show_object_numbers && show_info)
 				{
 					DrawLineInfo(x1, y1, x2, y2, false);
 				}
@@ -832,7 +987,7 @@ void UI_Canvas::DrawLinedefs()
 						col = WHITE;
 				}
 
-				if (inst.edit.show_object_numbers)
+				if (inst.edit.show_object_numbers && ! tiny)
 				{
 					if (s1 != NIL_OBJ)
 						DrawSectorNum(static_cast<int>(x1), static_cast<int>(y1), static_cast<int>(x2), static_cast<int>(y2), Side::right, s1);
@@ -852,6 +1007,12 @@ void UI_Canvas::DrawLinedefs()
 			break;
 		}
 
+		if (tiny && line_kind != 's')
+		{
+			LodPlotPixel(sx1, sy1, col);
+			continue;
+		}
+
 		RenderColor(col);
 
 		switch (line_kind)
@@ -870,6 +1031,8 @@ void UI_Canvas::DrawLinedefs()
 		}
 	}
 
+	LodFlushPixels();
+
 	// draw the linedef numbers
 	if (inst.edit.mode == ObjType::linedefs && inst.edit.show_object_numbers)
 	{
@@ -883,6 +1046,9 @@ void UI_Canvas::DrawLinedefs()
 			if (! Vis(std::min(x1,x2), std::min(y1,y2), std::max(x1,x2), std::max(y1,y2)))
 				continue;
 
+			if (SCREENX(x1) == SCREENX(x2) && SCREENY(y1) == SCREENY(y2))
+				continue;
+
 			DrawLineNumber(static_cast<int>(x1), static_cast<int>(y1), static_cast<int>(x2), static_cast<int>(y2), Side::neither, n);
 		}
 	}
@@ -920,10 +1086,13 @@ void UI_Canvas::DrawThing(double x, double y, int r, int angle, bool big_arrow)
 //
 void UI_Canvas::DrawThings()
 {
-	if (inst.edit.mode != ObjType::things)
-		RenderColor(DARKGREY);
-	else if (inst.edit.error_mode)
-		RenderColor(LIGHTGREY);
+	Fl_Color col = DARKGREY;
+
+	if (inst.edit.mode == ObjType::things && inst.edit.error_mode)
+		col = LIGHTGREY;
+
+	if (inst.edit.mode != ObjType::things || inst.edit.error_mode)
+		RenderColor(col);
 
 	for (const auto &thing : inst.level.things)
 	{
@@ -935,17 +1104,28 @@ void UI_Canvas::DrawThings()
 
 		const thingtype_t &info = inst.conf.getThingType(thing->type);
 
-		if (inst.edit.mode == ObjType::things && !inst.edit.error_mode)
+		bool own_color = (inst.edit.mode == ObjType::things && !inst.edit.error_mode);
+
+		if (own_color)
+			col = (Fl_Color)info.color;
+
+		int r = info.radius;
+
+		// things smaller than a pixel are only counted
+		if (LodThing(r, inst.grid.Scale))
 		{
-			Fl_Color col = (Fl_Color)info.color;
-			RenderColor(col);
+			LodAddThing(SCREENX(x), SCREENY(y), col);
+			continue;
 		}
 
-		int r = info.radius;
+		if (own_color)
+			RenderColor(col);
 
 		DrawThing(x, y, r, thing->angle, false);
 	}
 
+	LodFlushThings();
+
 	// draw the thing numbers
 	if (inst.edit.mode == ObjType::things && inst.edit.show_object_numbers)
 	{
@@ -986,11 +1166,15 @@ void UI_Canvas::DrawThingBodies()
 
 		const thingtype_t &info = inst.conf.getThingType(thing->type);
 
+		int r = info.radius;
+
+		// tiny things are shown by DrawThings()
+		if (LodThing(r, inst.grid.Scale))
+			continue;
+
 		Fl_Color col = (Fl_Color)info.color;
 		RenderColor(DarkerColor(DarkerColor(col)));
 
-		int r = info.radius;
-
 		int sx1 = SCREENX(x - r);
 		int sy1 = SCREENY(y + r);
 		int sx2 = SCREENX(x + r);
@@ -1001,6 +1185,165 @@ void UI_Canvas::DrawThingBodies()
 }
 
 
+//
+//  level of detail: whether objects are too small to draw as usual
+//
+bool UI_Canvas::LodVertices(double scale)
+{
+	return scale < LOD_VERTEX_SCALE;
+}
+
+bool UI_Canvas::LodLine(int sx1, int sy1, int sx2, int sy2)
+{
+	return sx1 == sx2 && sy1 == sy2;
+}
+
+bool UI_Canvas::LodThing(int radius, double scale)
+{
+	return radius * scale < 1.0;
+}
+
+
+void UI_Canvas::LodPlotPixel(int sx, int sy, Fl_Color col)
+{
+	lod_pixels.plot(sx - xx, sy - yy, w(), h(), col);
+}
+
+void UI_Canvas::LodFlushPixels()
+{
+	lod_pixels.flush(w(), h(), lod_rects);
+	LodDrawRects();
+}
+
+void UI_Canvas::LodAddThing(int sx, int sy, Fl_Color col)
+{
+	lod_things.add(sx - xx, sy - yy, w(), h(), col);
+}
+
+void UI_Canvas::LodFlushThings()
+{
+	lod_things.flush(lod_rects);
+	LodDrawRects();
+}
+
+void UI_Canvas::LodDrawRects()
+{
+	for (const lod_rect_t &rect : lod_rects)
+	{
+		RenderColor(rect.col);
+		RenderRect(xx + rect.x, yy + rect.y, rect.w, rect.h);
+	}
+
+	lod_rects.clear();
+}
+
+
+//
+//  plot a pixel of merged linedefs or vertices, the last one wins
+//
+void lod_pixels_c::plot(int x, int y, int W, int H, Fl_Color col)
+{
+	if (x < 0 || y < 0 || x >= W || y >= H)
+		return;
+
+	if (! used)
+	{
+		pixels.assign(W * H, LOD_EMPTY);
+		used = true;
+	}
+
+	pixels[y * W + x] = col;
+}
+
+
+//
+//  the plotted pixels, as runs of the same color
+//
+void lod_pixels_c::flush(int W, int H, std::vector<lod_rect_t> &rects)
+{
+	if (! used)
+		return;
+
+	used = false;
+
+	for (int y = 0 ; y < H ; y++)
+	{
+		const Fl_Color *row = &pixels[y * W];
+
+		for (int x = 0 ; x < W ; )
+		{
+			Fl_Color col = row[x];
+
+			if (col == LOD_EMPTY)
+			{
+				x++;
+				continue;
+			}
+
+			int x2 = x + 1;
+
+			while (x2 < W && row[x2] == col)
+				x2++;
+
+			rects.push_back(lod_rect_t{ x, y, x2 - x, 1, col });
+
+			x = x2;
+		}
+	}
+}
+
+
+//
+//  count a thing too small to draw in its density cell
+//
+void lod_things_c::add(int x, int y, int W, int H, Fl_Color col)
+{
+	if (x < 0 || y < 0 || x >= W || y >= H)
+		return;
+
+	if (! used)
+	{
+		cells_w = W / LOD_THING_CELL + 1;
+		int cells_h = H / LOD_THING_CELL + 1;
+
+		cells.assign(cells_w * cells_h, cell_t{ 0, 0 });
+		used = true;
+	}
+
+	cell_t &cell = cells[(y / LOD_THING_CELL) * cells_w + x / LOD_THING_CELL];
+
+	cell.count++;
+	cell.col = col;
+}
+
+
+//
+//  a marker for each cell with tiny things, bigger when it has more
+//
+void lod_things_c::flush(std::vector<lod_rect_t> &rects)
+{
+	if (! used)
+		return;
+
+	used = false;
+
+	for (int i = 0 ; i < (int)cells.size() ; i++)
+	{
+		const cell_t &cell = cells[i];
+
+		if (cell.count == 0)
+			continue;
+
+		int size = (cell.count >= 8) ? 4 : (cell.count >= 4) ? 3 : (cell.count >= 2) ? 2 : 1;
+
+		int x = (i % cells_w) * LOD_THING_CELL + (LOD_THING_CELL - size) / 2;
+		int y = (i / cells_w) * LOD_THING_CELL + (LOD_THING_CELL - size) / 2;
+
+		rects.push_back(lod_rect_t{ x, y, size, size, cell.col });
+	}
+}
+
+
 void UI_Canvas::DrawThingSprites()
 {
 #ifndef NO_OPENGL
@@ -1021,6 +1364,10 @@ void UI_Canvas::DrawThingSprites()
 		const thingtype_t &info = inst.conf.getThingType(thing->type);
 		float scale = info.scale;
 
+		// tiny things are shown by DrawThings()
+		if (info.radius * inst.grid.Scale < 1.0)
+			continue;
+
 		Img_c *sprite = inst.wad.getMutableSprite(inst.conf, thing->type);
 
 		if (! sprite)
@@ -1062,36 +1409,7 @@ void UI_Canvas::RenderSprite(int sx, int sy, float scale, Img_c *img)
 	if (bx2 <= bx1) bx2 = bx1 + 1;
 	if (by2 <= by1) by2 = by1 + 1;
 
-	// clip to screen
-	int rx1 = std::max(bx1, 0);
-	int ry1 = std::max(by1, 0);
-
-	int rx2 = std::min(bx2, rgb_w) - 1;
-	int ry2 = std::min(by2, rgb_h) - 1;
-
-	if (rx1 >= rx2 || ry1 >= ry2)
-		return;
-
-	for (int ry = ry1 ; ry <= ry2 ; ry++)
-	{
-		byte *dest = rgb_buf + 3 * (rx1 + ry * rgb_w);
-
-		for (int rx = rx1 ; rx <= rx2 ; rx++, dest += 3)
-		{
-			int ix = W * (rx - bx1) / (bx2 - bx1);
-			int iy = H * (ry - by1) / (by2 - by1);
-
-			ix = clamp(0, ix, W - 1);
-			iy = clamp(0, iy, H - 1);
-
-			img_pixel_t pix = img->buf()[iy * W + ix];
-
-			if (pix != TRANS_PIXEL)
-			{
-				inst.wad.palette.decodePixel(pix, dest[0], dest[1], dest[2]);
-			}
-		}
-	}
+	raster.sprite(bx1, by1, bx2, by2, *img);
 
 #else // OpenGL
 	int bx1 = sx + (int)floor(-W * scale);
@@ -1310,7 +1628,7 @@ void UI_Canvas::CheckGridSnap()
 	snap_x = new_snap_x;
 	snap_y = new_snap_y;
 
-	redraw();
+	RedrawOverlay();
 }
 
 
@@ -1326,16 +1644,24 @@ void UI_Canvas::UpdateHighlight()
 
 	int new_ld = inst.edit.split_line.valid() ? inst.edit.split_line.num : -1;
 
+	// the split line is drawn with the other linedefs, so the whole
+	// map needs redrawing when it changes
 	if (! (last_splitter == new_ld && last_split_x == inst.edit.split.x && last_split_y == inst.edit.split.y))
 	{
 		last_splitter = new_ld;
 		last_split_x  = inst.edit.split.x;
 		last_split_y  = inst.edit.split.y;
-		changes = true;
+		redraw();
 	}
 
 	if (changes)
-		redraw();
+		RedrawOverlay();
+}
+
+
+void UI_Canvas::RedrawOverlay()
+{
+	damage(FL_DAMAGE_USER1);
 }
 
 
@@ -1565,12 +1891,10 @@ void UI_Canvas::DrawTagged(ObjType objtype, int objnum)
     //
     auto highlightTaggedItems = [this](const SpecialTagInfo &info)
     {
-        if(info.numtags)
-            for (int m = 0 ; m < inst.level.numSectors(); m++)
-                if(inst.level.sectors[m]->tag > 0)
-                    for(int i = 0; i < info.numtags; ++i)
-                        if (inst.level.sectors[m]->tag == info.tags[i])
-                            DrawHighlight(ObjType::sectors, m);
+        for(int i = 0; i < info.numtags; ++i)
+            if(info.tags[i] > 0)
+                for(int m : inst.level.tags.objectsWithTag(ObjType::sectors, info.tags[i]))
+                    DrawHighlight(ObjType::sectors, m);
         if(info.numtids)
             for(int m = 0; m < inst.level.numThings(); m++)
                 if(inst.level.things[m]->tid > 0)
@@ -1582,23 +1906,28 @@ void UI_Canvas::DrawTagged(ObjType objtype, int objnum)
                             DrawHighlight(ObjType::things, m);
                 }
 
-        if(info.numlineids)
+        if(info.numlineids && inst.loaded.levelFormat == MapFormat::doom)
+        {
+            for(int i = 0; i < info.numlineids; ++i)
+            {
+                if(info.lineids[i] <= 0)
+                    continue;
+                for(int m : inst.level.tags.objectsWithTag(ObjType::linedefs, info.lineids[i]))
+                {
+                    if(info.type == ObjType::linedefs && info.objnum == m)
+                        continue;   // don't highlight the trigger again
+                    DrawHighlight(ObjType::linedefs, m);
+                }
+            }
+        }
+        else if(info.numlineids)
         {
             for(int m = 0; m < inst.level.numLinedefs(); ++m)
             {
                 if(info.type == ObjType::linedefs && info.objnum == m)
                     continue;   // don't highlight the trigger again
                 const LineDef &line = *inst.level.linedefs[m];
-                if(inst.loaded.levelFormat == MapFormat::doom)
-                {
-                    if(line.tag > 0)
-                    {
-                        for(int i = 0; i < info.numlineids; ++i)
-                            if(line.tag == info.lineids[i])
-                                DrawHighlight(ObjType::linedefs, m);
-                    }
-                }
-                else if(inst.loaded.levelFormat == MapFormat::hexen)
+                if(inst.loaded.levelFormat == MapFormat::hexen)
                 {
                     SpecialTagInfo linfo;
                     if(!getSpecialTagInfo(ObjType::linedefs, m, line.type, &line, inst.conf, linfo)
@@ -1618,7 +1947,7 @@ void UI_Canvas::DrawTagged(ObjType objtype, int objnum)
             for(int m = 0; m < inst.level.numThings(); ++m)
             {
                 const Thing &thing = *inst.level.things[m];
-                const thingtype_t *type = get(inst.conf.thing_types, thing.type);
+                const thingtype_t *type = inst.conf.findThingType(thing.type);
                 if(!type || !(type->flags & THINGDEF_POLYSPOT))
                     continue;
                 for(int i = 0; i < info.numpo; ++i)
@@ -1706,7 +2035,7 @@ void UI_Canvas::DrawTagged(ObjType objtype, int objnum)
         if(getSpecialTagInfo(objtype, objnum, thing->special, thing.get(), inst.conf, info))
             highlightTaggedItems(info);
         highlightTaggingTriggers(thing->tid, &SpecialTagInfo::tids, &SpecialTagInfo::numtids);
-        const thingtype_t *type = get(inst.conf.thing_types, thing->type);
+        const thingtype_t *type = inst.conf.findThingType(thing->type);
         if(type && type->flags & THINGDEF_POLYSPOT)
             highlightTaggingTriggers(thing->angle, &SpecialTagInfo::po, &SpecialTagInfo::numpo);
     }
@@ -2211,8 +2540,6 @@ void UI_Canvas::RenderSector(int num)
 	rgb_color_t light_col = SectorLightColor(inst.level.sectors[num]->light);
 	bool light_and_tex = false;
 
-	SString tex_name;
-
 	Img_c * img = NULL;
 
 	if (inst.edit.sector_render_mode == SREND_Lighting)
@@ -2239,19 +2566,23 @@ void UI_Canvas::RenderSector(int num)
 		if (inst.edit.sector_render_mode <= SREND_Ceiling)
 			light_and_tex = true;
 
+		StringID tex_name;
+
 		if (inst.edit.sector_render_mode == SREND_Ceiling ||
 			inst.edit.sector_render_mode == SREND_CeilBright)
-			tex_name = inst.level.sectors[num]->CeilTex();
+			tex_name = inst.level.sectors[num]->ceil_tex;
 		else
-			tex_name = inst.level.sectors[num]->FloorTex();
+			tex_name = inst.level.sectors[num]->floor_tex;
+
+		const resolved_image_t &res = inst.wad.images.resolveFlat(inst.conf, tex_name);
 
-		if (inst.is_sky(tex_name))
+		if (res.sky)
 		{
 			RenderColor(inst.wad.palette.getPaletteColor(inst.conf.miscInfo.sky_color));
 		}
 		else
 		{
-			img = inst.wad.images.getMutableFlat(inst.conf, tex_name);
+			img = res.img;
 
 			if (! img)
 			{
@@ -2333,46 +2664,15 @@ void UI_Canvas::RenderSector(int num)
 				continue;
 			}
 
-			int x = sx1;
-			int span_w = sx2 - sx1 + 1;
-
-			u8_t *dest = rgb_buf + ((x - rgb_x) + (y - rgb_y) * rgb_w) * 3;
-			u8_t *dest_end = dest + span_w * 3;
-
 			// the logic here for non-64x64 textures matches the software
 			// 3D renderer, but is different than ZDoom (which scales them).
 			int ty = (0 - (int)MAPY(y)) & (th - 1);
 
-			if (light_and_tex)
-			{
-				int r = RGB_RED(light_col)   * 0x101;
-				int g = RGB_GREEN(light_col) * 0x101;
-				int b = RGB_BLUE(light_col)  * 0x101;
-
-				for (; dest < dest_end ; dest += 3, x++)
-				{
-					int tx = (int)MAPX(x) & (tw - 1);
-
-					img_pixel_t pix = src_pix[ty * tw + tx];
+			TileRaster::Color light = { (byte)RGB_RED(light_col), (byte)RGB_GREEN(light_col), (byte)RGB_BLUE(light_col) };
 
-					inst.wad.palette.decodePixel(pix, dest[0], dest[1], dest[2]);
-
-					dest[0] = (u8_t)(((int)dest[0] * r) >> 16);
-					dest[1] = (u8_t)(((int)dest[1] * g) >> 16);
-					dest[2] = (u8_t)(((int)dest[2] * b) >> 16);
-				}
-			}
-			else  // fullbright version
-			{
-				for (; dest < dest_end ; dest += 3, x++)
-				{
-					int tx = (int)MAPX(x) & (tw - 1);
-
-					img_pixel_t pix = src_pix[ty * tw + tx];
-
-					inst.wad.palette.decodePixel(pix, dest[0], dest[1], dest[2]);
-				}
-			}
+			raster.flatSpan(y - rgb_y, sx1 - rgb_x, sx2 - rgb_x, src_pix + ty * tw, tw,
+							inst.grid.orig.x, w() / 2, inst.grid.Scale,
+							light_and_tex ? &light : NULL);
 		}
 	}
 
@@ -2452,6 +2752,8 @@ void UI_Canvas::PrepareToDraw()
 
 		rgb_buf = new byte[rgb_w * rgb_h * 3];
 	}
+
+	raster.begin(rgb_buf, rgb_w, rgb_h, inst.wad.palette);
 #endif
 }
 
@@ -2459,11 +2761,117 @@ void UI_Canvas::PrepareToDraw()
 void UI_Canvas::Blit()
 {
 #ifdef NO_OPENGL
+	raster.finish();
+
 	fl_draw_image(rgb_buf, x(), y(), w(), h());
 #endif
 }
 
 
+//
+// The cached map is only used when nothing but RedrawOverlay() was
+// requested since the last draw, and the view is the same.  Anything
+// else (edits, mode changes, expose events) asks for a full redraw.
+//
+bool UI_Canvas::CanReuseMap() const
+{
+	if (! map_cached || damage() != FL_DAMAGE_USER1)
+		return false;
+
+	return cached_key == MapCacheKey(inst, x(), y(), w(), h());
+}
+
+
+//
+// In the sound propagation view the sector colours follow the
+// highlighted sector, so it is part of the key there.
+//
+map_cache_key_t UI_Canvas::MapCacheKey(const Instance &inst, int X, int Y, int W, int H)
+{
+	map_cache_key_t key;
+
+	key.orig_x = inst.grid.orig.x;
+	key.orig_y = inst.grid.orig.y;
+	key.scale  = inst.grid.Scale;
+
+	key.x = X;
+	key.y = Y;
+	key.w = W;
+	key.h = H;
+
+	if (inst.edit.sector_render_mode == SREND_SoundProp &&
+		inst.edit.mode == ObjType::sectors && inst.edit.highlight.valid())
+	{
+		key.sound_sector = inst.edit.highlight.num;
+	}
+
+	return key;
+}
+
+
+void UI_Canvas::SaveMapCache()
+{
+#ifdef NO_OPENGL
+	raster.finish();
+
+	map_cache.assign(rgb_buf, rgb_buf + rgb_w * rgb_h * 3);
+#else
+	if (map_tex == 0)
+		glGenTextures(1, &map_tex);
+
+	glBindTexture(GL_TEXTURE_2D, map_tex);
+
+	if (map_tex_w < gl_w || map_tex_h < gl_h)
+	{
+		// use power-of-two sizes, the framebuffer is copied into a corner
+		for (map_tex_w = 64 ; map_tex_w < gl_w ; map_tex_w *= 2) { }
+		for (map_tex_h = 64 ; map_tex_h < gl_h ; map_tex_h *= 2) { }
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, map_tex_w, map_tex_h, 0,
+					 GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, gl_w, gl_h);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+#endif
+
+	map_cached = true;
+
+	cached_key = MapCacheKey(inst, x(), y(), w(), h());
+}
+
+
+void UI_Canvas::RestoreMapCache()
+{
+#ifdef NO_OPENGL
+	memcpy(rgb_buf, map_cache.data(), map_cache.size());
+#else
+	float tx = gl_w / (float)map_tex_w;
+	float ty = gl_h / (float)map_tex_h;
+
+	glColor3f(1, 1, 1);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, map_tex);
+
+	glBegin(GL_QUADS);
+
+	glTexCoord2f(0,  0);  glVertex2i(0,   0);
+	glTexCoord2f(0,  ty); glVertex2i(0,   h());
+	glTexCoord2f(tx, ty); glVertex2i(w(), h());
+	glTexCoord2f(tx, 0);  glVertex2i(w(), 0);
+
+	glEnd();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_TEXTURE_2D);
+#endif
+}
+
+
 void UI_Canvas::RenderColor(Fl_Color c)
 {
 #ifdef NO_OPENGL
@@ -2496,83 +2904,11 @@ void UI_Canvas::RenderRect(int rx, int ry, int rw, int rh)
 
 #else
 	// software version
-	rx -= rgb_x;
-	ry -= rgb_y;
-
-	// clip to screen
-	if (rx + rw > rgb_w)
-	{
-		rw = rgb_w - rx;
-	}
-	if (rx < 0)
-	{
-		rw += rx;
-		rx = 0;
-	}
-	if (rw <= 0)
-		return;
-
-	if (ry + rh > rgb_h)
-	{
-		rh = rgb_h - ry;
-	}
-	if (ry < 0)
-	{
-		rh += ry;
-		ry = 0;
-	}
-	if (rh <= 0)
-		return;
-
-	// fast method for greyscale (especially BLACK)
-	if (cur_col.r == cur_col.g && cur_col.g == cur_col.b)
-	{
-		byte *dest = rgb_buf + (ry * rgb_w * 3) + (rx * 3);
-
-		for ( ; rh > 0 ; rh--, dest += (rgb_w * 3))
-			memset(dest, cur_col.r, rw * 3);
-
-		return;
-	}
-
-	// slower method for all other colors
-	byte *base = rgb_buf + (ry * rgb_w * 3) + (rx * 3);
-
-	for ( ; rh > 0 ; rh--, base += (rgb_w * 3))
-	{
-		byte *dest = base;
-
-		for (int w2 = rw ; w2 > 0 ; w2--)
-		{
-			*dest++ = cur_col.r;
-			*dest++ = cur_col.g;
-			*dest++ = cur_col.b;
-		}
-	}
+	raster.rect(rx - rgb_x, ry - rgb_y, rw, rh, cur_col);
 #endif
 }
 
 
-#ifdef NO_OPENGL
-enum outcode_flags_e
-{
-	O_TOP    = 1,
-	O_BOTTOM = 2,
-	O_LEFT   = 4,
-	O_RIGHT  = 8,
-};
-
-int UI_Canvas::Calc_Outcode(int x, int y)
-{
-	return
-		((y < 0)      ? O_TOP    : 0) |
-		((y >= rgb_h) ? O_BOTTOM : 0) |
-		((x < 0)      ? O_LEFT   : 0) |
-		((x >= rgb_w) ? O_RIGHT  : 0);
-}
-#endif // NO_OPENGL
-
-
 void UI_Canvas::RenderLine(int x1, int y1, int x2, int y2)
 {
 #ifndef NO_OPENGL
@@ -2582,158 +2918,7 @@ void UI_Canvas::RenderLine(int x1, int y1, int x2, int y2)
 	glEnd();
 #else
 	// software line drawing
-	if (x1 == x2)
-	{
-		if (y1 > y2)
-			std::swap(y1, y2);
-
-		RenderRect(x1, y1, thickness, y2 - y1 + thickness);
-		return;
-	}
-	if (y1 == y2)
-	{
-		if (x1 > x2)
-			std::swap(x1, x2);
-
-		RenderRect(x1, y1, x2 - x1 + thickness, thickness);
-		return;
-	}
-
-
-	// completely off the screen?
-	x1 -= rgb_x; y1 -= rgb_y;
-	x2 -= rgb_x; y2 -= rgb_y;
-
-	int out1 = Calc_Outcode(x1, y1);
-	int out2 = Calc_Outcode(x2, y2);
-
-	if (out1 & out2)
-		return;
-
-
-	// clip diagonal line to the map
-	// (this is the Cohen-Sutherland clipping algorithm)
-
-	while (out1 | out2)
-	{
-		// may be partially inside box, find an outside point
-		int outside = (out1 ? out1 : out2);
-
-		int dx = x2 - x1;
-		int dy = y2 - y1;
-
-		// this almost certainly cannot happen, but for the sake of
-		// robustness we check anyway (just in case)
-		if (dx == 0 && dy == 0)
-			return;
-
-		int new_x, new_y;
-
-		// clip to each side
-		if (outside & O_TOP)
-		{
-			new_y = 0;
-			new_x = x1 + dx * (new_y - y1) / dy;
-		}
-		else if (outside & O_BOTTOM)
-		{
-			new_y = rgb_h-1;
-			new_x = x1 + dx * (new_y - y1) / dy;
-		}
-		else if (outside & O_LEFT)
-		{
-			new_x = 0;
-			new_y = y1 + dy * (new_x - x1) / dx;
-		}
-		else
-		{
-			SYS_ASSERT(outside & O_RIGHT);
-
-			new_x = rgb_w-1;
-			new_y = y1 + dy * (new_x - x1) / dx;
-		}
-
-		if (out1)
-		{
-			x1 = new_x;
-			y1 = new_y;
-
-			out1 = Calc_Outcode(x1, y1);
-		}
-		else
-		{
-			SYS_ASSERT(out2);
-
-			x2 = new_x;
-			y2 = new_y;
-
-			out2 = Calc_Outcode(x2, y2);
-		}
-
-		if (out1 & out2)
-			return;
-	}
-
-
-	// this is the Bresenham line drawing algorithm
-	// (based on code from am_map.c in the GPL DOOM source)
-
-	int dx = x2 - x1;
-	int dy = y2 - y1;
-
-	int ax = 2 * (dx < 0 ? -dx : dx);
-	int ay = 2 * (dy < 0 ? -dy : dy);
-
-	int sx = dx < 0 ? -1 : 1;
-	int sy = dy < 0 ? -1 : 1;
-
-	int x = x1;
-	int y = y1;
-
-	if (ax > ay)  // horizontal stepping
-	{
-		int d = ay - ax/2;
-
-		raw_pixel(x, y);
-		if (thickness == 2 && y+1 < rgb_h) raw_pixel(x, y+1);
-
-		while (x != x2)
-		{
-			if (d>=0)
-			{
-				y += sy;
-				d -= ax;
-			}
-
-			x += sx;
-			d += ay;
-
-			raw_pixel(x, y);
-			if (thickness == 2 && y+1 < rgb_h) raw_pixel(x, y+1);
-		}
-	}
-	else   // vertical stepping
-	{
-		int d = ax - ay/2;
-
-		raw_pixel(x, y);
-		if (thickness == 2 && x+1 < rgb_w) raw_pixel(x+1, y);
-
-		while (y != y2)
-		{
-			if (d >= 0)
-			{
-				x += sx;
-				d -= ay;
-			}
-
-			y += sy;
-			d += ax;
-
-			raw_pixel(x, y);
-			if (thickness == 2 && x+1 < rgb_w) raw_pixel(x+1, y);
-		}
-	}
+	raster.line(x1 - rgb_x, y1 - rgb_y, x2 - rgb_x, y2 - rgb_y, thickness, cur_col);
 #endif
 }
 
@@ -2812,35 +2997,7 @@ void UI_Canvas::RenderFontChar(int rx, int ry, Img_c *img, int ix, int iy, int i
 #ifdef NO_OPENGL
 	// software rendering
 
-	rx -= rgb_x;
-	ry -= rgb_y;
-
-	// clip to screen
-	int sx1 = std::max(rx, 0);
-	int sy1 = std::max(ry, 0);
-
-	int sx2 = std::min(rx + iw, rgb_w) - 1;
-	int sy2 = std::min(ry + ih, rgb_h) - 1;
-
-	if (sx1 >= sx2 || sy1 >= sy2)
-		return;
-
-	for (int sy = sy1 ; sy <= sy2 ; sy++, iy++)
-	{
-		const img_pixel_t *src = img->buf() + (ix + iy * img->width());
-
-		byte *dest = rgb_buf + 3 * (sx1 + sy * rgb_w);
-
-		for (int sx = sx1 ; sx <= sx2 ; sx++, dest += 3)
-		{
-			img_pixel_t pix = *src++;
-
-			if (pix != TRANS_PIXEL)
-			{
-				inst.wad.palette.decodePixel(pix, dest[0], dest[1], dest[2]);
-			}
-		}
-	}
+	raster.fontChar(rx - rgb_x, ry - rgb_y, *img, ix, iy, iw, ih);
 
 #else // OpenGL
 	int rx2 = rx + iw;
@@ -28,15 +28,91 @@
 #endif
 
 #include "m_events.h"
+#include "m_perf.h"
 #include "m_select.h"
 #include "e_objects.h"
 #include "r_grid.h"
+#include "r_raster.h"
 #include "sys_macro.h"
 
+#include <chrono>
+#include <vector>
+
 class Img_c;
 enum class Side;
 struct v2double_t;
 
+//
+// Level of detail: objects too small to see are merged, and drawn as a
+// batch of rectangles (in canvas coordinates).
+//
+struct lod_rect_t
+{
+	int x, y, w, h;
+	Fl_Color col;
+};
+
+//
+// Linedefs and vertices merged into per-pixel coverage, the last one
+// plotted wins.  Allocated on first use during a draw.
+//
+class lod_pixels_c
+{
+public:
+	void plot(int x, int y, int W, int H, Fl_Color col);
+
+	// runs of the same color, then empty again
+	void flush(int W, int H, std::vector<lod_rect_t> &rects);
+
+private:
+	std::vector<Fl_Color> pixels;
+	bool used = false;
+};
+
+//
+// Things counted in density cells, each drawn as one marker which is
+// bigger when the cell has more.  Allocated on first use during a draw.
+//
+class lod_things_c
+{
+public:
+	void add(int x, int y, int W, int H, Fl_Color col);
+
+	void flush(std::vector<lod_rect_t> &rects);
+
+private:
+	struct cell_t
+	{
+		int count;
+		Fl_Color col;
+	};
+
+	std::vector<cell_t> cells;
+	int cells_w = 0;
+	bool used = false;
+};
+
+//
+// What the cached map background depends on, besides the level itself
+//
+struct map_cache_key_t
+{
+	double orig_x = 0, orig_y = 0;
+	double scale = 0;
+
+	int x = 0, y = 0, w = 0, h = 0;
+
+	// the sector which sound propagation is shown from, or -1
+	int sound_sector = -1;
+
+	bool operator== (const map_cache_key_t &other) const
+	{
+		return orig_x == other.orig_x && orig_y == other.orig_y && scale == other.scale &&
+			x == other.x && y == other.y && w == other.w && h == other.h &&
+			sound_sector == other.sound_sector;
+	}
+};
+
 #ifdef NO_OPENGL
 class UI_Canvas : public Fl_Widget
 #else
@@ -72,10 +148,37 @@ private:
 	int rgb_x, rgb_y;
 	int rgb_w, rgb_h;
 	int thickness;
-	struct { byte r, g, b; } cur_col;
+	TileRaster::Color cur_col;
+
+	TileRaster raster;
 #endif
 	int cur_font;  // 14 or 19
 
+	// the background drawn by DrawMap(), kept for redraws where only
+	// the overlay (highlight, selection, selbox, etc) has changed.
+	bool map_cached;
+	map_cache_key_t cached_key;
+
+	// whether the last DrawEverything() could use the cached map
+	bool reused_map;
+
+#ifdef NO_OPENGL
+	std::vector<byte> map_cache;
+#else
+	// texture holding a copy of the framebuffer, and its size
+	unsigned int map_tex;
+	int map_tex_w, map_tex_h;
+
+	// size of the framebuffer in pixels
+	int gl_w, gl_h;
+#endif
+
+	// level of detail: objects too small to see are merged into
+	// per-pixel coverage (linedefs, vertices) or density cells (things).
+	lod_pixels_c lod_pixels;
+	lod_things_c lod_things;
+	std::vector<lod_rect_t> lod_rects;
+
 public:
 	UI_Canvas(Instance &inst, int X, int Y, int W, int H, const char *label = NULL);
 	virtual ~UI_Canvas();
@@ -93,6 +196,10 @@ public:
 
 	void DrawEverything();
 
+	// redraw without rebuilding the map background.  only valid when
+	// nothing drawn by DrawMap() has changed.
+	void RedrawOverlay();
+
 	void UpdateHighlight();
 
 	void CheckGridSnap();
@@ -114,6 +221,13 @@ public:
 	// return -1 if too small, 0 is OK, 1 is too big to fit
 	int ApproxBoxSize(int mx1, int my1, int mx2, int my2);
 
+	static map_cache_key_t MapCacheKey(const Instance &inst, int X, int Y, int W, int H);
+
+	// whether objects are too small to see, and get merged
+	static bool LodVertices(double scale);
+	static bool LodLine(int sx1, int sy1, int sx2, int sy2);
+	static bool LodThing(int radius, double scale);
+
 private:
 	// FLTK virtual method for drawing
 	void draw();
@@ -149,6 +263,12 @@ private:
 	void DrawCurrentLine();
 	void DrawSnapPoint();
 
+	void LodPlotPixel(int sx, int sy, Fl_Color col);
+	void LodFlushPixels();
+	void LodAddThing(int sx, int sy, Fl_Color col);
+	void LodFlushThings();
+	void LodDrawRects();
+
 	void SelboxDraw();
 
 	// calc screen-space normal of a line
@@ -188,6 +308,13 @@ private:
 	void PrepareToDraw();
 	void Blit();
 
+	bool CanReuseMap() const;
+	void SaveMapCache();
+	void RestoreMapCache();
+
+	void FinishFrame(FrameKind kind, std::chrono::steady_clock::time_point start);
+	void DrawPerfOverlay();
+
 	void RenderColor(Fl_Color c);
 	void RenderThickness(int w);
 	void RenderFontSize(int size);
@@ -201,20 +328,6 @@ private:
 	void RenderSprite(int sx, int sy, float scale, Img_c *img);
 	void RenderSector(int num);
 
-#ifdef NO_OPENGL
-	int Calc_Outcode(int x, int y);
-
-	// this is raw, it does no checking!
-	inline void raw_pixel(int rx, int ry) const
-	{
-		byte *dest = rgb_buf + (rx + ry * rgb_w) * 3;
-
-		dest[0] = cur_col.r;
-		dest[1] = cur_col.g;
-		dest[2] = cur_col.b;
-	}
-#endif
-
 	Instance &inst;
 };
 
@@ -528,10 +528,31 @@ void UI_StatusBar::draw()
 		break;
 	}
 
+	if (inst.edit.perf_display == PERF_StatusBar)
+		IB_ShowPerf(cy);
+
 	fl_pop_clip();
 }
 
 
+//
+// the performance figures, at the right end (over anything long)
+//
+void UI_StatusBar::IB_ShowPerf(int cy)
+{
+	SString text = inst.Perf_StatusText();
+
+	int tw = (int)fl_width(text.c_str());
+	int cx = x() + w() - tw - 10;
+
+	fl_color(fl_rgb_color(64, 64, 64));
+	fl_rectf(cx - 10, y(), tw + 20, h() - 1);
+
+	fl_color(INFO_DIM_COL);
+	fl_draw(text.c_str(), cx, cy);
+}
+
+
 void UI_StatusBar::IB_ShowDrag(int cx, int cy)
 {
 	if (inst.edit.render3d && inst.edit.mode == ObjType::sectors)
@@ -106,6 +106,7 @@ private:
 	void IB_ShowTransform(int cx, int cy);
 	void IB_ShowOffsets(int cx, int cy);
 	void IB_ShowDrawLine(int cx, int cy);
+	void IB_ShowPerf(int cy);
 
 	void IB_String(int& cx, int& cy, const char *str);
 	void IB_Number(int& cx, int& cy, const char *label, int value, int size);
@@ -394,6 +394,11 @@ static void tools_do_view_logs(Fl_Widget *w, void * data)
 	static_cast<Instance *>(data)->ExecuteCommand("LogViewer");
 }
 
+static void tools_do_trace_dump(Fl_Widget *w, void * data)
+{
+	static_cast<Instance *>(data)->ExecuteCommand("TraceDump");
+}
+
 static void tools_do_recalc_sectors(Fl_Widget *w, void * data)
 {
 	static_cast<Instance *>(data)->ExecuteCommand("RecalcSectors");
@@ -650,6 +655,7 @@ static Fl_Menu_Item menu_items[] =
 		{ "&Preferences",        FL_COMMAND + 'p', FCAL tools_do_preferences },
 #endif
 		{ "&View Logs",          0,  FCAL tools_do_view_logs },
+		{ "Dump Tra&ce",         0,  FCAL tools_do_trace_dump },
 		{ "&Recalc Sectors",     0,  FCAL tools_do_recalc_sectors },
 
 		{ "", 0, 0, 0, FL_MENU_DIVIDER|FL_MENU_INACTIVE },
@@ -717,6 +717,7 @@ public:
 
 	Fl_Check_Button *nod_on_save;
 	Fl_Check_Button *nod_fast;
+	Fl_Check_Button *nod_incremental;
 	Fl_Check_Button *nod_warn;
 
 	Fl_Choice *nod_factor;
@@ -1070,6 +1071,8 @@ UI_Preferences::UI_Preferences(const opt_desc_t *options) :
 		}
 		{ nod_warn = new Fl_Check_Button(50, 140, 220, 30, " Warning messages in the logs");
 		}
+		{ nod_incremental = new Fl_Check_Button(50, 170, 440, 30, " Incremental mode   (faster, may differ from a full build)");
+		}
 
 		{ Fl_Box* o = new Fl_Box(25, 205, 250, 30, "Advanced BSP Settings");
 		  o->labelfont(FL_BOLD);
@@ -1531,6 +1534,7 @@ void UI_Preferences::LoadValues()
 
 	nod_on_save->value(config::bsp_on_save ? 1 : 0);
 	nod_fast->value(config::bsp_fast ? 1 : 0);
+	nod_incremental->value(config::bsp_incremental ? 1 : 0);
 	nod_warn->value(config::bsp_warnings ? 1 : 0);
 
 	if (config::bsp_split_factor < 7)
@@ -1668,6 +1672,7 @@ void UI_Preferences::SaveValues()
 
 	config::bsp_on_save = nod_on_save->value() ? true : false;
 	config::bsp_fast = nod_fast->value() ? true : false;
+	config::bsp_incremental = nod_incremental->value() ? true : false;
 	config::bsp_warnings = nod_warn->value() ? true : false;
 
 	if (nod_factor->value() == 1)			// Minimize Splits
@@ -47,6 +47,9 @@ void ImageSet::W_ClearTextures()
 	textures.clear();
 
 	medusa_textures.clear();
+
+	resolved_textures.clear();
+	resolved_flats.clear();
 }
 
 
@@ -56,6 +59,9 @@ void ImageSet::W_AddTexture(const SString &name, Img_c &&img, bool is_medusa)
 
 	textures[name] = std::move(img);
 	medusa_textures[name] = is_medusa ? 1 : 0;
+
+	resolved_textures.clear();
+	resolved_flats.clear();
 }
 
 
@@ -462,6 +468,9 @@ SString NormalizeTex(const SString &name)
 void ImageSet::W_ClearFlats()
 {
 	flats.clear();
+
+	resolved_textures.clear();
+	resolved_flats.clear();
 }
 
 
@@ -469,6 +478,9 @@ void ImageSet::W_AddFlat(const SString &name, Img_c &&img)
 {
 	// find any existing one with same name, and free it
 	flats[name] = std::move(img);
+
+	resolved_textures.clear();
+	resolved_flats.clear();
 }
 
 
@@ -591,6 +603,27 @@ void ImageSet::W_ClearSprites()
 }
 
 
+size_t ImageSet::memoryUsage() const
+{
+	size_t total = 0;
+
+	auto add = [&total](const Img_c &img)
+	{
+		total += (size_t)img.width() * img.height() * sizeof(img_pixel_t);
+	};
+
+	for (const auto &pair : textures)
+		add(pair.second);
+	for (const auto &pair : flats)
+		add(pair.second);
+	for (const auto &pair : sprites)
+		if (pair.second)
+			add(*pair.second);
+
+	return total;
+}
+
+
 // find sprite by prefix
 static Lump_c * Sprite_loc_by_root (const MasterDir &master, const ConfigData &config, const SString &name)
 {
@@ -770,5 +803,55 @@ void ImageSet::W_UnloadAllTextures()
 	IM_UnloadDummyTextures();
 }
 
+
+//----------------------------------------------------------------------
+//    RESOLVED NAMES
+//----------------------------------------------------------------------
+
+static resolved_image_t &ResolvedEntry(std::vector<resolved_image_t> &table, StringID id)
+{
+	SYS_ASSERT(id.isValid());
+
+	if (id.get() >= (int)table.size())
+		table.resize(id.get() + 1);
+
+	return table[id.get()];
+}
+
+
+const resolved_image_t &ImageSet::resolveTexture(const ConfigData &config, StringID id)
+{
+	resolved_image_t &entry = ResolvedEntry(resolved_textures, id);
+
+	if (! entry.resolved)
+	{
+		SString name = BA_GetString(id);
+
+		entry.null_tex = is_null_tex(name);
+		entry.special = is_special_tex(name);
+		entry.img = getMutableTexture(config, name);
+		entry.resolved = true;
+	}
+
+	return entry;
+}
+
+
+const resolved_image_t &ImageSet::resolveFlat(const ConfigData &config, StringID id)
+{
+	resolved_image_t &entry = ResolvedEntry(resolved_flats, id);
+
+	if (! entry.resolved)
+	{
+		SString name = BA_GetString(id);
+
+		entry.sky = name.noCaseEqual(config.miscInfo.sky_flat);
+		entry.img = getMutableFlat(config, name);
+		entry.resolved = true;
+	}
+
+	return entry;
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
@@ -17,9 +17,13 @@
 //------------------------------------------------------------------------
 
 #include "Document.h"
+#include "e_basis.h"
 #include "Instance.h"
 #include "lib_adler.h"
 #include "LineDef.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
 #include "Thing.h"
 #include "Vertex.h"
 #include "gtest/gtest.h"
@@ -129,3 +133,138 @@ TEST_F(DocumentFixture, CRC)
 	ASSERT_EQ(crc.raw, crc3.raw);
 	ASSERT_EQ(crc.extra, crc3.extra);
 }
+
+//
+// The checksum as it was computed before, one field at a time
+//
+static crc32_c fieldByFieldChecksum(const Document &doc)
+{
+	crc32_c crc;
+
+	auto addSector = [&crc](const Sector &sector)
+	{
+		crc += sector.floorh;
+		crc += sector.ceilh;
+		crc += sector.light;
+		crc += sector.type;
+		crc += sector.tag;
+		crc += sector.FloorTex();
+		crc += sector.CeilTex();
+	};
+
+	auto addSide = [&](const SideDef *side)
+	{
+		crc += side->x_offset;
+		crc += side->y_offset;
+		crc += side->LowerTex();
+		crc += side->MidTex();
+		crc += side->UpperTex();
+		addSector(doc.getSector(*side));
+	};
+
+	for(const auto &thing : doc.things)
+	{
+		crc += thing->raw_x.raw();
+		crc += thing->raw_y.raw();
+		crc += thing->angle;
+		crc += thing->type;
+		crc += thing->options;
+	}
+	for(const auto &line : doc.linedefs)
+	{
+		crc += line->flags;
+		crc += line->type;
+		crc += line->tag;
+		crc += doc.getStart(*line).raw_x.raw();
+		crc += doc.getStart(*line).raw_y.raw();
+		crc += doc.getEnd(*line).raw_x.raw();
+		crc += doc.getEnd(*line).raw_y.raw();
+		if(doc.getRight(*line))
+			addSide(doc.getRight(*line));
+		if(doc.getLeft(*line))
+			addSide(doc.getLeft(*line));
+	}
+	return crc;
+}
+
+TEST(DocumentChecksum, SameAsFieldByFieldAndFollowsEdits)
+{
+	Instance inst;
+	selection_c selection;
+	inst.edit.Selected = &selection;
+	Document &doc = inst.level;
+
+	for(int i = 0; i < 3; ++i)
+	{
+		auto thing = std::make_unique<Thing>();
+		thing->raw_x = FFixedPoint(i * 100 - 50);
+		thing->raw_y = FFixedPoint(-i * 7);
+		thing->angle = i * 90;
+		thing->type = 3001 + i;
+		thing->options = 7;
+		doc.things.push_back(std::move(thing));
+
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(i * 64);
+		vertex->raw_y = FFixedPoint(-i * 32);
+		doc.vertices.push_back(std::move(vertex));
+	}
+
+	auto sector = std::make_unique<Sector>();
+	sector->floorh = -16;
+	sector->ceilh = 128;
+	sector->light = 160;
+	sector->floor_tex = BA_InternaliseString("FLOOR4_8");
+	sector->ceil_tex = BA_InternaliseString("CEIL3_5");
+	doc.sectors.push_back(std::move(sector));
+
+	for(int i = 0; i < 2; ++i)
+	{
+		auto side = std::make_unique<SideDef>();
+		side->x_offset = i * 3;
+		side->mid_tex = BA_InternaliseString(i ? "-" : "STARTAN3");
+		doc.sidedefs.push_back(std::move(side));
+
+		auto line = std::make_unique<LineDef>();
+		line->start = i;
+		line->end = i + 1;
+		line->right = i;
+		line->flags = 1;
+		line->tag = i * 5;
+		doc.linedefs.push_back(std::move(line));
+	}
+
+	crc32_c expected = fieldByFieldChecksum(doc);
+
+	crc32_c crc;
+	doc.getLevelChecksum(crc);
+	ASSERT_EQ(crc.raw, expected.raw);
+	ASSERT_EQ(crc.extra, expected.extra);
+
+	// the cached value is still right
+	crc32_c again;
+	doc.getLevelChecksum(again);
+	ASSERT_EQ(again.raw, expected.raw);
+	ASSERT_EQ(again.extra, expected.extra);
+
+	// edits made through the basis are seen
+	{
+		EditOperation op(doc.basis);
+		op.changeSector(0, Sector::F_LIGHT, 200);
+		op.changeVertex(2, Vertex::F_X, FFixedPoint(9));
+	}
+
+	crc32_c changed;
+	doc.getLevelChecksum(changed);
+	expected = fieldByFieldChecksum(doc);
+	ASSERT_EQ(changed.raw, expected.raw);
+	ASSERT_EQ(changed.extra, expected.extra);
+	ASSERT_NE(changed.raw, crc.raw);
+
+	ASSERT_TRUE(doc.basis.undo());
+
+	crc32_c undone;
+	doc.getLevelChecksum(undone);
+	ASSERT_EQ(undone.raw, crc.raw);
+	ASSERT_EQ(undone.extra, crc.extra);
+}
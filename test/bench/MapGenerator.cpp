@@ -0,0 +1,344 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "MapGenerator.hpp"
+
+#include "Document.h"
+#include "e_basis.h"
+#include "LineDef.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Thing.h"
+#include "Vertex.h"
+#include "w_rawdef.h"
+
+#include <algorithm>
+#include <math.h>
+#include <random>
+
+// all coordinates stay within this distance of the origin
+#define MAP_EXTENT  32000
+
+namespace
+{
+
+//
+// Adds the objects straight into the document, the way the level loaders do
+//
+class MapBuilder
+{
+public:
+	MapBuilder(Document &doc, uint32_t seed) : doc(doc), random(seed)
+	{
+		wall = BA_InternaliseString("STARTAN3");
+		step = BA_InternaliseString("STEP1");
+		none = BA_InternaliseString("-");
+		floor = BA_InternaliseString("FLOOR4_8");
+		ceil = BA_InternaliseString("CEIL3_5");
+	}
+
+	int vertex(int x, int y)
+	{
+		auto V = std::make_unique<Vertex>();
+		V->SetRawXY(MapFormat::doom, { (double)x, (double)y });
+		doc.vertices.push_back(std::move(V));
+		return doc.numVertices() - 1;
+	}
+
+	int sector(int floorh, int ceilh, int light)
+	{
+		auto S = std::make_unique<Sector>();
+		S->floorh = floorh;
+		S->ceilh = ceilh;
+		S->light = light;
+		S->floor_tex = floor;
+		S->ceil_tex = ceil;
+		doc.sectors.push_back(std::move(S));
+		return doc.numSectors() - 1;
+	}
+
+	//
+	// a line with the given sector on its right, and optionally on its left
+	//
+	void line(int v1, int v2, int right, int left = -1)
+	{
+		auto L = std::make_unique<LineDef>();
+		L->start = v1;
+		L->end = v2;
+		L->right = side(right, left >= 0);
+		L->left = left >= 0 ? side(left, true) : -1;
+		L->flags = left >= 0 ? MLF_TwoSided : MLF_Blocking;
+		doc.linedefs.push_back(std::move(L));
+	}
+
+	void thing(int x, int y, int type, int angle = 0)
+	{
+		auto T = std::make_unique<Thing>();
+		T->raw_x = FFixedPoint(x);
+		T->raw_y = FFixedPoint(y);
+		T->type = type;
+		T->angle = angle;
+		T->options = 7;
+		doc.things.push_back(std::move(T));
+	}
+
+	int below(int range)
+	{
+		return std::uniform_int_distribution<int>(0, range - 1)(random);
+	}
+
+private:
+	int side(int sec, bool two_sided)
+	{
+		auto SD = std::make_unique<SideDef>();
+		SD->sector = sec;
+		SD->mid_tex = two_sided ? none : wall;
+		SD->upper_tex = two_sided ? step : none;
+		SD->lower_tex = two_sided ? step : none;
+		doc.sidedefs.push_back(std::move(SD));
+		return doc.numSidedefs() - 1;
+	}
+
+	Document &doc;
+	std::mt19937 random;
+
+	StringID wall, step, none, floor, ceil;
+};
+
+//
+// W x H rooms sharing their walls. About one in eight cells is solid.
+//
+void GenerateCity(MapBuilder &build, int numLines)
+{
+	int size = std::max(2, (int)sqrt(numLines / 2.0));
+	int cell = std::clamp(2 * MAP_EXTENT / size, 32, 256);
+	int origin = -size * cell / 2;
+
+	std::vector<int> sectors(size * size, -1);
+
+	for (int i = 0 ; i < size * size ; i++)
+		if (i == 0 || build.below(8) != 0)
+			sectors[i] = build.sector(8 * build.below(6), 128 + 16 * build.below(8),
+									  96 + 16 * build.below(10));
+
+	auto sectorAt = [&](int x, int y)
+	{
+		if (x < 0 || y < 0 || x >= size || y >= size)
+			return -1;
+		return sectors[y * size + x];
+	};
+
+	std::vector<int> verts((size + 1) * (size + 1));
+
+	for (int y = 0 ; y <= size ; y++)
+		for (int x = 0 ; x <= size ; x++)
+			verts[y * (size + 1) + x] = build.vertex(origin + x * cell, origin + y * cell);
+
+	auto vertexAt = [&](int x, int y) { return verts[y * (size + 1) + x]; };
+
+	auto edge = [&](int v1, int v2, int right, int left)
+	{
+		if (right < 0 && left < 0)
+			return;
+		if (right < 0)
+			build.line(v2, v1, left);
+		else
+			build.line(v1, v2, right, left);
+	};
+
+	for (int y = 0 ; y <= size ; y++)
+		for (int x = 0 ; x <= size ; x++)
+		{
+			// going east the right side is south, going north it is east
+			if (x < size)
+				edge(vertexAt(x, y), vertexAt(x + 1, y), sectorAt(x, y - 1), sectorAt(x, y));
+			if (y < size)
+				edge(vertexAt(x, y), vertexAt(x, y + 1), sectorAt(x, y), sectorAt(x - 1, y));
+		}
+
+	build.thing(origin + cell / 2, origin + cell / 2, 1, 90);
+
+	for (int i = 1 ; i < size * size ; i += 4)
+		if (sectors[i] >= 0)
+			build.thing(origin + (i % size) * cell + cell / 2, origin + (i / size) * cell + cell / 2,
+						2001 + build.below(4), 45 * build.below(8));
+}
+
+//
+// A square arena with square pillars in a grid, and twice as many
+// monsters as linedefs (up to a limit).
+//
+void GenerateSlaughter(MapBuilder &build, int numLines)
+{
+	int pillars = std::max(1, (int)sqrt(numLines / 4.0));
+	int spacing = std::clamp(2 * MAP_EXTENT / (pillars + 1), 24, 192);
+	int width = spacing / 3;
+	int half = (pillars + 1) * spacing / 2;
+
+	int arena = build.sector(0, 256, 192);
+
+	// the outer wall, clockwise so the arena is on the right
+	int c1 = build.vertex(-half, -half);
+	int c2 = build.vertex(-half, half);
+	int c3 = build.vertex(half, half);
+	int c4 = build.vertex(half, -half);
+
+	build.line(c1, c2, arena);
+	build.line(c2, c3, arena);
+	build.line(c3, c4, arena);
+	build.line(c4, c1, arena);
+
+	// the pillars, anti-clockwise so the arena is on the right
+	for (int py = 0 ; py < pillars ; py++)
+		for (int px = 0 ; px < pillars ; px++)
+		{
+			int x = -half + (px + 1) * spacing - width / 2;
+			int y = -half + (py + 1) * spacing - width / 2;
+
+			int p1 = build.vertex(x, y);
+			int p2 = build.vertex(x + width, y);
+			int p3 = build.vertex(x + width, y + width);
+			int p4 = build.vertex(x, y + width);
+
+			build.line(p1, p2, arena);
+			build.line(p2, p3, arena);
+			build.line(p3, p4, arena);
+			build.line(p4, p1, arena);
+		}
+
+	build.thing(-half + spacing / 2, -half + spacing / 2, 1, 45);
+
+	static const int monsters[] = { 3004, 9, 3001, 3002, 3005, 66, 68, 3003, 16 };
+
+	int count = std::min(2 * numLines, 200000);
+
+	for (int i = 0 ; i < count ; i++)
+	{
+		// somewhere between the pillars
+		int gx = build.below(pillars + 1);
+		int gy = build.below(pillars + 1);
+
+		build.thing(-half + gx * spacing + spacing / 2, -half + gy * spacing + spacing / 2,
+					monsters[build.below((int)(sizeof(monsters) / sizeof(monsters[0])))],
+					45 * build.below(8));
+	}
+}
+
+//
+// Rows of comb shaped corridors: a spine along the bottom with narrow
+// teeth going up. Each row is a single sector of up to 4096 linedefs.
+//
+void GenerateCorridor(MapBuilder &build, int numLines)
+{
+	const int tooth = 32;
+	const int gap = 32;
+	const int spine = 32;
+	const int height = 64;
+	const int row_step = spine + height + 32;
+
+	int max_teeth = 2 * MAP_EXTENT / (tooth + gap) - 1;
+
+	int total_teeth = std::max(1, numLines / 4);
+	int rows = (total_teeth + max_teeth - 1) / max_teeth;
+
+	for (int row = 0 ; row < rows ; row++)
+	{
+		int teeth = std::min(max_teeth, total_teeth - row * max_teeth);
+
+		int sec = build.sector(0, 128 + 8 * (row % 4), 160);
+
+		int x0 = -MAP_EXTENT;
+		int y0 = -MAP_EXTENT + row * row_step;
+
+		// clockwise, so the corridor is on the right of every line
+		int first = build.vertex(x0, y0);
+		int prev = first;
+
+		for (int t = 0 ; t < teeth ; t++)
+		{
+			int x = x0 + t * (tooth + gap);
+
+			int up;
+			if (t == 0)
+				up = prev;
+			else
+			{
+				// the spine between two teeth
+				up = build.vertex(x, y0 + spine);
+				build.line(prev, up, sec);
+			}
+
+			int top_left = build.vertex(x, y0 + spine + height);
+			int top_right = build.vertex(x + tooth, y0 + spine + height);
+
+			build.line(up, top_left, sec);
+			build.line(top_left, top_right, sec);
+
+			if (t == teeth - 1)
+			{
+				int corner = build.vertex(x + tooth, y0);
+				build.line(top_right, corner, sec);
+				build.line(corner, first, sec);
+			}
+			else
+			{
+				prev = build.vertex(x + tooth, y0 + spine);
+				build.line(top_right, prev, sec);
+			}
+		}
+
+		if (row == 0)
+			build.thing(x0 + tooth / 2, y0 + spine / 2, 1, 0);
+
+		for (int t = 0 ; t < teeth ; t += 16)
+			build.thing(x0 + t * (tooth + gap) + tooth / 2, y0 + spine + height / 2,
+						3004, 270);
+	}
+}
+
+}  // namespace
+
+const char *MapShapeName(MapShape shape)
+{
+	switch (shape)
+	{
+	case MapShape::city:
+		return "city";
+	case MapShape::slaughter:
+		return "slaughter";
+	case MapShape::corridor:
+		return "corridor";
+	}
+	return "?";
+}
+
+void GenerateMap(Document &doc, MapShape shape, int numLines, uint32_t seed)
+{
+	MapBuilder build(doc, seed);
+
+	switch (shape)
+	{
+	case MapShape::city:
+		GenerateCity(build, numLines);
+		break;
+	case MapShape::slaughter:
+		GenerateSlaughter(build, numLines);
+		break;
+	case MapShape::corridor:
+		GenerateCorridor(build, numLines);
+		break;
+	}
+}
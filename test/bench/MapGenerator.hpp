@@ -2,8 +2,6 @@
 //
 //  Eureka DOOM Editor
 //
-//  Copyright (C) 2022 Ioan Chera
-//
 //  This program is free software; you can redistribute it and/or
 //  modify it under the terms of the GNU General Public License
 //  as published by the Free Software Foundation; either version 2
@@ -16,27 +14,30 @@
 //
 //------------------------------------------------------------------------
 
-#include "objid.h"
+#ifndef MapGenerator_hpp
+#define MapGenerator_hpp
+
+#include <stdint.h>
 
-class Instance;
 struct Document;
 
-void Render3D_NotifyBegin()
+//
+// Kinds of synthetic maps
+//
+enum class MapShape
 {
-}
+	city,		// a grid of rooms of various heights, with some solid blocks
+	slaughter,	// one big arena full of pillars and monsters
+	corridor,	// rows of comb shaped corridors, thousands of lines per sector
+};
 
-void Render3D_NotifyChange(ObjType type, int objnum, int field)
-{
-}
+const char *MapShapeName(MapShape shape);
 
-void Render3D_NotifyDelete(const Document &doc, ObjType type, int objnum)
-{
-}
-
-void Render3D_NotifyEnd(Instance &inst)
-{
-}
+//
+// Fills an empty document with a map of roughly the given number of
+// linedefs. The same arguments always give the same map. Coordinates
+// stay within the range of the binary map format.
+//
+void GenerateMap(Document &doc, MapShape shape, int numLines, uint32_t seed = 1);
 
-void Render3D_NotifyInsert(ObjType type, int objnum)
-{
-}
+#endif /* MapGenerator_hpp */
@@ -0,0 +1,533 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+//
+//  Benchmarks of the slow paths of the editor, on synthetic maps.
+//
+//  Usage: eureka_bench [--shapes city,slaughter,corridor]
+//                      [--sizes 1000,10000,100000] [--iterations 3]
+//                      [--only NAME] [--json FILE]
+//
+//  Sizes are approximate linedef counts, up to a million. The results go
+//  to stdout (or the given file) as JSON, progress goes to stderr.
+//
+//------------------------------------------------------------------------
+
+#include "MapGenerator.hpp"
+
+#include "bsp.h"
+#include "e_hover.h"
+#include "Errors.h"
+#include "Instance.h"
+#include "m_config.h"
+#include "m_select.h"
+#include "main.h"
+#include "r_subdiv.h"
+#include "Vertex.h"
+#include "w_wad.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// the most objects of a kind the binary map format can refer to
+#define BINARY_FORMAT_LIMIT  65535
+
+#define HOVER_QUERIES  1000
+
+//
+// Editor instance for the benchmarks, with what the level code needs
+//
+class BenchInstance : public Instance
+{
+public:
+	BenchInstance()
+	{
+		edit.Selected = &selection;
+	}
+
+private:
+	selection_c selection;
+};
+
+struct BenchOptions
+{
+	std::vector<MapShape> shapes = { MapShape::city, MapShape::slaughter, MapShape::corridor };
+	std::vector<int> sizes = { 1000, 10000, 100000 };
+	int iterations = 3;
+	std::string only;
+	std::string json;
+};
+
+struct BenchResult
+{
+	std::string name;
+	MapShape shape;
+	int size;
+	int linedefs;
+	int things;
+	std::vector<double> millis;
+};
+
+class BenchRunner
+{
+public:
+	explicit BenchRunner(const BenchOptions &options) : options(options)
+	{
+	}
+
+	void setMap(MapShape shape, int size, const Document &doc)
+	{
+		curShape = shape;
+		curSize = size;
+		curLines = doc.numLinedefs();
+		curThings = doc.numThings();
+	}
+
+	bool wanted(const std::string &name) const
+	{
+		return options.only.empty() || name.find(options.only) != std::string::npos;
+	}
+
+	//
+	// times the body, after an untimed setup, for each iteration
+	//
+	void run(const std::string &name, const std::function<void()> &setup,
+			 const std::function<void()> &body)
+	{
+		if (!wanted(name))
+			return;
+
+		fprintf(stderr, "  %s ...", name.c_str());
+		fflush(stderr);
+
+		BenchResult result = { name, curShape, curSize, curLines, curThings, {} };
+
+		for (int i = 0 ; i < options.iterations ; i++)
+		{
+			if (setup)
+				setup();
+
+			auto start = std::chrono::steady_clock::now();
+			body();
+			result.millis.push_back(std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - start).count());
+		}
+
+		fprintf(stderr, " %.2f ms\n", minimum(result.millis));
+		results.push_back(std::move(result));
+	}
+
+	//
+	// adds times measured elsewhere, for the current map
+	//
+	void add(const std::string &name, std::vector<double> &&millis)
+	{
+		results.push_back({ name, curShape, curSize, curLines, curThings, std::move(millis) });
+	}
+
+	void writeJSON(FILE *fp) const
+	{
+		fprintf(fp, "{\n  \"iterations\": %d,\n  \"results\": [", options.iterations);
+
+		for (size_t i = 0 ; i < results.size() ; i++)
+		{
+			const BenchResult &r = results[i];
+
+			double mean = 0;
+			for (double ms : r.millis)
+				mean += ms;
+			mean /= std::max<size_t>(1, r.millis.size());
+
+			fprintf(fp, "%s\n    { \"benchmark\": \"%s\", \"map\": \"%s\", \"size\": %d, "
+					"\"linedefs\": %d, \"things\": %d, \"min_ms\": %.3f, \"mean_ms\": %.3f }",
+					i ? "," : "", r.name.c_str(), MapShapeName(r.shape), r.size, r.linedefs,
+					r.things, minimum(r.millis), mean);
+		}
+
+		fprintf(fp, "%s]\n}\n", results.empty() ? "" : "\n  ");
+	}
+
+	static double minimum(const std::vector<double> &millis)
+	{
+		return millis.empty() ? 0 : *std::min_element(millis.begin(), millis.end());
+	}
+
+	const BenchOptions &options;
+
+private:
+	std::vector<BenchResult> results;
+
+	MapShape curShape = MapShape::city;
+	int curSize = 0;
+	int curLines = 0;
+	int curThings = 0;
+};
+
+
+static bool FitsBinaryFormat(const Document &doc)
+{
+	return doc.numVertices() <= BINARY_FORMAT_LIMIT && doc.numSidedefs() <= BINARY_FORMAT_LIMIT &&
+		   doc.numLinedefs() <= BINARY_FORMAT_LIMIT && doc.numSectors() <= BINARY_FORMAT_LIMIT;
+}
+
+
+//
+// saving, loading and building the nodes, in the given format
+//
+static void BenchFormat(BenchRunner &runner, BenchInstance &inst, const fs::path &dir,
+						MapFormat format, bool nodes)
+{
+	const char *suffix = (format == MapFormat::udmf) ? "udmf" : "doom";
+
+	inst.loaded.levelFormat = format;
+	inst.wad.master.edit_wad = Wad_file::Open(dir / (std::string(suffix) + ".wad"),
+											  WadOpenMode::write);
+	if (!inst.wad.master.edit_wad)
+		ThrowException("Cannot create the benchmark wad in %s\n", dir.u8string().c_str());
+
+	// save once even when not benchmarked, the rest needs the level
+	inst.SaveLevel("MAP01");
+
+	runner.run(std::string("save_") + suffix, nullptr, [&]()
+	{
+		inst.SaveLevel("MAP01");
+	});
+
+	BenchInstance loader;
+
+	runner.run(std::string("load_") + suffix, nullptr, [&]()
+	{
+		loader.LoadLevelNum(inst.wad.master.edit_wad.get(), 0);
+	});
+
+	if (nodes)
+	{
+		runner.run(std::string("nodes_") + suffix, nullptr, [&]()
+		{
+			nodebuildinfo_t info;
+			int lev_idx = inst.wad.master.edit_wad->LevelFind("MAP01");
+
+			build_result_e ret = AJBSP_BuildLevel(&info, lev_idx, inst);
+			if (ret != BUILD_OK && ret != BUILD_LumpOverflow)
+				ThrowException("Node building failed (%d)\n", (int)ret);
+		});
+
+		// rebuilding after a small edit, the first iteration has nothing
+		// to reuse so the minimum is the interesting figure
+		Vertex *nudged = inst.level.vertices[inst.level.numVertices() / 2].get();
+		double step = 1;
+
+		partition_memos_t memos;
+
+		runner.run(std::string("nodes_incremental_") + suffix, [&]()
+		{
+			v2double_t pos = nudged->xy();
+			pos.x += step;
+			step = -step;
+
+			nudged->SetRawXY(format, pos);
+		},
+		[&]()
+		{
+			nodebuildinfo_t info;
+			info.incremental = true;
+			info.memos = &memos;
+			int lev_idx = inst.wad.master.edit_wad->LevelFind("MAP01");
+
+			build_result_e ret = AJBSP_BuildLevel(&info, lev_idx, inst);
+			if (ret != BUILD_OK && ret != BUILD_LumpOverflow)
+				ThrowException("Node building failed (%d)\n", (int)ret);
+		});
+	}
+
+	inst.wad.master.edit_wad.reset();
+}
+
+
+static void BenchChecks(BenchRunner &runner, const BenchInstance &inst)
+{
+	if (!runner.wanted("check_"))
+		return;
+
+	fprintf(stderr, "  check_* ...");
+	fflush(stderr);
+
+	// one result per detector, timed by the checks themselves
+	std::map<std::string, std::vector<double>> millis;
+
+	for (int i = 0 ; i < runner.options.iterations ; i++)
+		for (int task = 0 ; task < ChecksModule::lintTaskCount() ; task++)
+		{
+			std::vector<lint_check_t> found;
+			inst.level.checks.lintTask(task, found);
+
+			for (const lint_check_t &check : found)
+				millis[std::string("check_") + check.name].push_back(check.millis);
+		}
+
+	double total = 0;
+
+	for (auto &pair : millis)
+	{
+		total += BenchRunner::minimum(pair.second);
+		runner.add(pair.first, std::move(pair.second));
+	}
+
+	fprintf(stderr, " %.2f ms\n", total);
+}
+
+
+static void BenchHover(BenchRunner &runner, BenchInstance &inst)
+{
+	static const ObjType types[] = { ObjType::things, ObjType::vertices, ObjType::linedefs,
+									 ObjType::sectors };
+
+	// the same points every time
+	std::vector<v2double_t> points;
+	std::mt19937 random(42);
+
+	for (int i = 0 ; i < HOVER_QUERIES ; i++)
+	{
+		std::uniform_real_distribution<double> xdist(inst.Map_bound1.x, inst.Map_bound2.x);
+		std::uniform_real_distribution<double> ydist(inst.Map_bound1.y, inst.Map_bound2.y);
+		points.push_back({ xdist(random), ydist(random) });
+	}
+
+	for (ObjType type : types)
+	{
+		runner.run(std::string("hover_") + NameForObjectType(type, true), nullptr, [&]()
+		{
+			for (const v2double_t &pos : points)
+				hover::getNearbyObject(type, inst.level, inst.conf, inst.grid, pos);
+		});
+	}
+}
+
+
+static void BenchSubdivision(BenchRunner &runner, BenchInstance &inst)
+{
+	std::vector<int> all(inst.level.numSectors());
+	for (int s = 0 ; s < inst.level.numSectors() ; s++)
+		all[s] = s;
+
+	auto invalidate = [&inst]()
+	{
+		inst.Subdiv_InvalidateAll();
+		inst.sector_info_cache.Update();
+	};
+
+	runner.run("subdivide_serial", invalidate, [&]()
+	{
+		inst.sector_info_cache.BuildPolygons(all, 1);
+	});
+
+	runner.run("subdivide_parallel", invalidate, [&]()
+	{
+		inst.sector_info_cache.BuildPolygons(all);
+	});
+}
+
+
+static void BenchSoftwareRender(BenchRunner &runner, BenchInstance &inst)
+{
+	// look across the map from the player start (the first thing)
+	const Thing &player = *inst.level.things[0];
+
+	inst.r_view.x = player.x();
+	inst.r_view.y = player.y();
+	inst.r_view.SetAngle(static_cast<float>(M_PI / 4));
+	inst.r_view.PrepareToRender(1280, 800);
+
+	runner.run("render_software", nullptr, [&]()
+	{
+		inst.SW_RenderToBuffer();
+	});
+}
+
+
+static void BenchMap(BenchRunner &runner, MapShape shape, int size, const fs::path &dir)
+{
+	BenchInstance inst;
+
+	GenerateMap(inst.level, shape, size);
+	inst.CalculateLevelBounds();
+
+	runner.setMap(shape, size, inst.level);
+
+	fprintf(stderr, "%s %d: %d linedefs, %d sectors, %d things\n", MapShapeName(shape), size,
+			inst.level.numLinedefs(), inst.level.numSectors(), inst.level.numThings());
+
+	bool binary = FitsBinaryFormat(inst.level);
+
+	if (binary)
+		BenchFormat(runner, inst, dir, MapFormat::doom, true);
+
+	BenchFormat(runner, inst, dir, MapFormat::udmf, !binary);
+
+	BenchChecks(runner, inst);
+	BenchHover(runner, inst);
+	BenchSubdivision(runner, inst);
+	BenchSoftwareRender(runner, inst);
+}
+
+
+static std::vector<std::string> SplitList(const char *arg)
+{
+	std::vector<std::string> list;
+	std::string item;
+
+	for (const char *p = arg ; ; p++)
+	{
+		if (*p == ',' || *p == 0)
+		{
+			if (!item.empty())
+				list.push_back(item);
+			item.clear();
+
+			if (*p == 0)
+				return list;
+		}
+		else
+			item += *p;
+	}
+}
+
+
+static bool ParseOptions(int argc, char *argv[], BenchOptions &options)
+{
+	for (int i = 1 ; i < argc ; i++)
+	{
+		std::string opt = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		const char *arg = argv[++i];
+
+		if (opt == "--shapes")
+		{
+			options.shapes.clear();
+
+			for (const std::string &name : SplitList(arg))
+			{
+				if (name == "city")
+					options.shapes.push_back(MapShape::city);
+				else if (name == "slaughter")
+					options.shapes.push_back(MapShape::slaughter);
+				else if (name == "corridor")
+					options.shapes.push_back(MapShape::corridor);
+				else
+					return false;
+			}
+		}
+		else if (opt == "--sizes")
+		{
+			options.sizes.clear();
+
+			for (const std::string &size : SplitList(arg))
+			{
+				int value = atoi(size.c_str());
+				if (value < 1 || value > 1000000)
+					return false;
+				options.sizes.push_back(value);
+			}
+		}
+		else if (opt == "--iterations")
+		{
+			options.iterations = atoi(arg);
+			if (options.iterations < 1)
+				return false;
+		}
+		else if (opt == "--only")
+			options.only = arg;
+		else if (opt == "--json")
+			options.json = arg;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+	BenchOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		fprintf(stderr, "Usage: %s [--shapes city,slaughter,corridor] [--sizes 1000,10000,...] "
+				"[--iterations N] [--only NAME] [--json FILE]\n", argv[0]);
+		return 2;
+	}
+
+	// keep the log off stdout, and the node builder from running on save
+	global::Quiet = true;
+	config::bsp_on_save = false;
+
+#ifdef _WIN32
+	fs::path dir = fs::temp_directory_path() / "eureka_bench";
+#else
+	fs::path dir = fs::temp_directory_path() /
+			("eureka_bench_" + std::to_string((long)getpid()));
+#endif
+	fs::create_directories(dir);
+
+	// user state, journals and recent files go there too
+	global::home_dir = dir;
+	global::cache_dir = dir;
+
+	BenchRunner runner(options);
+	int status = 0;
+
+	try
+	{
+		for (MapShape shape : options.shapes)
+			for (int size : options.sizes)
+				BenchMap(runner, shape, size, dir);
+	}
+	catch (const std::exception &e)
+	{
+		fprintf(stderr, "\nBenchmark failed: %s\n", e.what());
+		status = 1;
+	}
+
+	std::error_code ec;
+	fs::remove_all(dir, ec);
+
+	FILE *fp = options.json.empty() ? stdout : fopen(options.json.c_str(), "w");
+	if (!fp)
+	{
+		fprintf(stderr, "Cannot create %s\n", options.json.c_str());
+		return 1;
+	}
+
+	runner.writeJSON(fp);
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return status;
+}
@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "bsp.h"
+
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Vertex.h"
+#include "w_rawdef.h"
+#include "w_wad.h"
+
+#include "testUtils/TempDirContext.hpp"
+
+class BspIncremental : public TempDirContext
+{
+protected:
+	void SetUp() override;
+	void TearDown() override;
+
+	//
+	// builds the nodes of MAP01, returning the NODES and SEGS lumps
+	//
+	std::vector<byte> buildNodes(bool incremental, bool verify = false)
+	{
+		nodebuildinfo_t info;
+		info.incremental = incremental;
+		info.verify_incremental = verify;
+		info.memos = &memos;
+
+		const auto &wad = inst.wad.master.edit_wad;
+		int lev_idx = wad->LevelFind("MAP01");
+
+		EXPECT_EQ(AJBSP_BuildLevel(&info, lev_idx, inst), BUILD_OK);
+		EXPECT_EQ(info.total_warnings, 0);
+
+		std::vector<byte> data = wad->GetLump(wad->LevelLookupLump(lev_idx, "NODES"))->getData();
+		const std::vector<byte> &segs = wad->GetLump(wad->LevelLookupLump(lev_idx, "SEGS"))->getData();
+
+		data.insert(data.end(), segs.begin(), segs.end());
+		return data;
+	}
+
+	template<typename T>
+	std::vector<T> readLump(const char *name) const
+	{
+		const auto &wad = inst.wad.master.edit_wad;
+		const std::vector<byte> &data = wad->GetLump(wad->LevelLookupLump(wad->LevelFind("MAP01"), name))->getData();
+
+		std::vector<T> result(data.size() / sizeof(T));
+		if(!result.empty())
+			memcpy(result.data(), data.data(), result.size() * sizeof(T));
+		return result;
+	}
+
+	void checkValidNodes() const;
+
+	void moveVertex(int index, double dx)
+	{
+		Vertex *vertex = inst.level.vertices[index].get();
+		vertex->SetRawXY(MapFormat::doom, { vertex->x() + dx, vertex->y() });
+
+		inst.SaveLevel("MAP01");
+	}
+
+	Instance inst;
+	selection_c selection;
+	partition_memos_t memos;
+};
+
+//
+// The built nodes must form a valid tree: every subsector is convex, and
+// the inside of each room lands in a subsector of that room.
+//
+void BspIncremental::checkValidNodes() const
+{
+	auto vertices = readLump<raw_vertex_t>("VERTEXES");
+	auto segs = readLump<raw_seg_t>("SEGS");
+	auto subsecs = readLump<raw_subsec_t>("SSECTORS");
+	auto nodes = readLump<raw_node_t>("NODES");
+
+	ASSERT_FALSE(nodes.empty());
+
+	auto vertex = [&](int index)
+	{
+		return v2double_t(LE_S16(vertices[index].x), LE_S16(vertices[index].y));
+	};
+
+	for(const raw_subsec_t &sub : subsecs)
+	{
+		int first = LE_U16(sub.first);
+		int num = LE_U16(sub.num);
+
+		ASSERT_LE(first + num, (int)segs.size());
+
+		// all the segs are on the right of each other, give or take the
+		// rounding of the split vertices
+		for(int i = first; i < first + num; ++i)
+		{
+			v2double_t a = vertex(LE_U16(segs[i].start));
+			v2double_t b = vertex(LE_U16(segs[i].end));
+			v2double_t dir = b - a;
+
+			for(int k = first; k < first + num; ++k)
+			{
+				for(v2double_t p : { vertex(LE_U16(segs[k].start)), vertex(LE_U16(segs[k].end)) })
+				{
+					double cross = dir.x * (p.y - a.y) - dir.y * (p.x - a.x);
+					ASSERT_LE(cross / dir.hypot(), 1.0) << "seg " << i << " against seg " << k;
+				}
+			}
+		}
+	}
+
+	for(int row = 0; row < 4; row++)
+	for(int col = 0; col < 4; col++)
+	for(int y = 4; y < 64; y += 8)
+	for(int x = 4; x < 64; x += 8)
+	{
+		v2double_t pos(col * 96.0 + x, row * 96.0 + y);
+
+		int child = (int)nodes.size() - 1;
+
+		while(!(child & 0x8000))
+		{
+			ASSERT_LT(child, (int)nodes.size());
+			const raw_node_t &node = nodes[child];
+
+			double dx = LE_S16(node.dx);
+			double dy = LE_S16(node.dy);
+
+			bool right = (pos.y - LE_S16(node.y)) * dx < (pos.x - LE_S16(node.x)) * dy;
+
+			child = LE_U16(right ? node.right : node.left);
+		}
+
+		int sub = child & 0x7FFF;
+		ASSERT_LT(sub, (int)subsecs.size());
+
+		const raw_seg_t &seg = segs[LE_U16(subsecs[sub].first)];
+		const LineDef *L = inst.level.linedefs[LE_U16(seg.linedef)].get();
+
+		int side = LE_U16(seg.flip) ? L->left : L->right;
+		ASSERT_GE(side, 0);
+		ASSERT_EQ(inst.level.sidedefs[side]->sector, row * 4 + col) << "at " << pos.x << "," << pos.y;
+	}
+}
+
+//
+// A 4x4 grid of separate square rooms
+//
+void BspIncremental::SetUp()
+{
+	TempDirContext::SetUp();
+
+	inst.edit.Selected = &selection;
+	inst.inhibit_node_build = true;
+
+	for (int row = 0 ; row < 4 ; row++)
+	for (int col = 0 ; col < 4 ; col++)
+	{
+		static const int corners[4][2] = { { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 } };
+
+		int sec = inst.level.numSectors();
+		int first = inst.level.numVertices();
+
+		inst.level.sectors.push_back(std::make_unique<Sector>());
+
+		for (int i = 0 ; i < 4 ; i++)
+		{
+			auto vertex = std::make_unique<Vertex>();
+			vertex->SetRawXY(MapFormat::doom, { col * 96.0 + corners[i][0],
+												row * 96.0 + corners[i][1] });
+			inst.level.vertices.push_back(std::move(vertex));
+
+			auto side = std::make_unique<SideDef>();
+			side->sector = sec;
+			side->mid_tex = BA_InternaliseString("STARTAN3");
+			inst.level.sidedefs.push_back(std::move(side));
+
+			// clockwise, so the sector is on the right
+			auto line = std::make_unique<LineDef>();
+			line->start = first + i;
+			line->end = first + (i + 1) % 4;
+			line->right = inst.level.numSidedefs() - 1;
+			line->flags = MLF_Blocking;
+			inst.level.linedefs.push_back(std::move(line));
+		}
+	}
+
+	fs::path path = getChildPath("nodes.wad");
+	mDeleteList.push(path);
+
+	inst.wad.master.edit_wad = Wad_file::Open(path, WadOpenMode::write);
+	ASSERT_TRUE(inst.wad.master.edit_wad);
+
+	inst.SaveLevel("MAP01");
+}
+
+void BspIncremental::TearDown()
+{
+	inst.wad.master.edit_wad.reset();
+
+	TempDirContext::TearDown();
+}
+
+TEST_F(BspIncremental, UnchangedLevelGivesTheSameNodes)
+{
+	std::vector<byte> full = buildNodes(false);
+	ASSERT_FALSE(full.empty());
+
+	// nothing to reuse, then everything
+	ASSERT_EQ(buildNodes(true), full);
+	ASSERT_EQ(buildNodes(true), full);
+	ASSERT_EQ(buildNodes(true, true), full);
+}
+
+TEST_F(BspIncremental, VerifyBuildsLikeAFullBuild)
+{
+	buildNodes(true);
+
+	// widen the last room
+	moveVertex(inst.level.numVertices() - 1, 8);
+	moveVertex(inst.level.numVertices() - 2, 8);
+
+	std::vector<byte> verified = buildNodes(true, true);
+
+	ASSERT_EQ(buildNodes(false), verified);
+
+	// a full build leaves nothing to reuse, the next build reuses it all
+	moveVertex(inst.level.numVertices() - 1, -8);
+	moveVertex(inst.level.numVertices() - 2, -8);
+
+	std::vector<byte> incremental = buildNodes(true);
+	ASSERT_FALSE(incremental.empty());
+	ASSERT_EQ(buildNodes(true), incremental);
+}
+
+TEST_F(BspIncremental, EditedLevelGivesValidNodes)
+{
+	buildNodes(true);
+	checkValidNodes();
+
+	// widen the last room, and move the first one over a bit
+	moveVertex(inst.level.numVertices() - 1, 8);
+	moveVertex(inst.level.numVertices() - 2, 8);
+
+	for(int i = 0; i < 4; i++)
+		moveVertex(i, -16);
+
+	buildNodes(true);
+	checkValidNodes();
+
+	buildNodes(true);
+	checkValidNodes();
+}
+
+TEST_F(BspIncremental, WrongMemosStillGiveValidNodes)
+{
+	std::vector<byte> full = buildNodes(false);
+	buildNodes(true);
+
+	// as if every signature collided with a subsector
+	for(partition_memo_t &memo : memos.nodes)
+		memo.position = -1;
+
+	ASSERT_EQ(buildNodes(true), full);
+	checkValidNodes();
+
+	// or with some other partition
+	for(partition_memo_t &memo : memos.nodes)
+		memo.position = 0;
+
+	buildNodes(true);
+	checkValidNodes();
+}
+
+TEST_F(BspIncremental, MemosAreKeptPerLevel)
+{
+	buildNodes(true);
+	ASSERT_FALSE(memos.nodes.empty());
+	ASSERT_EQ(memos.level_name, "MAP01");
+	ASSERT_EQ(memos.wad_path, SString(inst.wad.master.edit_wad->PathName().u8string()));
+
+	// a build of another wad or level starts afresh
+	memos.level_name = "MAP02";
+	std::vector<byte> full = buildNodes(false);
+	ASSERT_EQ(buildNodes(true), full);
+	ASSERT_EQ(memos.level_name, "MAP01");
+}
@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  Copyright (C) 2022 Ioan Chera
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "e_basis.h"
+#include "Instance.h"
+#include "m_config.h"
+#include "m_select.h"
+#include "Vertex.h"
+
+class BasisFixture : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		oldUndoMaxSpace = config::undo_max_space;
+		for(int i = 0; i < 4; ++i)
+			inst.level.vertices.push_back(std::make_unique<Vertex>());
+	}
+
+	void TearDown() override
+	{
+		config::undo_max_space = oldUndoMaxSpace;
+	}
+
+	Instance inst;
+	int oldUndoMaxSpace = 0;
+};
+
+//
+// Repeated changes of the same field within one operation take a single record
+//
+TEST_F(BasisFixture, CoalesceRepeatedChanges)
+{
+	Basis &basis = inst.level.basis;
+	{
+		EditOperation op(basis);
+		op.changeVertex(1, Vertex::F_X, FFixedPoint(1));
+	}
+	size_t single = basis.undoMemoryUsage();
+	ASSERT_GT(single, 0);
+	ASSERT_TRUE(basis.undo());
+
+	{
+		EditOperation op(basis);
+		for(int k = 1; k <= 100; ++k)
+			op.changeVertex(1, Vertex::F_X, FFixedPoint(k));
+		op.changeVertex(2, Vertex::F_Y, FFixedPoint(7));
+	}
+	ASSERT_EQ(inst.level.vertices[1]->x(), 100);
+	ASSERT_EQ(inst.level.vertices[2]->y(), 7);
+
+	// the redo step was dropped, so only the new group counts
+	size_t coalesced = basis.undoMemoryUsage();
+	ASSERT_LT(coalesced, 2 * single);
+
+	ASSERT_TRUE(basis.undo());
+	ASSERT_EQ(inst.level.vertices[1]->x(), 0);
+	ASSERT_EQ(inst.level.vertices[2]->y(), 0);
+	ASSERT_TRUE(basis.redo());
+	ASSERT_EQ(inst.level.vertices[1]->x(), 100);
+	ASSERT_EQ(inst.level.vertices[2]->y(), 7);
+	ASSERT_EQ(basis.undoMemoryUsage(), coalesced);
+}
+
+//
+// The oldest undo steps get dropped when going over the limit
+//
+TEST_F(BasisFixture, MemoryCap)
+{
+	Basis &basis = inst.level.basis;
+	config::undo_max_space = 1;
+
+	for(int g = 0; g < 20000; ++g)
+	{
+		EditOperation op(basis);
+		op.changeVertex(g & 3, Vertex::F_X, FFixedPoint(g));
+	}
+	ASSERT_LE(basis.undoMemoryUsage(), (size_t)1 << 20);
+
+	int undos = 0;
+	while(basis.undo())
+		++undos;
+	ASSERT_GT(undos, 0);
+	ASSERT_LT(undos, 20000);
+
+	basis.clearAll();
+	ASSERT_EQ(basis.undoMemoryUsage(), 0);
+}
+
+//
+// Records what the listeners get told
+//
+class RecordingListener : public ChangeListener
+{
+public:
+	void notifyBegin() override
+	{
+		events.push_back("begin");
+	}
+	void notifyInsert(ObjType type, int objnum, int count) override
+	{
+		std::string event = "insert " + std::to_string(objnum);
+		if(count > 1)
+			event += " x" + std::to_string(count);
+		events.push_back(event);
+	}
+	void notifyDelete(ObjType type, int objnum) override
+	{
+		events.push_back("delete " + std::to_string(objnum));
+	}
+	void notifyChanges(const ChangeBatch &changes) override
+	{
+		std::string event = "changes";
+		for(int objnum : changes.getObjects(ObjType::vertices))
+			event += " " + std::to_string(objnum);
+		if(changes.hasField(ObjType::vertices, Vertex::F_Y))
+			event += " y";
+		events.push_back(event);
+	}
+	void notifyEnd() override
+	{
+		events.push_back("end");
+	}
+
+	std::vector<std::string> events;
+};
+
+//
+// Field changes reach the listeners in one batch per operation
+//
+TEST_F(BasisFixture, BatchedNotifications)
+{
+	selection_c selection;
+	inst.edit.Selected = &selection;
+
+	RecordingListener listener;
+	Basis &basis = inst.level.basis;
+	basis.addListener(listener);
+	{
+		EditOperation op(basis);
+		for(int i = 3; i >= 0; --i)
+		{
+			op.changeVertex(i, Vertex::F_X, FFixedPoint(i + 10));
+			op.changeVertex(i, Vertex::F_X, FFixedPoint(i + 20));
+		}
+		op.changeVertex(1, Vertex::F_Y, FFixedPoint(5));
+	}
+	std::vector<std::string> expected = { "begin", "changes 3 2 1 0 y", "end" };
+	ASSERT_EQ(listener.events, expected);
+
+	// Insertions and deletions send the changes before them
+	listener.events.clear();
+	{
+		EditOperation op(basis);
+		op.changeVertex(2, Vertex::F_X, FFixedPoint(1));
+		op.addNew(ObjType::vertices);
+		op.changeVertex(4, Vertex::F_X, FFixedPoint(1));
+		op.del(ObjType::vertices, 0);
+	}
+	expected = { "begin", "changes 2", "insert 4", "changes 4", "delete 0", "end" };
+	ASSERT_EQ(listener.events, expected);
+
+	// Also on undo
+	listener.events.clear();
+	ASSERT_TRUE(basis.undo());
+	expected = { "begin", "insert 0", "changes 4", "delete 4", "changes 2", "end" };
+	ASSERT_EQ(listener.events, expected);
+
+	// Objects added together are told about once
+	listener.events.clear();
+	{
+		EditOperation op(basis);
+		op.changeVertex(2, Vertex::F_X, FFixedPoint(3));
+		ASSERT_EQ(op.addNew(ObjType::vertices, 3), 4);
+		inst.level.vertices[6]->raw_x = FFixedPoint(7);
+	}
+	expected = { "begin", "changes 2", "insert 4 x3", "end" };
+	ASSERT_EQ(listener.events, expected);
+	ASSERT_EQ(inst.level.numVertices(), 7);
+
+	// but one by one on undo
+	listener.events.clear();
+	ASSERT_TRUE(basis.undo());
+	expected = { "begin", "delete 6", "delete 5", "delete 4", "changes 2", "end" };
+	ASSERT_EQ(listener.events, expected);
+	ASSERT_EQ(inst.level.numVertices(), 4);
+
+	ASSERT_TRUE(basis.redo());
+	ASSERT_EQ(inst.level.vertices[6]->x(), 7);
+
+	// No changes, no batch
+	listener.events.clear();
+	{
+		EditOperation op(basis);
+	}
+	expected = { "begin", "end" };
+	ASSERT_EQ(listener.events, expected);
+
+	basis.removeListener(listener);
+	{
+		EditOperation op(basis);
+		op.changeVertex(0, Vertex::F_X, FFixedPoint(2));
+	}
+	ASSERT_EQ(listener.events, expected);
+}
@@ -24,9 +24,16 @@
 #include "e_hover.h"
 #include "Instance.h"
 #include "LineDef.h"
+#include "m_lint.h"
 #include "m_select.h"
 #include "Sector.h"
+#include "SideDef.h"
+#include "Thing.h"
 #include "ui_window.h"
+#include "Vertex.h"
+
+#include <chrono>
+#include <random>
 
 //==============================================================================
 //
@@ -281,3 +288,412 @@ TEST(EChecks, TagsApplyNewValue)
 
 	ASSERT_EQ(inst.level.checks.mLastTag, 1);	// changed again
 }
+
+//
+// Tests Things_FindStuckies against testing all pairs
+//
+TEST(EChecks, FindStuckies)
+{
+	Instance inst;
+
+	inst.conf.thing_types[1] = { 'p', 0, 16, 1.0f, "Player 1 start" };
+	inst.conf.thing_types[2035] = { 'd', THINGDEF_PASS, 10, 1.0f, "Barrel" };
+
+	// A one-sided wall across the middle
+	static const int coords[][2] = { { -4000, 100 }, { 4000, 132 } };
+	for(const auto &coord : coords)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(coord[0]);
+		vertex->raw_y = FFixedPoint(coord[1]);
+		inst.level.vertices.push_back(std::move(vertex));
+	}
+	auto line = std::make_unique<LineDef>();
+	line->start = 0;
+	line->end = 1;
+	line->right = 0;
+	inst.level.linedefs.push_back(std::move(line));
+
+	// Scattered things, some of them crowded together
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> coordinate(-3000, 3000);
+	std::uniform_int_distribution<int> nearby(-40, 40);
+	for(int i = 0; i < 600; ++i)
+	{
+		auto thing = std::make_unique<Thing>();
+		if(i % 3 == 2)
+		{
+			const Thing &previous = *inst.level.things.back();
+			thing->raw_x = previous.raw_x + FFixedPoint(nearby(random));
+			thing->raw_y = previous.raw_y + FFixedPoint(nearby(random));
+		}
+		else
+		{
+			thing->raw_x = FFixedPoint(coordinate(random));
+			thing->raw_y = FFixedPoint(coordinate(random) / 20 + 100);
+		}
+		thing->type = i % 7 == 0 ? 2035 : 1;
+		inst.level.things.push_back(std::move(thing));
+	}
+
+	selection_c stuck;
+	Things_FindStuckies(stuck, inst);
+
+	// Players overlap when their boxes do, and only the first one is marked
+	const Document &doc = inst.level;
+	int numStuck = 0;
+	for(int n = 0; n < doc.numThings(); ++n)
+	{
+		const Thing &T = *doc.things[n];
+		bool expected = false;
+		if(T.type == 1)
+		{
+			// walls need to cross the box, so it's shrunk a bit
+			expected = doc.objects.lineTouchesBox(0, T.x() - 15, T.y() - 15, T.x() + 15,
+												  T.y() + 15);
+			for(int n2 = n + 1; n2 < doc.numThings() && !expected; ++n2)
+			{
+				const Thing &T2 = *doc.things[n2];
+				expected = T2.type == 1 && fabs(T.x() - T2.x()) < 32 &&
+						fabs(T.y() - T2.y()) < 32;
+			}
+		}
+		ASSERT_EQ(stuck.get(n), expected) << "thing " << n;
+		numStuck += expected;
+	}
+
+	// Make sure the test covers both kinds of problems
+	ASSERT_GT(numStuck, 50);
+	ASSERT_LT(numStuck, 400);
+}
+
+//
+// Tests linting levels concurrently against running the checks in order
+//
+TEST(EChecks, LintLevels)
+{
+	auto addVertex = [](Document &doc, int x, int y)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(x);
+		vertex->raw_y = FFixedPoint(y);
+		doc.vertices.push_back(std::move(vertex));
+	};
+
+	// A square room, with an unused vertex and a zero-length line on an
+	// overlapping one, and a thing outside
+	auto makeLevel = [&addVertex](Instance &inst, int size)
+	{
+		Document &doc = inst.level;
+		doc.sectors.push_back(std::make_unique<Sector>());
+
+		addVertex(doc, 0, 0);
+		addVertex(doc, 0, size);
+		addVertex(doc, size, size);
+		addVertex(doc, size, 0);
+		addVertex(doc, 2 * size, 0);
+		addVertex(doc, size, 0);
+
+		for(int i = 0; i < 5; ++i)
+		{
+			auto side = std::make_unique<SideDef>();
+			side->sector = 0;
+			doc.sidedefs.push_back(std::move(side));
+
+			auto line = std::make_unique<LineDef>();
+			line->start = i < 4 ? i : 3;
+			line->end = i < 4 ? (i + 1) % 4 : 5;
+			line->right = i;
+			doc.linedefs.push_back(std::move(line));
+		}
+
+		auto thing = std::make_unique<Thing>();
+		thing->raw_x = FFixedPoint(-100);
+		thing->raw_y = FFixedPoint(-100);
+		thing->type = 1;
+		doc.things.push_back(std::move(thing));
+	};
+
+	Instance first, second;
+	makeLevel(first, 64);
+	makeLevel(second, 256);
+
+	auto findCheck = [](const lint_level_t &level, const char *name) -> const lint_check_t *
+	{
+		for(const lint_check_t &check : level.checks)
+			if(!strcmp(check.name, name))
+				return &check;
+		return nullptr;
+	};
+
+	std::vector<const Instance *> levels = { &first, nullptr, &second };
+	std::vector<lint_level_t> serial(3), parallel(3);
+	Lint_CheckLevels(levels, serial, 1);
+	Lint_CheckLevels(levels, parallel, 4);
+
+	ASSERT_TRUE(serial[1].checks.empty());
+	ASSERT_TRUE(parallel[1].checks.empty());
+
+	for(int i : { 0, 2 })
+	{
+		ASSERT_EQ(parallel[i].checks.size(), serial[i].checks.size());
+		ASSERT_GT(serial[i].checks.size(), 20u);
+		for(size_t k = 0; k < serial[i].checks.size(); ++k)
+		{
+			ASSERT_STREQ(parallel[i].checks[k].name, serial[i].checks[k].name);
+			ASSERT_EQ(parallel[i].checks[k].objects, serial[i].checks[k].objects);
+		}
+
+		const lint_check_t *check = findCheck(serial[i], "vertices.unused");
+		ASSERT_NE(check, nullptr);
+		ASSERT_EQ(check->objects, std::vector<int>{ 4 });
+		ASSERT_EQ(check->type, ObjType::vertices);
+
+		check = findCheck(serial[i], "linedefs.zero_length");
+		ASSERT_NE(check, nullptr);
+		ASSERT_EQ(check->objects, std::vector<int>{ 4 });
+		ASSERT_EQ(check->severity, 2);
+
+		check = findCheck(serial[i], "vertices.overlapping");
+		ASSERT_NE(check, nullptr);
+		ASSERT_EQ(check->objects.size(), 1u);
+
+		check = findCheck(serial[i], "things.in_void");
+		ASSERT_NE(check, nullptr);
+		ASSERT_EQ(check->objects, std::vector<int>{ 0 });
+	}
+
+	// The report
+	serial[0].name = "MAP01";
+	serial[1].name = "MAP\"02";
+	serial[1].error = "No things lump!\n";
+	serial[2].name = "MAP03";
+
+	FILE *fp = tmpfile();
+	ASSERT_NE(fp, nullptr);
+	Lint_WriteReport(fp, "test.wad", serial, 4, 12.5);
+
+	std::string report(ftell(fp), '\0');
+	rewind(fp);
+	ASSERT_EQ(fread(&report[0], 1, report.size(), fp), report.size());
+	fclose(fp);
+
+	ASSERT_NE(report.find("\"wad\": \"test.wad\""), std::string::npos);
+	ASSERT_NE(report.find("\"threads\": 4,"), std::string::npos);
+	ASSERT_NE(report.find("\"name\": \"MAP\\\"02\",\n      \"error\": \"No things lump!\\u000a\""),
+			  std::string::npos);
+	ASSERT_NE(report.find("{ \"name\": \"linedefs.zero_length\", \"severity\": \"major\", "
+						  "\"type\": \"linedefs\", \"ms\": "), std::string::npos);
+	ASSERT_NE(report.find("\"count\": 1, \"objects\": [4] }"), std::string::npos);
+
+	// balanced brackets, nothing after the end
+	int depth = 0;
+	bool in_string = false;
+	for(size_t i = 0; i < report.size(); ++i)
+	{
+		char ch = report[i];
+		if(in_string)
+		{
+			if(ch == '\\')
+				++i;
+			else if(ch == '"')
+				in_string = false;
+			continue;
+		}
+		if(ch == '"')
+			in_string = true;
+		else if(ch == '{' || ch == '[')
+			++depth;
+		else if(ch == '}' || ch == ']')
+		{
+			--depth;
+			ASSERT_GE(depth, 0);
+			if(depth == 0)
+			{
+				ASSERT_EQ(report.substr(i + 1), "\n");
+			}
+		}
+	}
+	ASSERT_EQ(depth, 0);
+}
+
+//
+// The previous way of finding crossings: sort by the left end, compare with
+// the following lines until they start right of the end
+//
+static void FindCrossingsBySort(selection_c &lines, const Document &doc)
+{
+	lines.change_type(ObjType::linedefs);
+
+	auto minX = [&doc](int n)
+	{
+		return std::min(doc.getStart(*doc.linedefs[n]).raw_x, doc.getEnd(*doc.linedefs[n]).raw_x);
+	};
+	auto maxX = [&doc](int n)
+	{
+		return std::max(doc.getStart(*doc.linedefs[n]).raw_x, doc.getEnd(*doc.linedefs[n]).raw_x);
+	};
+
+	std::vector<int> sorted(doc.numLinedefs());
+	for(int n = 0; n < doc.numLinedefs(); ++n)
+		sorted[n] = n;
+	std::sort(sorted.begin(), sorted.end(), [&minX](int a, int b) { return minX(a) < minX(b); });
+
+	for(size_t n = 0; n < sorted.size(); ++n)
+		for(size_t k = n + 1; k < sorted.size() && !(maxX(sorted[n]) < minX(sorted[k])); ++k)
+			if(CheckLinesCross(sorted[n], sorted[k], doc))
+			{
+				lines.set(sorted[n]);
+				lines.set(sorted[k]);
+			}
+}
+
+static void AddLine(Document &doc, double x1, double y1, double x2, double y2)
+{
+	for(int i = 0; i < 2; ++i)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(i ? x2 : x1);
+		vertex->raw_y = FFixedPoint(i ? y2 : y1);
+		doc.vertices.push_back(std::move(vertex));
+	}
+	auto line = std::make_unique<LineDef>();
+	line->start = doc.numVertices() - 2;
+	line->end = doc.numVertices() - 1;
+	doc.linedefs.push_back(std::move(line));
+}
+
+//
+// Rooms on a grid, sharing walls, with some stray lines across them
+//
+static void MakeRooms(Document &doc, int size, int numStray, std::mt19937 &random)
+{
+	for(int y = 0; y < size; ++y)
+		for(int x = 0; x < size; ++x)
+		{
+			AddLine(doc, x * 128, y * 128, x * 128 + 128, y * 128);
+			AddLine(doc, x * 128, y * 128, x * 128, y * 128 + 128);
+			AddLine(doc, x * 128 + 32, y * 128 + 32, x * 128 + 96, y * 128 + 32);
+			AddLine(doc, x * 128 + 96, y * 128 + 32, x * 128 + 64, y * 128 + 96);
+		}
+
+	std::uniform_int_distribution<int> coord(0, size * 16);
+	for(int i = 0; i < numStray; ++i)
+		AddLine(doc, coord(random) * 8, coord(random) * 8, coord(random) * 8, coord(random) * 8);
+}
+
+static void ExpectSameSelection(const selection_c &a, const selection_c &b, int count)
+{
+	for(int n = 0; n < count; ++n)
+		ASSERT_EQ(a.get(n), b.get(n)) << "linedef " << n;
+}
+
+TEST(EChecks, FindCrossings)
+{
+	std::mt19937 random(5678);
+
+	// Map-like, with T junctions, overlaps and touching ends on the lattice
+	{
+		Instance inst;
+		MakeRooms(inst.level, 12, 150, random);
+
+		selection_c expected, result;
+		FindCrossingsBySort(expected, inst.level);
+		LineDefs_FindCrossings(result, inst.level);
+		ExpectSameSelection(result, expected, inst.level.numLinedefs());
+		ASSERT_GT(expected.count_obj(), 100);
+		ASSERT_LT(expected.count_obj(), inst.level.numLinedefs());
+	}
+
+	// Long lines sharing the X range, near misses and co-linear pieces
+	{
+		Instance inst;
+		Document &doc = inst.level;
+		std::uniform_real_distribution<double> offset(-0.05, 0.05);
+		for(int i = 0; i < 200; ++i)
+			AddLine(doc, -5000, i * 16, 5000, i * 16 + (i % 5 == 0 ? 1 : 0));
+		for(int i = 0; i < 60; ++i)
+			AddLine(doc, i * 150 - 4500, 3200 + offset(random), i * 150 - 4450, 3300);
+		for(int i = 0; i < 60; ++i)
+			AddLine(doc, i * 160 - 4800, 48 + offset(random), i * 160 - 4700, 48);
+		AddLine(doc, 7, -100, 7, 4000);
+		AddLine(doc, 100, 100, 100, 100);	// zero length
+
+		selection_c expected, result;
+		FindCrossingsBySort(expected, doc);
+		LineDefs_FindCrossings(result, doc);
+		ExpectSameSelection(result, expected, doc.numLinedefs());
+		ASSERT_GT(expected.count_obj(), 100);
+	}
+
+	// Nothing to find
+	{
+		Instance inst;
+		selection_c result;
+		LineDefs_FindCrossings(result, inst.level);
+		ASSERT_TRUE(result.empty());
+		AddLine(inst.level, 0, 0, 64, 0);
+		AddLine(inst.level, 64, 0, 64, 64);
+		LineDefs_FindCrossings(result, inst.level);
+		ASSERT_TRUE(result.empty());
+	}
+}
+
+//
+// Compares the speed of the crossing search with the previous one. Run with
+// --gtest_also_run_disabled_tests
+//
+TEST(EChecks, DISABLED_FindCrossingsBenchmark)
+{
+	auto run = [](const char *title, const Document &doc)
+	{
+		selection_c expected, result;
+
+		auto start = std::chrono::steady_clock::now();
+		FindCrossingsBySort(expected, doc);
+		auto middle = std::chrono::steady_clock::now();
+		LineDefs_FindCrossings(result, doc);
+		auto end = std::chrono::steady_clock::now();
+
+		ExpectSameSelection(result, expected, doc.numLinedefs());
+
+		printf("%-28s %6d lines, %6d crossing: sort %9.2f ms, grid %8.2f ms\n", title,
+			   doc.numLinedefs(), result.count_obj(),
+			   std::chrono::duration<double, std::milli>(middle - start).count(),
+			   std::chrono::duration<double, std::milli>(end - middle).count());
+	};
+
+	std::mt19937 random(1);
+
+	{
+		Instance inst;
+		MakeRooms(inst.level, 100, 0, random);
+		run("rooms", inst.level);
+	}
+	{
+		Instance inst;
+		MakeRooms(inst.level, 100, 2000, random);
+		run("rooms with stray lines", inst.level);
+	}
+	{
+		Instance inst;
+		for(int i = 0; i < 20000; ++i)
+			AddLine(inst.level, -30000, i * 3, 30000, i * 3);
+		run("stacked long lines", inst.level);
+	}
+	{
+		Instance inst;
+		for(int i = 0; i < 20000; ++i)
+			AddLine(inst.level, i % 50 * 8, i / 50 * 8, i % 50 * 8 + 4, i / 50 * 8 + 4);
+		run("narrow column of lines", inst.level);
+	}
+	{
+		Instance inst;
+		for(int i = 0; i < 300; ++i)
+		{
+			AddLine(inst.level, -3000, i * 20, 3000, i * 20);
+			AddLine(inst.level, i * 20 - 3000, -100, i * 20 - 3000, 6100);
+		}
+		run("lattice", inst.level);
+	}
+}
@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "e_cutpaste.h"
+
+#include "e_basis.h"
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_game.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Thing.h"
+#include "Vertex.h"
+#include "w_rawdef.h"
+
+#include "gtest/gtest.h"
+
+class ECutPaste : public ::testing::Test
+{
+protected:
+	ECutPaste() : selection(ObjType::sectors)
+	{
+	}
+
+	void SetUp() override;
+
+	int countTwoSided() const
+	{
+		int count = 0;
+		for (const auto &L : inst.level.linedefs)
+			if (L->TwoSided())
+				count++;
+		return count;
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+//
+// A 64x64 square sector, with a thing facing east in the middle
+//
+void ECutPaste::SetUp()
+{
+	static const int coords[4][2] = { { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 } };
+
+	inst.level.sectors.push_back(std::make_unique<Sector>());
+
+	for (int i = 0 ; i < 4 ; i++)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(coords[i][0]);
+		vertex->raw_y = FFixedPoint(coords[i][1]);
+		inst.level.vertices.push_back(std::move(vertex));
+
+		auto side = std::make_unique<SideDef>();
+		side->mid_tex = BA_InternaliseString("STARTAN3");
+		inst.level.sidedefs.push_back(std::move(side));
+
+		// clockwise, so the sector is on the right
+		auto line = std::make_unique<LineDef>();
+		line->start = i;
+		line->end = (i + 1) % 4;
+		line->right = i;
+		line->flags = MLF_Blocking;
+		inst.level.linedefs.push_back(std::move(line));
+	}
+
+	auto thing = std::make_unique<Thing>();
+	thing->raw_x = FFixedPoint(32);
+	thing->raw_y = FFixedPoint(32);
+	inst.level.things.push_back(std::move(thing));
+
+	inst.edit.mode = ObjType::sectors;
+	inst.edit.Selected = &selection;
+	inst.edit.pointer_in_window = false;
+
+	selection.set(0);
+	ASSERT_TRUE(inst.Clipboard_DoCopy());
+}
+
+TEST_F(ECutPaste, ArrayCopiesShareVerticesAndLines)
+{
+	ASSERT_TRUE(inst.Clipboard_DoPasteArray(2, 2, {}, 0));
+
+	// the copies are spaced by the size of the sector, around the origin,
+	// so they form a 3x3 grid of vertices with 12 lines between them
+	ASSERT_EQ(inst.level.numSectors(), 1 + 4);
+	ASSERT_EQ(inst.level.numVertices(), 4 + 9);
+	ASSERT_EQ(inst.level.numLinedefs(), 4 + 12);
+	ASSERT_EQ(inst.level.numSidedefs(), 4 + 16);
+	ASSERT_EQ(inst.level.numThings(), 1 + 4);
+
+	// the inner lines join two different copies
+	ASSERT_EQ(countTwoSided(), 4);
+
+	for (const auto &L : inst.level.linedefs)
+	{
+		if (! L->TwoSided())
+			continue;
+
+		ASSERT_NE(inst.level.getRight(*L)->sector, inst.level.getLeft(*L)->sector);
+		ASSERT_TRUE(L->flags & MLF_TwoSided);
+		ASSERT_FALSE(L->flags & MLF_Blocking);
+		ASSERT_TRUE(is_null_tex(inst.level.getRight(*L)->MidTex()));
+		ASSERT_FALSE(is_null_tex(inst.level.getRight(*L)->LowerTex()));
+	}
+
+	// only the new sectors are selected
+	ASSERT_EQ(selection.count_obj(), 4);
+	ASSERT_FALSE(selection.get(0));
+
+	// all of it is one undo step
+	ASSERT_TRUE(inst.level.basis.undo());
+	ASSERT_EQ(inst.level.numSectors(), 1);
+	ASSERT_EQ(inst.level.numVertices(), 4);
+	ASSERT_EQ(inst.level.numLinedefs(), 4);
+	ASSERT_EQ(inst.level.numSidedefs(), 4);
+	ASSERT_EQ(countTwoSided(), 0);
+}
+
+TEST_F(ECutPaste, ArrayRotatesEachCopy)
+{
+	ASSERT_TRUE(inst.Clipboard_DoPasteArray(3, 1, { 128, 0 }, 90));
+
+	// apart from each other, so nothing is welded
+	ASSERT_EQ(inst.level.numVertices(), 4 + 12);
+	ASSERT_EQ(inst.level.numLinedefs(), 4 + 12);
+	ASSERT_EQ(countTwoSided(), 0);
+
+	ASSERT_EQ(inst.level.things[1]->angle, 0);
+	ASSERT_EQ(inst.level.things[2]->angle, 90);
+	ASSERT_EQ(inst.level.things[3]->angle, 180);
+
+	// the first copy is centred on the paste position
+	ASSERT_EQ(inst.level.things[1]->xy(), v2double_t(0, 0));
+	ASSERT_EQ(inst.level.things[2]->xy(), v2double_t(128, 0));
+	ASSERT_EQ(inst.level.things[3]->xy(), v2double_t(256, 0));
+}
+
+TEST_F(ECutPaste, SinglePasteIsNotWelded)
+{
+	ASSERT_TRUE(inst.Clipboard_DoPasteArray(1, 1, {}, 0));
+
+	ASSERT_EQ(inst.level.numVertices(), 8);
+	ASSERT_EQ(inst.level.numLinedefs(), 8);
+	ASSERT_EQ(countTwoSided(), 0);
+}
+
+//
+// A normal paste gives the same objects as the original, moved over
+//
+TEST_F(ECutPaste, SinglePasteCopiesTheObjects)
+{
+	// a line with only a left side gets flipped when pasted
+	{
+		auto &L = inst.level.linedefs[1];
+		std::swap(L->start, L->end);
+		std::swap(L->left, L->right);
+	}
+	ASSERT_TRUE(inst.Clipboard_DoCopy());
+	{
+		auto &L = inst.level.linedefs[1];
+		std::swap(L->start, L->end);
+		std::swap(L->left, L->right);
+	}
+
+	ASSERT_TRUE(inst.Clipboard_DoPaste());
+
+	ASSERT_EQ(inst.level.numSectors(), 2);
+	ASSERT_EQ(inst.level.numVertices(), 8);
+	ASSERT_EQ(inst.level.numLinedefs(), 8);
+	ASSERT_EQ(inst.level.numSidedefs(), 8);
+	ASSERT_EQ(inst.level.numThings(), 2);
+
+	// everything moves along with the thing in the middle
+	v2double_t delta = inst.level.things[1]->xy() - inst.level.things[0]->xy();
+
+	for (int i = 0 ; i < 4 ; i++)
+		ASSERT_EQ(inst.level.vertices[4 + i]->xy(), inst.level.vertices[i]->xy() + delta);
+
+	for (int i = 0 ; i < 4 ; i++)
+	{
+		const LineDef &L = *inst.level.linedefs[i];
+		const LineDef &P = *inst.level.linedefs[4 + i];
+
+		ASSERT_EQ(inst.level.getStart(P).xy(), inst.level.getStart(L).xy() + delta);
+		ASSERT_EQ(inst.level.getEnd(P).xy(), inst.level.getEnd(L).xy() + delta);
+		ASSERT_GE(P.right, 4);
+		ASSERT_EQ(P.left, -1);
+		ASSERT_EQ(P.flags, L.flags);
+
+		const SideDef *SD = inst.level.getRight(P);
+		ASSERT_EQ(SD->sector, 1);
+		ASSERT_EQ(SD->mid_tex, inst.level.getRight(L)->mid_tex);
+	}
+
+	// only the new sector is selected
+	ASSERT_EQ(selection.count_obj(), 1);
+	ASSERT_TRUE(selection.get(1));
+
+	ASSERT_TRUE(inst.level.basis.undo());
+	ASSERT_EQ(inst.level.numVertices(), 4);
+	ASSERT_EQ(inst.level.numLinedefs(), 4);
+	ASSERT_EQ(inst.level.numThings(), 1);
+}
@@ -0,0 +1,333 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  Copyright (C) 2022 Ioan Chera
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "e_basis.h"
+#include "e_hover.h"
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_bitvec.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "Side.h"
+#include "SideDef.h"
+#include "Thing.h"
+#include "Vertex.h"
+
+//
+// Two square rooms side by side, sharing linedef #2
+//
+class HoverFixture : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		inst.edit.Selected = &selection;
+
+		static const int coords[][2] = { { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 }, { 128, 64 },
+			{ 128, 0 } };
+		for(const auto &coord : coords)
+			addVertex(coord[0], coord[1]);
+
+		for(int i = 0; i < 2; ++i)
+			doc().sectors.push_back(std::make_unique<Sector>());
+
+		addLine(0, 1, 0, -1);
+		addLine(1, 2, 0, -1);
+		addLine(2, 3, 0, 1);
+		addLine(3, 0, 0, -1);
+		addLine(2, 4, 1, -1);
+		addLine(4, 5, 1, -1);
+		addLine(5, 3, 1, -1);
+	}
+
+	Document &doc()
+	{
+		return inst.level;
+	}
+
+	void addVertex(int x, int y)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint(x);
+		vertex->raw_y = FFixedPoint(y);
+		doc().vertices.push_back(std::move(vertex));
+	}
+
+	int addSide(int sector)
+	{
+		if(sector < 0)
+			return -1;
+		auto side = std::make_unique<SideDef>();
+		side->sector = sector;
+		doc().sidedefs.push_back(std::move(side));
+		return doc().numSidedefs() - 1;
+	}
+
+	void addLine(int start, int end, int rightSector, int leftSector)
+	{
+		auto line = std::make_unique<LineDef>();
+		line->start = start;
+		line->end = end;
+		line->right = addSide(rightSector);
+		line->left = addSide(leftSector);
+		doc().linedefs.push_back(std::move(line));
+	}
+
+	int opposite(int ld, Side side, const bitvec_c *ignore = nullptr) const
+	{
+		Side oppSide;
+		return inst.level.hover.getOppositeLinedef(ld, side, &oppSide, ignore);
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+TEST_F(HoverFixture, OppositeSector)
+{
+	const Hover &hover = inst.level.hover;
+
+	ASSERT_EQ(hover.getOppositeSector(0, Side::right), 0);
+	ASSERT_EQ(hover.getOppositeSector(0, Side::left), -1);
+	ASSERT_EQ(hover.getOppositeSector(2, Side::left), 1);
+	ASSERT_EQ(hover.getOppositeSector(5, Side::right), 1);
+	ASSERT_EQ(hover.getOppositeSector(5, Side::left), -1);
+
+	// Ignored lines are looked through
+	bitvec_c ignore(doc().numLinedefs());
+	ASSERT_EQ(opposite(0, Side::right), 2);
+	ignore.set(2);
+	ASSERT_EQ(opposite(0, Side::right, &ignore), 5);
+}
+
+TEST_F(HoverFixture, OppositeFollowsEdits)
+{
+	Basis &basis = inst.level.basis;
+
+	ASSERT_EQ(opposite(2, Side::left), 5);
+
+	// Move the far wall
+	{
+		EditOperation op(basis);
+		op.changeVertex(4, Vertex::F_X, FFixedPoint(200));
+		op.changeVertex(5, Vertex::F_X, FFixedPoint(200));
+	}
+	ASSERT_EQ(opposite(2, Side::left), 5);
+
+	// Add a closer line. Its vertices are filled in after the query.
+	{
+		EditOperation op(basis);
+		int v1 = op.addNew(ObjType::vertices);
+		int v2 = op.addNew(ObjType::vertices);
+		int ld = op.addNew(ObjType::linedefs);
+		doc().linedefs[ld]->start = v1;
+		doc().linedefs[ld]->end = v2;
+		doc().linedefs[ld]->right = 0;
+
+		ASSERT_EQ(opposite(2, Side::left), 5);
+
+		doc().vertices[v1]->raw_x = FFixedPoint(100);
+		doc().vertices[v1]->raw_y = FFixedPoint(-10);
+		doc().vertices[v2]->raw_x = FFixedPoint(100);
+		doc().vertices[v2]->raw_y = FFixedPoint(80);
+	}
+	ASSERT_EQ(opposite(2, Side::left), 7);
+
+	ASSERT_TRUE(basis.undo());
+	ASSERT_EQ(opposite(2, Side::left), 5);
+	ASSERT_TRUE(basis.redo());
+	ASSERT_EQ(opposite(2, Side::left), 7);
+
+	// Deletion renumbers the lines
+	{
+		EditOperation op(basis);
+		op.del(ObjType::linedefs, 0);
+	}
+	ASSERT_EQ(opposite(1, Side::left), 6);
+
+	// Moving the new line away
+	{
+		EditOperation op(basis);
+		op.changeVertex(6, Vertex::F_X, FFixedPoint(300));
+		op.changeVertex(7, Vertex::F_X, FFixedPoint(300));
+	}
+	ASSERT_EQ(opposite(1, Side::left), 4);
+
+	ASSERT_TRUE(basis.undo());
+	ASSERT_TRUE(basis.undo());
+	ASSERT_EQ(opposite(2, Side::left), 7);
+}
+
+//
+// Queries during an operation only catch up with what changed since
+//
+TEST_F(HoverFixture, QueriesDuringOperationIndexOnce)
+{
+	Basis &basis = inst.level.basis;
+	const Hover &hover = inst.level.hover;
+
+	auto thing = std::make_unique<Thing>();
+	thing->raw_x = FFixedPoint(32);
+	thing->raw_y = FFixedPoint(32);
+	doc().things.push_back(std::move(thing));
+
+	ASSERT_EQ(hover.getThingSector(0), 0);
+	ASSERT_EQ(hover.indexedLineCount(), doc().numLinedefs());
+
+	int lines = hover.indexedLineCount();
+	int lookups;
+
+	{
+		EditOperation op(basis);
+		op.changeVertex(4, Vertex::F_X, FFixedPoint(120));
+		int th = op.addNew(ObjType::things);
+		doc().things[th]->raw_x = FFixedPoint(96);
+		doc().things[th]->raw_y = FFixedPoint(32);
+
+		ASSERT_EQ(opposite(2, Side::left), 5);
+		ASSERT_EQ(hover.getThingSector(th), 1);
+
+		// just the two lines at the vertex
+		ASSERT_EQ(hover.indexedLineCount() - lines, 2);
+		lookups = hover.thingLookupCount();
+
+		for(int i = 0; i < 10; ++i)
+		{
+			ASSERT_EQ(opposite(2, Side::left), 5);
+			ASSERT_EQ(hover.getThingSector(th), 1);
+			ASSERT_EQ(hover.getThingSector(0), 0);
+		}
+		ASSERT_EQ(hover.indexedLineCount() - lines, 2);
+		ASSERT_EQ(hover.thingLookupCount(), lookups);
+	}
+
+	// once more at the end, in case they got filled in after the queries
+	for(int i = 0; i < 10; ++i)
+		ASSERT_EQ(opposite(2, Side::left), 5);
+	ASSERT_EQ(hover.indexedLineCount() - lines, 4);
+}
+
+//
+// The indexed sector lookup agrees with testing all the lines
+//
+TEST_F(HoverFixture, NearestSector)
+{
+	auto checkPoints = [this]()
+	{
+		for(int y = -40; y <= 104; y += 4)
+			for(int x = -40; x <= 168; x += 4)
+			{
+				v2double_t pos = { x + 0.5 * (y & 4), static_cast<double>(y) };
+				Objid expected = hover::getNearestSector(doc(), pos);
+				Objid result = doc().hover.getNearestSector(pos);
+				ASSERT_EQ(result.type, expected.type);
+				ASSERT_EQ(result.num, expected.num) << pos.x << " " << pos.y;
+			}
+	};
+
+	ASSERT_EQ(doc().hover.getNearestSector({ 32, 32 }).num, 0);
+	ASSERT_EQ(doc().hover.getNearestSector({ 96, 32 }).num, 1);
+	ASSERT_TRUE(doc().hover.getNearestSector({ 32, 90 }).is_nil());
+	checkPoints();
+
+	// Stretch the second room
+	{
+		EditOperation op(inst.level.basis);
+		op.changeVertex(4, Vertex::F_Y, FFixedPoint(100));
+		op.changeVertex(5, Vertex::F_X, FFixedPoint(160));
+	}
+	ASSERT_EQ(doc().hover.getNearestSector({ 100, 70 }).num, 1);
+	checkPoints();
+}
+
+//
+// The cached thing sectors follow the edits
+//
+TEST_F(HoverFixture, ThingSectors)
+{
+	for(int y = -12; y <= 76; y += 8)
+		for(int x = -12; x <= 140; x += 8)
+		{
+			auto thing = std::make_unique<Thing>();
+			thing->raw_x = FFixedPoint(x);
+			thing->raw_y = FFixedPoint(y);
+			doc().things.push_back(std::move(thing));
+		}
+
+	auto checkThings = [this]()
+	{
+		for(int th = 0; th < doc().numThings(); ++th)
+		{
+			Objid expected = hover::getNearestSector(doc(), doc().things[th]->xy());
+			ASSERT_EQ(doc().hover.getThingSector(th), expected.num) << "thing " << th;
+		}
+	};
+
+	ASSERT_EQ(doc().hover.getThingSector(0), -1);
+	checkThings();
+
+	Basis &basis = inst.level.basis;
+
+	// Move the shared wall, some things change rooms
+	{
+		EditOperation op(basis);
+		op.changeVertex(2, Vertex::F_X, FFixedPoint(40));
+		op.changeVertex(3, Vertex::F_X, FFixedPoint(40));
+	}
+	checkThings();
+
+	// Move some things, and add a new one which gets placed afterwards
+	{
+		EditOperation op(basis);
+		op.changeThing(5, Thing::F_X, FFixedPoint(100));
+		op.changeThing(6, Thing::F_Y, FFixedPoint(30));
+		int th = op.addNew(ObjType::things);
+		doc().things[th]->raw_x = FFixedPoint(20);
+		doc().things[th]->raw_y = FFixedPoint(20);
+	}
+	checkThings();
+	ASSERT_EQ(doc().hover.getThingSector(doc().numThings() - 1), 0);
+
+	// Make the second room part of the first one
+	{
+		EditOperation op(basis);
+		for(int sd = 0; sd < doc().numSidedefs(); ++sd)
+			if(doc().sidedefs[sd]->sector == 1)
+				op.changeSidedef(sd, SideDef::F_SECTOR, 0);
+	}
+	checkThings();
+
+	ASSERT_TRUE(basis.undo());
+	checkThings();
+	ASSERT_TRUE(basis.undo());
+	checkThings();
+
+	// Deleting the first room's outer walls renumbers the lines
+	{
+		EditOperation op(basis);
+		op.del(ObjType::linedefs, 1);
+		op.del(ObjType::linedefs, 0);
+		op.del(ObjType::things, 3);
+	}
+	checkThings();
+
+	ASSERT_TRUE(basis.undo());
+	checkThings();
+}
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "e_path.h"
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "w_rawdef.h"
+
+#include <random>
+
+//
+// Sectors joined by lines without geometry, since the sound propagation
+// only looks at which sectors the lines join
+//
+class SoundPropFixture : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		inst.edit.Selected = &selection;
+	}
+
+	Document &doc()
+	{
+		return inst.level;
+	}
+
+	void addSector(int floorh, int ceilh)
+	{
+		auto sector = std::make_unique<Sector>();
+		sector->floorh = floorh;
+		sector->ceilh = ceilh;
+		doc().sectors.push_back(std::move(sector));
+	}
+
+	int addSide(int sector)
+	{
+		auto side = std::make_unique<SideDef>();
+		side->sector = sector;
+		doc().sidedefs.push_back(std::move(side));
+		return doc().numSidedefs() - 1;
+	}
+
+	void addLine(int sec1, int sec2, bool block)
+	{
+		auto line = std::make_unique<LineDef>();
+		line->right = addSide(sec1);
+		line->left = addSide(sec2);
+		line->flags = MLF_TwoSided | (block ? MLF_SoundBlock : 0);
+		doc().linedefs.push_back(std::move(line));
+	}
+
+	//
+	// The old way, rescanning all the lines until nothing changes
+	//
+	std::vector<int> propagateByRescan(int start_sec, bool ignore_doors)
+	{
+		std::vector<int> vec(doc().numSectors(), 0);
+		vec[start_sec] = 2;
+
+		bool changes;
+		do
+		{
+			changes = false;
+
+			for(const auto &L : doc().linedefs)
+			{
+				int sec1 = doc().getSectorID(*L, Side::right);
+				int sec2 = doc().getSectorID(*L, Side::left);
+
+				if(!ignore_doors &&
+				   std::min(doc().sectors[sec1]->ceilh, doc().sectors[sec2]->ceilh) <=
+				   std::max(doc().sectors[sec1]->floorh, doc().sectors[sec2]->floorh))
+				{
+					continue;
+				}
+
+				int new_val = std::max(vec[sec1], vec[sec2]);
+				if(L->flags & MLF_SoundBlock)
+					new_val -= 1;
+
+				for(int sec : { sec1, sec2 })
+					if(new_val > vec[sec])
+					{
+						vec[sec] = new_val;
+						changes = true;
+					}
+			}
+		} while(changes);
+
+		return vec;
+	}
+
+	int expectedLevel(int t1, int t2)
+	{
+		if(t1 != t2)
+		{
+			if(t1 == 0 || t2 == 0)
+				return PGL_Maybe;
+			t1 = std::min(t1, t2);
+		}
+		return t1 == 0 ? PGL_Never : t1 == 1 ? PGL_Level_1 : PGL_Level_2;
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+TEST_F(SoundPropFixture, Chain)
+{
+	// 0 -- 1 -| 2 -| 3 -| 4, and a closed door from 1 to 5
+	for(int i = 0; i < 5; ++i)
+		addSector(0, 128);
+	addSector(0, 0);
+
+	addLine(0, 1, false);
+	addLine(1, 2, true);
+	addLine(2, 3, true);
+	addLine(3, 4, true);
+	addLine(1, 5, false);
+
+	const byte *prop = inst.SoundPropagation(0);
+	ASSERT_EQ(prop[0], PGL_Level_2);
+	ASSERT_EQ(prop[1], PGL_Level_2);
+	ASSERT_EQ(prop[2], PGL_Level_1);
+	ASSERT_EQ(prop[3], PGL_Never);
+	ASSERT_EQ(prop[4], PGL_Never);
+	ASSERT_EQ(prop[5], PGL_Maybe);
+
+	prop = inst.SoundPropagation(3);
+	ASSERT_EQ(prop[0], PGL_Never);
+	ASSERT_EQ(prop[2], PGL_Level_1);
+	ASSERT_EQ(prop[3], PGL_Level_2);
+	ASSERT_EQ(prop[4], PGL_Level_1);
+
+	// Cached results are dropped when the level changes
+	doc().linedefs[2]->flags &= ~MLF_SoundBlock;
+	inst.sound_propagation_invalid = true;
+
+	prop = inst.SoundPropagation(0);
+	ASSERT_EQ(prop[3], PGL_Level_1);
+	ASSERT_EQ(prop[4], PGL_Never);
+}
+
+TEST_F(SoundPropFixture, SameAsRescanning)
+{
+	std::mt19937 random(1234);
+
+	const int numSectors = 300;
+
+	for(int i = 0; i < numSectors; ++i)
+		addSector((int)(random() % 3) * 64, 64 + (int)(random() % 3) * 64);
+
+	for(int i = 0; i < 700; ++i)
+	{
+		int sec1 = (int)(random() % numSectors);
+		int sec2 = (int)(random() % numSectors);
+		addLine(sec1, sec2, random() % 4 == 0);
+	}
+
+	for(int start = 0; start < numSectors; start += 7)
+	{
+		std::vector<int> t1 = propagateByRescan(start, false);
+		std::vector<int> t2 = propagateByRescan(start, true);
+
+		const byte *prop = inst.SoundPropagation(start);
+
+		for(int s = 0; s < numSectors; ++s)
+			ASSERT_EQ(prop[s], expectedLevel(t1[s], t2[s])) << "start " << start << " sector " << s;
+	}
+}
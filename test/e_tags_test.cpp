@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "e_basis.h"
+#include "e_tags.h"
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_select.h"
+#include "Sector.h"
+
+//
+// Sectors and linedefs with a few tags. The lines have no geometry, the
+// index doesn't look at it.
+//
+class TagIndexFixture : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		inst.edit.Selected = &selection;
+
+		for(int tag : { 0, 3, 5, 3, 0 })
+		{
+			auto sector = std::make_unique<Sector>();
+			sector->tag = tag;
+			doc().sectors.push_back(std::move(sector));
+		}
+		for(int tag : { 5, 0, 3, 7 })
+		{
+			auto line = std::make_unique<LineDef>();
+			line->tag = tag;
+			doc().linedefs.push_back(std::move(line));
+		}
+	}
+
+	Document &doc()
+	{
+		return inst.level;
+	}
+
+	std::vector<int> tagged(ObjType type, int tag) const
+	{
+		return inst.level.tags.objectsWithTag(type, tag);
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+TEST_F(TagIndexFixture, Lookup)
+{
+	const TagIndex &tags = inst.level.tags;
+
+	ASSERT_EQ(tagged(ObjType::sectors, 3), std::vector<int>({ 1, 3 }));
+	ASSERT_EQ(tagged(ObjType::sectors, 0), std::vector<int>({ 0, 4 }));
+	ASSERT_TRUE(tagged(ObjType::sectors, 7).empty());
+	ASSERT_EQ(tagged(ObjType::linedefs, 7), std::vector<int>({ 3 }));
+
+	ASSERT_TRUE(tags.tagExists(ObjType::sectors, 5));
+	ASSERT_FALSE(tags.tagExists(ObjType::sectors, 7));
+	ASSERT_TRUE(tags.tagExists(ObjType::linedefs, 7));
+
+	ASSERT_EQ(tags.tagMap(ObjType::linedefs).size(), 4u);
+	ASSERT_EQ(tags.tagMap(ObjType::linedefs).begin()->first, 0);
+	ASSERT_EQ(tags.tagMap(ObjType::linedefs).rbegin()->first, 7);
+
+	int min_tag, max_tag;
+	inst.level.checks.tagsUsedRange(&min_tag, &max_tag);
+	ASSERT_EQ(min_tag, 3);
+	ASSERT_EQ(max_tag, 7);
+}
+
+TEST_F(TagIndexFixture, FollowsEdits)
+{
+	Basis &basis = inst.level.basis;
+
+	ASSERT_EQ(tagged(ObjType::sectors, 3), std::vector<int>({ 1, 3 }));
+
+	{
+		EditOperation op(basis);
+		op.changeSector(4, Sector::F_TAG, 3);
+		op.changeSector(1, Sector::F_TAG, 9);
+	}
+	ASSERT_EQ(tagged(ObjType::sectors, 3), std::vector<int>({ 3, 4 }));
+	ASSERT_EQ(tagged(ObjType::sectors, 9), std::vector<int>({ 1 }));
+	ASSERT_EQ(tagged(ObjType::sectors, 0), std::vector<int>({ 0 }));
+
+	ASSERT_TRUE(basis.undo());
+	ASSERT_EQ(tagged(ObjType::sectors, 3), std::vector<int>({ 1, 3 }));
+	ASSERT_FALSE(inst.level.tags.tagExists(ObjType::sectors, 9));
+	ASSERT_TRUE(basis.redo());
+	ASSERT_EQ(tagged(ObjType::sectors, 9), std::vector<int>({ 1 }));
+
+	// Deletion renumbers the sectors
+	{
+		EditOperation op(basis);
+		op.del(ObjType::sectors, 0);
+	}
+	ASSERT_EQ(tagged(ObjType::sectors, 3), std::vector<int>({ 2, 3 }));
+	ASSERT_EQ(tagged(ObjType::sectors, 9), std::vector<int>({ 0 }));
+	ASSERT_FALSE(inst.level.tags.tagExists(ObjType::sectors, 0));
+
+	// The linedef tags are separate
+	{
+		EditOperation op(basis);
+		int ld = op.addNew(ObjType::linedefs);
+		op.changeLinedef(ld, LineDef::F_TAG, 9);
+		op.changeLinedef(0, LineDef::F_TAG, 3);
+	}
+	ASSERT_EQ(tagged(ObjType::linedefs, 9), std::vector<int>({ 4 }));
+	ASSERT_EQ(tagged(ObjType::linedefs, 3), std::vector<int>({ 0, 2 }));
+	ASSERT_FALSE(inst.level.tags.tagExists(ObjType::linedefs, 5));
+	ASSERT_EQ(tagged(ObjType::sectors, 9), std::vector<int>({ 0 }));
+
+	ASSERT_TRUE(basis.undo());
+	ASSERT_EQ(tagged(ObjType::linedefs, 5), std::vector<int>({ 0 }));
+	ASSERT_FALSE(inst.level.tags.tagExists(ObjType::linedefs, 9));
+}
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "Instance.h"
+
+#include "e_basis.h"
+#include "e_vertex.h"
+#include "LineDef.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Vertex.h"
+#include "w_rawdef.h"
+
+#include "gtest/gtest.h"
+
+class EVertexWeld : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		inst.edit.Selected = &selection;
+	}
+
+	//
+	// adds a sector made of its own vertices and one-sided lines, the
+	// corners given clockwise so the sector is on the right
+	//
+	void addSector(const std::vector<v2double_t> &corners)
+	{
+		int sec = inst.level.numSectors();
+		int first = inst.level.numVertices();
+		int count = (int)corners.size();
+
+		inst.level.sectors.push_back(std::make_unique<Sector>());
+
+		for (int i = 0 ; i < count ; i++)
+		{
+			auto vertex = std::make_unique<Vertex>();
+			vertex->SetRawXY(MapFormat::doom, corners[i]);
+			inst.level.vertices.push_back(std::move(vertex));
+
+			auto side = std::make_unique<SideDef>();
+			side->sector = sec;
+			side->mid_tex = BA_InternaliseString("STARTAN3");
+			inst.level.sidedefs.push_back(std::move(side));
+
+			auto line = std::make_unique<LineDef>();
+			line->start = first + i;
+			line->end = first + (i + 1) % count;
+			line->right = inst.level.numSidedefs() - 1;
+			line->flags = MLF_Blocking;
+			inst.level.linedefs.push_back(std::move(line));
+		}
+	}
+
+	int weldAll(double epsilon)
+	{
+		selection_c verts(ObjType::vertices);
+		verts.frob_range(0, inst.level.numVertices() - 1, BitOp::add);
+
+		EditOperation op(inst.level.basis);
+		return inst.level.vertmod.weldVertices(op, verts, epsilon);
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+TEST_F(EVertexWeld, CoincidentVerticesJoinSectors)
+{
+	addSector({ { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 } });
+	addSector({ { 64, 0 }, { 64, 64 }, { 128, 64 }, { 128, 0 } });
+
+	// nothing is close enough apart from the overlaps
+	ASSERT_EQ(weldAll(0), 2);
+
+	ASSERT_EQ(inst.level.numVertices(), 6);
+	ASSERT_EQ(inst.level.numLinedefs(), 7);
+	ASSERT_EQ(inst.level.numSidedefs(), 8);
+	ASSERT_EQ(inst.level.numSectors(), 2);
+
+	int two_sided = 0;
+	for (const auto &L : inst.level.linedefs)
+	{
+		if (! L->TwoSided())
+			continue;
+
+		two_sided++;
+		ASSERT_NE(inst.level.getRight(*L)->sector, inst.level.getLeft(*L)->sector);
+		ASSERT_TRUE(L->flags & MLF_TwoSided);
+		ASSERT_FALSE(L->flags & MLF_Blocking);
+	}
+	ASSERT_EQ(two_sided, 1);
+
+	// nothing left to weld
+	ASSERT_EQ(weldAll(0), 0);
+	ASSERT_EQ(inst.level.numLinedefs(), 7);
+}
+
+TEST_F(EVertexWeld, WithinDistance)
+{
+	addSector({ { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 } });
+	addSector({ { 65, 1 }, { 65, 64 }, { 128, 64 }, { 128, 0 } });
+
+	ASSERT_EQ(weldAll(1), 1);
+	ASSERT_EQ(inst.level.numVertices(), 7);
+
+	ASSERT_EQ(weldAll(2), 1);
+	ASSERT_EQ(inst.level.numVertices(), 6);
+	ASSERT_EQ(inst.level.numLinedefs(), 7);
+
+	// the vertices which are kept do not move
+	ASSERT_EQ(inst.level.vertices[3]->xy(), v2double_t(64, 0));
+}
+
+TEST_F(EVertexWeld, TinyDistanceOnlyWeldsOverlaps)
+{
+	addSector({ { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 } });
+	addSector({ { 64, 0 }, { 64, 64 }, { 128, 64 }, { 128, 1 } });
+
+	// the grid cells would be far out of int range here
+	ASSERT_EQ(weldAll(1e-12), 2);
+	ASSERT_EQ(inst.level.numVertices(), 6);
+	ASSERT_EQ(weldAll(1e-12), 0);
+}
+
+TEST_F(EVertexWeld, CollapsedLinesAreDeleted)
+{
+	// the bottom edge is split very close to a corner
+	addSector({ { 0, 0 }, { 0, 64 }, { 64, 64 }, { 64, 0 }, { 1, 0 } });
+
+	ASSERT_EQ(weldAll(2), 1);
+
+	ASSERT_EQ(inst.level.numVertices(), 4);
+	ASSERT_EQ(inst.level.numLinedefs(), 4);
+	ASSERT_EQ(inst.level.numSidedefs(), 4);
+	ASSERT_EQ(inst.level.numSectors(), 1);
+
+	for (const auto &L : inst.level.linedefs)
+		ASSERT_NE(L->start, L->end);
+
+	// all in one undo step
+	ASSERT_TRUE(inst.level.basis.undo());
+	ASSERT_EQ(inst.level.numVertices(), 5);
+	ASSERT_EQ(inst.level.numLinedefs(), 5);
+}
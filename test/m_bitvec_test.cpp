@@ -134,3 +134,78 @@ TEST(BitVec, Frob)
 		ASSERT_FALSE(vec.get(i));
 }
 
+
+TEST(BitVec, CountAndFind)
+{
+	bitvec_c vec(200);
+	ASSERT_EQ(vec.count(), 0);
+	ASSERT_EQ(vec.find_next(0), -1);
+	ASSERT_EQ(vec.find_last(), -1);
+
+	vec.set(3);
+	vec.set(63);
+	vec.set(64);
+	vec.set(190);
+	ASSERT_EQ(vec.count(), 4);
+	ASSERT_EQ(vec.find_next(0), 3);
+	ASSERT_EQ(vec.find_next(4), 63);
+	ASSERT_EQ(vec.find_next(64), 64);
+	ASSERT_EQ(vec.find_next(65), 190);
+	ASSERT_EQ(vec.find_next(191), -1);
+	ASSERT_EQ(vec.find_next(500), -1);
+	ASSERT_EQ(vec.find_last(), 190);
+
+	// bits past the end don't count
+	vec.set_all();
+	ASSERT_EQ(vec.count(), 200);
+	ASSERT_EQ(vec.find_last(), 199);
+	vec.toggle_all();
+	ASSERT_EQ(vec.count(), 0);
+}
+
+TEST(BitVec, FrobRange)
+{
+	bitvec_c vec(100);
+	vec.frob_range(10, 140, BitOp::add);
+	ASSERT_GE(vec.size(), 141);
+	for(int i = 0; i < vec.size(); ++i)
+		ASSERT_EQ(vec.get(i), i >= 10 && i <= 140);
+
+	vec.frob_range(60, 70, BitOp::remove);
+	vec.frob_range(0, 20, BitOp::toggle);
+	for(int i = 0; i < vec.size(); ++i)
+		ASSERT_EQ(vec.get(i), (i >= 0 && i < 10) || (i > 20 && i < 60) || (i > 70 && i <= 140));
+	ASSERT_EQ(vec.count(), 10 + 39 + 70);
+
+	// removing past the end doesn't grow it
+	int lastSize = vec.size();
+	vec.frob_range(100, 1000, BitOp::remove);
+	ASSERT_EQ(vec.size(), lastSize);
+	ASSERT_EQ(vec.find_last(), 99);
+}
+
+TEST(BitVec, SetAlgebra)
+{
+	bitvec_c a(100);
+	bitvec_c b(300);
+	for(int i = 0; i < 100; i += 2)
+		a.set(i);
+	for(int i = 0; i < 300; i += 3)
+		b.set(i);
+
+	bitvec_c merged(a);
+	merged.merge(b);
+	bitvec_c unmerged(a);
+	unmerged.unmerge(b);
+	bitvec_c intersected(b);
+	intersected.intersect(a);
+
+	for(int i = 0; i < 300; ++i)
+	{
+		bool inA = i < 100 && i % 2 == 0;
+		bool inB = i % 3 == 0;
+		ASSERT_EQ(merged.get(i), inA || inB);
+		ASSERT_EQ(unmerged.get(i), inA && !inB);
+		ASSERT_EQ(intersected.get(i), inA && inB);
+	}
+}
@@ -17,6 +17,7 @@
 //------------------------------------------------------------------------
 
 #include "m_config.h"
+#include "m_lint.h"
 
 #include "testUtils/FatalHandler.hpp"
 #include "testUtils/TempDirContext.hpp"
@@ -720,6 +721,7 @@ rgb_color_t config::transparent_col = rgbMake(0, 255, 255);
 bool config::auto_load_recent = false;
 int config::backup_max_files = 30;
 int config::backup_max_space = 60;  // MB
+int config::undo_max_space = 64;  // MB
 int  config::bsp_split_factor    = DEFAULT_FACTOR;
 int config::floor_bump_medium = 8;
 int config::floor_bump_large  = 64;
@@ -750,6 +752,8 @@ bool config::grid_hide_in_free_mode = false;
 bool config::sidedef_add_del_buttons = false;
 bool config::same_mode_clears_selection = false;
 bool config::bsp_fast        = false;
+bool config::bsp_incremental = false;
+bool config::bsp_verify_incremental = false;
 fs::path global::config_file;
 fs::path global::install_dir;
 int global::show_version  = 0;
@@ -758,6 +762,8 @@ fs::path global::log_file;
 std::vector<fs::path> global::Pwad_list;
 fs::path global::cache_dir;
 int global::show_help     = 0;
+fs::path global::lint_report;
+int global::lint_jobs = 0;
 
 Instance gInstance;
 
@@ -844,6 +850,38 @@ void Document::getLevelChecksum(crc32_c &crc) const
 {
 }
 
+void EditJournal::stop(bool removeFile)
+{
+}
+
+Hover::~Hover()
+{
+}
+
+void Basis::removeListener(ChangeListener &listener)
+{
+}
+
+void Instance::notifyBegin()
+{
+}
+
+void Instance::notifyInsert(ObjType type, int objnum, int count)
+{
+}
+
+void Instance::notifyDelete(ObjType type, int objnum)
+{
+}
+
+void Instance::notifyChanges(const ChangeBatch &changes)
+{
+}
+
+void Instance::notifyEnd()
+{
+}
+
 void Instance::Grid_WriteUser(std::ostream &os) const
 {
 	sUnitTokens["WriteUser"].push_back("grid");
@@ -877,7 +915,3 @@ void Instance::Render3D_WriteUser(std::ostream &os) const
 DocumentModule::DocumentModule(Document &doc) : inst(doc.inst), doc(doc)
 {
 }
-
-void Basis::EditUnit::destroy()
-{
-}
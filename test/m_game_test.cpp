@@ -193,6 +193,48 @@ TEST(MGame, ConfigDataGetThingType)
 	ASSERT_EQ(config.getThingType(-1).desc, "UNKNOWN TYPE");
 }
 
+TEST(MGame, ConfigDataCompiledDefinitions)
+{
+	ConfigData config = {};
+
+	thingtype_t type = {};
+	type.desc = "Low";
+	config.thing_types[5] = type;
+	type.desc = "High";
+	config.thing_types[40000] = type;
+	type.desc = "Negative";
+	config.thing_types[-3] = type;
+
+	linetype_t line = {};
+	line.desc = "Door";
+	config.line_types[1] = line;
+
+	config.compileDefinitions();
+
+	ASSERT_EQ(config.getThingType(5).desc, "Low");
+	ASSERT_EQ(config.getThingType(40000).desc, "High");
+	ASSERT_EQ(config.getThingType(-3).desc, "Negative");
+	ASSERT_FALSE(config.findThingType(6));
+	ASSERT_FALSE(config.findThingType(39999));
+	ASSERT_FALSE(config.findThingType(100000));
+	ASSERT_EQ(config.findLineType(1)->desc, "Door");
+	ASSERT_FALSE(config.findLineType(2));
+	ASSERT_FALSE(config.findSectorType(0));
+
+	// definitions added after compiling are still found
+	type.desc = "Late";
+	config.thing_types[7] = type;
+	ASSERT_EQ(config.getThingType(7).desc, "Late");
+	ASSERT_EQ(config.getThingType(5).desc, "Low");
+
+	// copies keep working on their own
+	ConfigData copy = config;
+	copy.compileDefinitions();
+	config.clearExceptDefaults();
+	ASSERT_EQ(copy.getThingType(7).desc, "Late");
+	ASSERT_EQ(config.getThingType(7).desc, "UNKNOWN TYPE");
+}
+
 TEST_F(MGameFixture, MCollectKnownDefs)
 {
 	//
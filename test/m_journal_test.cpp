@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  Copyright (C) 2022 Ioan Chera
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "e_basis.h"
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_journal.h"
+#include "m_select.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Vertex.h"
+
+#include <signal.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+//
+// Editor instance with what the notifications need
+//
+class JournalInstance : public Instance
+{
+public:
+	JournalInstance()
+	{
+		edit.Selected = &selection;
+	}
+
+private:
+	selection_c selection;
+};
+
+//
+// A square room, as loaded from the PWAD
+//
+static void MakeBaseline(Document &doc)
+{
+	auto sector = std::make_unique<Sector>();
+	sector->ceilh = 128;
+	sector->floor_tex = BA_InternaliseString("FLOOR0_1");
+	sector->ceil_tex = BA_InternaliseString("CEIL1_1");
+	doc.sectors.push_back(std::move(sector));
+
+	for(int i = 0; i < 4; ++i)
+	{
+		auto vertex = std::make_unique<Vertex>();
+		vertex->raw_x = FFixedPoint((i >= 2) ? 64 : 0);
+		vertex->raw_y = FFixedPoint((i == 1 || i == 2) ? 64 : 0);
+		doc.vertices.push_back(std::move(vertex));
+
+		auto side = std::make_unique<SideDef>();
+		side->mid_tex = BA_InternaliseString("STARTAN2");
+		doc.sidedefs.push_back(std::move(side));
+
+		auto line = std::make_unique<LineDef>();
+		line->start = i;
+		line->end = (i + 1) % 4;
+		line->right = i;
+		doc.linedefs.push_back(std::move(line));
+	}
+}
+
+//
+// Some edits, the way the editing commands do them
+//
+static void MakeEdits(Instance &inst)
+{
+	Basis &basis = inst.level.basis;
+	{
+		EditOperation op(basis);
+		op.setMessage("moved vertex");
+		op.changeVertex(0, Vertex::F_X, FFixedPoint(-32));
+		op.changeVertex(0, Vertex::F_X, FFixedPoint(-64));
+		op.changeSector(0, Sector::F_FLOOR_TEX, BA_InternaliseString("NUKAGE1"));
+	}
+	{
+		EditOperation op(basis);
+		int sec = op.addNew(ObjType::sectors);
+		int side = op.addNew(ObjType::sidedefs);
+		op.changeLinedef(3, LineDef::F_LEFT, side);
+
+		// new objects get filled in even after further operations
+		inst.level.sidedefs[side]->sector = sec;
+		inst.level.sidedefs[side]->lower_tex = BA_InternaliseString("SUPPORT2");
+		inst.level.sectors[sec]->floorh = 24;
+		inst.level.sectors[sec]->ceil_tex = BA_InternaliseString("F_SKY1");
+	}
+	{
+		EditOperation op(basis);
+		op.del(ObjType::vertices, 1);	// also deletes two linedefs
+	}
+	ASSERT_TRUE(basis.undo());
+	ASSERT_TRUE(basis.redo());
+	ASSERT_TRUE(basis.undo());
+	{
+		EditOperation op(basis);
+		op.changeSidedef(0, SideDef::F_X_OFFSET, 8);
+	}
+	{
+		EditOperation op(basis);
+		op.changeLinedef(0, LineDef::F_FLAGS, 1);
+		op.setAbort(true);	// kept, but not undoable
+	}
+}
+
+static void ExpectSameLevel(const Document &doc, const Document &expected)
+{
+	ASSERT_EQ(doc.numVertices(), expected.numVertices());
+	ASSERT_EQ(doc.numSectors(), expected.numSectors());
+	ASSERT_EQ(doc.numSidedefs(), expected.numSidedefs());
+	ASSERT_EQ(doc.numLinedefs(), expected.numLinedefs());
+
+	for(int i = 0; i < doc.numSectors(); ++i)
+	{
+		ASSERT_EQ(doc.sectors[i]->floorh, expected.sectors[i]->floorh);
+		ASSERT_EQ(doc.sectors[i]->FloorTex(), expected.sectors[i]->FloorTex());
+		ASSERT_EQ(doc.sectors[i]->CeilTex(), expected.sectors[i]->CeilTex());
+	}
+	for(int i = 0; i < doc.numSidedefs(); ++i)
+	{
+		ASSERT_EQ(doc.sidedefs[i]->sector, expected.sidedefs[i]->sector);
+		ASSERT_EQ(doc.sidedefs[i]->x_offset, expected.sidedefs[i]->x_offset);
+		ASSERT_EQ(doc.sidedefs[i]->LowerTex(), expected.sidedefs[i]->LowerTex());
+	}
+
+	crc32_c crc = EditJournal::baseline(doc);
+	crc32_c expectedCrc = EditJournal::baseline(expected);
+	ASSERT_EQ(crc.raw, expectedCrc.raw);
+	ASSERT_EQ(crc.extra, expectedCrc.extra);
+}
+
+class EditJournalFixture : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// Fixed name, since death tests may run in a fresh process
+		mPath = fs::temp_directory_path() / "eureka_test_MAP01.journal";
+		fs::remove(mPath);
+	}
+
+	void TearDown() override
+	{
+		std::error_code ec;
+		fs::remove(mPath, ec);
+	}
+
+	fs::path mPath;
+};
+
+TEST_F(EditJournalFixture, RecoverAfterKill)
+{
+	JournalInstance expected;
+	MakeBaseline(expected.level);
+	MakeEdits(expected);
+
+	// The editor dies right after the edits: no destructors, no clean stop
+	ASSERT_EXIT(
+		{
+			JournalInstance inst;
+			MakeBaseline(inst.level);
+			inst.journal.start(mPath, EditJournal::baseline(inst.level));
+			MakeEdits(inst);
+			inst.journal.flush();
+#ifdef _WIN32
+			TerminateProcess(GetCurrentProcess(), 3);
+#else
+			raise(SIGKILL);
+#endif
+		},
+#ifdef _WIN32
+		::testing::ExitedWithCode(3),
+#else
+		::testing::KilledBySignal(SIGKILL),
+#endif
+		"");
+
+	// Also simulate a torn write at the end
+	FILE *fp = fopen(mPath.u8string().c_str(), "ab");
+	ASSERT_NE(fp, nullptr);
+	fputs("G\x40", fp);
+	fclose(fp);
+
+	JournalInstance inst;
+	MakeBaseline(inst.level);
+	crc32_c base = EditJournal::baseline(inst.level);
+	ASSERT_TRUE(EditJournal::isRecoverable(mPath, base));
+
+	int numGroups = 0;
+	size_t length = EditJournal::replay(mPath, inst.level.basis, numGroups);
+	ASSERT_EQ(numGroups, 5);
+	ASSERT_EQ(length + 2, fs::file_size(mPath));
+
+	ExpectSameLevel(inst.level, expected.level);
+
+	// The recovered edits are undoable like the original ones
+	for(int i = 0; i < 3; ++i)
+	{
+		ASSERT_TRUE(inst.level.basis.undo());
+		ASSERT_TRUE(expected.level.basis.undo());
+		ExpectSameLevel(inst.level, expected.level);
+	}
+	ASSERT_FALSE(inst.level.basis.undo());
+	ASSERT_FALSE(expected.level.basis.undo());
+
+	// A journal of another level state doesn't apply
+	{
+		EditOperation op(inst.level.basis);
+		op.changeVertex(2, Vertex::F_Y, FFixedPoint(5));
+	}
+	ASSERT_FALSE(EditJournal::isRecoverable(mPath, EditJournal::baseline(inst.level)));
+}
+
+//
+// Continuing after recovery truncates the torn tail and keeps appending
+//
+TEST_F(EditJournalFixture, ContinueAfterReplay)
+{
+	JournalInstance inst;
+	MakeBaseline(inst.level);
+	crc32_c base = EditJournal::baseline(inst.level);
+
+	inst.journal.start(mPath, base);
+	ASSERT_FALSE(fs::exists(mPath));	// nothing written yet
+	{
+		EditOperation op(inst.level.basis);
+		op.changeSector(0, Sector::F_LIGHT, 200);
+	}
+	inst.journal.stop(false);
+
+	FILE *fp = fopen(mPath.u8string().c_str(), "ab");
+	ASSERT_NE(fp, nullptr);
+	fputs("Rubbish", fp);
+	fclose(fp);
+
+	JournalInstance second;
+	MakeBaseline(second.level);
+	int numGroups = 0;
+	size_t length = EditJournal::replay(mPath, second.level.basis, numGroups);
+	ASSERT_EQ(numGroups, 1);
+	ASSERT_EQ(second.level.sectors[0]->light, 200);
+
+	second.journal.start(mPath, base, length);
+	ASSERT_EQ(fs::file_size(mPath), length);
+	ASSERT_TRUE(second.level.basis.undo());
+	second.journal.stop(false);
+
+	JournalInstance third;
+	MakeBaseline(third.level);
+	EditJournal::replay(mPath, third.level.basis, numGroups);
+	ASSERT_EQ(third.level.sectors[0]->light, 0);
+	ASSERT_TRUE(third.level.basis.redo());
+	ASSERT_EQ(third.level.sectors[0]->light, 200);
+
+	third.journal.start(mPath, base, fs::file_size(mPath));
+	third.journal.stop(true);
+	ASSERT_FALSE(fs::exists(mPath));
+}
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "m_perf.h"
+
+#include "Instance.h"
+#include "m_select.h"
+#include "Sector.h"
+
+#include "gtest/gtest.h"
+
+TEST(MPerf, PercentilesOfRecentFrames)
+{
+	PerfCounters perf;
+
+	ASSERT_EQ(perf.frameCount(FrameKind::map2d), 0);
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 50), 0);
+
+	// 1..100 ms, in a scrambled order
+	for (int i = 0 ; i < 100 ; i++)
+		perf.addFrame(FrameKind::map2d, (i * 37) % 100 + 1, i % 4 == 0);
+
+	ASSERT_EQ(perf.frameCount(FrameKind::map2d), 100);
+	ASSERT_EQ(perf.frameCount(FrameKind::view3d), 0);
+	ASSERT_EQ(perf.reusedMapCount(), 25);
+
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 0), 1);
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 50), 51);
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 95), 96);
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 100), 100);
+
+	// the old frames drop out of the history
+	for (int i = 0 ; i < PERF_HISTORY ; i++)
+		perf.addFrame(FrameKind::map2d, 5);
+
+	ASSERT_EQ(perf.frameCount(FrameKind::map2d), 100 + PERF_HISTORY);
+	ASSERT_EQ(perf.percentile(FrameKind::map2d, 99), 5);
+
+	perf.addFrame(FrameKind::view3d, 20);
+	ASSERT_EQ(perf.percentile(FrameKind::view3d, 50), 20);
+	ASSERT_EQ(perf.reusedMapCount(), 25);
+}
+
+TEST(MPerf, FormatBytes)
+{
+	ASSERT_EQ(Perf_FormatBytes(0), "0 KB");
+	ASSERT_EQ(Perf_FormatBytes(1000), "1 KB");
+	ASSERT_EQ(Perf_FormatBytes(3 * 1024 * 1024 / 2), "1.5 MB");
+}
+
+TEST(MPerf, OverlayFollowsTheSectorCache)
+{
+	Instance inst;
+	selection_c selection;
+	inst.edit.Selected = &selection;
+
+	inst.level.sectors.push_back(std::make_unique<Sector>());
+
+	inst.sector_info_cache.Update();
+	inst.Subdiv_PolygonsForSector(0);
+
+	ASSERT_EQ(inst.sector_info_cache.rebuilds, 1);
+	ASSERT_EQ(inst.sector_info_cache.polygon_builds, 1);
+
+	std::vector<SString> lines = inst.Perf_OverlayLines();
+
+	ASSERT_EQ(lines.size(), 4u);
+	ASSERT_NE(lines[2].find("1 rebuilds  1 subdivided"), std::string::npos);
+	ASSERT_NE(lines[3].find("undo 0 KB  images 0 KB"), std::string::npos);
+}
@@ -19,6 +19,8 @@
 #include "m_select.h"
 #include "gtest/gtest.h"
 
+#include <random>
+
 TEST(MSelect, ChangeType)
 {
 	selection_c selection(ObjType::things);
@@ -657,3 +659,79 @@ TEST(MSelect, ExtendedSizeCanGrow)
 	for(int i = 0; i < 1024; ++i)
 		ASSERT_EQ(selection.get_ext(i), static_cast<byte>((i * i + 1) % 256));
 }
+
+//
+// The same selection, built up one object at a time
+//
+static void expectSameSelection(const selection_c &fast, const selection_c &slow)
+{
+	ASSERT_EQ(fast.count_obj(), slow.count_obj());
+	ASSERT_EQ(fast.max_obj(), slow.max_obj());
+	ASSERT_EQ(fast.find_first(), slow.find_first());
+	ASSERT_EQ(fast.find_second(), slow.find_second());
+
+	sel_iter_c it1(fast);
+	sel_iter_c it2(slow);
+	for(; !it1.done() && !it2.done(); it1.next(), it2.next())
+		ASSERT_EQ(*it1, *it2);
+	ASSERT_TRUE(it1.done());
+	ASSERT_TRUE(it2.done());
+}
+
+TEST(MSelect, BulkOperationsMatchSingleOnes)
+{
+	std::mt19937 random(99);
+
+	for(int round = 0; round < 300; ++round)
+	{
+		selection_c fast;
+		selection_c slow;
+		selection_c other;
+
+		// Small or big, sparse or dense selections
+		int range = random() % 2 ? 40 : 3000;
+		int num = (int)(random() % (range / 2));
+		for(int i = 0; i < num; ++i)
+		{
+			int n = (int)(random() % range);
+			fast.set(n);
+			slow.set(n);
+		}
+		num = (int)(random() % (range / 2));
+		for(int i = 0; i < num; ++i)
+			other.set((int)(random() % range));
+
+		int n1 = (int)(random() % range);
+		int n2 = n1 + (int)(random() % range);
+		BitOp op = (BitOp)(random() % 3);
+
+		switch(random() % 4)
+		{
+		case 0:
+			fast.frob_range(n1, n2, op);
+			for(int i = n1; i <= n2; ++i)
+				slow.frob(i, op);
+			break;
+		case 1:
+			fast.merge(other);
+			for(sel_iter_c it(other); !it.done(); it.next())
+				slow.set(*it);
+			break;
+		case 2:
+			fast.unmerge(other);
+			for(sel_iter_c it(other); !it.done(); it.next())
+				slow.clear(*it);
+			break;
+		default:
+			fast.intersect(other);
+			for(int i = 0; i <= slow.max_obj(); ++i)
+				if(slow.get(i) && !other.get(i))
+					slow.clear(i);
+			break;
+		}
+
+		expectSameSelection(fast, slow);
+		if(::testing::Test::HasFatalFailure())
+			FAIL() << "round " << round;
+	}
+}
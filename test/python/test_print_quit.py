@@ -38,7 +38,7 @@ def test_help_command():
                 saved_pos = pos
 
     assert parms == {'--home', '--install', '--log', '--config', '--help', '--version', '--debug',
-        '--quiet', '--file', '--merge', '--iwad', '--port', '--warp',
+        '--quiet', '--trace', '--lint', '--lint_jobs', '--file', '--merge', '--iwad', '--port', '--warp',
     }
 
     # Check that '<' marked arguments (like -warp) have an extra newline after
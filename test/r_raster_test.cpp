@@ -0,0 +1,557 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "im_img.h"
+#include "r_raster.h"
+#include "sys_macro.h"
+#include "testUtils/Palette.hpp"
+
+#include <random>
+#include <string.h>
+
+//
+// The canvas drawing code from before the tiled rasterizer, drawing
+// directly into the buffer. Screen coordinates start at (X0, Y0).
+//
+class DirectCanvas
+{
+public:
+	static const int X0 = 7;
+	static const int Y0 = 3;
+
+	DirectCanvas(int width, int height, const Palette &palette) :
+		rgb_w(width), rgb_h(height), rgb_buf(width * height * 3), palette(palette)
+	{
+	}
+
+	void RenderRect(int rx, int ry, int rw, int rh)
+	{
+		rx -= X0;
+		ry -= Y0;
+
+		if (rx + rw > rgb_w)
+			rw = rgb_w - rx;
+		if (rx < 0)
+		{
+			rw += rx;
+			rx = 0;
+		}
+		if (rw <= 0)
+			return;
+
+		if (ry + rh > rgb_h)
+			rh = rgb_h - ry;
+		if (ry < 0)
+		{
+			rh += ry;
+			ry = 0;
+		}
+		if (rh <= 0)
+			return;
+
+		byte *base = &rgb_buf[(ry * rgb_w * 3) + (rx * 3)];
+
+		for ( ; rh > 0 ; rh--, base += (rgb_w * 3))
+		{
+			byte *dest = base;
+
+			for (int w2 = rw ; w2 > 0 ; w2--)
+			{
+				*dest++ = cur_col.r;
+				*dest++ = cur_col.g;
+				*dest++ = cur_col.b;
+			}
+		}
+	}
+
+	int Calc_Outcode(int x, int y)
+	{
+		return ((y < 0) ? 1 : 0) | ((y >= rgb_h) ? 2 : 0) | ((x < 0) ? 4 : 0) | ((x >= rgb_w) ? 8 : 0);
+	}
+
+	void raw_pixel(int rx, int ry)
+	{
+		byte *dest = &rgb_buf[(rx + ry * rgb_w) * 3];
+
+		dest[0] = cur_col.r;
+		dest[1] = cur_col.g;
+		dest[2] = cur_col.b;
+	}
+
+	void RenderLine(int x1, int y1, int x2, int y2)
+	{
+		if (x1 == x2)
+		{
+			if (y1 > y2)
+				std::swap(y1, y2);
+
+			RenderRect(x1, y1, thickness, y2 - y1 + thickness);
+			return;
+		}
+		if (y1 == y2)
+		{
+			if (x1 > x2)
+				std::swap(x1, x2);
+
+			RenderRect(x1, y1, x2 - x1 + thickness, thickness);
+			return;
+		}
+
+		x1 -= X0; y1 -= Y0;
+		x2 -= X0; y2 -= Y0;
+
+		int out1 = Calc_Outcode(x1, y1);
+		int out2 = Calc_Outcode(x2, y2);
+
+		if (out1 & out2)
+			return;
+
+		while (out1 | out2)
+		{
+			int outside = (out1 ? out1 : out2);
+
+			int dx = x2 - x1;
+			int dy = y2 - y1;
+
+			if (dx == 0 && dy == 0)
+				return;
+
+			int new_x, new_y;
+
+			if (outside & 1)
+			{
+				new_y = 0;
+				new_x = x1 + dx * (new_y - y1) / dy;
+			}
+			else if (outside & 2)
+			{
+				new_y = rgb_h-1;
+				new_x = x1 + dx * (new_y - y1) / dy;
+			}
+			else if (outside & 4)
+			{
+				new_x = 0;
+				new_y = y1 + dy * (new_x - x1) / dx;
+			}
+			else
+			{
+				new_x = rgb_w-1;
+				new_y = y1 + dy * (new_x - x1) / dx;
+			}
+
+			if (out1)
+			{
+				x1 = new_x;
+				y1 = new_y;
+				out1 = Calc_Outcode(x1, y1);
+			}
+			else
+			{
+				x2 = new_x;
+				y2 = new_y;
+				out2 = Calc_Outcode(x2, y2);
+			}
+
+			if (out1 & out2)
+				return;
+		}
+
+		int dx = x2 - x1;
+		int dy = y2 - y1;
+
+		int ax = 2 * (dx < 0 ? -dx : dx);
+		int ay = 2 * (dy < 0 ? -dy : dy);
+
+		int sx = dx < 0 ? -1 : 1;
+		int sy = dy < 0 ? -1 : 1;
+
+		int x = x1;
+		int y = y1;
+
+		if (ax > ay)
+		{
+			int d = ay - ax/2;
+
+			raw_pixel(x, y);
+			if (thickness == 2 && y+1 < rgb_h) raw_pixel(x, y+1);
+
+			while (x != x2)
+			{
+				if (d>=0)
+				{
+					y += sy;
+					d -= ax;
+				}
+
+				x += sx;
+				d += ay;
+
+				raw_pixel(x, y);
+				if (thickness == 2 && y+1 < rgb_h) raw_pixel(x, y+1);
+			}
+		}
+		else
+		{
+			int d = ax - ay/2;
+
+			raw_pixel(x, y);
+			if (thickness == 2 && x+1 < rgb_w) raw_pixel(x+1, y);
+
+			while (y != y2)
+			{
+				if (d >= 0)
+				{
+					x += sx;
+					d -= ay;
+				}
+
+				y += sy;
+				d += ax;
+
+				raw_pixel(x, y);
+				if (thickness == 2 && x+1 < rgb_w) raw_pixel(x+1, y);
+			}
+		}
+	}
+
+	// one span of RenderSector(), already clipped to the screen
+	void RenderSpan(int y, int sx1, int sx2, const Img_c &img, int ty, const TileRaster::Color *light)
+	{
+		int tw = img.width();
+		const img_pixel_t *src_pix = img.buf();
+
+		int x = sx1;
+		int span_w = sx2 - sx1 + 1;
+
+		byte *dest = &rgb_buf[((x - X0) + (y - Y0) * rgb_w) * 3];
+		byte *dest_end = dest + span_w * 3;
+
+		for (; dest < dest_end ; dest += 3, x++)
+		{
+			int tx = (int)MAPX(x) & (tw - 1);
+
+			img_pixel_t pix = src_pix[ty * tw + tx];
+
+			palette.decodePixel(pix, dest[0], dest[1], dest[2]);
+
+			if (light)
+			{
+				dest[0] = (byte)(((int)dest[0] * (light->r * 0x101)) >> 16);
+				dest[1] = (byte)(((int)dest[1] * (light->g * 0x101)) >> 16);
+				dest[2] = (byte)(((int)dest[2] * (light->b * 0x101)) >> 16);
+			}
+		}
+	}
+
+	void RenderSprite(int bx1, int by1, int bx2, int by2, const Img_c &img)
+	{
+		int W = img.width();
+		int H = img.height();
+
+		int rx1 = std::max(bx1, 0);
+		int ry1 = std::max(by1, 0);
+
+		int rx2 = std::min(bx2, rgb_w) - 1;
+		int ry2 = std::min(by2, rgb_h) - 1;
+
+		if (rx1 >= rx2 || ry1 >= ry2)
+			return;
+
+		for (int ry = ry1 ; ry <= ry2 ; ry++)
+		{
+			byte *dest = &rgb_buf[3 * (rx1 + ry * rgb_w)];
+
+			for (int rx = rx1 ; rx <= rx2 ; rx++, dest += 3)
+			{
+				int ix = W * (rx - bx1) / (bx2 - bx1);
+				int iy = H * (ry - by1) / (by2 - by1);
+
+				ix = clamp(0, ix, W - 1);
+				iy = clamp(0, iy, H - 1);
+
+				img_pixel_t pix = img.buf()[iy * W + ix];
+
+				if (pix != TRANS_PIXEL)
+					palette.decodePixel(pix, dest[0], dest[1], dest[2]);
+			}
+		}
+	}
+
+	void RenderFontChar(int rx, int ry, const Img_c &img, int ix, int iy, int iw, int ih)
+	{
+		int sx1 = std::max(rx, 0);
+		int sy1 = std::max(ry, 0);
+
+		int sx2 = std::min(rx + iw, rgb_w) - 1;
+		int sy2 = std::min(ry + ih, rgb_h) - 1;
+
+		if (sx1 >= sx2 || sy1 >= sy2)
+			return;
+
+		for (int sy = sy1 ; sy <= sy2 ; sy++, iy++)
+		{
+			const img_pixel_t *src = img.buf() + (ix + iy * img.width());
+
+			byte *dest = &rgb_buf[3 * (sx1 + sy * rgb_w)];
+
+			for (int sx = sx1 ; sx <= sx2 ; sx++, dest += 3)
+			{
+				img_pixel_t pix = *src++;
+
+				if (pix != TRANS_PIXEL)
+					palette.decodePixel(pix, dest[0], dest[1], dest[2]);
+			}
+		}
+	}
+
+	double MAPX(int sx) const
+	{
+		return orig_x + (sx - rgb_w / 2 - X0) / scale;
+	}
+
+	int rgb_w, rgb_h;
+	std::vector<byte> rgb_buf;
+	const Palette &palette;
+
+	TileRaster::Color cur_col = {};
+	int thickness = 1;
+
+	double orig_x = 0;
+	double scale = 1;
+};
+
+static Img_c RandomImage(std::mt19937 &rng, int width, int height)
+{
+	Img_c img(width, height);
+	img_pixel_t *pix = img.wbuf();
+
+	for (int i = 0; i < width * height; ++i)
+		pix[i] = (rng() % 4 == 0) ? TRANS_PIXEL : static_cast<img_pixel_t>(rng() % 255);
+
+	return img;
+}
+
+//
+// Draws the same random scene both ways, and compares the images
+//
+static void CompareScene(unsigned seed, int width, int height, int numCommands, int numThreads)
+{
+	std::mt19937 rng(seed);
+
+	Palette palette;
+	makeCommonPalette(palette);
+
+	Img_c flat = RandomImage(rng, 64, 64);
+	Img_c sprite = RandomImage(rng, 37, 51);
+	Img_c font = RandomImage(rng, 14 * 14, 19);
+
+	DirectCanvas direct(width, height, palette);
+	std::vector<byte> tiled(width * height * 3);
+
+	TileRaster raster;
+	raster.begin(tiled.data(), width, height, palette);
+
+	direct.orig_x = 123.25;
+	direct.scale = 0.37;
+
+	const int X0 = DirectCanvas::X0;
+	const int Y0 = DirectCanvas::Y0;
+
+	auto coord = [&rng](int size)
+	{
+		return static_cast<int>(rng() % (size + 400)) - 200;
+	};
+
+	for (int i = 0; i < numCommands; ++i)
+	{
+		TileRaster::Color col = { (byte)rng(), (byte)rng(), (byte)rng() };
+		if (rng() % 3 == 0)
+			col.g = col.b = col.r;	// greyscale
+
+		direct.cur_col = col;
+		direct.thickness = (rng() % 3 == 0) ? 2 : 1;
+
+		switch (rng() % 6)
+		{
+			case 0:
+			{
+				int x = coord(width), y = coord(height);
+				int w = rng() % 300, h = rng() % 300;
+
+				direct.RenderRect(x, y, w, h);
+				raster.rect(x - X0, y - Y0, w, h, col);
+				break;
+			}
+			case 1:
+			case 2:
+			{
+				int x1 = coord(width), y1 = coord(height);
+				int x2 = coord(width), y2 = coord(height);
+
+				if (rng() % 8 == 0)
+					x2 = x1;
+				else if (rng() % 8 == 0)
+					y2 = y1;
+
+				direct.RenderLine(x1, y1, x2, y2);
+				raster.line(x1 - X0, y1 - Y0, x2 - X0, y2 - Y0, direct.thickness, col);
+				break;
+			}
+			case 3:
+			{
+				int y = Y0 + static_cast<int>(rng() % height);
+				int x1 = X0 + static_cast<int>(rng() % width);
+				int x2 = std::min(x1 + static_cast<int>(rng() % 400), X0 + width - 1);
+				int ty = rng() % 64;
+				bool lit = (rng() % 2 == 0);
+
+				direct.RenderSpan(y, x1, x2, flat, ty, lit ? &col : nullptr);
+				raster.flatSpan(y - Y0, x1 - X0, x2 - X0, flat.buf() + ty * 64, 64,
+								direct.orig_x, width / 2, direct.scale, lit ? &col : nullptr);
+				break;
+			}
+			case 4:
+			{
+				int bx1 = coord(width), by1 = coord(height);
+				int bx2 = bx1 + 1 + static_cast<int>(rng() % 150);
+				int by2 = by1 + 1 + static_cast<int>(rng() % 150);
+
+				direct.RenderSprite(bx1, by1, bx2, by2, sprite);
+				raster.sprite(bx1, by1, bx2, by2, sprite);
+				break;
+			}
+			default:
+			{
+				int rx = coord(width), ry = coord(height);
+				int ch = rng() % 14;
+
+				direct.RenderFontChar(rx, ry, font, ch * 14, 0, 14, 19);
+				raster.fontChar(rx, ry, font, ch * 14, 0, 14, 19);
+				break;
+			}
+		}
+	}
+
+	raster.finish(numThreads);
+
+	ASSERT_FALSE(raster.hasPending());
+
+	int differing = 0;
+	for (size_t i = 0; i < tiled.size(); ++i)
+		if (tiled[i] != direct.rgb_buf[i])
+			++differing;
+
+	ASSERT_EQ(differing, 0) << "seed " << seed;
+}
+
+TEST(TileRaster, SameAsDirectDrawing)
+{
+	for (unsigned seed = 1; seed <= 6; ++seed)
+	{
+		CompareScene(seed, 640, 480, 40, 1);
+		CompareScene(seed, 333, 217, 400, 1);
+		CompareScene(seed, 1000, 700, 3000, 4);
+	}
+}
+
+//
+// Long nearly diagonal lines step through many tiles
+//
+TEST(TileRaster, LongLines)
+{
+	Palette palette;
+	makeCommonPalette(palette);
+
+	const int width = 1280;
+	const int height = 1024;
+
+	DirectCanvas direct(width, height, palette);
+	std::vector<byte> tiled(width * height * 3);
+
+	TileRaster raster;
+	raster.begin(tiled.data(), width, height, palette);
+
+	for (int i = 0; i < 600; ++i)
+	{
+		TileRaster::Color col = { (byte)(i * 7), (byte)(i * 13), (byte)(i * 29) };
+		direct.cur_col = col;
+		direct.thickness = 1 + i % 2;
+
+		int x1 = (i * 37) % width - 300 + DirectCanvas::X0;
+		int y1 = -50 + DirectCanvas::Y0;
+		int x2 = x1 + 300 + i % 11;
+		int y2 = height + 50 - i % 5 + DirectCanvas::Y0;
+
+		if (i % 3 == 0)
+			std::swap(y1, y2);
+		if (i % 4 == 1)
+			std::swap(x1, y1), std::swap(x2, y2);
+
+		direct.RenderLine(x1, y1, x2, y2);
+		raster.line(x1 - DirectCanvas::X0, y1 - DirectCanvas::Y0, x2 - DirectCanvas::X0,
+					y2 - DirectCanvas::Y0, direct.thickness, col);
+	}
+
+	raster.finish(3);
+
+	ASSERT_EQ(memcmp(tiled.data(), direct.rgb_buf.data(), tiled.size()), 0);
+}
+
+//
+// The worker threads are kept between frames, and restarted when another
+// count is asked for
+//
+TEST(TileRaster, WorkersKeptBetweenFrames)
+{
+	Palette palette;
+	makeCommonPalette(palette);
+
+	const int width = 700;
+	const int height = 500;
+
+	TileRaster raster;
+	std::vector<byte> tiled(width * height * 3);
+
+	static const int threadCounts[] = { 4, 4, 2, 1, 3, 3, 4 };
+
+	for (int frame = 0; frame < 7; ++frame)
+	{
+		DirectCanvas direct(width, height, palette);
+
+		std::fill(tiled.begin(), tiled.end(), 0);
+		raster.begin(tiled.data(), width, height, palette);
+
+		for (int i = 0; i < 400; ++i)
+		{
+			TileRaster::Color col = { (byte)(i * 5 + frame), (byte)(i * 11), (byte)(i * 17 + frame) };
+			direct.cur_col = col;
+			direct.thickness = 1;
+
+			int x = (i * 53 + frame * 31) % width + DirectCanvas::X0;
+			int y = (i * 29 + frame * 7) % height + DirectCanvas::Y0;
+
+			direct.RenderRect(x, y, 40, 30);
+			raster.rect(x - DirectCanvas::X0, y - DirectCanvas::Y0, 40, 30, col);
+		}
+
+		raster.finish(threadCounts[frame]);
+
+		ASSERT_FALSE(raster.hasPending());
+		ASSERT_EQ(memcmp(tiled.data(), direct.rgb_buf.data(), tiled.size()), 0) << "frame " << frame;
+	}
+}
@@ -0,0 +1,194 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "Instance.h"
+#include "LineDef.h"
+#include "m_select.h"
+#include "r_subdiv.h"
+#include "Sector.h"
+#include "SideDef.h"
+#include "Vertex.h"
+
+#include <algorithm>
+#include <array>
+#include <math.h>
+#include <random>
+
+//
+// A grid of square sectors, with the linedefs in random order so each
+// sector's lines are spread over the whole linedef array
+//
+class SubdivFixture : public ::testing::Test
+{
+protected:
+	static const int SIZE = 16;
+	static const int CELL = 64;
+
+	void SetUp() override
+	{
+		inst.edit.Selected = &selection;
+	}
+
+	Document &doc()
+	{
+		return inst.level;
+	}
+
+	int sectorAt(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= SIZE || y >= SIZE)
+			return -1;
+		return y * SIZE + x;
+	}
+
+	int addSide(int sector)
+	{
+		if (sector < 0)
+			return -1;
+
+		auto side = std::make_unique<SideDef>();
+		side->sector = sector;
+		doc().sidedefs.push_back(std::move(side));
+		return doc().numSidedefs() - 1;
+	}
+
+	void makeGrid()
+	{
+		for (int y = 0 ; y <= SIZE ; y++)
+			for (int x = 0 ; x <= SIZE ; x++)
+			{
+				auto vertex = std::make_unique<Vertex>();
+				vertex->SetRawXY(MapFormat::doom, { double(x * CELL), double(y * CELL) });
+				doc().vertices.push_back(std::move(vertex));
+			}
+
+		for (int n = 0 ; n < SIZE * SIZE ; n++)
+			doc().sectors.push_back(std::make_unique<Sector>());
+
+		// (start vertex, end vertex, right sector, left sector)
+		std::vector<std::array<int, 4>> edges;
+
+		auto vertexAt = [](int x, int y) { return y * (SIZE + 1) + x; };
+
+		for (int y = 0 ; y <= SIZE ; y++)
+			for (int x = 0 ; x <= SIZE ; x++)
+			{
+				// going east, the right side is the cell below
+				if (x < SIZE)
+					edges.push_back({ vertexAt(x, y), vertexAt(x + 1, y),
+									  sectorAt(x, y - 1), sectorAt(x, y) });
+				// going north, the right side is the cell to the east
+				if (y < SIZE)
+					edges.push_back({ vertexAt(x, y), vertexAt(x, y + 1),
+									  sectorAt(x, y), sectorAt(x - 1, y) });
+			}
+
+		std::mt19937 random(1234);
+		std::shuffle(edges.begin(), edges.end(), random);
+
+		for (std::array<int, 4> &edge : edges)
+		{
+			if (edge[2] < 0)
+			{
+				std::swap(edge[0], edge[1]);
+				std::swap(edge[2], edge[3]);
+			}
+
+			auto line = std::make_unique<LineDef>();
+			line->start = edge[0];
+			line->end = edge[1];
+			line->right = addSide(edge[2]);
+			line->left = addSide(edge[3]);
+			doc().linedefs.push_back(std::move(line));
+		}
+	}
+
+	static double area(const sector_subdivision_c &sub)
+	{
+		double total = 0;
+
+		for (const sector_polygon_t &poly : sub.polygons)
+			for (int i = 0 ; i < poly.count ; i++)
+			{
+				int k = (i + 1) % poly.count;
+				total += poly.mx[i] * poly.my[k] - poly.mx[k] * poly.my[i];
+			}
+
+		return fabs(total) / 2;
+	}
+
+	Instance inst;
+	selection_c selection;
+};
+
+TEST_F(SubdivFixture, SectorsListTheirLines)
+{
+	makeGrid();
+
+	inst.sector_info_cache.Update();
+
+	for (int s = 0 ; s < doc().numSectors() ; s++)
+	{
+		const std::vector<int> &lines = inst.sector_info_cache.infos[s].lines;
+
+		ASSERT_EQ(lines.size(), 4u);
+		ASSERT_TRUE(std::is_sorted(lines.begin(), lines.end()));
+
+		for (int n : lines)
+			ASSERT_TRUE(doc().touchesSector(*doc().linedefs[n], s));
+	}
+}
+
+TEST_F(SubdivFixture, ParallelBuildMatchesSingleSectors)
+{
+	makeGrid();
+
+	std::vector<int> all(doc().numSectors());
+	for (int s = 0 ; s < doc().numSectors() ; s++)
+		all[s] = s;
+
+	inst.sector_info_cache.BuildPolygons(all, 4);
+
+	std::vector<std::vector<sector_polygon_t>> parallel;
+	for (int s = 0 ; s < doc().numSectors() ; s++)
+	{
+		ASSERT_TRUE(inst.sector_info_cache.infos[s].built);
+		parallel.push_back(inst.sector_info_cache.infos[s].sub.polygons);
+	}
+
+	inst.Subdiv_InvalidateAll();
+
+	for (int s = 0 ; s < doc().numSectors() ; s++)
+	{
+		const sector_subdivision_c *sub = inst.Subdiv_PolygonsForSector(s);
+
+		ASSERT_EQ(sub->polygons.size(), parallel[s].size());
+		ASSERT_DOUBLE_EQ(area(*sub), CELL * CELL);
+
+		for (size_t i = 0 ; i < sub->polygons.size() ; i++)
+		{
+			ASSERT_EQ(sub->polygons[i].count, parallel[s][i].count);
+
+			for (int k = 0 ; k < sub->polygons[i].count ; k++)
+			{
+				ASSERT_EQ(sub->polygons[i].mx[k], parallel[s][i].mx[k]);
+				ASSERT_EQ(sub->polygons[i].my[k], parallel[s][i].my[k]);
+			}
+		}
+	}
+}
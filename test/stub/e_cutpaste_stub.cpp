@@ -30,10 +30,6 @@ void Clipboard_NotifyBegin()
 {
 }
 
-void Clipboard_NotifyChange(ObjType type, int objnum, int field)
-{
-}
-
 void Clipboard_NotifyDelete(ObjType type, int objnum)
 {
 }
@@ -37,7 +37,7 @@ void Instance::MapStuff_NotifyBegin()
 {
 }
 
-void Instance::MapStuff_NotifyChange(ObjType type, int objnum, int field)
+void Instance::MapStuff_NotifyChanges(const ChangeBatch &changes)
 {
 }
 
@@ -57,7 +57,7 @@ void Instance::ObjectBox_NotifyBegin()
 {
 }
 
-void Instance::ObjectBox_NotifyChange(ObjType type, int objnum, int field)
+void Instance::ObjectBox_NotifyChanges(const ChangeBatch &changes)
 {
 }
 
@@ -104,7 +104,3 @@ void Recently_used::insert(const SString &name)
 void Recently_used::insert_number(int val)
 {
 }
-
-void Selection_NotifyChange(ObjType type, int objnum, int field)
-{
-}
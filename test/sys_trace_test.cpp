@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "sys_trace.h"
+
+#include "testUtils/TempDirContext.hpp"
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+class SysTraceTempDir : public TempDirContext
+{
+protected:
+	void SetUp() override
+	{
+		TempDirContext::SetUp();
+		trace::stop();
+		trace::clear();
+	}
+
+	void TearDown() override
+	{
+		trace::stop();
+		trace::clear();
+		TempDirContext::TearDown();
+	}
+
+	static int countOf(const std::string &text, const std::string &what)
+	{
+		int count = 0;
+		for (size_t pos = text.find(what) ; pos != std::string::npos ;
+			 pos = text.find(what, pos + 1))
+		{
+			count++;
+		}
+		return count;
+	}
+};
+
+TEST_F(SysTraceTempDir, NothingRecordedUntilStarted)
+{
+	{
+		trace::Scope scope("test", "ignored");
+	}
+	ASSERT_EQ(trace::eventCount(), 0);
+
+	trace::start();
+	{
+		trace::Scope scope("test", "kept");
+	}
+	trace::stop();
+	{
+		trace::Scope scope("test", "ignored");
+	}
+	ASSERT_EQ(trace::eventCount(), 1);
+}
+
+TEST_F(SysTraceTempDir, WritesCompleteEvents)
+{
+	trace::start();
+	{
+		trace::Scope outer("load", "Outer \"quoted\"");
+		{
+			trace::Scope inner("load", "Inner");
+		}
+
+		std::thread worker([]()
+		{
+			trace::Scope scope("render", "Worker");
+		});
+		worker.join();
+	}
+	trace::stop();
+
+	ASSERT_EQ(trace::eventCount(), 3);
+
+	fs::path path = getChildPath("trace.json");
+	ASSERT_TRUE(trace::writeJSON(path));
+	mDeleteList.push(path);
+
+	std::ifstream is(path.u8string());
+	std::stringstream ss;
+	ss << is.rdbuf();
+	std::string text = ss.str();
+
+	ASSERT_EQ(countOf(text, "\"ph\": \"X\""), 3);
+	ASSERT_EQ(countOf(text, "\"name\": \"Outer \\\"quoted\\\"\", \"cat\": \"load\""), 1);
+	ASSERT_EQ(countOf(text, "\"name\": \"Inner\", \"cat\": \"load\""), 1);
+	ASSERT_EQ(countOf(text, "\"name\": \"Worker\", \"cat\": \"render\""), 1);
+
+	// the inner scope ends first, the worker runs on its own thread
+	ASSERT_LT(text.find("\"Inner\""), text.find("\"Worker\""));
+	ASSERT_LT(text.find("\"Worker\""), text.find("\"Outer"));
+	ASSERT_EQ(countOf(text, "\"tid\": "), 3);
+	ASSERT_NE(text.substr(text.find("\"tid\"", text.find("\"Inner\"")), 10),
+			  text.substr(text.find("\"tid\"", text.find("\"Worker\"")), 10));
+
+	// the events are kept after writing
+	ASSERT_EQ(trace::eventCount(), 3);
+}
@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------
+//
+//  Eureka DOOM Editor
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//------------------------------------------------------------------------
+
+#include "ui_canvas.h"
+
+#include "Instance.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+static void FillRects(std::vector<Fl_Color> &image, int W, const std::vector<lod_rect_t> &rects)
+{
+	for(const lod_rect_t &rect : rects)
+		for(int y = rect.y; y < rect.y + rect.h; ++y)
+			for(int x = rect.x; x < rect.x + rect.w; ++x)
+				image[y * W + x] = rect.col;
+}
+
+TEST(UICanvas, HighlightOnlyMattersForSoundPropagation)
+{
+	Instance inst;
+
+	inst.edit.mode = ObjType::sectors;
+	inst.edit.sector_render_mode = SREND_Floor;
+
+	inst.edit.highlight = Objid(ObjType::sectors, 0);
+	map_cache_key_t first = UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480);
+
+	inst.edit.highlight = Objid(ObjType::sectors, 1);
+	ASSERT_EQ(UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480), first);
+
+	// the sector colours come from the highlighted sector
+	inst.edit.sector_render_mode = SREND_SoundProp;
+	map_cache_key_t second = UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480);
+
+	inst.edit.highlight = Objid(ObjType::sectors, 0);
+	map_cache_key_t third = UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480);
+
+	ASSERT_FALSE(second == third);
+	ASSERT_FALSE(first == third);
+
+	inst.edit.highlight.clear();
+	ASSERT_EQ(UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480).sound_sector, -1);
+
+	// and the view
+	ASSERT_FALSE(UI_Canvas::MapCacheKey(inst, 0, 0, 640, 480) ==
+				 UI_Canvas::MapCacheKey(inst, 0, 0, 800, 600));
+}
+
+//
+// Tiny linedefs and vertices cover the same pixels, in the same colors,
+// as drawing each one as a pixel would
+//
+TEST(UICanvas, MergedPixelsMatchDrawingEach)
+{
+	const int W = 40, H = 30;
+	const Fl_Color colors[] = { FL_GREEN, FL_WHITE, FL_RED, FL_BLUE };
+
+	std::mt19937 rng(1234);
+
+	lod_pixels_c lod;
+	std::vector<Fl_Color> expected(W * H, FL_BLACK);
+
+	for(int i = 0; i < 500; ++i)
+	{
+		// some of them off the canvas
+		int x = (int)(rng() % (W + 10)) - 5;
+		int y = (int)(rng() % (H + 10)) - 5;
+		Fl_Color col = colors[rng() % 4];
+
+		lod.plot(x, y, W, H, col);
+
+		if(x >= 0 && y >= 0 && x < W && y < H)
+			expected[y * W + x] = col;
+	}
+
+	std::vector<lod_rect_t> rects;
+	lod.flush(W, H, rects);
+
+	std::vector<Fl_Color> image(W * H, FL_BLACK);
+	FillRects(image, W, rects);
+	ASSERT_EQ(image, expected);
+
+	// runs of the same color are merged
+	ASSERT_LT(rects.size(), 500u);
+
+	// and it starts afresh
+	rects.clear();
+	lod.flush(W, H, rects);
+	ASSERT_TRUE(rects.empty());
+
+	lod.plot(3, 4, W, H, FL_RED);
+	lod.flush(W, H, rects);
+	ASSERT_EQ(rects.size(), 1u);
+	ASSERT_EQ(rects[0].x, 3);
+	ASSERT_EQ(rects[0].y, 4);
+	ASSERT_EQ(rects[0].col, FL_RED);
+}
+
+//
+// Tiny things show up as one marker in their cell, in the color of the
+// last one, bigger when there are more
+//
+TEST(UICanvas, MergedThingsMarkTheirCells)
+{
+	const int W = 40, H = 30;
+
+	lod_things_c lod;
+
+	lod.add(1, 1, W, H, FL_RED);
+
+	for(int i = 0; i < 8; ++i)
+		lod.add(20 + i % 4, 10 + i / 4, W, H, i < 7 ? FL_RED : FL_GREEN);
+
+	lod.add(-1, 5, W, H, FL_BLUE);
+	lod.add(5, H, W, H, FL_BLUE);
+
+	std::vector<lod_rect_t> rects;
+	lod.flush(rects);
+
+	ASSERT_EQ(rects.size(), 2u);
+
+	// each marker is inside the cell of its things
+	for(const lod_rect_t &rect : rects)
+	{
+		ASSERT_EQ(rect.x / 4, (rect.x + rect.w - 1) / 4);
+		ASSERT_EQ(rect.y / 4, (rect.y + rect.h - 1) / 4);
+	}
+
+	ASSERT_EQ(rects[0].x / 4, 0);
+	ASSERT_EQ(rects[0].y / 4, 0);
+	ASSERT_EQ(rects[0].w, 1);
+	ASSERT_EQ(rects[0].col, FL_RED);
+
+	ASSERT_EQ(rects[1].x / 4, 5);
+	ASSERT_EQ(rects[1].y / 4, 2);
+	ASSERT_EQ(rects[1].w, 4);
+	ASSERT_EQ(rects[1].col, FL_GREEN);
+
+	rects.clear();
+	lod.flush(rects);
+	ASSERT_TRUE(rects.empty());
+}
+
+//
+// Above the thresholds the objects are drawn as usual
+//
+TEST(UICanvas, LevelOfDetailThresholds)
+{
+	ASSERT_TRUE(UI_Canvas::LodVertices(0.1));
+	ASSERT_FALSE(UI_Canvas::LodVertices(0.125));
+	ASSERT_FALSE(UI_Canvas::LodVertices(1.0));
+
+	ASSERT_TRUE(UI_Canvas::LodLine(5, 7, 5, 7));
+	ASSERT_FALSE(UI_Canvas::LodLine(5, 7, 6, 7));
+	ASSERT_FALSE(UI_Canvas::LodLine(5, 7, 5, 6));
+
+	ASSERT_TRUE(UI_Canvas::LodThing(16, 0.05));
+	ASSERT_FALSE(UI_Canvas::LodThing(16, 0.0625));
+	ASSERT_FALSE(UI_Canvas::LodThing(20, 1.0));
+}
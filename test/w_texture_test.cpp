@@ -17,6 +17,7 @@
 //------------------------------------------------------------------------
 
 #include "WadData.h"
+#include "e_basis.h"
 #include "m_game.h"
 #include "w_wad.h"
 #include "gtest/gtest.h"
@@ -73,3 +74,41 @@ TEST(Texture, WadDataGetNullSprite)
     image = wadData.getSprite(config, 1234);
     ASSERT_FALSE(image);
 }
+
+TEST(Texture, ResolvedNamesFollowTheImageSet)
+{
+    ConfigData config;
+    config.miscInfo.sky_flat = "F_SKY1";
+
+    ImageSet images;
+    images.W_AddTexture("STARTAN", Img_c(4, 4), false);
+    images.W_AddFlat("FLOOR0_1", Img_c(64, 64));
+
+    StringID startan = BA_InternaliseString("STARTAN");
+    StringID nothing = BA_InternaliseString("-");
+    StringID special = BA_InternaliseString("#1234");
+    StringID floor = BA_InternaliseString("FLOOR0_1");
+    StringID sky = BA_InternaliseString("f_sky1");
+
+    const resolved_image_t &tex = images.resolveTexture(config, startan);
+    ASSERT_TRUE(tex.img);
+    ASSERT_EQ(tex.img->width(), 4);
+    ASSERT_FALSE(tex.null_tex);
+    ASSERT_FALSE(tex.special);
+
+    ASSERT_TRUE(images.resolveTexture(config, nothing).null_tex);
+    ASSERT_FALSE(images.resolveTexture(config, nothing).img);
+    ASSERT_TRUE(images.resolveTexture(config, special).special);
+
+    ASSERT_TRUE(images.resolveFlat(config, floor).img);
+    ASSERT_FALSE(images.resolveFlat(config, floor).sky);
+    ASSERT_TRUE(images.resolveFlat(config, sky).sky);
+    ASSERT_FALSE(images.resolveFlat(config, sky).img);
+
+    // replacing a texture is seen by the next lookup
+    images.W_AddTexture("STARTAN", Img_c(8, 8), false);
+    ASSERT_EQ(images.resolveTexture(config, startan).img->width(), 8);
+
+    images.W_ClearFlats();
+    ASSERT_FALSE(images.resolveFlat(config, floor).img);
+}